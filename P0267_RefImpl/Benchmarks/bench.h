@@ -0,0 +1,89 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ctime>
+#include <functional>
+#include <string>
+#include <vector>
+
+// A small benchmark harness modelled on Google Benchmark: benchmarks are registered with IO2D_BENCHMARK, time
+// the body of a `while (state.keep_running())` loop and can take integer arguments. Results are printed as a
+// table, and written in Google Benchmark's JSON format with --benchmark_out=<file> or --benchmark_format=json,
+// so that existing comparison tooling can read them.
+
+namespace io2d_bench {
+
+class state {
+public:
+    state(int64_t arg, int64_t iterations) noexcept : _Arg(arg), _Iterations(iterations) {}
+
+    // Returns true while the benchmark should run another iteration. Timing starts with the first call.
+    bool keep_running() noexcept {
+        if (_Done == 0) {
+            resume_timing();
+        }
+        if (_Done++ < _Iterations) {
+            return true;
+        }
+        pause_timing();
+        return false;
+    }
+
+    // Excludes the setup inside an iteration, like creating a surface that the benchmark consumes, from the timing.
+    void pause_timing() noexcept {
+        _Real += std::chrono::steady_clock::now() - _Real_start;
+        _Cpu += std::clock() - _Cpu_start;
+    }
+    void resume_timing() noexcept {
+        _Real_start = std::chrono::steady_clock::now();
+        _Cpu_start = std::clock();
+    }
+
+    int64_t arg() const noexcept { return _Arg; }
+    int64_t iterations() const noexcept { return _Iterations; }
+
+    void set_bytes_processed(int64_t bytes) noexcept { _Bytes = bytes; }
+    void set_items_processed(int64_t items) noexcept { _Items = items; }
+    void skip_with_error(const std::string& message) { _Error = message; }
+
+    std::chrono::nanoseconds real_time() const noexcept { return _Real; }
+    double cpu_seconds() const noexcept { return static_cast<double>(_Cpu) / CLOCKS_PER_SEC; }
+    int64_t bytes_processed() const noexcept { return _Bytes; }
+    int64_t items_processed() const noexcept { return _Items; }
+    const std::string& error() const noexcept { return _Error; }
+
+private:
+    int64_t _Arg;
+    int64_t _Iterations;
+    int64_t _Done = 0;
+    std::chrono::steady_clock::time_point _Real_start;
+    std::chrono::nanoseconds _Real{};
+    std::clock_t _Cpu_start = 0;
+    std::clock_t _Cpu = 0;
+    int64_t _Bytes = 0;
+    int64_t _Items = 0;
+    std::string _Error;
+};
+
+using benchmark_function = std::function<void(state&)>;
+
+// Registers fn, run once per argument, or once with an argument of 0 when args is empty.
+bool register_benchmark(const char* name, benchmark_function fn, std::vector<int64_t> args);
+
+// Keeps the compiler from discarding a value that a benchmark computes only to be timed.
+template <class T>
+inline void do_not_optimize(const T& value) {
+#if defined(_MSC_VER)
+    static volatile const void* sink;
+    sink = &value;
+#else
+    asm volatile("" : : "g"(&value) : "memory");
+#endif
+}
+
+}
+
+#define IO2D_BENCHMARK_CONCAT_IMPL(a, b) a##b
+#define IO2D_BENCHMARK_CONCAT(a, b) IO2D_BENCHMARK_CONCAT_IMPL(a, b)
+#define IO2D_BENCHMARK(fn, ...) static const bool IO2D_BENCHMARK_CONCAT(fn##_registered_, __LINE__) = ::io2d_bench::register_benchmark(#fn, fn, { __VA_ARGS__ })
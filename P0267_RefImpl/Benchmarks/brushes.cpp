@@ -0,0 +1,120 @@
+#include "bench.h"
+#include <io2d.h>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+using io2d_bench::state;
+
+static void BM_brush_solid(state& s) {
+    while (s.keep_running()) {
+        brush b{ rgba_color::cornflower_blue };
+        io2d_bench::do_not_optimize(b);
+    }
+}
+IO2D_BENCHMARK(BM_brush_solid);
+
+static void BM_brush_linear_gradient(state& s) {
+    while (s.keep_running()) {
+        brush b{ { 0.f, 0.f }, { 256.f, 0.f }, { gradient_stop{ 0.f, rgba_color::aquamarine }, gradient_stop{ 0.5f, rgba_color::dark_magenta }, gradient_stop{ 1.f, rgba_color::lime } } };
+        io2d_bench::do_not_optimize(b);
+    }
+}
+IO2D_BENCHMARK(BM_brush_linear_gradient);
+
+static void BM_brush_radial_gradient(state& s) {
+    while (s.keep_running()) {
+        brush b{ circle{ { 128.f, 128.f }, 0.f }, circle{ { 128.f, 128.f }, 128.f }, { gradient_stop{ 0.f, rgba_color::aquamarine }, gradient_stop{ 0.5f, rgba_color::dark_magenta }, gradient_stop{ 1.f, rgba_color::lime } } };
+        io2d_bench::do_not_optimize(b);
+    }
+}
+IO2D_BENCHMARK(BM_brush_radial_gradient);
+
+// The argument is the source surface's width and height. Creating the surface isn't timed.
+static void BM_brush_surface(state& s) {
+    const auto size = static_cast<int>(s.arg());
+    while (s.keep_running()) {
+        s.pause_timing();
+        image_surface img{ format::argb32, size, size };
+        s.resume_timing();
+        brush b{ move(img) };
+        io2d_bench::do_not_optimize(b);
+    }
+}
+IO2D_BENCHMARK(BM_brush_surface, 64, 256, 1024);
+
+// Paints a 256x256 surface with a 1024x1024 image shrunk by the argument, with and without a mip chain, using
+// filter::good. Building the brush isn't timed.
+static brush MinifiedBrush(bool mipmap) {
+    image_surface img{ format::argb32, 1024, 1024 };
+    img.paint(brush{ { 0.f, 0.f }, { 7.f, 3.f }, { gradient_stop{ 0.f, rgba_color::aquamarine }, gradient_stop{ 1.f, rgba_color::dark_magenta } } }, brush_props{ wrap_mode::reflect });
+    return brush{ move(img), mipmap };
+}
+
+static void PaintMinified(state& s, bool mipmap) {
+    const auto b = MinifiedBrush(mipmap);
+    image_surface target{ format::argb32, 256, 256 };
+    brush_props bp{ wrap_mode::repeat, filter::good };
+    bp.brush_matrix(matrix_2d::create_scale({ static_cast<float>(s.arg()), static_cast<float>(s.arg()) }));
+    while (s.keep_running()) {
+        target.paint(b, bp);
+    }
+    s.set_items_processed(s.iterations() * 256 * 256);
+}
+
+static void BM_paint_minified_surface_brush(state& s) {
+    PaintMinified(s, false);
+}
+IO2D_BENCHMARK(BM_paint_minified_surface_brush, 1, 2, 4, 8, 16, 32);
+
+static void BM_paint_minified_mipmapped_surface_brush(state& s) {
+    PaintMinified(s, true);
+}
+IO2D_BENCHMARK(BM_paint_minified_mipmapped_surface_brush, 1, 2, 4, 8, 16, 32);
+
+// Draws the argument's number of distinct 16x16 icons onto a 1024x1024 surface, each through its own surface brush or
+// through a brush over the page of a brush_atlas that holds it. Making the icons, brushes and atlas isn't timed.
+static image_surface Icon(int i) {
+    image_surface icon{ format::argb32, 16, 16 };
+    icon.paint(brush{ rgba_color(i % 256, (i * 7) % 256, (i * 13) % 256) });
+    return icon;
+}
+
+static point_2d IconOrigin(int i) {
+    return { static_cast<float>(i % 64 * 16), static_cast<float>(i / 64 % 64 * 16) };
+}
+
+static void BM_draw_icons_separate_brushes(state& s) {
+    const auto count = static_cast<int>(s.arg());
+    vector<brush> icons;
+    for (int i = 0; i < count; ++i) {
+        icons.emplace_back(Icon(i));
+    }
+    image_surface target{ format::argb32, 1024, 1024 };
+    while (s.keep_running()) {
+        for (int i = 0; i < count; ++i) {
+            const auto origin = IconOrigin(i);
+            target.fill(icons[i], interpreted_path{ bounding_box{ origin.x(), origin.y(), 16.f, 16.f } }, brush_props{ wrap_mode::none, filter::fast, fill_rule::winding, matrix_2d::create_translate({ -origin.x(), -origin.y() }) });
+        }
+    }
+    s.set_items_processed(s.iterations() * count);
+}
+IO2D_BENCHMARK(BM_draw_icons_separate_brushes, 256, 4096);
+
+static void BM_draw_icons_atlas(state& s) {
+    const auto count = static_cast<int>(s.arg());
+    brush_atlas atlas;
+    vector<size_t> keys;
+    for (int i = 0; i < count; ++i) {
+        keys.push_back(atlas.insert(Icon(i)));
+    }
+    image_surface target{ format::argb32, 1024, 1024 };
+    while (s.keep_running()) {
+        for (int i = 0; i < count; ++i) {
+            const auto origin = IconOrigin(i);
+            target.fill(brush{ atlas, keys[i] }, interpreted_path{ bounding_box{ origin.x(), origin.y(), 16.f, 16.f } }, brush_props{ wrap_mode::none, filter::fast, fill_rule::winding, atlas.brush_matrix(keys[i], origin) });
+        }
+    }
+    s.set_items_processed(s.iterations() * count);
+}
+IO2D_BENCHMARK(BM_draw_icons_atlas, 256, 4096);
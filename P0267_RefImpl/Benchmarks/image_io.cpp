@@ -0,0 +1,148 @@
+#include "bench.h"
+#include <io2d.h>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+using io2d_bench::state;
+
+// Loading and saving through the backend's codecs; the argument is the image's width and height. The largest saves are
+// big enough to be converted in bands on a second thread.
+
+static filesystem::path BenchmarkImagePath(const char* extension, int64_t size) {
+    return filesystem::temp_directory_path() / ("io2d_bench_" + to_string(size) + extension);
+}
+
+static image_surface GradientImage(int size) {
+    image_surface img{ format::argb32, size, size };
+    const auto s = static_cast<float>(size);
+    img.paint(brush{ { 0.f, 0.f }, { s, s }, { gradient_stop{ 0.f, rgba_color::aquamarine }, gradient_stop{ 1.f, rgba_color::dark_magenta } } });
+    return img;
+}
+
+static void Save(state& s, image_file_format fmt, const char* extension) {
+    auto img = GradientImage(static_cast<int>(s.arg()));
+    const auto path = BenchmarkImagePath(extension, s.arg());
+    while (s.keep_running()) {
+        error_code ec;
+        img.save(path, fmt, ec);
+        if (ec) {
+            s.skip_with_error(ec.message());
+            break;
+        }
+    }
+    filesystem::remove(path);
+    s.set_items_processed(s.iterations() * s.arg() * s.arg());
+}
+
+static void Load(state& s, image_file_format fmt, const char* extension, int maxDimension = 0) {
+    const auto path = BenchmarkImagePath(extension, s.arg());
+    GradientImage(static_cast<int>(s.arg())).save(path, fmt);
+    while (s.keep_running()) {
+        error_code ec;
+        image_surface img{ path, fmt, format::argb32, maxDimension, ec };
+        if (ec) {
+            s.skip_with_error(ec.message());
+            break;
+        }
+        io2d_bench::do_not_optimize(img);
+    }
+    filesystem::remove(path);
+    s.set_items_processed(s.iterations() * s.arg() * s.arg());
+}
+
+static void BM_save_png(state& s) {
+    Save(s, image_file_format::png, ".png");
+}
+IO2D_BENCHMARK(BM_save_png, 256, 1024, 4096);
+
+static void BM_load_png(state& s) {
+    Load(s, image_file_format::png, ".png");
+}
+IO2D_BENCHMARK(BM_load_png, 256, 1024);
+
+static void BM_save_jpeg(state& s) {
+    Save(s, image_file_format::jpeg, ".jpg");
+}
+IO2D_BENCHMARK(BM_save_jpeg, 256, 1024, 4096);
+
+static void BM_load_jpeg(state& s) {
+    Load(s, image_file_format::jpeg, ".jpg");
+}
+IO2D_BENCHMARK(BM_load_jpeg, 256, 1024);
+
+// QOI, for frame dumps and render caches; compare with BM_save_png and BM_load_png.
+static void BM_save_qoi(state& s) {
+    Save(s, default_graphics_surfaces::additional_image_file_formats::qoi, ".qoi");
+}
+IO2D_BENCHMARK(BM_save_qoi, 256, 1024, 4096);
+
+static void BM_load_qoi(state& s) {
+    Load(s, default_graphics_surfaces::additional_image_file_formats::qoi, ".qoi");
+}
+IO2D_BENCHMARK(BM_load_qoi, 256, 1024);
+
+// Loads a 512px thumbnail of each image; compare with BM_load_png and BM_load_jpeg at the same size.
+static void BM_load_png_thumbnail(state& s) {
+    Load(s, image_file_format::png, ".png", 512);
+}
+IO2D_BENCHMARK(BM_load_png_thumbnail, 1024, 4096);
+
+static void BM_load_jpeg_thumbnail(state& s) {
+    Load(s, image_file_format::jpeg, ".jpg", 512);
+}
+IO2D_BENCHMARK(BM_load_jpeg_thumbnail, 1024, 4096);
+
+// Loads the same PNG over and over with the decoded image cache on; compare with BM_load_png.
+static void BM_load_png_cached(state& s) {
+    image_surface::cache_budget(256 * 1024 * 1024);
+    Load(s, image_file_format::png, ".png");
+    image_surface::cache_budget(0);
+}
+IO2D_BENCHMARK(BM_load_png_cached, 256, 1024);
+
+// Maps a native image file instead of decoding it; compare with BM_load_png.
+static void BM_load_native(state& s) {
+    Load(s, default_graphics_surfaces::additional_image_file_formats::native, ".io2d");
+}
+IO2D_BENCHMARK(BM_load_native, 256, 1024, 4096);
+
+// Loads a directory of PNG and JPEG assets with load_images; the argument is the number of threads.
+static const int BatchImageCount = 32;
+static const int BatchImageSize = 512;
+
+static vector<string> WriteBatchImages() {
+    const auto directory = filesystem::temp_directory_path() / "io2d_bench_batch";
+    filesystem::create_directories(directory);
+    auto img = GradientImage(BatchImageSize);
+    vector<string> paths;
+    for (int i = 0; i < BatchImageCount; i++) {
+        const bool png = i % 2 == 0;
+        const auto path = directory / ("asset" + to_string(i) + (png ? ".png" : ".jpg"));
+        if (!filesystem::exists(path)) {
+            img.save(path, png ? image_file_format::png : image_file_format::jpeg);
+        }
+        paths.push_back(path.string());
+    }
+    return paths;
+}
+
+static void BM_load_images(state& s) {
+    const auto paths = WriteBatchImages();
+    while (s.keep_running()) {
+        auto images = image_surface::load_images(paths, image_file_format::unknown, format::argb32, static_cast<unsigned int>(s.arg()));
+        for (auto& image : images) {
+            try {
+                io2d_bench::do_not_optimize(image.get());
+            }
+            catch (const system_error& e) {
+                s.skip_with_error(e.what());
+            }
+        }
+        if (!s.error().empty()) {
+            break;
+        }
+    }
+    s.set_items_processed(s.iterations() * BatchImageCount);
+}
+IO2D_BENCHMARK(BM_load_images, 1, 2, 4, 8, 16);
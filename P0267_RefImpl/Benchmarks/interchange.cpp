@@ -0,0 +1,42 @@
+#include "bench.h"
+#include <io2d.h>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+using io2d_bench::state;
+
+// _Interchange_buffer conversions from cairo's premultiplied BGRA; the argument is the width and height.
+
+static void Convert(state& s, _Interchange_buffer::pixel_layout layout, _Interchange_buffer::alpha_mode alpha) {
+    const auto size = static_cast<int>(s.arg());
+    vector<byte> source(static_cast<size_t>(size) * size * 4);
+    for (size_t i = 0; i < source.size(); ++i) {
+        source[i] = static_cast<byte>(i * 31 % 251);
+    }
+    while (s.keep_running()) {
+        _Interchange_buffer buffer{ layout, alpha, source.data(), _Interchange_buffer::pixel_layout::b8g8r8a8, _Interchange_buffer::alpha_mode::premultiplied, size, size };
+        io2d_bench::do_not_optimize(buffer);
+    }
+    s.set_bytes_processed(s.iterations() * static_cast<int64_t>(source.size()));
+}
+
+static void BM_interchange_copy(state& s) {
+    Convert(s, _Interchange_buffer::pixel_layout::b8g8r8a8, _Interchange_buffer::alpha_mode::premultiplied);
+}
+IO2D_BENCHMARK(BM_interchange_copy, 256, 1024);
+
+static void BM_interchange_rgba_straight(state& s) {
+    Convert(s, _Interchange_buffer::pixel_layout::r8g8b8a8, _Interchange_buffer::alpha_mode::straight);
+}
+IO2D_BENCHMARK(BM_interchange_rgba_straight, 256, 1024);
+
+static void BM_interchange_r5g6b5(state& s) {
+    Convert(s, _Interchange_buffer::pixel_layout::r5g6b5, _Interchange_buffer::alpha_mode::ignore);
+}
+IO2D_BENCHMARK(BM_interchange_r5g6b5, 256, 1024);
+
+static void BM_interchange_a8(state& s) {
+    Convert(s, _Interchange_buffer::pixel_layout::a8, _Interchange_buffer::alpha_mode::straight);
+}
+IO2D_BENCHMARK(BM_interchange_a8, 256, 1024);
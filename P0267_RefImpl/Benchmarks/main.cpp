@@ -0,0 +1,191 @@
+#include "bench.h"
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <regex>
+#include <thread>
+
+using namespace std;
+
+namespace io2d_bench {
+
+namespace {
+    struct registration {
+        string name;
+        benchmark_function fn;
+        int64_t arg;
+    };
+
+    vector<registration>& registry() {
+        static vector<registration> benchmarks;
+        return benchmarks;
+    }
+
+    struct result {
+        string name;
+        int64_t iterations;
+        double real_ns;
+        double cpu_ns;
+        double bytes_per_second;
+        double items_per_second;
+        string error;
+    };
+
+    string json_escape(const string& s) {
+        string escaped;
+        for (auto c : s) {
+            if (c == '"' || c == '\\') {
+                escaped += '\\';
+            }
+            escaped += c;
+        }
+        return escaped;
+    }
+
+    // Like Google Benchmark, grows the iteration count until a run takes at least minTime, then reports that run.
+    result run(const registration& r, double minTime) {
+        int64_t iterations = 1;
+        for (;;) {
+            state s{ r.arg, iterations };
+            r.fn(s);
+            const auto seconds = chrono::duration<double>(s.real_time()).count();
+            if (!s.error().empty() || seconds >= minTime || iterations >= 1'000'000'000) {
+                result res{ r.name, iterations, 0., 0., 0., 0., s.error() };
+                res.real_ns = seconds * 1e9 / iterations;
+                res.cpu_ns = s.cpu_seconds() * 1e9 / iterations;
+                if (seconds > 0.) {
+                    res.bytes_per_second = s.bytes_processed() / seconds;
+                    res.items_per_second = s.items_processed() / seconds;
+                }
+                return res;
+            }
+            // Aims 40% past the target so that the next run is likely to be the last one.
+            const auto multiplier = seconds <= minTime / 10. ? 10. : minTime * 1.4 / seconds;
+            iterations = max(iterations + 1, static_cast<int64_t>(iterations * multiplier));
+        }
+    }
+
+    void write_json(ostream& os, const vector<result>& results) {
+        const auto now = time(nullptr);
+        char date[64];
+        strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%S", localtime(&now));
+        os << "{\n  \"context\": {\n";
+        os << "    \"date\": \"" << date << "\",\n";
+        os << "    \"num_cpus\": " << thread::hardware_concurrency() << ",\n";
+#if defined(NDEBUG)
+        os << "    \"library_build_type\": \"release\"\n";
+#else
+        os << "    \"library_build_type\": \"debug\"\n";
+#endif
+        os << "  },\n  \"benchmarks\": [";
+        bool first = true;
+        os << setprecision(12);
+        for (const auto& r : results) {
+            os << (first ? "\n" : ",\n") << "    {\n";
+            os << "      \"name\": \"" << json_escape(r.name) << "\",\n";
+            os << "      \"run_name\": \"" << json_escape(r.name) << "\",\n";
+            os << "      \"run_type\": \"iteration\",\n";
+            if (!r.error.empty()) {
+                os << "      \"error_occurred\": true,\n";
+                os << "      \"error_message\": \"" << json_escape(r.error) << "\",\n";
+            }
+            os << "      \"iterations\": " << r.iterations << ",\n";
+            os << "      \"real_time\": " << r.real_ns << ",\n";
+            os << "      \"cpu_time\": " << r.cpu_ns << ",\n";
+            if (r.bytes_per_second > 0.) {
+                os << "      \"bytes_per_second\": " << r.bytes_per_second << ",\n";
+            }
+            if (r.items_per_second > 0.) {
+                os << "      \"items_per_second\": " << r.items_per_second << ",\n";
+            }
+            os << "      \"time_unit\": \"ns\"\n    }";
+            first = false;
+        }
+        os << "\n  ]\n}\n";
+    }
+
+    void write_row(ostream& os, const result& r) {
+        os << left << setw(48) << r.name << right;
+        if (!r.error.empty()) {
+            os << " ERROR: " << r.error << '\n';
+            return;
+        }
+        os << setw(14) << fixed << setprecision(0) << r.real_ns << " ns" << setw(14) << r.cpu_ns << " ns" << setw(12) << r.iterations;
+        if (r.bytes_per_second > 0.) {
+            os << setw(12) << setprecision(1) << r.bytes_per_second / (1024. * 1024.) << " MiB/s";
+        }
+        if (r.items_per_second > 0.) {
+            os << setw(12) << setprecision(1) << r.items_per_second / 1000. << " k items/s";
+        }
+        os << defaultfloat << '\n';
+    }
+}
+
+bool register_benchmark(const char* name, benchmark_function fn, vector<int64_t> args) {
+    if (args.empty()) {
+        registry().push_back({ name, fn, 0 });
+    }
+    for (auto arg : args) {
+        registry().push_back({ string(name) + "/" + to_string(arg), fn, arg });
+    }
+    return true;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    using namespace io2d_bench;
+    string filter = ".";
+    string out;
+    bool jsonToStdout = false;
+    double minTime = 0.5;
+    for (int i = 1; i < argc; ++i) {
+        const string a = argv[i];
+        auto value = [&](const char* option) {
+            return a.compare(0, strlen(option), option) == 0 ? a.substr(strlen(option)) : string();
+        };
+        if (a.rfind("--benchmark_filter=", 0) == 0) {
+            filter = value("--benchmark_filter=");
+        }
+        else if (a.rfind("--benchmark_out=", 0) == 0) {
+            out = value("--benchmark_out=");
+        }
+        else if (a == "--benchmark_format=json") {
+            jsonToStdout = true;
+        }
+        else if (a.rfind("--benchmark_min_time=", 0) == 0) {
+            minTime = stod(value("--benchmark_min_time="));
+        }
+        else {
+            cerr << "usage: " << argv[0] << " [--benchmark_filter=<regex>] [--benchmark_min_time=<seconds>] [--benchmark_out=<file.json>] [--benchmark_format=json]\n";
+            return 1;
+        }
+    }
+
+    const regex re{ filter };
+    vector<result> results;
+    auto& table = jsonToStdout ? cerr : cout;
+    table << left << setw(48) << "Benchmark" << right << setw(17) << "Time" << setw(17) << "CPU" << setw(12) << "Iterations" << '\n';
+    for (const auto& r : registry()) {
+        if (!regex_search(r.name, re)) {
+            continue;
+        }
+        results.push_back(run(r, minTime));
+        write_row(table, results.back());
+    }
+
+    if (jsonToStdout) {
+        write_json(cout, results);
+    }
+    if (!out.empty()) {
+        ofstream file{ out };
+        if (!file) {
+            cerr << "Couldn't open " << out << '\n';
+            return 1;
+        }
+        write_json(file, results);
+    }
+    return any_of(begin(results), end(results), [](const result& r) { return !r.error.empty(); }) ? 1 : 0;
+}
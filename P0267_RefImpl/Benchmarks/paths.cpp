@@ -0,0 +1,52 @@
+#include "bench.h"
+#include <io2d.h>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+using io2d_bench::state;
+
+// Path interpretation; the argument is the number of segments in the path.
+
+static void Interpret(state& s, const path_builder& pb) {
+    while (s.keep_running()) {
+        interpreted_path ip{ pb };
+        io2d_bench::do_not_optimize(ip);
+    }
+    s.set_items_processed(s.iterations() * s.arg());
+}
+
+static void BM_interpret_lines(state& s) {
+    path_builder pb;
+    pb.new_figure({ 0.f, 0.f });
+    for (int64_t i = 0; i < s.arg(); ++i) {
+        pb.rel_line({ 3.f, (i % 2 == 0) ? 5.f : -5.f });
+    }
+    Interpret(s, pb);
+}
+IO2D_BENCHMARK(BM_interpret_lines, 16, 256, 4096);
+
+static void BM_interpret_curves(state& s) {
+    path_builder pb;
+    pb.new_figure({ 0.f, 0.f });
+    for (int64_t i = 0; i < s.arg(); ++i) {
+        if (i % 2 == 0) {
+            pb.rel_cubic_curve({ 1.f, 4.f }, { 2.f, -4.f }, { 3.f, 0.f });
+        }
+        else {
+            pb.rel_quadratic_curve({ 1.5f, 4.f }, { 3.f, 0.f });
+        }
+    }
+    Interpret(s, pb);
+}
+IO2D_BENCHMARK(BM_interpret_curves, 16, 256, 4096);
+
+static void BM_interpret_arcs(state& s) {
+    path_builder pb;
+    pb.new_figure({ 0.f, 0.f });
+    for (int64_t i = 0; i < s.arg(); ++i) {
+        pb.arc({ 4.f, 4.f }, half_pi<float>, static_cast<float>(i % 4) * half_pi<float>);
+    }
+    Interpret(s, pb);
+}
+IO2D_BENCHMARK(BM_interpret_arcs, 16, 256, 4096);
@@ -0,0 +1,96 @@
+#include "bench.h"
+#include <io2d.h>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+using io2d_bench::state;
+
+// Rendering on image_surface; the argument is the surface's width and height.
+
+static interpreted_path CirclePath(float size) {
+    path_builder pb;
+    pb.new_figure({ size * 0.9f, size * 0.5f });
+    pb.arc({ size * 0.4f, size * 0.4f }, two_pi<float>, 0.f);
+    pb.close_figure();
+    return interpreted_path{ pb };
+}
+
+static void SetPixelsProcessed(state& s) {
+    s.set_items_processed(s.iterations() * s.arg() * s.arg());
+}
+
+static void BM_paint(state& s) {
+    image_surface img{ format::argb32, static_cast<int>(s.arg()), static_cast<int>(s.arg()) };
+    const brush b{ rgba_color::cornflower_blue };
+    while (s.keep_running()) {
+        img.paint(b);
+    }
+    SetPixelsProcessed(s);
+}
+IO2D_BENCHMARK(BM_paint, 64, 256, 1024);
+
+static void BM_fill(state& s) {
+    const auto size = static_cast<float>(s.arg());
+    image_surface img{ format::argb32, static_cast<int>(s.arg()), static_cast<int>(s.arg()) };
+    const brush b{ rgba_color::cornflower_blue };
+    const auto ip = CirclePath(size);
+    while (s.keep_running()) {
+        img.fill(b, ip);
+    }
+    SetPixelsProcessed(s);
+}
+IO2D_BENCHMARK(BM_fill, 64, 256, 1024);
+
+static void BM_stroke(state& s) {
+    const auto size = static_cast<float>(s.arg());
+    image_surface img{ format::argb32, static_cast<int>(s.arg()), static_cast<int>(s.arg()) };
+    const brush b{ rgba_color::cornflower_blue };
+    const auto ip = CirclePath(size);
+    const stroke_props sp{ size / 32.f };
+    while (s.keep_running()) {
+        img.stroke(b, ip, nullopt, sp);
+    }
+    SetPixelsProcessed(s);
+}
+IO2D_BENCHMARK(BM_stroke, 64, 256, 1024);
+
+static void BM_stroke_dashed(state& s) {
+    const auto size = static_cast<float>(s.arg());
+    image_surface img{ format::argb32, static_cast<int>(s.arg()), static_cast<int>(s.arg()) };
+    const brush b{ rgba_color::cornflower_blue };
+    const auto ip = CirclePath(size);
+    const stroke_props sp{ size / 32.f };
+    const dashes d{ 0.f, { size / 16.f, size / 32.f } };
+    while (s.keep_running()) {
+        img.stroke(b, ip, nullopt, sp, d);
+    }
+    SetPixelsProcessed(s);
+}
+IO2D_BENCHMARK(BM_stroke_dashed, 64, 256, 1024);
+
+static void BM_mask(state& s) {
+    const auto size = static_cast<float>(s.arg());
+    image_surface img{ format::argb32, static_cast<int>(s.arg()), static_cast<int>(s.arg()) };
+    const brush b{ rgba_color::cornflower_blue };
+    const brush mb{ { 0.f, 0.f }, { size, 0.f }, { gradient_stop{ 0.f, rgba_color::transparent_black }, gradient_stop{ 1.f, rgba_color::black } } };
+    while (s.keep_running()) {
+        img.mask(b, mb);
+    }
+    SetPixelsProcessed(s);
+}
+IO2D_BENCHMARK(BM_mask, 64, 256, 1024);
+
+// Filling the same circle on a tiled_image_surface, which draws it once per tile it touches; compare with BM_fill.
+// The surface is split into 256 pixel tiles.
+static void BM_fill_tiled(state& s) {
+    const auto size = static_cast<float>(s.arg());
+    tiled_image_surface img{ format::argb32, static_cast<int>(s.arg()), static_cast<int>(s.arg()), 256 };
+    const brush b{ rgba_color::cornflower_blue };
+    const auto ip = CirclePath(size);
+    while (s.keep_running()) {
+        img.fill(b, ip);
+    }
+    SetPixelsProcessed(s);
+}
+IO2D_BENCHMARK(BM_fill_tiled, 256, 1024, 4096);
@@ -0,0 +1,354 @@
+#include "xcairo.h"
+#include "xcairo_helpers.h"
+#include <cstring>
+
+// The pages behind basic_brush_atlas. Packing many small images onto a few large surfaces means drawing them reuses a
+// handful of patterns, and the pixman images cairo caches for them, rather than making and destroying a pattern per
+// image. New entries go bottom left on a skyline, the lowest place along the page's top edge where they fit, as in
+// Jylanki's "A Thousand Ways to Pack the Bin". Whenever that leaves a gap below an entry, the gap goes on a free list
+// that's tried first, together with the places of erased entries. Free rectangles never overlap, so splitting the one
+// that's used and joining a freed one to its neighbours are both linear in the length of the list, however many
+// entries there are.
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			namespace {
+				using _Rect = _Brush_atlas::_Rect;
+				using _Skyline_node = _Brush_atlas::_Skyline_node;
+
+				int _Bytes_per_pixel(cairo_format_t fmt) noexcept {
+					switch (fmt) {
+					case CAIRO_FORMAT_ARGB32:
+					case CAIRO_FORMAT_RGB24:
+					case CAIRO_FORMAT_RGB30:
+						return 4;
+					case CAIRO_FORMAT_RGB16_565:
+						return 2;
+					case CAIRO_FORMAT_A8:
+						return 1;
+					default:
+						return 0;
+					}
+				}
+
+				// The free rectangle that an entry fits best, leaving the least room along one side, then along the other.
+				// Returns -1 if none is large enough.
+				ptrdiff_t _Find_free(const vector<_Rect>& free, int width, int height) noexcept {
+					ptrdiff_t best = -1;
+					int bestShort = 0;
+					int bestLong = 0;
+					for (size_t i = 0; i < free.size(); i++) {
+						const auto& r = free[i];
+						if (r.width < width || r.height < height) {
+							continue;
+						}
+						const int shortSide = ::std::min(r.width - width, r.height - height);
+						const int longSide = ::std::max(r.width - width, r.height - height);
+						if (best < 0 || shortSide < bestShort || (shortSide == bestShort && longSide < bestLong)) {
+							best = static_cast<ptrdiff_t>(i);
+							bestShort = shortSide;
+							bestLong = longSide;
+						}
+					}
+					return best;
+				}
+
+				// Takes an entry's room from the top left of free[index], leaving what's to its right and below it as two
+				// rectangles, cut along the shorter leftover side so that the larger piece stays as large as it can.
+				void _Take_free(vector<_Rect>& free, size_t index, int width, int height) {
+					const auto r = free[index];
+					free.erase(free.begin() + static_cast<ptrdiff_t>(index));
+					_Rect right;
+					_Rect below;
+					if (r.width - width < r.height - height) {
+						right = { r.x + width, r.y, r.width - width, height };
+						below = { r.x, r.y + height, r.width, r.height - height };
+					}
+					else {
+						right = { r.x + width, r.y, r.width - width, r.height };
+						below = { r.x, r.y + height, width, r.height - height };
+					}
+					for (const auto& piece : { right, below }) {
+						if (piece.width > 0 && piece.height > 0) {
+							free.push_back(piece);
+						}
+					}
+				}
+
+				// Adds r to the free list, first joining it to each rectangle it shares a whole edge with. Only the push can
+				// throw, and by then the list is consistent.
+				void _Give_back(vector<_Rect>& free, _Rect r) {
+					bool merged = true;
+					while (merged) {
+						merged = false;
+						for (size_t i = 0; i < free.size(); i++) {
+							const auto& f = free[i];
+							if (f.x == r.x && f.width == r.width && (f.y + f.height == r.y || r.y + r.height == f.y)) {
+								r.y = ::std::min(r.y, f.y);
+								r.height += f.height;
+								merged = true;
+							}
+							else if (f.y == r.y && f.height == r.height && (f.x + f.width == r.x || r.x + r.width == f.x)) {
+								r.x = ::std::min(r.x, f.x);
+								r.width += f.width;
+								merged = true;
+							}
+							if (merged) {
+								free.erase(free.begin() + static_cast<ptrdiff_t>(i));
+								break;
+							}
+						}
+					}
+					free.push_back(r);
+				}
+
+				// The top edge an entry would have with its left edge at skyline[index]: just below the lowest node it spans.
+				// Returns false if it would run off the page.
+				bool _Skyline_fits(const vector<_Skyline_node>& skyline, size_t index, int width, int height, int pageSize, int& y) noexcept {
+					if (skyline[index].x + width > pageSize) {
+						return false;
+					}
+					y = skyline[index].y;
+					for (size_t i = index, covered = 0; covered < static_cast<size_t>(width); i++) {
+						y = ::std::max(y, skyline[i].y);
+						if (y + height > pageSize) {
+							return false;
+						}
+						covered += static_cast<size_t>(skyline[i].width);
+					}
+					return true;
+				}
+
+				// Bottom left: the node where the entry's bottom edge would be highest up the page, then the narrowest.
+				bool _Find_skyline(const vector<_Skyline_node>& skyline, int width, int height, int pageSize, size_t& index, int& y) noexcept {
+					bool found = false;
+					int bestBottom = 0;
+					int bestWidth = 0;
+					for (size_t i = 0; i < skyline.size(); i++) {
+						int top = 0;
+						if (!_Skyline_fits(skyline, i, width, height, pageSize, top)) {
+							continue;
+						}
+						if (!found || top + height < bestBottom || (top + height == bestBottom && skyline[i].width < bestWidth)) {
+							index = i;
+							y = top;
+							bestBottom = top + height;
+							bestWidth = skyline[i].width;
+							found = true;
+						}
+					}
+					return found;
+				}
+
+				// Raises the skyline over placed, whose left edge is at skyline[index]. The gaps between placed and the lower
+				// nodes it spans go on the free list.
+				void _Raise_skyline(vector<_Skyline_node>& skyline, vector<_Rect>& free, size_t index, const _Rect& placed) {
+					const int right = placed.x + placed.width;
+					for (size_t i = index; i < skyline.size() && skyline[i].x < right; i++) {
+						const auto& node = skyline[i];
+						if (node.y < placed.y) {
+							free.push_back({ node.x, node.y, ::std::min(node.x + node.width, right) - node.x, placed.y - node.y });
+						}
+					}
+					skyline.insert(skyline.begin() + static_cast<ptrdiff_t>(index), _Skyline_node{ placed.x, placed.y + placed.height, placed.width });
+					for (size_t i = index + 1; i < skyline.size() && skyline[i].x < right;) {
+						auto& node = skyline[i];
+						if (node.x + node.width <= right) {
+							skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(i));
+						}
+						else {
+							node.width -= right - node.x;
+							node.x = right;
+							break;
+						}
+					}
+					for (size_t i = 0; i + 1 < skyline.size();) {
+						if (skyline[i].y == skyline[i + 1].y) {
+							skyline[i].width += skyline[i + 1].width;
+							skyline.erase(skyline.begin() + static_cast<ptrdiff_t>(i + 1));
+						}
+						else {
+							i++;
+						}
+					}
+				}
+
+				// Finds room for a width x height rectangle on page, from its free list if it can, and sets skyline and free
+				// to the page's lists with the room taken. Returns false if the page is full.
+				bool _Place(const _Brush_atlas::_Page& page, int width, int height, int pageSize, vector<_Skyline_node>& skyline, vector<_Rect>& free, _Rect& placed) {
+					const auto freeIndex = _Find_free(page.free, width, height);
+					if (freeIndex >= 0) {
+						placed = { page.free[static_cast<size_t>(freeIndex)].x, page.free[static_cast<size_t>(freeIndex)].y, width, height };
+						skyline = page.skyline;
+						free = page.free;
+						_Take_free(free, static_cast<size_t>(freeIndex), width, height);
+						return true;
+					}
+					size_t index = 0;
+					int y = 0;
+					if (!_Find_skyline(page.skyline, width, height, pageSize, index, y)) {
+						return false;
+					}
+					placed = { page.skyline[index].x, y, width, height };
+					skyline = page.skyline;
+					free = page.free;
+					_Raise_skyline(skyline, free, index, placed);
+					return true;
+				}
+			}
+
+			_Brush_atlas::_Brush_atlas(cairo_format_t fmt, int pageSize, int gutter)
+				: _Format(fmt)
+				, _Page_size(pageSize)
+				, _Gutter(gutter) {
+				if (fmt == CAIRO_FORMAT_INVALID || gutter < 0 || pageSize > 32767 || pageSize < 1 + 2 * gutter) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				if (_Bytes_per_pixel(fmt) == 0) {
+					throw ::std::system_error(::std::make_error_code(errc::not_supported));
+				}
+			}
+
+			cairo_format_t _Brush_atlas::format() const noexcept {
+				return _Format;
+			}
+
+			int _Brush_atlas::page_size() const noexcept {
+				return _Page_size;
+			}
+
+			int _Brush_atlas::gutter() const noexcept {
+				return _Gutter;
+			}
+
+			int _Brush_atlas::page_count() const noexcept {
+				return static_cast<int>(_Pages.size());
+			}
+
+			size_t _Brush_atlas::size() const noexcept {
+				return _Entries.size();
+			}
+
+			const _Brush_atlas::_Page& _Brush_atlas::page(int index) const noexcept {
+				return _Pages[static_cast<size_t>(index)];
+			}
+
+			const _Brush_atlas::_Entry* _Brush_atlas::find(size_t key) const noexcept {
+				const auto it = _Entries.find(key);
+				return it == _Entries.end() ? nullptr : &it->second;
+			}
+
+			void _Brush_atlas::_Add_page() {
+				_Page page;
+				page.surface = shared_ptr<cairo_surface_t>(cairo_image_surface_create(_Format, _Page_size, _Page_size), &cairo_surface_destroy);
+				_Throw_if_failed_cairo_status_t(cairo_surface_status(page.surface.get()));
+				page.pattern = shared_ptr<cairo_pattern_t>(cairo_pattern_create_for_surface(page.surface.get()), &cairo_pattern_destroy);
+				_Throw_if_failed_cairo_status_t(cairo_pattern_status(page.pattern.get()));
+				page.skyline.push_back({ 0, 0, _Page_size });
+				_Pages.push_back(move(page));
+			}
+
+			void _Brush_atlas::_Clear(_Page& page, const _Rect& r) noexcept {
+				const auto sfc = page.surface.get();
+				cairo_surface_flush(sfc);
+				const auto data = cairo_image_surface_get_data(sfc);
+				const auto stride = cairo_image_surface_get_stride(sfc);
+				const auto bytesPerPixel = _Bytes_per_pixel(_Format);
+				for (int y = r.y; y < r.y + r.height; y++) {
+					::std::memset(data + static_cast<ptrdiff_t>(y) * stride + r.x * bytesPerPixel, 0, static_cast<size_t>(r.width) * bytesPerPixel);
+				}
+				cairo_surface_mark_dirty(sfc);
+			}
+
+			size_t _Brush_atlas::insert(cairo_surface_t* img) {
+				_IO2D_TRACE_SPAN("atlas_insert");
+				const int width = cairo_image_surface_get_width(img);
+				const int height = cairo_image_surface_get_height(img);
+				if (width < 1 || height < 1 || width > _Page_size - 2 * _Gutter || height > _Page_size - 2 * _Gutter) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+
+				// Images in another format are converted by letting cairo draw them onto one in the atlas's.
+				unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> converted(nullptr, &cairo_surface_destroy);
+				auto src = img;
+				if (cairo_image_surface_get_format(img) != _Format) {
+					converted.reset(cairo_image_surface_create(_Format, width, height));
+					_Throw_if_failed_cairo_status_t(cairo_surface_status(converted.get()));
+					unique_ptr<cairo_t, decltype(&cairo_destroy)> context(cairo_create(converted.get()), &cairo_destroy);
+					cairo_set_operator(context.get(), CAIRO_OPERATOR_SOURCE);
+					cairo_set_source_surface(context.get(), img, 0.0, 0.0);
+					cairo_paint(context.get());
+					_Throw_if_failed_cairo_status_t(cairo_status(context.get()));
+					src = converted.get();
+				}
+
+				_Rect placed{};
+				vector<_Skyline_node> skyline;
+				vector<_Rect> free;
+				size_t pageIndex = 0;
+				while (pageIndex < _Pages.size() && !_Place(_Pages[pageIndex], width + 2 * _Gutter, height + 2 * _Gutter, _Page_size, skyline, free, placed)) {
+					pageIndex++;
+				}
+				if (pageIndex == _Pages.size()) {
+					_Add_page();
+					_Place(_Pages[pageIndex], width + 2 * _Gutter, height + 2 * _Gutter, _Page_size, skyline, free, placed);
+				}
+				// Everything that can throw happens before the page changes.
+				auto& page = _Pages[pageIndex];
+				const auto key = _Next_key;
+				_Entries.emplace(key, _Entry{ static_cast<int>(pageIndex), _Rect{ placed.x + _Gutter, placed.y + _Gutter, width, height } });
+				page.skyline.swap(skyline);
+				page.free.swap(free);
+				page.entries++;
+				_Next_key++;
+
+				// The gutter is already transparent: pages start cleared and erase clears an entry's gutter with it.
+				const auto dst = page.surface.get();
+				cairo_surface_flush(src);
+				cairo_surface_flush(dst);
+				const auto srcData = cairo_image_surface_get_data(src);
+				const auto srcStride = cairo_image_surface_get_stride(src);
+				const auto dstData = cairo_image_surface_get_data(dst);
+				const auto dstStride = cairo_image_surface_get_stride(dst);
+				const auto rowBytes = static_cast<size_t>(width) * _Bytes_per_pixel(_Format);
+				for (int y = 0; y < height; y++) {
+					::std::memcpy(dstData + static_cast<ptrdiff_t>(placed.y + _Gutter + y) * dstStride + (placed.x + _Gutter) * _Bytes_per_pixel(_Format), srcData + static_cast<ptrdiff_t>(y) * srcStride, rowBytes);
+				}
+				cairo_surface_mark_dirty(dst);
+				return key;
+			}
+
+			bool _Brush_atlas::erase(size_t key) noexcept {
+				const auto it = _Entries.find(key);
+				if (it == _Entries.end()) {
+					return false;
+				}
+				auto& page = _Pages[static_cast<size_t>(it->second.page)];
+				const auto& area = it->second.area;
+				const _Rect used{ area.x - _Gutter, area.y - _Gutter, area.width + 2 * _Gutter, area.height + 2 * _Gutter };
+				_Clear(page, used);
+				_Entries.erase(it);
+				if (--page.entries == 0) {
+					// Back to a blank page. Shrinking the lists doesn't allocate, and the skyline is never empty.
+					page.skyline.resize(1);
+					page.skyline[0] = { 0, 0, _Page_size };
+					page.free.clear();
+					return true;
+				}
+				try {
+					_Give_back(page.free, used);
+				}
+				catch (const bad_alloc&) {
+					// The space stays unused until the page empties, which is all that's lost.
+				}
+				return true;
+			}
+
+			void _Brush_atlas::clear() noexcept {
+				_Entries.clear();
+				_Pages.clear();
+			}
+		}
+	}
+}
@@ -0,0 +1,1178 @@
+#include "xcairo.h"
+#include "xcairo_helpers.h"
+#include <cerrno>
+#include <condition_variable>
+#include <csetjmp>
+#include <cstdio>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#if defined(_IO2D_Has_Libpng)
+#include <png.h>
+#endif
+#if defined(_IO2D_Has_Libjpeg)
+#include <jpeglib.h>
+#endif
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define _IO2D_Has_SSE2
+#endif
+
+// Native PNG and JPEG codecs. They decode straight into the rows of a new cairo image surface and encode straight from
+// a surface's rows, converting at most one row at a time, instead of going through GraphicsMagick's full-image copies.
+// They read from a file or a block of memory and write to a file or a caller's sink. Large images are converted for
+// encoding in bands on io2d's worker pool (see _Encoder_rows). Anything they don't handle (other file formats, a8
+// surfaces, CMYK JPEGs) is left to GraphicsMagick. The native image format and QOI are passed on to
+// cairo_renderer-nativeimage.cpp and cairo_renderer-qoi.cpp.
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			namespace {
+				// cairo stores pixels as native-endian 32-bit values, so alpha is the last byte in memory on little-endian
+				// platforms and the first one on big-endian ones.
+				bool _Is_little_endian() noexcept {
+					const uint32_t probe = 1;
+					unsigned char firstByte;
+					::std::memcpy(&firstByte, &probe, 1);
+					return firstByte == 1;
+				}
+
+				struct _File_closer {
+					void operator()(FILE* f) const noexcept {
+						fclose(f);
+					}
+				};
+				using _File_ptr = unique_ptr<FILE, _File_closer>;
+
+				_File_ptr _Open_file(const string& path, const char* mode, error_code& ec) noexcept {
+					_File_ptr f{ fopen(path.c_str(), mode) };
+					if (f == nullptr) {
+						ec = errno != 0 ? error_code(errno, generic_category()) : make_error_code(errc::io_error);
+					}
+					return f;
+				}
+
+				// Where a codec reads from: a file, or the size bytes at data.
+				struct _Source {
+					FILE* file = nullptr;
+					const unsigned char* data = nullptr;
+					size_t size = 0;
+				};
+
+				// Where a codec writes to: a file, or a callback that receives the encoded bytes in order.
+				struct _Sink {
+					FILE* file = nullptr;
+					const function<void(const ::std::byte*, size_t)>* callback = nullptr;
+				};
+
+				// Returns false if the callback threw. Kept apart from the codecs' error handlers so that no try block is
+				// active when they longjmp.
+				bool _Call_sink(const _Sink& sink, const unsigned char* data, size_t size) noexcept {
+					try {
+						(*sink.callback)(reinterpret_cast<const ::std::byte*>(data), size);
+						return true;
+					}
+					catch (...) {
+						return false;
+					}
+				}
+
+				unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> _Create_decode_target(io2d::format fmt, uint32_t width, uint32_t height, error_code& ec) noexcept {
+					unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> sfc(nullptr, &cairo_surface_destroy);
+					if (width == 0 || height == 0 || width > 32767 || height > 32767) {
+						ec = make_error_code(errc::value_too_large);
+						return sfc;
+					}
+					sfc.reset(cairo_image_surface_create(_Format_to_cairo_format_t(fmt), static_cast<int>(width), static_cast<int>(height)));
+					if (cairo_surface_status(sfc.get()) != CAIRO_STATUS_SUCCESS) {
+						ec = make_error_code(errc::not_enough_memory);
+						sfc.reset();
+						return sfc;
+					}
+					cairo_surface_flush(sfc.get());
+					return sfc;
+				}
+
+				// Exact c * a / 255, rounded.
+				inline unsigned char _Multiply_by_alpha(unsigned int c, unsigned int a) noexcept {
+					const auto t = c * a + 128;
+					return static_cast<unsigned char>((t + (t >> 8)) >> 8);
+				}
+
+				void _Premultiply_row(unsigned char* row, int width, int alphaIndex) noexcept {
+					for (int x = 0; x < width; ++x, row += 4) {
+						const unsigned int a = row[alphaIndex];
+						if (a == 255) {
+							continue;
+						}
+						for (int c = 0; c < 4; ++c) {
+							if (c != alphaIndex) {
+								row[c] = _Multiply_by_alpha(row[c], a);
+							}
+						}
+					}
+				}
+
+				// Averages an image, fed to it a row at a time, down to the rows of a smaller surface. Each destination pixel
+				// is the mean of the block of source pixels it covers. The blocks don't overlap and differ in size by at most a
+				// pixel each way, so reductions by any factor, not only whole numbers, take a single pass.
+				class _Box_reducer {
+					int _Bytes_per_pixel = 4;
+					int _Src_height = 0;
+					int _Dst_width = 0;
+					int _Dst_height = 0;
+					unsigned char* _Dst = nullptr;
+					int _Dst_stride = 0;
+					vector<int> _Column_ends;
+					vector<uint64_t> _Sums;
+					int _Src_y = 0;
+					int _Dst_y = 0;
+					int _Row_start = 0;
+
+				public:
+					// Returns false if there isn't enough memory.
+					bool init(int bytesPerPixel, int srcWidth, int srcHeight, cairo_surface_t* dst) noexcept {
+						_Bytes_per_pixel = bytesPerPixel;
+						_Src_height = srcHeight;
+						_Dst_width = cairo_image_surface_get_width(dst);
+						_Dst_height = cairo_image_surface_get_height(dst);
+						_Dst = cairo_image_surface_get_data(dst);
+						_Dst_stride = cairo_image_surface_get_stride(dst);
+						try {
+							_Column_ends.resize(static_cast<size_t>(_Dst_width));
+							_Sums.assign(static_cast<size_t>(_Dst_width) * static_cast<size_t>(bytesPerPixel), 0);
+						}
+						catch (const bad_alloc&) {
+							return false;
+						}
+						for (int x = 0; x < _Dst_width; ++x) {
+							_Column_ends[x] = static_cast<int>(static_cast<int64_t>(x + 1) * srcWidth / _Dst_width);
+						}
+						return true;
+					}
+
+					void add_row(const unsigned char* row) noexcept {
+						const int bpp = _Bytes_per_pixel;
+						int columnStart = 0;
+						for (int x = 0; x < _Dst_width; ++x) {
+							uint64_t* sum = _Sums.data() + x * bpp;
+							for (int sx = columnStart; sx < _Column_ends[x]; ++sx) {
+								for (int c = 0; c < bpp; ++c) {
+									sum[c] += row[sx * bpp + c];
+								}
+							}
+							columnStart = _Column_ends[x];
+						}
+						++_Src_y;
+						const int rowEnd = static_cast<int>(static_cast<int64_t>(_Dst_y + 1) * _Src_height / _Dst_height);
+						if (_Src_y < rowEnd) {
+							return;
+						}
+						const uint64_t rows = static_cast<uint64_t>(rowEnd - _Row_start);
+						unsigned char* dst = _Dst + static_cast<ptrdiff_t>(_Dst_y) * _Dst_stride;
+						columnStart = 0;
+						for (int x = 0; x < _Dst_width; ++x) {
+							const uint64_t count = static_cast<uint64_t>(_Column_ends[x] - columnStart) * rows;
+							for (int c = 0; c < bpp; ++c) {
+								auto& sum = _Sums[x * bpp + c];
+								dst[x * bpp + c] = static_cast<unsigned char>((sum + count / 2) / count);
+								sum = 0;
+							}
+							columnStart = _Column_ends[x];
+						}
+						_Row_start = rowEnd;
+						++_Dst_y;
+					}
+				};
+
+				// The size that a width x height image is reduced to so that neither side is larger than maxDimension,
+				// keeping its aspect ratio. Images that already fit, or a maxDimension of 0, keep their size.
+				void _Reduced_size(int width, int height, int maxDimension, int& reducedWidth, int& reducedHeight) noexcept {
+					reducedWidth = width;
+					reducedHeight = height;
+					if (maxDimension <= 0 || (width <= maxDimension && height <= maxDimension)) {
+						return;
+					}
+					const double scale = static_cast<double>(maxDimension) / ::std::max(width, height);
+					reducedWidth = ::std::min(maxDimension, ::std::max(1, static_cast<int>(::std::lround(width * scale))));
+					reducedHeight = ::std::min(maxDimension, ::std::max(1, static_cast<int>(::std::lround(height * scale))));
+				}
+			}
+
+			void _Unpremultiply_row(const unsigned char* src, unsigned char* dst, int width, int alphaIndex) noexcept {
+				int x = 0;
+#if defined(_IO2D_Has_SSE2)
+				if (alphaIndex == 3) {
+					// Four pixels at a time, giving the same bytes as the scalar loop below: each color channel c becomes
+					// (c * 255 + a / 2) / a, truncated. The numerator is below 2^24 and the quotient is at least 1 / a away from
+					// the next whole number unless it is one, so float division truncates to the same value as integer division.
+					// Lanes where alpha is 0 become 0, and the alpha lane is passed through.
+					const __m128i zero = _mm_setzero_si128();
+					const __m128 maxChannel = _mm_set1_ps(255.0f);
+					const __m128 colorLanes = _mm_castsi128_ps(_mm_set_epi32(0, -1, -1, -1));
+					const auto unpremultiply = [&](__m128i pixel) {
+						const __m128 p = _mm_cvtepi32_ps(pixel);
+						const __m128 a = _mm_shuffle_ps(p, p, _MM_SHUFFLE(3, 3, 3, 3));
+						const __m128 halfAlpha = _mm_cvtepi32_ps(_mm_srli_epi32(_mm_shuffle_epi32(pixel, _MM_SHUFFLE(3, 3, 3, 3)), 1));
+						const __m128 quotient = _mm_and_ps(_mm_div_ps(_mm_add_ps(_mm_mul_ps(p, maxChannel), halfAlpha), a), _mm_cmpneq_ps(a, _mm_setzero_ps()));
+						return _mm_cvttps_epi32(_mm_or_ps(_mm_and_ps(quotient, colorLanes), _mm_andnot_ps(colorLanes, p)));
+					};
+					for (; x + 4 <= width; x += 4) {
+						const __m128i pixels = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + x * 4));
+						const __m128i lo = _mm_unpacklo_epi8(pixels, zero);
+						const __m128i hi = _mm_unpackhi_epi8(pixels, zero);
+						const __m128i p01 = _mm_packs_epi32(unpremultiply(_mm_unpacklo_epi16(lo, zero)), unpremultiply(_mm_unpackhi_epi16(lo, zero)));
+						const __m128i p23 = _mm_packs_epi32(unpremultiply(_mm_unpacklo_epi16(hi, zero)), unpremultiply(_mm_unpackhi_epi16(hi, zero)));
+						// Saturating packs clamp to 255 like the min below.
+						_mm_storeu_si128(reinterpret_cast<__m128i*>(dst + x * 4), _mm_packus_epi16(p01, p23));
+					}
+				}
+#endif
+				for (; x < width; ++x) {
+					const unsigned char* s = src + x * 4;
+					unsigned char* d = dst + x * 4;
+					const unsigned int a = s[alphaIndex];
+					for (int c = 0; c < 4; ++c) {
+						if (c == alphaIndex) {
+							d[c] = static_cast<unsigned char>(a);
+						}
+						else {
+							d[c] = a == 0 ? 0 : static_cast<unsigned char>(::std::min(255u, (s[c] * 255u + a / 2) / a));
+						}
+					}
+				}
+			}
+
+			namespace {
+				// What an encoder needs done to a surface row before the library gets it: un-premultiplying the alpha and, for
+				// libjpeg builds without libjpeg-turbo's extended color spaces, packing the pixels down to RGB.
+				struct _Row_conversion {
+					const unsigned char* data;
+					int stride;
+					int width;
+					bool unpremultiply;
+					bool packRgb;
+					bool littleEndian;
+
+					bool is_identity() const noexcept {
+						return !unpremultiply && !packRgb;
+					}
+
+					// The room operator() needs for a row, which can be more than the converted row takes up.
+					size_t buffer_row_size() const noexcept {
+						return static_cast<size_t>(width) * (packRgb && !unpremultiply ? 3 : 4);
+					}
+
+					void operator()(int y, unsigned char* dst) const noexcept {
+						const unsigned char* src = data + static_cast<ptrdiff_t>(y) * stride;
+						if (unpremultiply) {
+							_Unpremultiply_row(src, dst, width, littleEndian ? 3 : 0);
+							src = dst;
+						}
+						if (packRgb) {
+							// In place is fine: pixel x is read before anything at or after it is written.
+							for (int x = 0; x < width; ++x) {
+								const unsigned char* pixel = src + x * 4;
+								const unsigned char red = littleEndian ? pixel[2] : pixel[1];
+								const unsigned char green = littleEndian ? pixel[1] : pixel[2];
+								const unsigned char blue = littleEndian ? pixel[0] : pixel[3];
+								dst[x * 3 + 0] = red;
+								dst[x * 3 + 1] = green;
+								dst[x * 3 + 2] = blue;
+							}
+						}
+					}
+				};
+
+				// Images with at least this many pixels are converted on io2d's worker pool, in bands of about
+				// _Encoder_band_size bytes.
+				constexpr int64_t _Encoder_banded_min_pixels = 1 << 20;
+				constexpr size_t _Encoder_band_size = 256 * 1024;
+
+				// Hands an encoder the converted rows of an image in order. Rows that need no conversion come straight from the
+				// surface. Otherwise small images are converted one row at a time on the calling thread, and large ones in
+				// bands by a task on the worker pool, which converts band n + 1 while the encoder compresses band n. A band
+				// the task hasn't claimed by the time the encoder needs it is converted on the calling thread, so a busy pool
+				// only costs the overlap. Either way the memory used is proportional to the width, not to the size of the image.
+				class _Encoder_rows {
+					// Shared with the converter task, which may start after the _Encoder_rows it was queued for is gone.
+					struct _Band_state {
+						::std::mutex mutex;
+						::std::condition_variable changed;
+						int next = 0;					// The next band that hasn't been claimed for converting.
+						int encoding = 0;				// The band that the encoder is reading.
+						int converted[2] = { -1, -1 };	// The band most recently converted into each buffer.
+						bool stop = false;
+						bool running = false;
+					};
+
+					_Row_conversion _Conversion;
+					int _Height;
+					int _Band_rows = 1;
+					vector<unsigned char> _Buffer;
+					shared_ptr<_Band_state> _Bands;
+
+					unsigned char* _Band_buffer(int band) noexcept {
+						return _Buffer.data() + (band % 2) * _Conversion.buffer_row_size() * static_cast<size_t>(_Band_rows);
+					}
+
+					void _Convert_band(int band) noexcept {
+						const auto buffer = _Band_buffer(band);
+						const auto rowSize = _Conversion.buffer_row_size();
+						const int first = band * _Band_rows;
+						const int last = ::std::min(_Height, first + _Band_rows);
+						for (int y = first; y < last; ++y) {
+							_Conversion(y, buffer + (y - first) * rowSize);
+						}
+					}
+
+					void _Convert_bands() noexcept {
+						const int bands = (_Height + _Band_rows - 1) / _Band_rows;
+						auto& state = *_Bands;
+						for (;;) {
+							int band;
+							{
+								// Band n shares its buffer with band n - 2, which the encoder must be done with.
+								unique_lock<::std::mutex> lock(state.mutex);
+								state.changed.wait(lock, [&]() { return state.stop || state.next >= bands || state.next - state.encoding < 2; });
+								if (state.stop || state.next >= bands) {
+									return;
+								}
+								band = state.next++;
+							}
+							_Convert_band(band);
+							{
+								lock_guard<::std::mutex> lock(state.mutex);
+								state.converted[band % 2] = band;
+							}
+							state.changed.notify_all();
+						}
+					}
+
+				public:
+					_Encoder_rows(const _Row_conversion& conversion, int height) noexcept
+						: _Conversion(conversion)
+						, _Height(height) {
+					}
+
+					~_Encoder_rows() noexcept {
+						if (_Bands != nullptr) {
+							unique_lock<::std::mutex> lock(_Bands->mutex);
+							_Bands->stop = true;
+							_Bands->changed.notify_all();
+							_Bands->changed.wait(lock, [this]() { return !_Bands->running; });
+						}
+					}
+
+					_Encoder_rows(const _Encoder_rows&) = delete;
+					_Encoder_rows& operator=(const _Encoder_rows&) = delete;
+
+					// Allocates the buffers and queues the converter task. Returns false if there isn't enough memory.
+					bool start() noexcept {
+						if (_Conversion.is_identity()) {
+							return true;
+						}
+						const auto rowSize = _Conversion.buffer_row_size();
+						const bool banded = static_cast<int64_t>(_Conversion.width) * _Height >= _Encoder_banded_min_pixels;
+						if (banded) {
+							_Band_rows = static_cast<int>(::std::min(static_cast<size_t>(_Height), ::std::max(size_t{ 1 }, _Encoder_band_size / rowSize)));
+						}
+						try {
+							_Buffer.resize(rowSize * static_cast<size_t>(_Band_rows) * (banded ? 2 : 1));
+						}
+						catch (const bad_alloc&) {
+							return false;
+						}
+						if (banded) {
+							try {
+								_Bands = make_shared<_Band_state>();
+								_Thread_pool::instance().submit([this, bands = _Bands]() {
+									{
+										lock_guard<::std::mutex> lock(bands->mutex);
+										if (bands->stop) {
+											return;
+										}
+										bands->running = true;
+									}
+									_Convert_bands();
+									lock_guard<::std::mutex> lock(bands->mutex);
+									bands->running = false;
+									bands->changed.notify_all();
+								}, 1);
+							}
+							catch (...) {
+								// Converts on the calling thread instead, one row at a time.
+								_Bands = nullptr;
+								_Band_rows = 1;
+							}
+						}
+						return true;
+					}
+
+					// y must start at 0 and go up by one on each call. The row stays valid until the next call.
+					const unsigned char* row(int y) noexcept {
+						if (_Conversion.is_identity()) {
+							return _Conversion.data + static_cast<ptrdiff_t>(y) * _Conversion.stride;
+						}
+						if (_Bands == nullptr) {
+							_Conversion(y, _Buffer.data());
+							return _Buffer.data();
+						}
+						const int band = y / _Band_rows;
+						const int offset = y % _Band_rows;
+						if (offset == 0) {
+							// Done with the previous band, which frees its buffer for the converter.
+							unique_lock<::std::mutex> lock(_Bands->mutex);
+							_Bands->encoding = band;
+							_Bands->changed.notify_all();
+							if (_Bands->next == band) {
+								++_Bands->next;
+								lock.unlock();
+								_Convert_band(band);
+							}
+							else {
+								_Bands->changed.wait(lock, [&]() { return _Bands->converted[band % 2] == band; });
+							}
+						}
+						return _Band_buffer(band) + offset * _Conversion.buffer_row_size();
+					}
+				};
+
+#if defined(_IO2D_Has_Libpng)
+				// libpng reports errors by longjmp-ing back to the setjmp in the function that made the failing call. Those
+				// functions below don't own any C++ objects, since a longjmp mustn't skip their destructors.
+
+				void _Png_error(png_structp png, png_const_charp) {
+					longjmp(png_jmpbuf(png), 1);
+				}
+
+				void _Png_warning(png_structp, png_const_charp) {
+				}
+
+				void _Png_read_memory(png_structp png, png_bytep out, png_size_t count) {
+					auto& src = *static_cast<_Source*>(png_get_io_ptr(png));
+					if (count > src.size) {
+						png_error(png, "Unexpected end of data");
+					}
+					::std::memcpy(out, src.data, count);
+					src.data += count;
+					src.size -= count;
+				}
+
+				void _Png_write_sink(png_structp png, png_bytep data, png_size_t count) {
+					if (!_Call_sink(*static_cast<const _Sink*>(png_get_io_ptr(png)), data, count)) {
+						png_error(png, "Sink failed");
+					}
+				}
+
+				void _Png_flush_sink(png_structp) {
+				}
+
+				// Sets up libpng to produce cairo's byte order with an opaque filler for images without alpha.
+				bool _Png_read_info(png_structp png, png_infop info, bool littleEndian, png_uint_32& width, png_uint_32& height) noexcept {
+					if (setjmp(png_jmpbuf(png))) {
+						return false;
+					}
+					png_read_info(png, info);
+					png_set_expand(png);
+					png_set_strip_16(png);
+					png_set_gray_to_rgb(png);
+					if (littleEndian) {
+						png_set_bgr(png);
+						png_set_filler(png, 0xff, PNG_FILLER_AFTER);
+					}
+					else {
+						png_set_swap_alpha(png);
+						png_set_filler(png, 0xff, PNG_FILLER_BEFORE);
+					}
+					png_set_interlace_handling(png);
+					png_read_update_info(png, info);
+					width = png_get_image_width(png, info);
+					height = png_get_image_height(png, info);
+					return true;
+				}
+
+				bool _Png_read_rows(png_structp png, png_bytepp rows) noexcept {
+					if (setjmp(png_jmpbuf(png))) {
+						return false;
+					}
+					png_read_image(png, rows);
+					png_read_end(png, nullptr);
+					return true;
+				}
+
+				// Reads the rows of a non-interlaced image one at a time through row, into reducer.
+				bool _Png_read_rows_reduced(png_structp png, png_uint_32 height, unsigned char* row, int width, bool premultiply, int alphaIndex, _Box_reducer& reducer) noexcept {
+					if (setjmp(png_jmpbuf(png))) {
+						return false;
+					}
+					for (png_uint_32 y = 0; y < height; ++y) {
+						png_read_row(png, row, nullptr);
+						if (premultiply) {
+							_Premultiply_row(row, width, alphaIndex);
+						}
+						reducer.add_row(row);
+					}
+					png_read_end(png, nullptr);
+					return true;
+				}
+
+				bool _Png_write(png_structp png, png_infop info, _Encoder_rows& rows, int width, int height, bool alpha, bool littleEndian) noexcept {
+					if (setjmp(png_jmpbuf(png))) {
+						return false;
+					}
+					png_set_IHDR(png, info, static_cast<png_uint_32>(width), static_cast<png_uint_32>(height), 8, alpha ? PNG_COLOR_TYPE_RGB_ALPHA : PNG_COLOR_TYPE_RGB, PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_DEFAULT, PNG_FILTER_TYPE_DEFAULT);
+					// 96 DPI, as the GraphicsMagick path writes.
+					png_set_pHYs(png, info, 3780, 3780, PNG_RESOLUTION_METER);
+					png_write_info(png, info);
+					if (littleEndian) {
+						png_set_bgr(png);
+					}
+					if (alpha) {
+						if (!littleEndian) {
+							png_set_swap_alpha(png);
+						}
+					}
+					else {
+						png_set_filler(png, 0, littleEndian ? PNG_FILLER_AFTER : PNG_FILLER_BEFORE);
+					}
+					for (int y = 0; y < height; ++y) {
+						png_write_row(png, const_cast<png_bytep>(rows.row(y)));
+					}
+					png_write_end(png, info);
+					return true;
+				}
+
+				// Interlaced images are decoded at full size even when maxDimension asks for them to be reduced, leaving that to
+				// the caller, since libpng needs the whole image to hand for them.
+				cairo_surface_t* _Decode_png(_Source& src, io2d::format fmt, int maxDimension, error_code& ec) noexcept {
+					struct _Reader {
+						png_structp png = nullptr;
+						png_infop info = nullptr;
+						~_Reader() {
+							png_destroy_read_struct(&png, info != nullptr ? &info : nullptr, nullptr);
+						}
+					} reader;
+					reader.png = png_create_read_struct(PNG_LIBPNG_VER_STRING, nullptr, &_Png_error, &_Png_warning);
+					if (reader.png != nullptr) {
+						reader.info = png_create_info_struct(reader.png);
+					}
+					if (reader.info == nullptr) {
+						ec = make_error_code(errc::not_enough_memory);
+						return nullptr;
+					}
+					if (src.file != nullptr) {
+						png_init_io(reader.png, src.file);
+					}
+					else {
+						png_set_read_fn(reader.png, &src, &_Png_read_memory);
+					}
+					const bool littleEndian = _Is_little_endian();
+					png_uint_32 width = 0;
+					png_uint_32 height = 0;
+					if (!_Png_read_info(reader.png, reader.info, littleEndian, width, height)) {
+						ec = make_error_code(errc::illegal_byte_sequence);
+						return nullptr;
+					}
+					int reducedWidth;
+					int reducedHeight;
+					_Reduced_size(static_cast<int>(width), static_cast<int>(height), maxDimension, reducedWidth, reducedHeight);
+					if ((reducedWidth != static_cast<int>(width) || reducedHeight != static_cast<int>(height)) && png_get_interlace_type(reader.png, reader.info) == PNG_INTERLACE_NONE) {
+						auto sfc = _Create_decode_target(fmt, static_cast<uint32_t>(reducedWidth), static_cast<uint32_t>(reducedHeight), ec);
+						if (sfc == nullptr) {
+							return nullptr;
+						}
+						vector<unsigned char> row;
+						_Box_reducer reducer;
+						try {
+							row.resize(static_cast<size_t>(width) * 4);
+						}
+						catch (const bad_alloc&) {
+							ec = make_error_code(errc::not_enough_memory);
+							return nullptr;
+						}
+						if (!reducer.init(4, static_cast<int>(width), static_cast<int>(height), sfc.get())) {
+							ec = make_error_code(errc::not_enough_memory);
+							return nullptr;
+						}
+						if (!_Png_read_rows_reduced(reader.png, height, row.data(), static_cast<int>(width), fmt == io2d::format::argb32, littleEndian ? 3 : 0, reducer)) {
+							ec = make_error_code(errc::illegal_byte_sequence);
+							return nullptr;
+						}
+						cairo_surface_mark_dirty(sfc.get());
+						ec.clear();
+						return sfc.release();
+					}
+					auto sfc = _Create_decode_target(fmt, width, height, ec);
+					if (sfc == nullptr) {
+						return nullptr;
+					}
+					const auto data = cairo_image_surface_get_data(sfc.get());
+					const auto stride = cairo_image_surface_get_stride(sfc.get());
+					vector<png_bytep> rows;
+					try {
+						rows.resize(height);
+					}
+					catch (const bad_alloc&) {
+						ec = make_error_code(errc::not_enough_memory);
+						return nullptr;
+					}
+					for (png_uint_32 y = 0; y < height; ++y) {
+						rows[y] = data + static_cast<ptrdiff_t>(y) * stride;
+					}
+					if (!_Png_read_rows(reader.png, rows.data())) {
+						ec = make_error_code(errc::illegal_byte_sequence);
+						return nullptr;
+					}
+					if (fmt == io2d::format::argb32) {
+						for (png_uint_32 y = 0; y < height; ++y) {
+							_Premultiply_row(rows[y], static_cast<int>(width), littleEndian ? 3 : 0);
+						}
+					}
+					cairo_surface_mark_dirty(sfc.get());
+					ec.clear();
+					return sfc.release();
+				}
+
+				void _Encode_png(cairo_surface_t* sfc, io2d::format fmt, _Sink& sink, error_code& ec) noexcept {
+					struct _Writer {
+						png_structp png = nullptr;
+						png_infop info = nullptr;
+						~_Writer() {
+							png_destroy_write_struct(&png, info != nullptr ? &info : nullptr);
+						}
+					} writer;
+					writer.png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, &_Png_error, &_Png_warning);
+					if (writer.png != nullptr) {
+						writer.info = png_create_info_struct(writer.png);
+					}
+					if (writer.info == nullptr) {
+						ec = make_error_code(errc::not_enough_memory);
+						return;
+					}
+					if (sink.file != nullptr) {
+						png_init_io(writer.png, sink.file);
+					}
+					else {
+						png_set_write_fn(writer.png, &sink, &_Png_write_sink, &_Png_flush_sink);
+					}
+					const auto width = cairo_image_surface_get_width(sfc);
+					const auto height = cairo_image_surface_get_height(sfc);
+					const bool alpha = fmt == io2d::format::argb32;
+					const bool littleEndian = _Is_little_endian();
+					_Encoder_rows rows({ cairo_image_surface_get_data(sfc), cairo_image_surface_get_stride(sfc), width, alpha, false, littleEndian }, height);
+					if (!rows.start()) {
+						ec = make_error_code(errc::not_enough_memory);
+						return;
+					}
+					if (!_Png_write(writer.png, writer.info, rows, width, height, alpha, littleEndian)) {
+						ec = make_error_code(errc::io_error);
+						return;
+					}
+					ec.clear();
+				}
+#endif // _IO2D_Has_Libpng
+
+#if defined(_IO2D_Has_Libjpeg)
+				// libjpeg reports errors through error_exit, which longjmp-s back like libpng's handler.
+				struct _Jpeg_error_mgr {
+					jpeg_error_mgr pub;
+					jmp_buf jump;
+				};
+
+				void _Jpeg_error_exit(j_common_ptr cinfo) {
+					longjmp(reinterpret_cast<_Jpeg_error_mgr*>(cinfo->err)->jump, 1);
+				}
+
+				void _Jpeg_output_message(j_common_ptr) {
+				}
+
+				// A source manager over a block of memory, which is handed over whole by _Jpeg_read_header. Running out of
+				// data is an error rather than being patched up with a fake end of image marker as jpeg_stdio_src does.
+				void _Jpeg_init_source(j_decompress_ptr) {
+				}
+
+				boolean _Jpeg_fill_input_buffer(j_decompress_ptr cinfo) {
+					cinfo->err->error_exit(reinterpret_cast<j_common_ptr>(cinfo));
+					return FALSE;
+				}
+
+				void _Jpeg_skip_input_data(j_decompress_ptr cinfo, long count) {
+					if (count <= 0) {
+						return;
+					}
+					if (static_cast<unsigned long>(count) > cinfo->src->bytes_in_buffer) {
+						cinfo->err->error_exit(reinterpret_cast<j_common_ptr>(cinfo));
+					}
+					cinfo->src->next_input_byte += count;
+					cinfo->src->bytes_in_buffer -= static_cast<size_t>(count);
+				}
+
+				void _Jpeg_term_source(j_decompress_ptr) {
+				}
+
+				// A destination manager that passes the output to a sink in buffer sized pieces.
+				struct _Jpeg_sink_destination {
+					jpeg_destination_mgr pub;
+					const _Sink* sink;
+					JOCTET buffer[16384];
+				};
+
+				void _Jpeg_init_destination(j_compress_ptr cinfo) {
+					auto& dest = *reinterpret_cast<_Jpeg_sink_destination*>(cinfo->dest);
+					dest.pub.next_output_byte = dest.buffer;
+					dest.pub.free_in_buffer = sizeof(dest.buffer);
+				}
+
+				boolean _Jpeg_empty_output_buffer(j_compress_ptr cinfo) {
+					// Always called with a full buffer, whatever free_in_buffer says.
+					auto& dest = *reinterpret_cast<_Jpeg_sink_destination*>(cinfo->dest);
+					if (!_Call_sink(*dest.sink, dest.buffer, sizeof(dest.buffer))) {
+						cinfo->err->error_exit(reinterpret_cast<j_common_ptr>(cinfo));
+					}
+					dest.pub.next_output_byte = dest.buffer;
+					dest.pub.free_in_buffer = sizeof(dest.buffer);
+					return TRUE;
+				}
+
+				void _Jpeg_term_destination(j_compress_ptr cinfo) {
+					auto& dest = *reinterpret_cast<_Jpeg_sink_destination*>(cinfo->dest);
+					const auto count = sizeof(dest.buffer) - dest.pub.free_in_buffer;
+					if (count != 0 && !_Call_sink(*dest.sink, dest.buffer, count)) {
+						cinfo->err->error_exit(reinterpret_cast<j_common_ptr>(cinfo));
+					}
+				}
+
+				bool _Jpeg_read_header(jpeg_decompress_struct& cinfo, _Jpeg_error_mgr& err, const _Source& src, jpeg_source_mgr& memorySource) noexcept {
+					if (setjmp(err.jump)) {
+						return false;
+					}
+					jpeg_create_decompress(&cinfo);
+					if (src.file != nullptr) {
+						jpeg_stdio_src(&cinfo, src.file);
+					}
+					else {
+						memorySource.next_input_byte = src.data;
+						memorySource.bytes_in_buffer = src.size;
+						memorySource.init_source = &_Jpeg_init_source;
+						memorySource.fill_input_buffer = &_Jpeg_fill_input_buffer;
+						memorySource.skip_input_data = &_Jpeg_skip_input_data;
+						memorySource.resync_to_restart = &jpeg_resync_to_restart;
+						memorySource.term_source = &_Jpeg_term_source;
+						cinfo.src = &memorySource;
+					}
+					jpeg_read_header(&cinfo, TRUE);
+					return true;
+				}
+
+				// Reads scanlines straight into the surface rows when libjpeg-turbo can produce cairo's byte order, and
+				// through the one-row scratch buffer otherwise. With a reducer, data is a single row that each scanline is
+				// converted into (stride is 0) before it's passed on.
+				bool _Jpeg_read_rows(jpeg_decompress_struct& cinfo, _Jpeg_error_mgr& err, unsigned char* data, int stride, unsigned char* scratch, bool littleEndian, _Box_reducer* reducer) noexcept {
+					if (setjmp(err.jump)) {
+						return false;
+					}
+					jpeg_start_decompress(&cinfo);
+					while (cinfo.output_scanline < cinfo.output_height) {
+						unsigned char* row = data + static_cast<ptrdiff_t>(cinfo.output_scanline) * stride;
+						JSAMPROW target = scratch != nullptr ? scratch : row;
+						jpeg_read_scanlines(&cinfo, &target, 1);
+						if (scratch != nullptr) {
+							for (JDIMENSION x = 0; x < cinfo.output_width; ++x) {
+								const unsigned char* rgb = scratch + x * 3;
+								unsigned char* pixel = row + x * 4;
+								if (littleEndian) {
+									pixel[0] = rgb[2]; pixel[1] = rgb[1]; pixel[2] = rgb[0]; pixel[3] = 0xff;
+								}
+								else {
+									pixel[0] = 0xff; pixel[1] = rgb[0]; pixel[2] = rgb[1]; pixel[3] = rgb[2];
+								}
+							}
+						}
+						if (reducer != nullptr) {
+							reducer->add_row(row);
+						}
+					}
+					jpeg_finish_decompress(&cinfo);
+					return true;
+				}
+
+				bool _Jpeg_write(jpeg_compress_struct& cinfo, _Jpeg_error_mgr& err, const _Sink& sink, _Jpeg_sink_destination& sinkDestination, _Encoder_rows& rows, int width, int height, bool littleEndian) noexcept {
+					if (setjmp(err.jump)) {
+						return false;
+					}
+					jpeg_create_compress(&cinfo);
+					if (sink.file != nullptr) {
+						jpeg_stdio_dest(&cinfo, sink.file);
+					}
+					else {
+						sinkDestination.sink = &sink;
+						sinkDestination.pub.init_destination = &_Jpeg_init_destination;
+						sinkDestination.pub.empty_output_buffer = &_Jpeg_empty_output_buffer;
+						sinkDestination.pub.term_destination = &_Jpeg_term_destination;
+						cinfo.dest = &sinkDestination.pub;
+					}
+					cinfo.image_width = static_cast<JDIMENSION>(width);
+					cinfo.image_height = static_cast<JDIMENSION>(height);
+#if defined(JCS_EXTENSIONS)
+					cinfo.input_components = 4;
+					cinfo.in_color_space = littleEndian ? JCS_EXT_BGRX : JCS_EXT_XRGB;
+#else
+					cinfo.input_components = 3;
+					cinfo.in_color_space = JCS_RGB;
+#endif
+					jpeg_set_defaults(&cinfo);
+					// The quality the GraphicsMagick path uses.
+					jpeg_set_quality(&cinfo, 90, TRUE);
+					cinfo.density_unit = 1;
+					cinfo.X_density = 96;
+					cinfo.Y_density = 96;
+					jpeg_start_compress(&cinfo, TRUE);
+					while (cinfo.next_scanline < cinfo.image_height) {
+						JSAMPROW sample = const_cast<JSAMPROW>(rows.row(static_cast<int>(cinfo.next_scanline)));
+						jpeg_write_scanlines(&cinfo, &sample, 1);
+					}
+					jpeg_finish_compress(&cinfo);
+					return true;
+				}
+
+				// Returns false for color spaces that libjpeg can't convert to RGB, such as CMYK. An image larger than
+				// maxDimension is reduced in the DCT, by up to 1/8, to the smallest size that's still at least as large as the
+				// result, and the rest of the way as the scanlines come out, so it's never held at full size.
+				bool _Decode_jpeg(_Source& src, io2d::format fmt, int maxDimension, cairo_surface_t*& result, error_code& ec) noexcept {
+					_Jpeg_error_mgr err;
+					jpeg_decompress_struct cinfo{};
+					cinfo.err = jpeg_std_error(&err.pub);
+					err.pub.error_exit = &_Jpeg_error_exit;
+					err.pub.output_message = &_Jpeg_output_message;
+					struct _Destroyer {
+						jpeg_decompress_struct& cinfo;
+						~_Destroyer() {
+							jpeg_destroy_decompress(&cinfo);
+						}
+					} destroyer{ cinfo };
+					jpeg_source_mgr memorySource{};
+					if (!_Jpeg_read_header(cinfo, err, src, memorySource)) {
+						ec = make_error_code(errc::illegal_byte_sequence);
+						return true;
+					}
+					if (cinfo.jpeg_color_space == JCS_CMYK || cinfo.jpeg_color_space == JCS_YCCK) {
+						return false;
+					}
+					const bool littleEndian = _Is_little_endian();
+#if defined(JCS_EXTENSIONS)
+					cinfo.out_color_space = littleEndian ? JCS_EXT_BGRX : JCS_EXT_XRGB;
+					const bool packedRgb = false;
+#else
+					cinfo.out_color_space = JCS_RGB;
+					const bool packedRgb = true;
+#endif
+					const int imageWidth = static_cast<int>(cinfo.image_width);
+					const int imageHeight = static_cast<int>(cinfo.image_height);
+					int reducedWidth;
+					int reducedHeight;
+					_Reduced_size(imageWidth, imageHeight, maxDimension, reducedWidth, reducedHeight);
+					int scaledWidth = imageWidth;
+					int scaledHeight = imageHeight;
+					if (reducedWidth != imageWidth || reducedHeight != imageHeight) {
+						const int reducedMax = ::std::max(reducedWidth, reducedHeight);
+						const int imageMax = ::std::max(imageWidth, imageHeight);
+						for (int denominator = 8; denominator > 1; denominator /= 2) {
+							if ((imageMax + denominator - 1) / denominator >= reducedMax) {
+								cinfo.scale_num = 1;
+								cinfo.scale_denom = static_cast<unsigned int>(denominator);
+								scaledWidth = (imageWidth + denominator - 1) / denominator;
+								scaledHeight = (imageHeight + denominator - 1) / denominator;
+								break;
+							}
+						}
+						reducedWidth = ::std::min(reducedWidth, scaledWidth);
+						reducedHeight = ::std::min(reducedHeight, scaledHeight);
+					}
+					const bool reduce = reducedWidth != scaledWidth || reducedHeight != scaledHeight;
+					auto sfc = _Create_decode_target(fmt, static_cast<uint32_t>(reducedWidth), static_cast<uint32_t>(reducedHeight), ec);
+					if (sfc == nullptr) {
+						return true;
+					}
+					vector<unsigned char> scratch;
+					vector<unsigned char> row;
+					_Box_reducer reducer;
+					try {
+						scratch.resize(packedRgb ? static_cast<size_t>(scaledWidth) * 3 : 0);
+						row.resize(reduce ? static_cast<size_t>(scaledWidth) * 4 : 0);
+					}
+					catch (const bad_alloc&) {
+						ec = make_error_code(errc::not_enough_memory);
+						return true;
+					}
+					if (reduce && !reducer.init(4, scaledWidth, scaledHeight, sfc.get())) {
+						ec = make_error_code(errc::not_enough_memory);
+						return true;
+					}
+					const bool read = reduce
+						? _Jpeg_read_rows(cinfo, err, row.data(), 0, packedRgb ? scratch.data() : nullptr, littleEndian, &reducer)
+						: _Jpeg_read_rows(cinfo, err, cairo_image_surface_get_data(sfc.get()), cairo_image_surface_get_stride(sfc.get()), packedRgb ? scratch.data() : nullptr, littleEndian, nullptr);
+					if (!read) {
+						ec = make_error_code(errc::illegal_byte_sequence);
+						return true;
+					}
+					cairo_surface_mark_dirty(sfc.get());
+					result = sfc.release();
+					ec.clear();
+					return true;
+				}
+
+				void _Encode_jpeg(cairo_surface_t* sfc, io2d::format fmt, _Sink& sink, error_code& ec) noexcept {
+					_Jpeg_error_mgr err;
+					jpeg_compress_struct cinfo{};
+					cinfo.err = jpeg_std_error(&err.pub);
+					err.pub.error_exit = &_Jpeg_error_exit;
+					err.pub.output_message = &_Jpeg_output_message;
+					struct _Destroyer {
+						jpeg_compress_struct& cinfo;
+						~_Destroyer() {
+							jpeg_destroy_compress(&cinfo);
+						}
+					} destroyer{ cinfo };
+					const auto width = cairo_image_surface_get_width(sfc);
+					const auto height = cairo_image_surface_get_height(sfc);
+					const bool littleEndian = _Is_little_endian();
+#if defined(JCS_EXTENSIONS)
+					const bool packRgb = false;
+#else
+					const bool packRgb = true;
+#endif
+					_Encoder_rows rows({ cairo_image_surface_get_data(sfc), cairo_image_surface_get_stride(sfc), width, fmt == io2d::format::argb32, packRgb, littleEndian }, height);
+					if (!rows.start()) {
+						ec = make_error_code(errc::not_enough_memory);
+						return;
+					}
+					_Jpeg_sink_destination sinkDestination;
+					if (!_Jpeg_write(cinfo, err, sink, sinkDestination, rows, width, height, littleEndian)) {
+						ec = make_error_code(errc::io_error);
+						return;
+					}
+					ec.clear();
+				}
+#endif // _IO2D_Has_Libjpeg
+
+				bool _Handles(image_file_format iff, io2d::format fmt) noexcept {
+					if (fmt != io2d::format::argb32 && fmt != io2d::format::xrgb32) {
+						return false;
+					}
+#if defined(_IO2D_Has_Libpng)
+					if (iff == image_file_format::png) {
+						return true;
+					}
+#endif
+#if defined(_IO2D_Has_Libjpeg)
+					if (iff == image_file_format::jpeg) {
+						return true;
+					}
+#endif
+					(void)iff;
+					return false;
+				}
+
+				// Returns false if GraphicsMagick has to decode the image after all.
+				bool _Decode(_Source& src, image_file_format iff, io2d::format fmt, int maxDimension, cairo_surface_t*& result, error_code& ec) noexcept {
+#if defined(_IO2D_Has_Libpng)
+					if (iff == image_file_format::png) {
+						_IO2D_TRACE_SPAN("_Native_decode_png");
+						result = _Decode_png(src, fmt, maxDimension, ec);
+						return true;
+					}
+#endif
+#if defined(_IO2D_Has_Libjpeg)
+					if (iff == image_file_format::jpeg) {
+						_IO2D_TRACE_SPAN("_Native_decode_jpeg");
+						return _Decode_jpeg(src, fmt, maxDimension, result, ec);
+					}
+#endif
+					(void)src;
+					(void)iff;
+					(void)fmt;
+					(void)maxDimension;
+					(void)result;
+					(void)ec;
+					return false;
+				}
+
+				// Finishes reducing images that the codecs couldn't reduce as they decoded them. Always returns true, for
+				// chaining after _Decode.
+				bool _Reduce_decoded(cairo_surface_t*& result, int maxDimension, error_code& ec) noexcept {
+					if (result != nullptr) {
+						_Reduce_image(result, maxDimension, ec);
+					}
+					return true;
+				}
+
+				void _Encode(cairo_surface_t* sfc, io2d::format fmt, _Sink& sink, image_file_format iff, error_code& ec) noexcept {
+					cairo_surface_flush(sfc);
+#if defined(_IO2D_Has_Libpng)
+					if (iff == image_file_format::png) {
+						_IO2D_TRACE_SPAN("_Native_encode_png");
+						_Encode_png(sfc, fmt, sink, ec);
+						return;
+					}
+#endif
+#if defined(_IO2D_Has_Libjpeg)
+					if (iff == image_file_format::jpeg) {
+						_IO2D_TRACE_SPAN("_Native_encode_jpeg");
+						_Encode_jpeg(sfc, fmt, sink, ec);
+						return;
+					}
+#endif
+					(void)sfc;
+					(void)fmt;
+					(void)sink;
+					(void)iff;
+					(void)ec;
+				}
+			}
+
+			void _Reduce_image(cairo_surface_t*& sfc, int maxDimension, ::std::error_code& ec) noexcept {
+				const int width = cairo_image_surface_get_width(sfc);
+				const int height = cairo_image_surface_get_height(sfc);
+				int reducedWidth;
+				int reducedHeight;
+				_Reduced_size(width, height, maxDimension, reducedWidth, reducedHeight);
+				if (reducedWidth == width && reducedHeight == height) {
+					return;
+				}
+				_IO2D_TRACE_SPAN("_Reduce_image");
+				unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> src(sfc, &cairo_surface_destroy);
+				sfc = nullptr;
+				const auto format = cairo_image_surface_get_format(src.get());
+				unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> dst(cairo_image_surface_create(format, reducedWidth, reducedHeight), &cairo_surface_destroy);
+				_Box_reducer reducer;
+				if (cairo_surface_status(dst.get()) != CAIRO_STATUS_SUCCESS || !reducer.init(format == CAIRO_FORMAT_A8 ? 1 : 4, width, height, dst.get())) {
+					ec = make_error_code(errc::not_enough_memory);
+					return;
+				}
+				cairo_surface_flush(src.get());
+				cairo_surface_flush(dst.get());
+				const auto data = cairo_image_surface_get_data(src.get());
+				const auto stride = cairo_image_surface_get_stride(src.get());
+				for (int y = 0; y < height; ++y) {
+					reducer.add_row(data + static_cast<ptrdiff_t>(y) * stride);
+				}
+				cairo_surface_mark_dirty(dst.get());
+				sfc = dst.release();
+			}
+
+			cairo_surface_t* _Half_size_image(cairo_surface_t* sfc) noexcept {
+				const auto format = cairo_image_surface_get_format(sfc);
+				if (format != CAIRO_FORMAT_ARGB32 && format != CAIRO_FORMAT_RGB24 && format != CAIRO_FORMAT_A8) {
+					return nullptr;
+				}
+				const int width = cairo_image_surface_get_width(sfc);
+				const int height = cairo_image_surface_get_height(sfc);
+				unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> dst(cairo_image_surface_create(format, (width + 1) / 2, (height + 1) / 2), &cairo_surface_destroy);
+				_Box_reducer reducer;
+				if (cairo_surface_status(dst.get()) != CAIRO_STATUS_SUCCESS || !reducer.init(format == CAIRO_FORMAT_A8 ? 1 : 4, width, height, dst.get())) {
+					return nullptr;
+				}
+				cairo_surface_flush(sfc);
+				cairo_surface_flush(dst.get());
+				const auto data = cairo_image_surface_get_data(sfc);
+				const auto stride = cairo_image_surface_get_stride(sfc);
+				for (int y = 0; y < height; ++y) {
+					reducer.add_row(data + static_cast<ptrdiff_t>(y) * stride);
+				}
+				cairo_surface_mark_dirty(dst.get());
+				return dst.release();
+			}
+
+			bool _Native_decode_image(const ::std::string& path, image_file_format iff, io2d::format fmt, int maxDimension, cairo_surface_t*& result, ::std::error_code& ec) noexcept {
+				result = nullptr;
+				if (iff == _Native_image_file_format) {
+					_IO2D_TRACE_SPAN("_Map_native_image");
+					_Map_native_image(path, fmt, result, ec);
+					return _Reduce_decoded(result, maxDimension, ec);
+				}
+				if (iff == _Qoi_image_file_format) {
+					_IO2D_TRACE_SPAN("_Decode_qoi_image");
+					_Decode_qoi_image(path, fmt, result, ec);
+					return _Reduce_decoded(result, maxDimension, ec);
+				}
+				if (!_Handles(iff, fmt)) {
+					return false;
+				}
+				auto file = _Open_file(path, "rb", ec);
+				if (file == nullptr) {
+					return true;
+				}
+				_Source src;
+				src.file = file.get();
+				return _Decode(src, iff, fmt, maxDimension, result, ec) && _Reduce_decoded(result, maxDimension, ec);
+			}
+
+			bool _Native_decode_image(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, cairo_surface_t*& result, ::std::error_code& ec) noexcept {
+				result = nullptr;
+				if (iff == _Native_image_file_format) {
+					_Decode_native_image(data, size, fmt, result, ec);
+					return _Reduce_decoded(result, maxDimension, ec);
+				}
+				if (iff == _Qoi_image_file_format) {
+					_IO2D_TRACE_SPAN("_Decode_qoi_image");
+					_Decode_qoi_image(data, size, fmt, result, ec);
+					return _Reduce_decoded(result, maxDimension, ec);
+				}
+				if (!_Handles(iff, fmt)) {
+					return false;
+				}
+				_Source src;
+				src.data = reinterpret_cast<const unsigned char*>(data);
+				src.size = size;
+				return _Decode(src, iff, fmt, maxDimension, result, ec) && _Reduce_decoded(result, maxDimension, ec);
+			}
+
+			bool _Native_encode_image(cairo_surface_t* sfc, io2d::format fmt, const ::std::string& path, image_file_format iff, ::std::error_code& ec) noexcept {
+				if (iff == _Native_image_file_format) {
+					_Encode_native_image(sfc, path, ec);
+					return true;
+				}
+				if (iff == _Qoi_image_file_format) {
+					_IO2D_TRACE_SPAN("_Encode_qoi_image");
+					_Encode_qoi_image(sfc, path, ec);
+					return true;
+				}
+				if (!_Handles(iff, fmt)) {
+					return false;
+				}
+				auto file = _Open_file(path, "wb", ec);
+				if (file == nullptr) {
+					return true;
+				}
+				_Sink sink;
+				sink.file = file.get();
+				_Encode(sfc, fmt, sink, iff, ec);
+				return true;
+			}
+
+			bool _Native_encode_image(cairo_surface_t* sfc, io2d::format fmt, const function<void(const ::std::byte*, size_t)>& callback, image_file_format iff, ::std::error_code& ec) noexcept {
+				if (iff == _Native_image_file_format) {
+					_Encode_native_image(sfc, callback, ec);
+					return true;
+				}
+				if (iff == _Qoi_image_file_format) {
+					_IO2D_TRACE_SPAN("_Encode_qoi_image");
+					_Encode_qoi_image(sfc, callback, ec);
+					return true;
+				}
+				if (!_Handles(iff, fmt)) {
+					return false;
+				}
+				_Sink sink;
+				sink.callback = &callback;
+				_Encode(sfc, fmt, sink, iff, ec);
+				return true;
+			}
+		}
+	}
+}
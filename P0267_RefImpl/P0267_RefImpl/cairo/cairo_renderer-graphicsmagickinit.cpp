@@ -11,6 +11,9 @@ namespace std::experimental::io2d {
 	inline namespace v1 {
 		namespace _Cairo {
 
+			// Every read and write through GraphicsMagick first calls this, so it's safe to load images on several threads at
+			// once (as basic_image_surface::load_images does): once InitializeMagick has returned, GraphicsMagick's readers and
+			// writers are reentrant as long as each call has its own ImageInfo and ExceptionInfo, which ours do.
 			void _Init_graphics_magic() {
 				::std::call_once(_Init_graphics_magick_once_flag, []() {
 					InitializeMagick(nullptr);
@@ -0,0 +1,311 @@
+#include "xcairo.h"
+#include <cstring>
+#include <list>
+#include <mutex>
+#include <unordered_map>
+#include <sys/stat.h>
+
+#if defined(__linux__)
+#include <sys/mman.h>
+#include <unistd.h>
+#if defined(MFD_CLOEXEC)
+#define _IO2D_Has_Memfd
+#endif
+#endif
+
+// The decoded image cache behind basic_image_surface::cache_budget. Images loaded from files are kept, up to a byte
+// budget, keyed by path, file format, surface format and maximum dimension, and are valid while the file's modification
+// time and size are unchanged. Where memfd_create is available each entry's pixels live in an anonymous file, and a hit
+// maps it privately, so the new surface shares the cached pages until it draws on them and the kernel copies the pages
+// it changes. Elsewhere a hit copies the cached pixels, which is still far cheaper than decoding the file again.
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			namespace {
+				bool _File_stamp(const string& path, int64_t& modified, uint64_t& size) noexcept {
+#if defined(_WIN32)
+					struct _stat64 st;
+					if (_stat64(path.c_str(), &st) != 0) {
+						return false;
+					}
+					modified = static_cast<int64_t>(st.st_mtime) * 1'000'000'000;
+#else
+					struct stat st;
+					if (stat(path.c_str(), &st) != 0) {
+						return false;
+					}
+#if defined(__APPLE__)
+					modified = static_cast<int64_t>(st.st_mtimespec.tv_sec) * 1'000'000'000 + st.st_mtimespec.tv_nsec;
+#else
+					modified = static_cast<int64_t>(st.st_mtim.tv_sec) * 1'000'000'000 + st.st_mtim.tv_nsec;
+#endif
+#endif
+					size = static_cast<uint64_t>(st.st_size);
+					return true;
+				}
+
+				// The pixels of one cached image, stored at cairo's stride.
+				class _Cached_pixels {
+#if defined(_IO2D_Has_Memfd)
+					int _Fd = -1;
+#else
+					unique_ptr<unsigned char[]> _Data;
+#endif
+					size_t _Size = 0;
+				public:
+					cairo_format_t format = CAIRO_FORMAT_INVALID;
+					int width = 0;
+					int height = 0;
+					int stride = 0;
+
+					_Cached_pixels() noexcept = default;
+					_Cached_pixels(const _Cached_pixels&) = delete;
+					_Cached_pixels& operator=(const _Cached_pixels&) = delete;
+					~_Cached_pixels() noexcept {
+#if defined(_IO2D_Has_Memfd)
+						if (_Fd != -1) {
+							close(_Fd);
+						}
+#endif
+					}
+
+					size_t size() const noexcept {
+						return _Size;
+					}
+
+					bool store(cairo_surface_t* sfc) noexcept {
+						cairo_surface_flush(sfc);
+						format = cairo_image_surface_get_format(sfc);
+						width = cairo_image_surface_get_width(sfc);
+						height = cairo_image_surface_get_height(sfc);
+						stride = cairo_image_surface_get_stride(sfc);
+						_Size = static_cast<size_t>(stride) * static_cast<size_t>(height);
+						const auto data = cairo_image_surface_get_data(sfc);
+						if (data == nullptr || _Size == 0) {
+							return false;
+						}
+#if defined(_IO2D_Has_Memfd)
+						_Fd = memfd_create("io2d_image_cache", MFD_CLOEXEC);
+						if (_Fd == -1) {
+							return false;
+						}
+						size_t written = 0;
+						while (written < _Size) {
+							const auto n = write(_Fd, data + written, _Size - written);
+							if (n <= 0) {
+								return false;
+							}
+							written += static_cast<size_t>(n);
+						}
+						return true;
+#else
+						_Data.reset(new (nothrow) unsigned char[_Size]);
+						if (_Data == nullptr) {
+							return false;
+						}
+						::std::memcpy(_Data.get(), data, _Size);
+						return true;
+#endif
+					}
+
+					// Returns a new surface holding the cached pixels, or nullptr if there isn't the memory for one.
+					cairo_surface_t* surface() const noexcept {
+#if defined(_IO2D_Has_Memfd)
+						void* data = mmap(nullptr, _Size, PROT_READ | PROT_WRITE, MAP_PRIVATE, _Fd, 0);
+						if (data == MAP_FAILED) {
+							return nullptr;
+						}
+						auto sfc = cairo_image_surface_create_for_data(static_cast<unsigned char*>(data), format, width, height, stride);
+						if (cairo_surface_status(sfc) != CAIRO_STATUS_SUCCESS) {
+							cairo_surface_destroy(sfc);
+							munmap(data, _Size);
+							return nullptr;
+						}
+						auto mapping = new (nothrow) _Mapping{ data, _Size };
+						if (mapping == nullptr || cairo_surface_set_user_data(sfc, &_Mapping_key, mapping, &_Unmap) != CAIRO_STATUS_SUCCESS) {
+							delete mapping;
+							cairo_surface_destroy(sfc);
+							munmap(data, _Size);
+							return nullptr;
+						}
+						return sfc;
+#else
+						auto sfc = cairo_image_surface_create(format, width, height);
+						if (cairo_surface_status(sfc) != CAIRO_STATUS_SUCCESS || cairo_image_surface_get_stride(sfc) != stride) {
+							cairo_surface_destroy(sfc);
+							return nullptr;
+						}
+						cairo_surface_flush(sfc);
+						::std::memcpy(cairo_image_surface_get_data(sfc), _Data.get(), _Size);
+						cairo_surface_mark_dirty(sfc);
+						return sfc;
+#endif
+					}
+
+#if defined(_IO2D_Has_Memfd)
+				private:
+					struct _Mapping {
+						void* data;
+						size_t size;
+					};
+					static const cairo_user_data_key_t _Mapping_key;
+
+					static void _Unmap(void* p) noexcept {
+						auto m = static_cast<_Mapping*>(p);
+						munmap(m->data, m->size);
+						delete m;
+					}
+#endif
+				};
+#if defined(_IO2D_Has_Memfd)
+				const cairo_user_data_key_t _Cached_pixels::_Mapping_key{};
+#endif
+
+				struct _Image_cache_entry {
+					string key;
+					int64_t modified;
+					uint64_t fileSize;
+					_Cached_pixels pixels;
+				};
+
+				struct _Image_cache {
+					mutex lock;
+					size_t budget = 0;
+					size_t bytes = 0;
+					image_cache_stats stats{};
+					// Most recently used first. Entries are heap allocated so that a hit can hold one while it maps or copies
+					// the pixels without holding the lock.
+					list<shared_ptr<_Image_cache_entry>> entries;
+					unordered_map<string, list<shared_ptr<_Image_cache_entry>>::iterator> index;
+
+					void erase(list<shared_ptr<_Image_cache_entry>>::iterator it) noexcept {
+						bytes -= (*it)->pixels.size();
+						index.erase((*it)->key);
+						entries.erase(it);
+					}
+
+					void evict_to(size_t limit) noexcept {
+						while (bytes > limit && !entries.empty()) {
+							erase(prev(entries.end()));
+							++stats.evictions;
+						}
+					}
+				};
+
+				_Image_cache& _Cache() noexcept {
+					static _Image_cache cache;
+					return cache;
+				}
+
+				string _Image_cache_key(const string& path, image_file_format iff, io2d::format fmt, int maxDimension) {
+					return to_string(static_cast<int>(iff)) + ':' + to_string(static_cast<int>(fmt)) + ':' + to_string(maxDimension) + ':' + path;
+				}
+			}
+
+			bool _Image_cache_find(const ::std::string& path, image_file_format iff, io2d::format fmt, int maxDimension, cairo_surface_t*& result, _Image_cache_ticket& ticket) noexcept {
+				result = nullptr;
+				ticket.cacheable = false;
+				auto& cache = _Cache();
+				{
+					lock_guard<mutex> lock(cache.lock);
+					if (cache.budget == 0) {
+						return false;
+					}
+				}
+				if (iff == _Native_image_file_format || !_File_stamp(path, ticket.modified, ticket.fileSize)) {
+					// Native images are mapped rather than decoded, so caching them would only cost memory.
+					return false;
+				}
+				shared_ptr<_Image_cache_entry> entry;
+				try {
+					ticket.key = _Image_cache_key(path, iff, fmt, maxDimension);
+					lock_guard<mutex> lock(cache.lock);
+					ticket.cacheable = true;
+					auto found = cache.index.find(ticket.key);
+					if (found == cache.index.end()) {
+						++cache.stats.misses;
+						return false;
+					}
+					auto it = found->second;
+					if ((*it)->modified != ticket.modified || (*it)->fileSize != ticket.fileSize) {
+						cache.erase(it);
+						++cache.stats.misses;
+						return false;
+					}
+					cache.entries.splice(cache.entries.begin(), cache.entries, it);
+					entry = *it;
+					++cache.stats.hits;
+				}
+				catch (const bad_alloc&) {
+					return false;
+				}
+				result = entry->pixels.surface();
+				return result != nullptr;
+			}
+
+			void _Image_cache_add(const _Image_cache_ticket& ticket, cairo_surface_t* sfc) noexcept {
+				if (!ticket.cacheable) {
+					return;
+				}
+				auto& cache = _Cache();
+				try {
+					auto entry = make_shared<_Image_cache_entry>();
+					entry->key = ticket.key;
+					entry->modified = ticket.modified;
+					entry->fileSize = ticket.fileSize;
+					if (!entry->pixels.store(sfc)) {
+						return;
+					}
+					lock_guard<mutex> lock(cache.lock);
+					if (entry->pixels.size() > cache.budget) {
+						return;
+					}
+					// Another thread may have loaded the same file meanwhile; the newer pixels replace its entry.
+					auto found = cache.index.find(entry->key);
+					if (found != cache.index.end()) {
+						cache.erase(found->second);
+					}
+					cache.evict_to(cache.budget - entry->pixels.size());
+					cache.entries.push_front(entry);
+					cache.index.emplace(entry->key, cache.entries.begin());
+					cache.bytes += entry->pixels.size();
+				}
+				catch (const bad_alloc&) {
+					// Not caching an image is harmless.
+				}
+			}
+
+			void _Image_cache_budget(size_t bytes) noexcept {
+				auto& cache = _Cache();
+				lock_guard<mutex> lock(cache.lock);
+				cache.budget = bytes;
+				cache.evict_to(bytes);
+			}
+
+			size_t _Image_cache_budget() noexcept {
+				auto& cache = _Cache();
+				lock_guard<mutex> lock(cache.lock);
+				return cache.budget;
+			}
+
+			image_cache_stats _Image_cache_stats() noexcept {
+				auto& cache = _Cache();
+				lock_guard<mutex> lock(cache.lock);
+				auto stats = cache.stats;
+				stats.entries = cache.entries.size();
+				stats.bytes = cache.bytes;
+				stats.byte_budget = cache.budget;
+				return stats;
+			}
+
+			void _Image_cache_clear() noexcept {
+				auto& cache = _Cache();
+				lock_guard<mutex> lock(cache.lock);
+				cache.entries.clear();
+				cache.index.clear();
+				cache.bytes = 0;
+			}
+		}
+	}
+}
@@ -0,0 +1,392 @@
+#include "xcairo.h"
+#include "xcairo_helpers.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// The native image format (additional_image_file_formats::native): a _Native_image_header followed by the rows of a
+// cairo image surface exactly as cairo keeps them in memory, i.e. premultiplied, native-endian pixels (BGRA bytes on
+// little-endian platforms) at cairo's stride. Loading a file maps it copy-on-write and hands the mapped pages to cairo,
+// so there's nothing to decode or copy: pages are read from disk when they're first touched, and drawing on the surface
+// copies only the pages it changes, leaving the file as it was. Files are meant to be baked by the platform that loads
+// them; one written with the other byte order is rejected. Saving writes a temporary file next to the target and
+// renames it over the target, so a surface that is still mapping the target keeps its pages when it's saved over.
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			namespace {
+				struct _Native_image_header {
+					char magic[8];
+					uint32_t byteOrder;		// _Native_image_byte_order as written by the platform that made the file.
+					uint32_t version;
+					int32_t format;			// A cairo_format_t.
+					int32_t width;
+					int32_t height;
+					int32_t stride;
+					uint32_t reserved[8];	// Pads the header to 64 bytes so that the rows that follow are cache line aligned.
+				};
+				static_assert(sizeof(_Native_image_header) == 64, "The native image header must be 64 bytes.");
+
+				const char _Native_image_magic[8] = { 'I', 'O', '2', 'D', 'B', 'G', 'R', 'A' };
+				const uint32_t _Native_image_byte_order = 0x01020304;
+				const uint32_t _Native_image_version = 1;
+
+				bool _Is_native_image_format(int32_t format) noexcept {
+					return format == CAIRO_FORMAT_ARGB32 || format == CAIRO_FORMAT_RGB24 || format == CAIRO_FORMAT_A8;
+				}
+
+				// Checks that header describes an image whose rows fit in the size bytes of the file or buffer it heads.
+				bool _Validate_native_image_header(const _Native_image_header& header, size_t size, error_code& ec) noexcept {
+					if (::std::memcmp(header.magic, _Native_image_magic, sizeof(_Native_image_magic)) != 0 || header.version != _Native_image_version) {
+						ec = make_error_code(errc::invalid_argument);
+						return false;
+					}
+					if (header.byteOrder != _Native_image_byte_order || !_Is_native_image_format(header.format)) {
+						ec = make_error_code(errc::not_supported);
+						return false;
+					}
+					if (header.width <= 0 || header.height <= 0 || header.width > 32767 || header.height > 32767) {
+						ec = make_error_code(errc::value_too_large);
+						return false;
+					}
+					if (header.stride % 4 != 0 || header.stride < cairo_format_stride_for_width(static_cast<cairo_format_t>(header.format), header.width) ||
+						static_cast<uint64_t>(header.stride) * static_cast<uint64_t>(header.height) > size - sizeof(_Native_image_header)) {
+						ec = make_error_code(errc::invalid_argument);
+						return false;
+					}
+					return true;
+				}
+
+				bool _Read_native_image_header(const unsigned char* data, size_t size, _Native_image_header& header, error_code& ec) noexcept {
+					if (size < sizeof(_Native_image_header)) {
+						ec = make_error_code(errc::invalid_argument);
+						return false;
+					}
+					::std::memcpy(&header, data, sizeof(header));
+					return _Validate_native_image_header(header, size, ec);
+				}
+
+				// Wraps the rows that follow header in a surface that reads them in place.
+				unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> _Create_native_image_view(const _Native_image_header& header, unsigned char* data, error_code& ec) noexcept {
+					unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> sfc(cairo_image_surface_create_for_data(data + sizeof(_Native_image_header),
+						static_cast<cairo_format_t>(header.format), header.width, header.height, header.stride), &cairo_surface_destroy);
+					if (cairo_surface_status(sfc.get()) != CAIRO_STATUS_SUCCESS) {
+						ec = make_error_code(errc::not_enough_memory);
+						sfc.reset();
+					}
+					return sfc;
+				}
+
+				// Returns a new surface of format fmt holding the pixels of view, converting them if need be.
+				cairo_surface_t* _Copy_native_image(cairo_surface_t* view, io2d::format fmt, error_code& ec) noexcept {
+					unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> sfc(cairo_image_surface_create(_Format_to_cairo_format_t(fmt),
+						cairo_image_surface_get_width(view), cairo_image_surface_get_height(view)), &cairo_surface_destroy);
+					if (cairo_surface_status(sfc.get()) != CAIRO_STATUS_SUCCESS) {
+						ec = make_error_code(errc::not_enough_memory);
+						return nullptr;
+					}
+					auto ctx = cairo_create(sfc.get());
+					cairo_set_operator(ctx, CAIRO_OPERATOR_SOURCE);
+					cairo_set_source_surface(ctx, view, 0.0, 0.0);
+					cairo_paint(ctx);
+					const auto status = cairo_status(ctx);
+					cairo_destroy(ctx);
+					if (status != CAIRO_STATUS_SUCCESS) {
+						ec = make_error_code(errc::not_enough_memory);
+						return nullptr;
+					}
+					ec.clear();
+					return sfc.release();
+				}
+
+				// A copy-on-write view of a whole file, unmapped when the surface that uses it is destroyed.
+				struct _File_mapping {
+					unsigned char* data = nullptr;
+					size_t size = 0;
+#if defined(_WIN32)
+					HANDLE mapping = nullptr;
+#endif
+				};
+
+				void _Unmap_file(void* p) noexcept {
+					auto m = static_cast<_File_mapping*>(p);
+#if defined(_WIN32)
+					UnmapViewOfFile(m->data);
+					CloseHandle(m->mapping);
+#else
+					munmap(m->data, m->size);
+#endif
+					delete m;
+				}
+
+				const cairo_user_data_key_t _File_mapping_key{};
+
+				_File_mapping* _Map_file(const string& path, error_code& ec) noexcept {
+					unique_ptr<_File_mapping> m(new (nothrow) _File_mapping);
+					if (m == nullptr) {
+						ec = make_error_code(errc::not_enough_memory);
+						return nullptr;
+					}
+#if defined(_WIN32)
+					const HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+					if (file == INVALID_HANDLE_VALUE) {
+						ec = error_code(static_cast<int>(GetLastError()), system_category());
+						return nullptr;
+					}
+					LARGE_INTEGER size;
+					if (!GetFileSizeEx(file, &size) || size.QuadPart < static_cast<LONGLONG>(sizeof(_Native_image_header))) {
+						CloseHandle(file);
+						ec = make_error_code(errc::invalid_argument);
+						return nullptr;
+					}
+					m->size = static_cast<size_t>(size.QuadPart);
+					m->mapping = CreateFileMappingA(file, nullptr, PAGE_WRITECOPY, 0, 0, nullptr);
+					CloseHandle(file);
+					if (m->mapping == nullptr) {
+						ec = error_code(static_cast<int>(GetLastError()), system_category());
+						return nullptr;
+					}
+					m->data = static_cast<unsigned char*>(MapViewOfFile(m->mapping, FILE_MAP_COPY, 0, 0, 0));
+					if (m->data == nullptr) {
+						ec = error_code(static_cast<int>(GetLastError()), system_category());
+						CloseHandle(m->mapping);
+						return nullptr;
+					}
+#else
+					const int fd = open(path.c_str(), O_RDONLY);
+					if (fd == -1) {
+						ec = error_code(errno, generic_category());
+						return nullptr;
+					}
+					struct stat st;
+					if (fstat(fd, &st) != 0 || st.st_size < static_cast<off_t>(sizeof(_Native_image_header))) {
+						close(fd);
+						ec = make_error_code(errc::invalid_argument);
+						return nullptr;
+					}
+					m->size = static_cast<size_t>(st.st_size);
+					void* data = mmap(nullptr, m->size, PROT_READ | PROT_WRITE, MAP_PRIVATE, fd, 0);
+					close(fd);
+					if (data == MAP_FAILED) {
+						ec = error_code(errno, generic_category());
+						return nullptr;
+					}
+					m->data = static_cast<unsigned char*>(data);
+#endif
+					return m.release();
+				}
+
+				template <class Write>
+				void _Write_native_image(cairo_surface_t* sfc, Write&& write, error_code& ec) noexcept {
+					cairo_surface_flush(sfc);
+					_Native_image_header header{};
+					::std::memcpy(header.magic, _Native_image_magic, sizeof(_Native_image_magic));
+					header.byteOrder = _Native_image_byte_order;
+					header.version = _Native_image_version;
+					header.format = cairo_image_surface_get_format(sfc);
+					header.width = cairo_image_surface_get_width(sfc);
+					header.height = cairo_image_surface_get_height(sfc);
+					header.stride = cairo_format_stride_for_width(static_cast<cairo_format_t>(header.format), header.width);
+					if (!_Is_native_image_format(header.format)) {
+						ec = make_error_code(errc::not_supported);
+						return;
+					}
+					if (!write(reinterpret_cast<const unsigned char*>(&header), sizeof(header))) {
+						ec = make_error_code(errc::io_error);
+						return;
+					}
+					const auto data = cairo_image_surface_get_data(sfc);
+					const auto stride = cairo_image_surface_get_stride(sfc);
+					if (stride == header.stride) {
+						if (!write(data, static_cast<size_t>(stride) * static_cast<size_t>(header.height))) {
+							ec = make_error_code(errc::io_error);
+							return;
+						}
+					}
+					else {
+						for (int y = 0; y < header.height; ++y) {
+							if (!write(data + static_cast<ptrdiff_t>(y) * stride, static_cast<size_t>(header.stride))) {
+								ec = make_error_code(errc::io_error);
+								return;
+							}
+						}
+					}
+					ec.clear();
+				}
+
+				// Creates a file that no one else has opened in the directory of path and stores its name in tmpPath.
+				FILE* _Open_temporary_file(const string& path, string& tmpPath, error_code& ec) noexcept {
+					static atomic<unsigned> counter{ 0 };
+#if defined(_WIN32)
+					const auto pid = static_cast<unsigned long>(GetCurrentProcessId());
+#else
+					const auto pid = static_cast<unsigned long>(getpid());
+#endif
+					for (int attempt = 0; attempt < 100; ++attempt) {
+						try {
+							tmpPath = path + "." + to_string(pid) + "." + to_string(counter.fetch_add(1, memory_order_relaxed)) + ".tmp";
+						}
+						catch (const bad_alloc&) {
+							ec = make_error_code(errc::not_enough_memory);
+							return nullptr;
+						}
+#if defined(_WIN32)
+						const HANDLE handle = CreateFileA(tmpPath.c_str(), GENERIC_WRITE, 0, nullptr, CREATE_NEW, FILE_ATTRIBUTE_NORMAL, nullptr);
+						if (handle == INVALID_HANDLE_VALUE) {
+							if (GetLastError() == ERROR_FILE_EXISTS) {
+								continue;
+							}
+							ec = error_code(static_cast<int>(GetLastError()), system_category());
+							return nullptr;
+						}
+						CloseHandle(handle);
+						if (FILE* file = fopen(tmpPath.c_str(), "wb")) {
+							return file;
+						}
+						ec = errno != 0 ? error_code(errno, generic_category()) : make_error_code(errc::io_error);
+						DeleteFileA(tmpPath.c_str());
+						return nullptr;
+#else
+						// open() applies the umask to 0666 just as fopen() does, so a new file gets the usual permissions.
+						const int fd = open(tmpPath.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0666);
+						if (fd == -1) {
+							if (errno == EEXIST) {
+								continue;
+							}
+							ec = error_code(errno, generic_category());
+							return nullptr;
+						}
+						// Saving over a file keeps that file's permissions.
+						struct stat st;
+						if (stat(path.c_str(), &st) == 0) {
+							fchmod(fd, st.st_mode & 07777);
+						}
+						if (FILE* file = fdopen(fd, "wb")) {
+							return file;
+						}
+						ec = error_code(errno, generic_category());
+						close(fd);
+						unlink(tmpPath.c_str());
+						return nullptr;
+#endif
+					}
+					ec = make_error_code(errc::file_exists);
+					return nullptr;
+				}
+
+				// Replaces path with the file at tmpPath. Mappings of the file that path named keep their pages: POSIX only
+				// unlinks that file, and Windows refuses to replace a file that is mapped.
+				void _Replace_file(const string& tmpPath, const string& path, error_code& ec) noexcept {
+#if defined(_WIN32)
+					if (!MoveFileExA(tmpPath.c_str(), path.c_str(), MOVEFILE_REPLACE_EXISTING)) {
+						ec = error_code(static_cast<int>(GetLastError()), system_category());
+						DeleteFileA(tmpPath.c_str());
+					}
+#else
+					if (rename(tmpPath.c_str(), path.c_str()) != 0) {
+						ec = error_code(errno, generic_category());
+						unlink(tmpPath.c_str());
+					}
+#endif
+				}
+			}
+
+			void _Map_native_image(const ::std::string& path, io2d::format fmt, cairo_surface_t*& result, ::std::error_code& ec) noexcept {
+				result = nullptr;
+				if (fmt == io2d::format::invalid) {
+					ec = make_error_code(errc::invalid_argument);
+					return;
+				}
+				auto m = _Map_file(path, ec);
+				if (m == nullptr) {
+					return;
+				}
+				_Native_image_header header;
+				if (!_Read_native_image_header(m->data, m->size, header, ec)) {
+					_Unmap_file(m);
+					return;
+				}
+				auto view = _Create_native_image_view(header, m->data, ec);
+				if (view == nullptr) {
+					_Unmap_file(m);
+					return;
+				}
+				if (cairo_surface_set_user_data(view.get(), &_File_mapping_key, m, &_Unmap_file) != CAIRO_STATUS_SUCCESS) {
+					view.reset();
+					_Unmap_file(m);
+					ec = make_error_code(errc::not_enough_memory);
+					return;
+				}
+				if (header.format != _Format_to_cairo_format_t(fmt)) {
+					// The file's pixels aren't in the layout that was asked for, so they have to be converted after all.
+					result = _Copy_native_image(view.get(), fmt, ec);
+					return;
+				}
+				ec.clear();
+				result = view.release();
+			}
+
+			void _Decode_native_image(const ::std::byte* data, size_t size, io2d::format fmt, cairo_surface_t*& result, ::std::error_code& ec) noexcept {
+				result = nullptr;
+				if (fmt == io2d::format::invalid) {
+					ec = make_error_code(errc::invalid_argument);
+					return;
+				}
+				_Native_image_header header;
+				if (!_Read_native_image_header(reinterpret_cast<const unsigned char*>(data), size, header, ec)) {
+					return;
+				}
+				// The caller keeps its buffer, so the pixels are copied out of it; cairo only reads from a source surface.
+				auto view = _Create_native_image_view(header, const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(data)), ec);
+				if (view == nullptr) {
+					return;
+				}
+				result = _Copy_native_image(view.get(), fmt, ec);
+			}
+
+			void _Encode_native_image(cairo_surface_t* sfc, const ::std::string& path, ::std::error_code& ec) noexcept {
+				// Truncating path in place would pull the pages out from under a surface that was loaded from it.
+				string tmpPath;
+				FILE* file = _Open_temporary_file(path, tmpPath, ec);
+				if (file == nullptr) {
+					return;
+				}
+				_Write_native_image(sfc, [file](const unsigned char* bytes, size_t size) {
+					return fwrite(bytes, 1, size, file) == size;
+				}, ec);
+				if (fclose(file) != 0 && !ec) {
+					ec = make_error_code(errc::io_error);
+				}
+				if (ec) {
+					remove(tmpPath.c_str());
+					return;
+				}
+				_Replace_file(tmpPath, path, ec);
+			}
+
+			void _Encode_native_image(cairo_surface_t* sfc, const function<void(const ::std::byte*, size_t)>& sink, ::std::error_code& ec) noexcept {
+				_Write_native_image(sfc, [&sink](const unsigned char* bytes, size_t size) {
+					try {
+						sink(reinterpret_cast<const ::std::byte*>(bytes), size);
+						return true;
+					}
+					catch (...) {
+						return false;
+					}
+				}, ec);
+			}
+		}
+	}
+}
@@ -0,0 +1,346 @@
+#include "xcairo.h"
+#include "xcairo_helpers.h"
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+// The QOI format (additional_image_file_formats::qoi, see https://qoiformat.org/qoi-specification.pdf): a lossless
+// format that's a few times larger than PNG but encodes and decodes in a single pass over the pixels with no entropy
+// coding, which makes it a good fit for frame dumps and render caches. Files are standard QOI, with straight alpha, so
+// other tools can read them. The encoder reads a surface's rows in place, working on cairo's native-endian 32-bit pixels
+// rather than on bytes, and only un-premultiplies pixels that start a new op; the decoder writes straight into the rows of
+// a new surface. Premultiplying undoes un-premultiplying exactly, so argb32 surfaces round trip unchanged.
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			namespace {
+				const unsigned char _Qoi_magic[4] = { 'q', 'o', 'i', 'f' };
+				const unsigned char _Qoi_end_marker[8] = { 0, 0, 0, 0, 0, 0, 0, 1 };
+				constexpr size_t _Qoi_header_size = 14;
+
+				constexpr unsigned char _Qoi_op_index = 0x00;
+				constexpr unsigned char _Qoi_op_diff = 0x40;
+				constexpr unsigned char _Qoi_op_luma = 0x80;
+				constexpr unsigned char _Qoi_op_run = 0xc0;
+				constexpr unsigned char _Qoi_op_rgb = 0xfe;
+				constexpr unsigned char _Qoi_op_rgba = 0xff;
+				constexpr unsigned char _Qoi_mask_2 = 0xc0;
+
+				// Encoded bytes are gathered into blocks of this size before they're written out.
+				constexpr size_t _Qoi_write_block_size = 64 * 1024;
+
+				// Pixels are kept as cairo keeps them, 0xAARRGGBB, whether they're premultiplied or not.
+				inline unsigned int _Alpha(uint32_t p) noexcept {
+					return p >> 24;
+				}
+				inline unsigned int _Red(uint32_t p) noexcept {
+					return (p >> 16) & 0xff;
+				}
+				inline unsigned int _Green(uint32_t p) noexcept {
+					return (p >> 8) & 0xff;
+				}
+				inline unsigned int _Blue(uint32_t p) noexcept {
+					return p & 0xff;
+				}
+
+				inline unsigned int _Qoi_hash(uint32_t p) noexcept {
+					return (_Red(p) * 3 + _Green(p) * 5 + _Blue(p) * 7 + _Alpha(p) * 11) % 64;
+				}
+
+				inline uint32_t _Unpremultiply(uint32_t p) noexcept {
+					const unsigned int a = _Alpha(p);
+					if (a == 255) {
+						return p;
+					}
+					if (a == 0) {
+						return 0;
+					}
+					const auto channel = [a](unsigned int c) {
+						return ::std::min(255u, (c * 255u + a / 2) / a);
+					};
+					return (a << 24) | (channel(_Red(p)) << 16) | (channel(_Green(p)) << 8) | channel(_Blue(p));
+				}
+
+				inline uint32_t _Premultiply(uint32_t p) noexcept {
+					const unsigned int a = _Alpha(p);
+					if (a == 255) {
+						return p;
+					}
+					// Exact c * a / 255, rounded.
+					const auto channel = [a](unsigned int c) {
+						const auto t = c * a + 128;
+						return (t + (t >> 8)) >> 8;
+					};
+					return (a << 24) | (channel(_Red(p)) << 16) | (channel(_Green(p)) << 8) | channel(_Blue(p));
+				}
+
+				void _Write_big_endian(unsigned char* out, uint32_t v) noexcept {
+					out[0] = static_cast<unsigned char>(v >> 24);
+					out[1] = static_cast<unsigned char>(v >> 16);
+					out[2] = static_cast<unsigned char>(v >> 8);
+					out[3] = static_cast<unsigned char>(v);
+				}
+
+				uint32_t _Read_big_endian(const unsigned char* in) noexcept {
+					return (static_cast<uint32_t>(in[0]) << 24) | (static_cast<uint32_t>(in[1]) << 16) | (static_cast<uint32_t>(in[2]) << 8) | in[3];
+				}
+
+				template <class Write>
+				void _Write_qoi_image(cairo_surface_t* sfc, Write&& write, error_code& ec) noexcept {
+					cairo_surface_flush(sfc);
+					const auto format = cairo_image_surface_get_format(sfc);
+					if (format != CAIRO_FORMAT_ARGB32 && format != CAIRO_FORMAT_RGB24) {
+						ec = make_error_code(errc::not_supported);
+						return;
+					}
+					const bool alpha = format == CAIRO_FORMAT_ARGB32;
+					const int width = cairo_image_surface_get_width(sfc);
+					const int height = cairo_image_surface_get_height(sfc);
+					const auto data = cairo_image_surface_get_data(sfc);
+					const auto stride = cairo_image_surface_get_stride(sfc);
+
+					vector<unsigned char> block;
+					try {
+						block.resize(_Qoi_write_block_size);
+					}
+					catch (const bad_alloc&) {
+						ec = make_error_code(errc::not_enough_memory);
+						return;
+					}
+					unsigned char* const begin = block.data();
+					unsigned char* out = begin;
+					::std::memcpy(out, _Qoi_magic, sizeof(_Qoi_magic));
+					_Write_big_endian(out + 4, static_cast<uint32_t>(width));
+					_Write_big_endian(out + 8, static_cast<uint32_t>(height));
+					out[12] = alpha ? 4 : 3;
+					out[13] = 0;	// sRGB with linear alpha.
+					out += _Qoi_header_size;
+
+					// The longest op is 5 bytes, so the block is written out whenever there might not be room for another.
+					unsigned char* const flushAt = begin + block.size() - 5;
+					uint32_t index[64] = {};
+					uint32_t previous = 0xff000000;
+					// The source pixel that previous came from. Equal source pixels give equal straight pixels, so runs are
+					// found without un-premultiplying anything.
+					uint32_t previousSource = 0xff000000;
+					unsigned int run = 0;
+					for (int y = 0; y < height; ++y) {
+						const auto row = reinterpret_cast<const uint32_t*>(data + static_cast<ptrdiff_t>(y) * stride);
+						for (int x = 0; x < width; ++x) {
+							const uint32_t source = alpha ? row[x] : (row[x] | 0xff000000);
+							if (source == previousSource) {
+								if (++run == 62) {
+									*out++ = static_cast<unsigned char>(_Qoi_op_run | (run - 1));
+									run = 0;
+								}
+							}
+							else {
+								if (run > 0) {
+									*out++ = static_cast<unsigned char>(_Qoi_op_run | (run - 1));
+									run = 0;
+								}
+								const uint32_t p = _Unpremultiply(source);
+								const auto hash = _Qoi_hash(p);
+								if (index[hash] == p) {
+									*out++ = static_cast<unsigned char>(_Qoi_op_index | hash);
+								}
+								else {
+									index[hash] = p;
+									if (_Alpha(p) == _Alpha(previous)) {
+										const int dr = static_cast<signed char>(static_cast<unsigned char>(_Red(p) - _Red(previous)));
+										const int dg = static_cast<signed char>(static_cast<unsigned char>(_Green(p) - _Green(previous)));
+										const int db = static_cast<signed char>(static_cast<unsigned char>(_Blue(p) - _Blue(previous)));
+										const int drg = dr - dg;
+										const int dbg = db - dg;
+										if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+											*out++ = static_cast<unsigned char>(_Qoi_op_diff | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2));
+										}
+										else if (drg >= -8 && drg <= 7 && dg >= -32 && dg <= 31 && dbg >= -8 && dbg <= 7) {
+											*out++ = static_cast<unsigned char>(_Qoi_op_luma | (dg + 32));
+											*out++ = static_cast<unsigned char>(((drg + 8) << 4) | (dbg + 8));
+										}
+										else {
+											*out++ = _Qoi_op_rgb;
+											*out++ = static_cast<unsigned char>(_Red(p));
+											*out++ = static_cast<unsigned char>(_Green(p));
+											*out++ = static_cast<unsigned char>(_Blue(p));
+										}
+									}
+									else {
+										*out++ = _Qoi_op_rgba;
+										*out++ = static_cast<unsigned char>(_Red(p));
+										*out++ = static_cast<unsigned char>(_Green(p));
+										*out++ = static_cast<unsigned char>(_Blue(p));
+										*out++ = static_cast<unsigned char>(_Alpha(p));
+									}
+								}
+								previous = p;
+								previousSource = source;
+							}
+							if (out >= flushAt) {
+								if (!write(begin, static_cast<size_t>(out - begin))) {
+									ec = make_error_code(errc::io_error);
+									return;
+								}
+								out = begin;
+							}
+						}
+					}
+					if (run > 0) {
+						*out++ = static_cast<unsigned char>(_Qoi_op_run | (run - 1));
+					}
+					if ((out > begin && !write(begin, static_cast<size_t>(out - begin))) || !write(_Qoi_end_marker, sizeof(_Qoi_end_marker))) {
+						ec = make_error_code(errc::io_error);
+						return;
+					}
+					ec.clear();
+				}
+			}
+
+			void _Decode_qoi_image(const ::std::byte* bytes, size_t size, io2d::format fmt, cairo_surface_t*& result, ::std::error_code& ec) noexcept {
+				result = nullptr;
+				if (fmt != io2d::format::argb32 && fmt != io2d::format::xrgb32) {
+					ec = make_error_code(errc::not_supported);
+					return;
+				}
+				const auto data = reinterpret_cast<const unsigned char*>(bytes);
+				if (size < _Qoi_header_size + sizeof(_Qoi_end_marker) || ::std::memcmp(data, _Qoi_magic, sizeof(_Qoi_magic)) != 0 || data[12] < 3 || data[12] > 4 || data[13] > 1) {
+					ec = make_error_code(errc::illegal_byte_sequence);
+					return;
+				}
+				const uint32_t width = _Read_big_endian(data + 4);
+				const uint32_t height = _Read_big_endian(data + 8);
+				if (width == 0 || height == 0 || width > 32767 || height > 32767) {
+					ec = make_error_code(errc::value_too_large);
+					return;
+				}
+				unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> sfc(cairo_image_surface_create(_Format_to_cairo_format_t(fmt), static_cast<int>(width), static_cast<int>(height)), &cairo_surface_destroy);
+				if (cairo_surface_status(sfc.get()) != CAIRO_STATUS_SUCCESS) {
+					ec = make_error_code(errc::not_enough_memory);
+					return;
+				}
+				cairo_surface_flush(sfc.get());
+				const auto pixels = cairo_image_surface_get_data(sfc.get());
+				const auto stride = cairo_image_surface_get_stride(sfc.get());
+				const bool premultiply = fmt == io2d::format::argb32;
+
+				// Every op is followed at least by the end marker, so as long as in is before end no op reads past the data.
+				const unsigned char* in = data + _Qoi_header_size;
+				const unsigned char* const end = data + size - sizeof(_Qoi_end_marker);
+				uint32_t index[64] = {};
+				uint32_t p = 0xff000000;
+				uint32_t output = p;
+				unsigned int run = 0;
+				for (uint32_t y = 0; y < height; ++y) {
+					const auto row = reinterpret_cast<uint32_t*>(pixels + static_cast<ptrdiff_t>(y) * stride);
+					for (uint32_t x = 0; x < width; ++x) {
+						if (run > 0) {
+							--run;
+							row[x] = output;
+							continue;
+						}
+						if (in >= end) {
+							ec = make_error_code(errc::illegal_byte_sequence);
+							return;
+						}
+						const unsigned char op = *in++;
+						if (op == _Qoi_op_rgb) {
+							p = (p & 0xff000000) | (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2];
+							in += 3;
+						}
+						else if (op == _Qoi_op_rgba) {
+							p = (static_cast<uint32_t>(in[3]) << 24) | (static_cast<uint32_t>(in[0]) << 16) | (static_cast<uint32_t>(in[1]) << 8) | in[2];
+							in += 4;
+						}
+						else if ((op & _Qoi_mask_2) == _Qoi_op_index) {
+							p = index[op];
+						}
+						else if ((op & _Qoi_mask_2) == _Qoi_op_diff) {
+							const unsigned int r = (_Red(p) + ((op >> 4) & 3) - 2) & 0xff;
+							const unsigned int g = (_Green(p) + ((op >> 2) & 3) - 2) & 0xff;
+							const unsigned int b = (_Blue(p) + (op & 3) - 2) & 0xff;
+							p = (p & 0xff000000) | (r << 16) | (g << 8) | b;
+						}
+						else if ((op & _Qoi_mask_2) == _Qoi_op_luma) {
+							const int dg = (op & 0x3f) - 32;
+							const int drg = (*in >> 4) - 8;
+							const int dbg = (*in & 0x0f) - 8;
+							++in;
+							const unsigned int r = static_cast<unsigned int>(static_cast<int>(_Red(p)) + dg + drg) & 0xff;
+							const unsigned int g = static_cast<unsigned int>(static_cast<int>(_Green(p)) + dg) & 0xff;
+							const unsigned int b = static_cast<unsigned int>(static_cast<int>(_Blue(p)) + dg + dbg) & 0xff;
+							p = (p & 0xff000000) | (r << 16) | (g << 8) | b;
+						}
+						else {
+							run = op & 0x3f;
+						}
+						index[_Qoi_hash(p)] = p;
+						output = premultiply ? _Premultiply(p) : (p | 0xff000000);
+						row[x] = output;
+					}
+				}
+				cairo_surface_mark_dirty(sfc.get());
+				ec.clear();
+				result = sfc.release();
+			}
+
+			void _Decode_qoi_image(const ::std::string& path, io2d::format fmt, cairo_surface_t*& result, ::std::error_code& ec) noexcept {
+				result = nullptr;
+				FILE* file = fopen(path.c_str(), "rb");
+				if (file == nullptr) {
+					ec = errno != 0 ? error_code(errno, generic_category()) : make_error_code(errc::io_error);
+					return;
+				}
+				vector<unsigned char> contents;
+				bool read = fseek(file, 0, SEEK_END) == 0;
+				const long size = read ? ftell(file) : -1;
+				read = size >= 0 && fseek(file, 0, SEEK_SET) == 0;
+				if (read) {
+					try {
+						contents.resize(static_cast<size_t>(size));
+					}
+					catch (const bad_alloc&) {
+						fclose(file);
+						ec = make_error_code(errc::not_enough_memory);
+						return;
+					}
+					read = fread(contents.data(), 1, contents.size(), file) == contents.size();
+				}
+				fclose(file);
+				if (!read) {
+					ec = make_error_code(errc::io_error);
+					return;
+				}
+				_Decode_qoi_image(reinterpret_cast<const ::std::byte*>(contents.data()), contents.size(), fmt, result, ec);
+			}
+
+			void _Encode_qoi_image(cairo_surface_t* sfc, const ::std::string& path, ::std::error_code& ec) noexcept {
+				FILE* file = fopen(path.c_str(), "wb");
+				if (file == nullptr) {
+					ec = errno != 0 ? error_code(errno, generic_category()) : make_error_code(errc::io_error);
+					return;
+				}
+				_Write_qoi_image(sfc, [file](const unsigned char* bytes, size_t size) {
+					return fwrite(bytes, 1, size, file) == size;
+				}, ec);
+				if (fclose(file) != 0 && !ec) {
+					ec = make_error_code(errc::io_error);
+				}
+			}
+
+			void _Encode_qoi_image(cairo_surface_t* sfc, const function<void(const ::std::byte*, size_t)>& sink, ::std::error_code& ec) noexcept {
+				_Write_qoi_image(sfc, [&sink](const unsigned char* bytes, size_t size) {
+					try {
+						sink(reinterpret_cast<const ::std::byte*>(bytes), size);
+						return true;
+					}
+					catch (...) {
+						return false;
+					}
+				}, ec);
+			}
+		}
+	}
+}
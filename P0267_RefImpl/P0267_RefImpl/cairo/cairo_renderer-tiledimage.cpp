@@ -0,0 +1,429 @@
+#include "xcairo.h"
+#include <cstdio>
+#include <cstring>
+
+// The tile store behind basic_tiled_image_surface, which covers extents that a single cairo image surface can't: cairo
+// limits image surfaces to 32767 pixels a side and needs their pixels in one allocation. Tiles are only allocated once
+// something is drawn on them, and with a store file only a byte budget's worth of them are kept in memory. The store is
+// a scratch file that grows by one tile the first time each tile is paged out; after that the tile keeps its place and
+// is only written again if it has changed since.
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			namespace {
+				// Large enough to keep the number of tiles, and so the bookkeeping, small; small enough that drawing on a
+				// tile doesn't mean allocating tens of megabytes.
+				constexpr int _Max_tile_size = 4096;
+				constexpr uint64_t _Max_tiles = uint64_t(1) << 22;
+
+				int _Tiff_samples_per_pixel(cairo_format_t fmt) noexcept {
+					switch (fmt) {
+					case CAIRO_FORMAT_ARGB32:
+						return 4;
+					case CAIRO_FORMAT_RGB24:
+						return 3;
+					case CAIRO_FORMAT_A8:
+						return 1;
+					default:
+						return 0;
+					}
+				}
+
+				void _Put_le(vector<unsigned char>& out, uint64_t value, int bytes) {
+					for (int i = 0; i < bytes; i++) {
+						out.push_back(static_cast<unsigned char>(value >> (8 * i)));
+					}
+				}
+
+				enum : uint16_t {
+					_Tiff_short = 3,
+					_Tiff_long = 4,
+					_Tiff_long8 = 16
+				};
+
+				struct _Tiff_entry {
+					uint16_t tag;
+					uint16_t type;
+					uint64_t count;
+					vector<unsigned char> value;
+				};
+
+				_Tiff_entry _Tiff_shorts(uint16_t tag, initializer_list<uint64_t> values) {
+					_Tiff_entry entry{ tag, _Tiff_short, values.size(), {} };
+					for (auto v : values) {
+						_Put_le(entry.value, v, 2);
+					}
+					return entry;
+				}
+
+				_Tiff_entry _Tiff_long_value(uint16_t tag, uint64_t value) {
+					_Tiff_entry entry{ tag, _Tiff_long, 1, {} };
+					_Put_le(entry.value, value, 4);
+					return entry;
+				}
+
+				// Converts a tile from cairo's native endian pixels to the interleaved samples TIFF stores, padding the
+				// right and bottom edges of partial tiles with zeroes.
+				void _Tile_to_tiff_samples(const unsigned char* src, int stride, int width, int height, int tileSize, int samples, unsigned char* dst) noexcept {
+					::std::memset(dst, 0, static_cast<size_t>(tileSize) * tileSize * samples);
+					for (int y = 0; y < height; y++) {
+						const auto row = src + static_cast<ptrdiff_t>(y) * stride;
+						auto out = dst + static_cast<ptrdiff_t>(y) * tileSize * samples;
+						if (samples == 1) {
+							::std::memcpy(out, row, static_cast<size_t>(width));
+							continue;
+						}
+						for (int x = 0; x < width; x++) {
+							uint32_t px;
+							::std::memcpy(&px, row + x * 4, 4);
+							*out++ = static_cast<unsigned char>(px >> 16);
+							*out++ = static_cast<unsigned char>(px >> 8);
+							*out++ = static_cast<unsigned char>(px);
+							if (samples == 4) {
+								*out++ = static_cast<unsigned char>(px >> 24);
+							}
+						}
+					}
+				}
+			}
+
+			_Tiled_image::_Tiled_image(cairo_format_t fmt, int width, int height, int tileSize)
+				: _Format(fmt)
+				, _Width(width)
+				, _Height(height) {
+				if (fmt == CAIRO_FORMAT_INVALID || width < 1 || height < 1 || tileSize < 1) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				_Tile_size = (::std::min(tileSize, _Max_tile_size) + 15) / 16 * 16;
+				_Columns = (width - 1) / _Tile_size + 1;
+				_Rows = (height - 1) / _Tile_size + 1;
+				if (static_cast<uint64_t>(_Columns) * static_cast<uint64_t>(_Rows) > _Max_tiles) {
+					throw ::std::system_error(::std::make_error_code(errc::value_too_large));
+				}
+				_Tiles.resize(static_cast<size_t>(_Columns) * static_cast<size_t>(_Rows));
+			}
+
+			_Tiled_image::~_Tiled_image() noexcept {
+				_Close_store();
+			}
+
+			cairo_format_t _Tiled_image::format() const noexcept {
+				return _Format;
+			}
+
+			int _Tiled_image::width() const noexcept {
+				return _Width;
+			}
+
+			int _Tiled_image::height() const noexcept {
+				return _Height;
+			}
+
+			int _Tiled_image::tile_size() const noexcept {
+				return _Tile_size;
+			}
+
+			int _Tiled_image::columns() const noexcept {
+				return _Columns;
+			}
+
+			int _Tiled_image::rows() const noexcept {
+				return _Rows;
+			}
+
+			int _Tiled_image::tile_width(int column) const noexcept {
+				return ::std::min(_Tile_size, _Width - column * _Tile_size);
+			}
+
+			int _Tiled_image::tile_height(int row) const noexcept {
+				return ::std::min(_Tile_size, _Height - row * _Tile_size);
+			}
+
+			int _Tiled_image::tile_stride(int column) const noexcept {
+				return cairo_format_stride_for_width(_Format, tile_width(column));
+			}
+
+			size_t _Tiled_image::allocated_tiles() const noexcept {
+				return _Allocated;
+			}
+
+			size_t _Tiled_image::resident_tiles() const noexcept {
+				return _Resident.size();
+			}
+
+			size_t _Tiled_image::_Tile_bytes(size_t index) const noexcept {
+				const auto column = static_cast<int>(index % static_cast<size_t>(_Columns));
+				const auto row = static_cast<int>(index / static_cast<size_t>(_Columns));
+				return static_cast<size_t>(tile_stride(column)) * static_cast<size_t>(tile_height(row));
+			}
+
+			void _Tiled_image::_Evict(size_t index) {
+				auto& t = _Tiles[index];
+				const auto bytes = _Tile_bytes(index);
+				if (t.dirty || t.storeOffset < 0) {
+					const auto offset = t.storeOffset < 0 ? _Store_size : t.storeOffset;
+					_Store.seekp(offset);
+					_Store.write(reinterpret_cast<const char*>(t.pixels.get()), static_cast<streamsize>(bytes));
+					if (!_Store) {
+						_Store.clear();
+						throw ::std::system_error(::std::make_error_code(errc::io_error));
+					}
+					if (t.storeOffset < 0) {
+						t.storeOffset = offset;
+						_Store_size += static_cast<int64_t>(bytes);
+					}
+					t.dirty = false;
+				}
+				_Resident.erase(t.lru);
+				t.pixels.reset();
+				_Resident_bytes -= bytes;
+			}
+
+			void _Tiled_image::_Make_room(size_t bytes) {
+				if (!_Store.is_open()) {
+					return;
+				}
+				while (!_Resident.empty() && _Resident_bytes + bytes > _Budget) {
+					_Evict(_Resident.back());
+				}
+			}
+
+			void _Tiled_image::_Close_store() noexcept {
+				if (_Store.is_open()) {
+					_Store.close();
+					::std::remove(_Store_path.c_str());
+				}
+				_Store.clear();
+				_Store_path.clear();
+				_Store_size = 0;
+			}
+
+			unsigned char* _Tiled_image::tile(int column, int row, bool create) {
+				const auto index = static_cast<size_t>(row) * static_cast<size_t>(_Columns) + static_cast<size_t>(column);
+				auto& t = _Tiles[index];
+				if (t.pixels != nullptr) {
+					_Resident.splice(_Resident.begin(), _Resident, t.lru);
+				}
+				else {
+					const bool stored = t.storeOffset >= 0;
+					if (!stored && !create) {
+						return nullptr;
+					}
+					const auto bytes = _Tile_bytes(index);
+					// Make room first, so that the new tile never pushes the tiles in memory over the budget.
+					_Make_room(bytes);
+					::std::unique_ptr<unsigned char[]> pixels(new unsigned char[bytes]);
+					if (stored) {
+						_Store.seekg(t.storeOffset);
+						_Store.read(reinterpret_cast<char*>(pixels.get()), static_cast<streamsize>(bytes));
+						if (!_Store) {
+							_Store.clear();
+							throw ::std::system_error(::std::make_error_code(errc::io_error));
+						}
+					}
+					else {
+						::std::memset(pixels.get(), 0, bytes);
+					}
+					_Resident.push_front(index);
+					t.lru = _Resident.begin();
+					t.pixels = ::std::move(pixels);
+					_Resident_bytes += bytes;
+					if (!stored) {
+						++_Allocated;
+					}
+				}
+				if (create) {
+					t.dirty = true;
+				}
+				return t.pixels.get();
+			}
+
+			void _Tiled_image::page_to(const ::std::string& path, size_t residentBytes) {
+				if (_Store.is_open()) {
+					// Bring everything back from the old store, which is removed, so that the new one starts out empty.
+					_Budget = numeric_limits<size_t>::max();
+					for (int row = 0; row < _Rows; row++) {
+						for (int column = 0; column < _Columns; column++) {
+							tile(column, row, false);
+						}
+					}
+					for (auto& t : _Tiles) {
+						t.storeOffset = -1;
+						t.dirty = false;
+					}
+					_Close_store();
+				}
+				_Store.open(path, ios::in | ios::out | ios::trunc | ios::binary);
+				if (!_Store.is_open()) {
+					_Store.clear();
+					throw ::std::system_error(::std::make_error_code(errc::io_error));
+				}
+				_Store_path = path;
+				_Budget = ::std::max(residentBytes, static_cast<size_t>(cairo_format_stride_for_width(_Format, _Tile_size)) * static_cast<size_t>(_Tile_size));
+				_Make_room(0);
+			}
+
+			void _Tiled_image::clear() noexcept {
+				for (auto& t : _Tiles) {
+					t.pixels.reset();
+					t.storeOffset = -1;
+					t.dirty = false;
+				}
+				_Resident.clear();
+				_Resident_bytes = 0;
+				_Allocated = 0;
+				// Every tile's place in the store is free again.
+				_Store_size = 0;
+			}
+
+			void _Tiled_image::save_tiff(const ::std::string& path, ::std::error_code& ec) noexcept {
+				const auto samples = _Tiff_samples_per_pixel(_Format);
+				if (samples == 0) {
+					ec = ::std::make_error_code(errc::not_supported);
+					return;
+				}
+				bool created = false;
+				try {
+					const auto tileCount = _Tiles.size();
+					const auto tileBytes = static_cast<uint64_t>(_Tile_size) * static_cast<uint64_t>(_Tile_size) * static_cast<uint64_t>(samples);
+					const bool hasEmpty = _Allocated < tileCount;
+					const auto dataBytes = (_Allocated + (hasEmpty ? 1 : 0)) * tileBytes;
+					// The IFD and the tag values too big to go in it come after the tiles. Without the two tile arrays
+					// they take up well under a kilobyte.
+					const bool big = 8 + dataBytes + 8 * static_cast<uint64_t>(tileCount) + 1024 > numeric_limits<uint32_t>::max();
+					const int offsetBytes = big ? 8 : 4;
+					const uint64_t headerBytes = big ? 16 : 8;
+
+					// Tiles that have never been drawn on all point at one empty tile, which goes first.
+					vector<uint64_t> offsets(tileCount);
+					auto next = headerBytes;
+					const auto emptyOffset = next;
+					if (hasEmpty) {
+						next += tileBytes;
+					}
+					for (size_t i = 0; i < tileCount; i++) {
+						if (_Tiles[i].pixels != nullptr || _Tiles[i].storeOffset >= 0) {
+							offsets[i] = next;
+							next += tileBytes;
+						}
+						else {
+							offsets[i] = emptyOffset;
+						}
+					}
+					const auto ifdOffset = next;
+
+					vector<_Tiff_entry> entries;
+					entries.push_back(_Tiff_long_value(256, static_cast<uint64_t>(_Width)));
+					entries.push_back(_Tiff_long_value(257, static_cast<uint64_t>(_Height)));
+					if (samples == 4) {
+						entries.push_back(_Tiff_shorts(258, { 8, 8, 8, 8 }));
+					}
+					else if (samples == 3) {
+						entries.push_back(_Tiff_shorts(258, { 8, 8, 8 }));
+					}
+					else {
+						entries.push_back(_Tiff_shorts(258, { 8 }));
+					}
+					entries.push_back(_Tiff_shorts(259, { 1 }));
+					entries.push_back(_Tiff_shorts(262, { samples == 1 ? 1u : 2u }));
+					entries.push_back(_Tiff_shorts(277, { static_cast<uint64_t>(samples) }));
+					entries.push_back(_Tiff_shorts(284, { 1 }));
+					entries.push_back(_Tiff_long_value(322, static_cast<uint64_t>(_Tile_size)));
+					entries.push_back(_Tiff_long_value(323, static_cast<uint64_t>(_Tile_size)));
+					_Tiff_entry offsetsEntry{ 324, big ? _Tiff_long8 : _Tiff_long, tileCount, {} };
+					_Tiff_entry countsEntry{ 325, big ? _Tiff_long8 : _Tiff_long, tileCount, {} };
+					offsetsEntry.value.reserve(tileCount * offsetBytes);
+					countsEntry.value.reserve(tileCount * offsetBytes);
+					for (auto offset : offsets) {
+						_Put_le(offsetsEntry.value, offset, offsetBytes);
+						_Put_le(countsEntry.value, tileBytes, offsetBytes);
+					}
+					entries.push_back(::std::move(offsetsEntry));
+					entries.push_back(::std::move(countsEntry));
+					if (samples == 4) {
+						// Associated alpha: cairo's pixels are premultiplied.
+						entries.push_back(_Tiff_shorts(338, { 1 }));
+					}
+
+					vector<unsigned char> ifd;
+					vector<unsigned char> extra;
+					const auto ifdBytes = big ? 8 + entries.size() * 20 + 8 : 2 + entries.size() * 12 + 4;
+					_Put_le(ifd, entries.size(), big ? 8 : 2);
+					for (const auto& entry : entries) {
+						_Put_le(ifd, entry.tag, 2);
+						_Put_le(ifd, entry.type, 2);
+						_Put_le(ifd, entry.count, offsetBytes);
+						if (entry.value.size() <= static_cast<size_t>(offsetBytes)) {
+							ifd.insert(ifd.end(), entry.value.begin(), entry.value.end());
+							ifd.insert(ifd.end(), offsetBytes - entry.value.size(), 0);
+						}
+						else {
+							_Put_le(ifd, ifdOffset + ifdBytes + extra.size(), offsetBytes);
+							extra.insert(extra.end(), entry.value.begin(), entry.value.end());
+						}
+					}
+					_Put_le(ifd, 0, offsetBytes);
+
+					vector<unsigned char> header{ 'I', 'I' };
+					if (big) {
+						_Put_le(header, 43, 2);
+						_Put_le(header, 8, 2);
+						_Put_le(header, 0, 2);
+						_Put_le(header, ifdOffset, 8);
+					}
+					else {
+						_Put_le(header, 42, 2);
+						_Put_le(header, ifdOffset, 4);
+					}
+
+					::std::ofstream out(path, ios::out | ios::trunc | ios::binary);
+					if (!out.is_open()) {
+						ec = ::std::make_error_code(errc::io_error);
+						return;
+					}
+					created = true;
+					::std::unique_ptr<unsigned char[]> samplesBuffer(new unsigned char[static_cast<size_t>(tileBytes)]);
+					out.write(reinterpret_cast<const char*>(header.data()), static_cast<streamsize>(header.size()));
+					if (hasEmpty) {
+						::std::memset(samplesBuffer.get(), 0, static_cast<size_t>(tileBytes));
+						out.write(reinterpret_cast<const char*>(samplesBuffer.get()), static_cast<streamsize>(tileBytes));
+					}
+					for (int row = 0; row < _Rows && out; row++) {
+						for (int column = 0; column < _Columns && out; column++) {
+							auto pixels = tile(column, row, false);
+							if (pixels == nullptr) {
+								continue;
+							}
+							_Tile_to_tiff_samples(pixels, tile_stride(column), tile_width(column), tile_height(row), _Tile_size, samples, samplesBuffer.get());
+							out.write(reinterpret_cast<const char*>(samplesBuffer.get()), static_cast<streamsize>(tileBytes));
+						}
+					}
+					out.write(reinterpret_cast<const char*>(ifd.data()), static_cast<streamsize>(ifd.size()));
+					out.write(reinterpret_cast<const char*>(extra.data()), static_cast<streamsize>(extra.size()));
+					out.close();
+					if (!out) {
+						::std::remove(path.c_str());
+						ec = ::std::make_error_code(errc::io_error);
+						return;
+					}
+				}
+				catch (const ::std::system_error& e) {
+					if (created) {
+						::std::remove(path.c_str());
+					}
+					ec = e.code();
+					return;
+				}
+				catch (const ::std::bad_alloc&) {
+					if (created) {
+						::std::remove(path.c_str());
+					}
+					ec = ::std::make_error_code(errc::not_enough_memory);
+					return;
+				}
+				ec.clear();
+			}
+		}
+	}
+}
@@ -0,0 +1,26 @@
+#include "xio2d_cairo_headless_main.h"
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+
+			void _Headless_wake::signal() {
+				::std::lock_guard<::std::mutex> lock(mutex);
+				pending = true;
+				cv.notify_all();
+			}
+
+			void _Headless_wake::end_show() {
+				::std::lock_guard<::std::mutex> lock(mutex);
+				show_ended = true;
+				pending = true;
+				cv.notify_all();
+			}
+
+			bool _Headless_wake::ended() {
+				::std::lock_guard<::std::mutex> lock(mutex);
+				return show_ended;
+			}
+		}
+	}
+}
@@ -0,0 +1,22 @@
+#ifndef _IO2D_CAIRO_HEADLESS_
+#define _IO2D_CAIRO_HEADLESS_
+
+#include "xio2d_cairo_headless_main.h"
+
+namespace std {
+    namespace experimental {
+        namespace io2d {
+            inline namespace v1 {
+                namespace _Cairo {
+
+                    // TODO: cairo-specific typenames definition
+                    
+                    
+                    
+                } // namespace _Cairo
+            } // namespace v1
+        } // namespace io2d
+    } // namespace experimental
+} // namespace std
+
+#endif
@@ -0,0 +1,13 @@
+#ifndef _XIO2D_CAIRO_HEADLESS_MAIN_H_
+#define _XIO2D_CAIRO_HEADLESS_MAIN_H_
+
+#include <xio2d.h>
+
+#include <xio2d_cairo_main.h>
+
+#include "xio2d_cairo_headless_surfaces.h"
+#include "xio2d_cairo_headless_output_surfaces.h"
+#include "xio2d_cairo_headless_unmanaged_output_surfaces.h"
+#include "xio2d_cairo_headless_surfaces_impl.h"
+
+#endif // _XIO2D_CAIRO_HEADLESS_MAIN_H_
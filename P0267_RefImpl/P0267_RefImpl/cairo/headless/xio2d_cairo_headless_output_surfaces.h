@@ -0,0 +1,418 @@
+#pragma once
+#include "xcairo_surfaces_impl.h"
+
+#include <mutex>
+#include <condition_variable>
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			// output surface functions
+
+			// Wakes begin_show up while it waits for the next frame. Signalled by redraw_required(true), end_show and a finished
+			// async frame, any of which can happen on another thread.
+			struct _Headless_wake {
+				::std::mutex mutex;
+				::std::condition_variable cv;
+				bool pending = false;
+				bool show_ended = false;
+
+				void signal();
+				void end_show();
+				bool ended();
+			};
+
+			template<class GraphicsMath>
+			struct _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Display_surface_data_type {
+				bool unmanaged = false;
+				// Created by begin_show.
+				::std::unique_ptr<_Headless_wake> wake;
+				bool letterbox_brush_is_default = true;
+				optional<basic_brush<_Graphics_surfaces_type>> _Letterbox_brush;
+				optional<basic_brush_props<_Graphics_surfaces_type>> _Letterbox_brush_props;
+
+				optional<basic_brush<_Graphics_surfaces_type>> _Default_letterbox_brush;
+
+				// There is no display. These are only reported back, e.g. to a user scaling callback.
+				basic_display_point<GraphicsMath> display_dimensions;
+
+				image_surface_data_type back_buffer;
+				// Set while async_render is on. Declared after back_buffer so that the render thread stops before the back buffer is destroyed.
+				::std::unique_ptr<_Async_renderer> async;
+
+				bool auto_clear = false;
+				int buffer_count = 1;
+				bool damage_tracking = false;
+				bool display_invalid = true;
+				_Damage_region damage;
+				io2d::scaling scl = io2d::scaling::letterbox;
+				io2d::refresh_style rr = io2d::refresh_style::as_fast_as_possible;
+				float refresh_fps = 30.0f;
+				bool redraw_required = false;
+				float elapsed_draw_time = 0.0f;
+			};
+
+			template<class GraphicsMath>
+			struct _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Output_surface_data {
+				_Display_surface_data_type data;
+				::std::function<void(basic_output_surface<_Graphics_surfaces_type>&)> draw_callback;
+				::std::function<void(basic_output_surface<_Graphics_surfaces_type>&)> size_change_callback;
+				::std::function<basic_bounding_box<GraphicsMath>(const basic_output_surface<_Graphics_surfaces_type>&, bool&)> user_scaling_callback;
+				::std::function<void(const _Interchange_buffer&)> present_callback;
+				// What present_callback is handed. Kept between frames so that with damage_tracking only the damaged part is copied again.
+				_Interchange_buffer present_copy;
+				_Show_budget budget;
+				::std::function<void(const frame_timing&)> frame_timing_callback;
+				_Frame_timing_ring timing;
+			};
+
+			template<class GraphicsMath>
+			struct _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Unmanaged_output_surface_data {
+				_Display_surface_data_type data;
+				::std::function<void(basic_unmanaged_output_surface<_Graphics_surfaces_type>&)> draw_callback;
+				::std::function<void(basic_unmanaged_output_surface<_Graphics_surfaces_type>&)> size_change_callback;
+				::std::function<basic_bounding_box<GraphicsMath>(const basic_unmanaged_output_surface<_Graphics_surfaces_type>&, bool&)> user_scaling_callback;
+			};
+
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::output_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_output_surface(int preferredWidth, int preferredHeight, io2d::format preferredFormat, io2d::scaling scl, io2d::refresh_style rr, float fps) {
+				return create_output_surface(preferredWidth, preferredHeight, preferredFormat, preferredWidth, preferredHeight, scl, rr, fps);
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::output_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_output_surface(int preferredWidth, int preferredHeight, io2d::format preferredFormat, error_code& ec, io2d::scaling scl, io2d::refresh_style rr, float fps) noexcept {
+				return create_output_surface(preferredWidth, preferredHeight, preferredFormat, preferredWidth, preferredHeight, ec, scl, rr, fps);
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::output_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_output_surface(int preferredWidth, int preferredHeight, io2d::format preferredFormat, int preferredDisplayWidth, int preferredDisplayHeight, io2d::scaling scl, io2d::refresh_style rr, float fps) {
+				auto result = make_unique<_Output_surface_data>();
+				_Display_surface_data_type& data = result->data;
+				data.display_dimensions.x(preferredDisplayWidth);
+				data.display_dimensions.y(preferredDisplayHeight);
+				data.rr = rr;
+				data.refresh_fps = fps;
+				data.scl = scl;
+				data.back_buffer.format = preferredFormat;
+				data.back_buffer.dimensions.x(preferredWidth);
+				data.back_buffer.dimensions.y(preferredHeight);
+				return result.release();
+			}
+			template <class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::output_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_output_surface(int preferredWidth, int preferredHeight, io2d::format preferredFormat, int preferredDisplayWidth, int preferredDisplayHeight, error_code& ec, io2d::scaling scl, io2d::refresh_style rr, float fps) noexcept {
+				try {
+					auto result = create_output_surface(preferredWidth, preferredHeight, preferredFormat, preferredDisplayWidth, preferredDisplayHeight, scl, rr, fps);
+					ec.clear();
+					return result;
+				}
+				catch (const ::std::bad_alloc&) {
+					ec = ::std::make_error_code(::std::errc::not_enough_memory);
+					return output_surface_data_type{};
+				}
+			}
+			template <class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::output_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::move_output_surface(output_surface_data_type&& data) noexcept {
+				return ::std::exchange(data, nullptr);
+			}
+			template <class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::destroy(output_surface_data_type& data) noexcept {
+				// A moved-from surface has no data.
+				if (data == nullptr) {
+					return;
+				}
+				data->data.async.reset();
+				destroy(data->data.back_buffer);
+				delete data;
+			}
+
+			template<class GraphicsMath>
+			inline int _Cairo_graphics_surfaces<GraphicsMath>::surfaces::begin_show(output_surface_data_type& osd, basic_output_surface<_Cairo_graphics_surfaces<GraphicsMath>>* /*instance*/, basic_output_surface<_Cairo_graphics_surfaces<GraphicsMath>>& sfc) {
+				_Display_surface_data_type& data = osd->data;
+				data._Default_letterbox_brush = basic_brush<_Cairo_graphics_surfaces>(rgba_color::black);
+				data._Letterbox_brush = data._Default_letterbox_brush;
+
+				data.back_buffer = ::std::move(create_image_surface(data.back_buffer.format, data.back_buffer.dimensions.x(), data.back_buffer.dimensions.y()));
+				data.display_invalid = true;
+
+				if (data.wake == nullptr) {
+					data.wake = ::std::make_unique<_Headless_wake>();
+				}
+				auto wake = data.wake.get();
+				{
+					::std::lock_guard<::std::mutex> lock(wake->mutex);
+					wake->pending = false;
+					wake->show_ended = false;
+				}
+
+				osd->budget.begin();
+				auto previousTime = ::std::chrono::steady_clock::now();
+				// The first frame is drawn right away, whatever the refresh style.
+				data.redraw_required = true;
+				data.elapsed_draw_time = 1'000'000'000.0f / data.refresh_fps;
+				while (!wake->ended()) {
+					auto currentTime = ::std::chrono::steady_clock::now();
+					data.elapsed_draw_time += static_cast<float>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(currentTime - previousTime).count());
+					previousTime = currentTime;
+
+					bool redraw = true;
+					if (data.rr == io2d::refresh_style::as_needed) {
+						redraw = data.redraw_required;
+						data.redraw_required = false;
+					}
+
+					const auto desiredElapsed = 1'000'000'000.0f / data.refresh_fps;
+
+					if (data.rr == io2d::refresh_style::fixed) {
+						// desiredElapsed is the amount of time, in nanoseconds, that must have passed before we should redraw.
+						redraw = data.elapsed_draw_time >= desiredElapsed;
+					}
+					if (redraw) {
+						// Run user draw function:
+						const auto drawStart = ::std::chrono::steady_clock::now();
+						if (osd->draw_callback != nullptr) {
+							if (data.auto_clear) {
+								_Ds_clear<_Cairo_graphics_surfaces<GraphicsMath>>(data);
+							}
+							osd->draw_callback(sfc);
+						}
+						else {
+							throw system_error(make_error_code(errc::operation_not_supported));
+						}
+						osd->timing.add_draw(drawStart);
+						_Present_frame(osd, sfc);
+						if (data.rr == io2d::refresh_style::fixed) {
+							while (data.elapsed_draw_time >= desiredElapsed) {
+								data.elapsed_draw_time -= desiredElapsed;
+							}
+						}
+						else {
+							data.elapsed_draw_time = 0.0f;
+						}
+					}
+					else {
+						// Shows a frame that the render thread finished after the last one was presented.
+						_Present_async_frame_if_ready(osd, sfc);
+					}
+					// _Present_frame ends the show when a frame uses up the budget; this catches a time budget running out between frames.
+					if (osd->budget.spent()) {
+						break;
+					}
+
+					// Sleep until the next refresh_style::fixed frame is due or the loop is woken up. Only
+					// refresh_style::as_fast_as_possible (and a pending redraw_required) keep it from blocking.
+					_Async_notify_frame_finished(data, [wake]() { wake->signal(); });
+					bool wait = true;
+					optional<::std::chrono::steady_clock::time_point> deadline;
+					if (data.rr == io2d::refresh_style::as_fast_as_possible || (data.rr == io2d::refresh_style::as_needed && data.redraw_required)) {
+						wait = false;
+					}
+					else if (data.rr == io2d::refresh_style::fixed) {
+						const auto sinceLoopStart = static_cast<float>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now() - previousTime).count());
+						const auto remaining = static_cast<long long>(desiredElapsed - data.elapsed_draw_time - sinceLoopStart);
+						if (remaining <= 0) {
+							wait = false;
+						}
+						else {
+							deadline = previousTime + ::std::chrono::nanoseconds(remaining);
+						}
+					}
+					if (wait) {
+						auto& budget = osd->budget;
+						if (budget.time.count() > 0) {
+							const auto budgetEnd = budget.start + budget.time;
+							deadline = deadline.has_value() ? ::std::min(*deadline, budgetEnd) : budgetEnd;
+						}
+						::std::unique_lock<::std::mutex> lock(wake->mutex);
+						const auto woken = [wake]() { return wake->pending; };
+						if (deadline.has_value()) {
+							wake->cv.wait_until(lock, *deadline, woken);
+						}
+						else {
+							wake->cv.wait(lock, woken);
+						}
+						wake->pending = false;
+					}
+				}
+				data.elapsed_draw_time = 0.0F;
+				return 0;
+			}
+
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::end_show(output_surface_data_type& osd) {
+				if (osd->data.wake != nullptr) {
+					osd->data.wake->end_show();
+				}
+			}
+
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::display_dimensions(output_surface_data_type& osd, const basic_display_point<GraphicsMath>& val) {
+				_Ds_display_dimensions<_Cairo_graphics_surfaces<GraphicsMath>>(osd->data, val);
+			}
+
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::refresh_style(output_surface_data_type& data, io2d::refresh_style val) {
+				data->data.rr = val;
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::desired_frame_rate(output_surface_data_type& data, float val) {
+				const float oneFramePerHour = 1.0f / (60.0f * 60.0f); // If you need a lower framerate than this, use as_needed and control the refresh by writing a timer that will trigger a refresh at your desired interval.
+				const float maxFPS = 120.0f; // It's unlikely to find a display output that operates higher than this.
+				data->data.refresh_fps = ::std::min(::std::max(val, oneFramePerHour), maxFPS);
+			}
+			template<class GraphicsMath>
+			inline io2d::refresh_style _Cairo_graphics_surfaces<GraphicsMath>::surfaces::refresh_style(const output_surface_data_type& data) noexcept {
+				return data->data.rr;
+			}
+			template<class GraphicsMath>
+			inline float _Cairo_graphics_surfaces<GraphicsMath>::surfaces::desired_frame_rate(const output_surface_data_type& data) noexcept {
+				return data->data.refresh_fps;
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::damage_tracking(output_surface_data_type& data, bool val) {
+				data->data.damage_tracking = val;
+				data->data.damage = _Damage_region{};
+				data->data.display_invalid = true;
+			}
+			template<class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::surfaces::damage_tracking(const output_surface_data_type& data) noexcept {
+				return data->data.damage_tracking;
+			}
+
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::flush(output_surface_data_type& data) {
+				_Async_finish_recorded(data->data);
+				cairo_surface_flush(data->data.back_buffer.surface.get());
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::flush(output_surface_data_type& data, error_code& ec) noexcept {
+				_Async_finish_recorded(data->data);
+				cairo_surface_flush(data->data.back_buffer.surface.get());
+				ec.clear();
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data) {
+				_Async_wait_idle(data->data);
+				cairo_surface_mark_dirty(data->data.back_buffer.surface.get());
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>());
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, error_code& ec) noexcept {
+				_Async_wait_idle(data->data);
+				cairo_surface_mark_dirty(data->data.back_buffer.surface.get());
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>());
+				ec.clear();
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, const basic_bounding_box<GraphicsMath>& extents) {
+				_Async_wait_idle(data->data);
+				cairo_surface_mark_dirty_rectangle(data->data.back_buffer.surface.get(), _Float_to_int(extents.x()), _Float_to_int(extents.y()), _Float_to_int(extents.width()), _Float_to_int(extents.height()));
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>(extents));
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, const basic_bounding_box<GraphicsMath>& extents, error_code& ec) noexcept {
+				_Async_wait_idle(data->data);
+				cairo_surface_mark_dirty_rectangle(data->data.back_buffer.surface.get(), _Float_to_int(extents.x()), _Float_to_int(extents.y()), _Float_to_int(extents.width()), _Float_to_int(extents.height()));
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>(extents));
+				ec.clear();
+			}
+
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::clear(output_surface_data_type& data) {
+				_Ds_clear<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+			template <class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::paint(output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_paint<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, b, bp, rp, cl);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke(output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_stroke<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, b, ip, bp, sp, d, rp, cl);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill(output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_fill<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, b, ip, bp, rp, cl);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mask(output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush<_Graphics_surfaces_type>& mb, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_mask_props<_Graphics_surfaces_type>& mp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_mask<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, b, mb, bp, mp, rp, cl);
+			}
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill_instances(output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_fill_instances<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, ip, first, last, bp, rp, cl);
+			}
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke_instances(output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_stroke_instances<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, ip, first, last, bp, sp, d, rp, cl);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::draw_callback(output_surface_data_type& data, function<void(basic_output_surface<_Graphics_surfaces_type>&)> fn) {
+				data->draw_callback = fn;
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::size_change_callback(output_surface_data_type& data, function<void(basic_output_surface<_Graphics_surfaces_type>&)> fn) {
+				data->size_change_callback = fn;
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::user_scaling_callback(output_surface_data_type& data, function<basic_bounding_box<GraphicsMath>(const basic_output_surface<_Graphics_surfaces_type>&, bool&)> fn) {
+				data->user_scaling_callback = fn;
+				data->data.display_invalid = true;
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::dimensions(output_surface_data_type& data, const basic_display_point<GraphicsMath>& val) {
+				_Ds_dimensions<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, val);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::scaling(output_surface_data_type& data, io2d::scaling val) {
+				_Ds_scaling<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, val);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::letterbox_brush(output_surface_data_type& data, const optional<basic_brush<_Graphics_surfaces_type>>& val, const optional<basic_brush_props<_Graphics_surfaces_type>>& bp) noexcept {
+				_Ds_letterbox_brush<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, val, bp);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::letterbox_brush_props(output_surface_data_type& data, const basic_brush_props<_Graphics_surfaces_type>& val) {
+				_Ds_letterbox_brush_props<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, val);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::auto_clear(output_surface_data_type& data, bool val) {
+				_Ds_auto_clear<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, val);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::redraw_required(output_surface_data_type& data, bool val) {
+				_Ds_redraw_required<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, val);
+			}
+			template<class GraphicsMath>
+			inline io2d::format _Cairo_graphics_surfaces<GraphicsMath>::surfaces::format(const output_surface_data_type& data) noexcept {
+				return _Ds_format<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+			template<class GraphicsMath>
+			inline basic_display_point<GraphicsMath> _Cairo_graphics_surfaces<GraphicsMath>::surfaces::dimensions(const output_surface_data_type& data) noexcept {
+				return _Ds_dimensions<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+			template<class GraphicsMath>
+			inline basic_display_point<GraphicsMath> _Cairo_graphics_surfaces<GraphicsMath>::surfaces::display_dimensions(const output_surface_data_type& data) noexcept {
+				return _Ds_display_dimensions<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+			template<class GraphicsMath>
+			inline io2d::scaling _Cairo_graphics_surfaces<GraphicsMath>::surfaces::scaling(output_surface_data_type& data) noexcept {
+				return _Ds_scaling<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+			template<class GraphicsMath>
+			inline optional<basic_brush<_Cairo_graphics_surfaces<GraphicsMath>>> _Cairo_graphics_surfaces<GraphicsMath>::surfaces::letterbox_brush(const output_surface_data_type& data) noexcept {
+				return _Ds_letterbox_brush<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+			template<class GraphicsMath>
+			inline basic_brush_props<_Cairo_graphics_surfaces<GraphicsMath>> _Cairo_graphics_surfaces<GraphicsMath>::surfaces::letterbox_brush_props(const output_surface_data_type& data) noexcept {
+				return _Ds_letterbox_brush_props<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+			template<class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::surfaces::auto_clear(const output_surface_data_type& data) noexcept {
+				return _Ds_auto_clear<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+			template<class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::surfaces::redraw_required(const output_surface_data_type& data) noexcept {
+				return _Ds_redraw_required<_Cairo_graphics_surfaces<GraphicsMath>>(data->data);
+			}
+		}
+	}
+}
@@ -0,0 +1,201 @@
+#pragma once
+
+namespace std::experimental::io2d {
+    inline namespace v1 {
+        namespace _Cairo {
+            
+            template <class GraphicsSurfaces>
+            inline void _Ds_clear(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::clear(data.async->recording);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    // Clearing uses whatever clip the previous draw left behind, so its extents aren't known here.
+                    data.damage.full = true;
+                }
+                GraphicsSurfaces::surfaces::clear(data.back_buffer);
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_paint(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_brush_props<GraphicsSurfaces>& bp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::paint(data.async->recording, b, bp, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_damage(data.damage, _Clip_device_extents(_Recording_extents_context(), rp, cl));
+                }
+                GraphicsSurfaces::surfaces::paint(data.back_buffer, b, bp, rp, cl);
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_stroke(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const basic_brush_props<GraphicsSurfaces>& bp, const basic_stroke_props<GraphicsSurfaces>& sp, const basic_dashes<GraphicsSurfaces>& d, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::stroke(data.async->recording, b, ip, bp, sp, d, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_damage(data.damage, _Stroke_device_extents(ip, sp, d, rp, cl));
+                }
+                GraphicsSurfaces::surfaces::stroke(data.back_buffer, b, ip, bp, sp, d, rp, cl);
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_fill(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const basic_brush_props<GraphicsSurfaces>& bp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::fill(data.async->recording, b, ip, bp, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_damage(data.damage, _Fill_device_extents(ip, bp, rp, cl));
+                }
+                GraphicsSurfaces::surfaces::fill(data.back_buffer, b, ip, bp, rp, cl);
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_mask(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const basic_brush_props<GraphicsSurfaces>& bp, const basic_mask_props<GraphicsSurfaces>& mp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::mask(data.async->recording, b, mb, bp, mp, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_damage(data.damage, _Clip_device_extents(_Recording_extents_context(), rp, cl));
+                }
+                GraphicsSurfaces::surfaces::mask(data.back_buffer, b, mb, bp, mp, rp, cl);
+            }
+            template <class GraphicsSurfaces, class InputIterator>
+            inline void _Ds_fill_instances(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const basic_brush_props<GraphicsSurfaces>& bp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::fill_instances(data.async->recording, ip, first, last, bp, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_instances_damage(data.damage, first, last, rp, [&](const basic_render_props<GraphicsSurfaces>& irp) { return _Fill_device_extents(ip, bp, irp, cl); });
+                }
+                GraphicsSurfaces::surfaces::fill_instances(data.back_buffer, ip, first, last, bp, rp, cl);
+            }
+            template <class GraphicsSurfaces, class InputIterator>
+            inline void _Ds_stroke_instances(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const basic_brush_props<GraphicsSurfaces>& bp, const basic_stroke_props<GraphicsSurfaces>& sp, const basic_dashes<GraphicsSurfaces>& d, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::stroke_instances(data.async->recording, ip, first, last, bp, sp, d, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_instances_damage(data.damage, first, last, rp, [&](const basic_render_props<GraphicsSurfaces>& irp) { return _Stroke_device_extents(ip, sp, d, irp, cl); });
+                }
+                GraphicsSurfaces::surfaces::stroke_instances(data.back_buffer, ip, first, last, bp, sp, d, rp, cl);
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_dimensions(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_display_point<typename GraphicsSurfaces::graphics_math_type>& val) {
+                _Async_wait_idle(data);
+                if (val != data.back_buffer.dimensions) {
+                    // Recreate the render target that is drawn to the displayed surface
+                    data.back_buffer = ::std::move(GraphicsSurfaces::surfaces::create_image_surface(data.back_buffer.format, val.x(), val.y()));
+                    data.display_invalid = true;
+                }
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_display_dimensions(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_display_point<typename GraphicsSurfaces::graphics_math_type>& val) {
+                data.display_dimensions = val;
+                data.display_invalid = true;
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_scaling(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, io2d::scaling val) {
+                data.scl = val;
+                data.display_invalid = true;
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_letterbox_brush(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const optional<basic_brush<GraphicsSurfaces>>& val, const optional<basic_brush_props<GraphicsSurfaces>>& bp) noexcept {
+                data.letterbox_brush_is_default = !val.has_value();
+                data._Letterbox_brush = (val.has_value() ? val.value() : data._Default_letterbox_brush);
+                data._Letterbox_brush_props = (bp.has_value() ? bp.value() : basic_brush_props<GraphicsSurfaces>());
+                data.display_invalid = true;
+                
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_letterbox_brush_props(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush_props<GraphicsSurfaces>& val) {
+                data._Letterbox_brush_props = val;
+                data.display_invalid = true;
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_auto_clear(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, bool val) {
+                data.auto_clear = val;
+            }
+            template <class GraphicsSurfaces>
+            inline void _Ds_redraw_required(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, bool val) {
+                data.redraw_required = val;
+                if (val && data.wake != nullptr) {
+                    data.wake->signal();
+                }
+            }
+            template <class GraphicsSurfaces>
+            inline io2d::format _Ds_format(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
+                return data.back_buffer.format;
+            }
+            template <class GraphicsSurfaces>
+            inline basic_display_point<typename GraphicsSurfaces::graphics_math_type> _Ds_dimensions(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
+                return data.back_buffer.dimensions;
+            }
+            template <class GraphicsSurfaces>
+            inline basic_display_point<typename GraphicsSurfaces::graphics_math_type> _Ds_max_dimensions() noexcept {
+                return GraphicsSurfaces::surfaces::max_dimensions();
+            }
+            template <class GraphicsSurfaces>
+            inline basic_display_point<typename GraphicsSurfaces::graphics_math_type> _Ds_display_dimensions(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
+                return data.display_dimensions;
+            }
+            template <class GraphicsSurfaces>
+            inline basic_display_point<typename GraphicsSurfaces::graphics_math_type> _Ds_max_display_dimensions() noexcept {
+                return GraphicsSurfaces::max_display_dimensions();
+            }
+            template <class GraphicsSurfaces>
+            inline io2d::scaling _Ds_scaling(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
+                return data.scl;
+            }
+            template <class GraphicsSurfaces>
+            inline optional<basic_brush<GraphicsSurfaces>> _Ds_letterbox_brush(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
+                return (data.letterbox_brush_is_default ? optional<basic_brush<GraphicsSurfaces>>() : optional<basic_brush<GraphicsSurfaces>>(data._Letterbox_brush));
+            }
+            template <class GraphicsSurfaces>
+            inline basic_brush_props<GraphicsSurfaces> _Ds_letterbox_brush_props(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
+                return data._Letterbox_brush_props;
+            }
+            template <class GraphicsSurfaces>
+            inline bool _Ds_auto_clear(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
+                return data.auto_clear;
+            }
+            template <class GraphicsSurfaces>
+            inline bool _Ds_redraw_required(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
+                return data.redraw_required;
+            }
+            
+            template <class GraphicsMath>
+            inline basic_display_point<GraphicsMath> _Cairo_graphics_surfaces<GraphicsMath>::surfaces::max_display_dimensions() noexcept {
+                return basic_display_point<GraphicsMath>(16384, 16384); // This takes up 1 GB of RAM, you probably don't want to do this. 2048x2048 is the max size for hardware that meets 9_1 specs (i.e. quite low powered or really old). Probably much more reasonable.
+            }
+            
+            template <class GraphicsMath>
+            template <class OutputDataType, class OutputSurfaceType>
+            inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Render_to_native_surface(OutputDataType& osdp, OutputSurfaceType&) {
+                // There is no display, so presenting only finishes the frame; the present callback gets the back buffer itself.
+                auto& data = osdp->data;
+                cairo_surface_flush(data.back_buffer.surface.get());
+                data.damage = _Damage_region{};
+                data.display_invalid = false;
+            }
+            
+        }
+    }
+}
+
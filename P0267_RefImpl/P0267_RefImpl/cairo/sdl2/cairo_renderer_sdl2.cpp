@@ -16,25 +16,59 @@ namespace std::experimental::io2d {
 			template <>
 			void _Create_display_surface_and_context<std::experimental::io2d::v1::_Graphics_math_float_impl>(_Cairo_graphics_surfaces<std::experimental::io2d::v1::_Graphics_math_float_impl>::surfaces::_Display_surface_data_type& data)
 			{
-                data.display_surface = ::std::move(::std::unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)>(cairo_image_surface_create(CAIRO_FORMAT_ARGB32, data.display_dimensions.x(), data.display_dimensions.y()), &cairo_surface_destroy));
-                auto sfc = data.display_surface.get();
-                _Throw_if_failed_cairo_status_t(cairo_surface_status(sfc));
-                data.display_context = ::std::move(::std::unique_ptr<cairo_t, decltype(&cairo_destroy)>(cairo_create(sfc), &cairo_destroy));
-                _Throw_if_failed_cairo_status_t(cairo_status(data.display_context.get()));
-
-                if (data.texture) {
-                    SDL_DestroyTexture(data.texture);
-                    data.texture = nullptr;
-                }
-                if (data.renderer) {
-                    int w = data.back_buffer.dimensions.x();
-                    int h = data.back_buffer.dimensions.y();
-                    data.texture = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, w, h);
+				// The display surface and context are created over the locked texture memory in _Render_to_native_surface.
+				if (data.texture) {
+					SDL_DestroyTexture(data.texture);
+					data.texture = nullptr;
+				}
+				if (data.renderer) {
+					data.texture = SDL_CreateTexture(data.renderer, SDL_PIXELFORMAT_ARGB8888, SDL_TEXTUREACCESS_STREAMING, data.display_dimensions.x(), data.display_dimensions.y());
 					if (!data.texture) {
 						throw ::std::system_error(::std::make_error_code(::std::errc::io_error), SDL_GetError());
 					}
-                }
-            }
+				}
+				data.display_invalid = true;
+			}
+
+			// Locks a rectangle of the display texture and makes cairo draw straight into it through the display surface and
+			// context. Locked texture memory is write-only, so every pixel of the rectangle has to be drawn.
+			struct _Sdl2_texture_lock {
+				_Cairo_graphics_surfaces<_Graphics_math_float_impl>::surfaces::_Display_surface_data_type& data;
+
+				_Sdl2_texture_lock(_Cairo_graphics_surfaces<_Graphics_math_float_impl>::surfaces::_Display_surface_data_type& d, const SDL_Rect& rect)
+					: data(d) {
+					void* pixels = nullptr;
+					int pitch = 0;
+					if (SDL_LockTexture(data.texture, &rect, &pixels, &pitch) != 0) {
+						throw ::std::system_error(::std::make_error_code(::std::errc::io_error), SDL_GetError());
+					}
+					try {
+						data.display_surface.reset(cairo_image_surface_create_for_data(static_cast<unsigned char*>(pixels), CAIRO_FORMAT_ARGB32, rect.w, rect.h, pitch));
+						_Throw_if_failed_cairo_status_t(cairo_surface_status(data.display_surface.get()));
+						// Display coordinates stay the same whichever rectangle is locked.
+						cairo_surface_set_device_offset(data.display_surface.get(), -rect.x, -rect.y);
+						data.display_context.reset(cairo_create(data.display_surface.get()));
+						_Throw_if_failed_cairo_status_t(cairo_status(data.display_context.get()));
+					}
+					catch (...) {
+						release();
+						throw;
+					}
+				}
+				_Sdl2_texture_lock(const _Sdl2_texture_lock&) = delete;
+				_Sdl2_texture_lock& operator=(const _Sdl2_texture_lock&) = delete;
+				~_Sdl2_texture_lock() {
+					release();
+				}
+				void release() noexcept {
+					data.display_context.reset();
+					if (data.display_surface != nullptr) {
+						cairo_surface_finish(data.display_surface.get());
+						data.display_surface.reset();
+					}
+					SDL_UnlockTexture(data.texture);
+				}
+			};
 
 			template <> template <>
 			void _Cairo_graphics_surfaces <_Graphics_math_float_impl>::surfaces::_Render_to_native_surface <
@@ -51,159 +85,82 @@ namespace std::experimental::io2d {
 				auto& data = osd.data;
 				double displayWidth = static_cast<double>(data.display_dimensions.x());
 				double displayHeight = static_cast<double>(data.display_dimensions.y());
-				double backBufferWidth = static_cast<double>(data.back_buffer.dimensions.x());
-				double backBufferHeight = static_cast<double>(data.back_buffer.dimensions.y());
 				auto backBufferSfc = data.back_buffer.surface.get();
-				auto displaySfc = data.display_surface.get();
-				auto displayContext = data.display_context.get();
 				cairo_surface_flush(backBufferSfc);
-				cairo_set_operator(displayContext, CAIRO_OPERATOR_SOURCE);
-				if (osd.user_scaling_callback != nullptr) {
-					bool letterbox = false;
-					auto userRect = osd.user_scaling_callback(sfc, letterbox);
-					if (letterbox) {
-						if (data._Letterbox_brush == nullopt) {
-							cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
-							cairo_paint(displayContext);
-						}
-						else {
-							auto pttn = data._Letterbox_brush.value().data().brush.get();
-							if (data._Letterbox_brush_props == nullopt) {
-								cairo_pattern_set_extend(pttn, CAIRO_EXTEND_NONE);
-								cairo_pattern_set_filter(pttn, CAIRO_FILTER_GOOD);
-								cairo_matrix_t cPttnMatrix;
-								cairo_matrix_init_identity(&cPttnMatrix);
-								cairo_pattern_set_matrix(pttn, &cPttnMatrix);
-								cairo_set_source(displayContext, pttn);
-								cairo_paint(displayContext);
-							}
-							else {
-								const basic_brush_props<_Cairo_graphics_surfaces<std::experimental::io2d::v1::_Graphics_math_float_impl>>& props = data._Letterbox_brush_props.value();
-								cairo_pattern_set_extend(pttn, _Extend_to_cairo_extend_t(props.wrap_mode()));
-								cairo_pattern_set_filter(pttn, _Filter_to_cairo_filter_t(props.filter()));
-								cairo_matrix_t cPttnMatrix;
-								const auto& m = props.brush_matrix();
-								cairo_matrix_init(&cPttnMatrix, m.m00(), m.m01(), m.m10(), m.m11(), m.m20(), m.m21());
-								cairo_pattern_set_matrix(pttn, &cPttnMatrix);
-								cairo_set_source(displayContext, pttn);
-								cairo_paint(displayContext);
-							}
-						}
-					}
-					cairo_matrix_t ctm;
-					cairo_matrix_init_scale(&ctm, 1.0 / displayWidth / static_cast<double>(userRect.width()), 1.0 / displayHeight / static_cast<double>(userRect.height()));
-					cairo_matrix_translate(&ctm, -static_cast<double>(userRect.x()), -static_cast<double>(userRect.y()));
-					unique_ptr<cairo_pattern_t, decltype(&cairo_pattern_destroy)> pat(cairo_pattern_create_for_surface(backBufferSfc), &cairo_pattern_destroy);
-					auto patPtr = pat.get();
-					cairo_pattern_set_matrix(patPtr, &ctm);
-					cairo_pattern_set_extend(patPtr, CAIRO_EXTEND_NONE);
-					cairo_pattern_set_filter(patPtr, cairoFilter);
-					cairo_set_source(displayContext, patPtr);
-					cairo_paint(displayContext);
+				const bool displayInvalid = data.display_invalid;
+				_Update_present_cache(data);
+				// With damage tracking only the part of the display that shows changed back buffer pixels is repainted.
+				cairo_rectangle_int_t damageRect;
+				const bool partial = osd.user_scaling_callback == nullptr && _Display_damage_rect(data, damageRect);
+				data.damage = _Damage_region{};
+				data.display_invalid = false;
+				if (partial && damageRect.width == 0) {
+					return;
 				}
-				else {
-					
-					// Calculate the destRect values.
-					switch (data.scl) {
-						case std::experimental::io2d::scaling::letterbox:
-						{
-							_Render_for_scaling_uniform_or_letterbox(osd);
-						} break;
-						case std::experimental::io2d::scaling::uniform:
-						{
-							_Render_for_scaling_uniform_or_letterbox(osd);
-						} break;
-						
-						case std::experimental::io2d::scaling::fill_uniform:
-						{
-							// Maintain aspect ratio and center, but overflow if needed rather than letterboxing.
-							if (backBufferWidth == displayWidth && backBufferHeight == displayHeight) {
-								cairo_set_source_surface(displayContext, backBufferSfc, 0.0, 0.0);
+				// The texture keeps whatever isn't locked, so only the part of the display that is redrawn gets locked: the damage,
+				// or the back buffer's rectangle while the letterbox bars are still valid.
+				SDL_Rect lockRect{ 0, 0, data.display_dimensions.x(), data.display_dimensions.y() };
+				const auto& cache = data.present_cache;
+				if (partial) {
+					lockRect = SDL_Rect{ damageRect.x, damageRect.y, damageRect.width, damageRect.height };
+				}
+				else if (osd.user_scaling_callback == nullptr && !displayInvalid && !cache.paints_display) {
+					lockRect = SDL_Rect{ static_cast<int>(cache.content.x), static_cast<int>(cache.content.y), static_cast<int>(cache.content.width), static_cast<int>(cache.content.height) };
+				}
+				if (lockRect.w <= 0 || lockRect.h <= 0) {
+					return;
+				}
+				{
+					// Unlocked at the end of this scope, before the texture is copied to the renderer.
+					_Sdl2_texture_lock textureLock(data, lockRect);
+					auto displayContext = data.display_context.get();
+					cairo_set_operator(displayContext, CAIRO_OPERATOR_SOURCE);
+					if (osd.user_scaling_callback != nullptr) {
+						bool letterbox = false;
+						auto userRect = osd.user_scaling_callback(sfc, letterbox);
+						if (letterbox) {
+							if (data._Letterbox_brush == nullopt) {
+								cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
 								cairo_paint(displayContext);
 							}
 							else {
-								auto widthRatio = displayWidth / backBufferWidth;
-								auto heightRatio = displayHeight / backBufferHeight;
-								if (widthRatio < heightRatio) {
-									cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
-									cairo_paint(displayContext);
-									cairo_matrix_t ctm;
-									cairo_matrix_init_scale(&ctm, 1.0 / heightRatio, 1.0 / heightRatio);
-									cairo_matrix_translate(&ctm, trunc(abs((displayWidth - (backBufferWidth * heightRatio)) / 2.0)), 0.0);
-									unique_ptr<cairo_pattern_t, decltype(&cairo_pattern_destroy)> pat(cairo_pattern_create_for_surface(backBufferSfc), &cairo_pattern_destroy);
-									auto patPtr = pat.get();
-									cairo_pattern_set_matrix(patPtr, &ctm);
-									cairo_pattern_set_extend(patPtr, CAIRO_EXTEND_NONE);
-									cairo_pattern_set_filter(patPtr, cairoFilter);
-									cairo_set_source(displayContext, patPtr);
+								auto pttn = data._Letterbox_brush.value().data().brush.get();
+								if (data._Letterbox_brush_props == nullopt) {
+									cairo_pattern_set_extend(pttn, CAIRO_EXTEND_NONE);
+									cairo_pattern_set_filter(pttn, CAIRO_FILTER_GOOD);
+									cairo_matrix_t cPttnMatrix;
+									cairo_matrix_init_identity(&cPttnMatrix);
+									cairo_pattern_set_matrix(pttn, &cPttnMatrix);
+									cairo_set_source(displayContext, pttn);
 									cairo_paint(displayContext);
 								}
 								else {
-									cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
-									cairo_paint(displayContext);
-									cairo_matrix_t ctm;
-									cairo_matrix_init_scale(&ctm, 1.0 / widthRatio, 1.0 / widthRatio);
-									cairo_matrix_translate(&ctm, 0.0, trunc(abs((displayHeight - (backBufferHeight * widthRatio)) / 2.0)));
-									unique_ptr<cairo_pattern_t, decltype(&cairo_pattern_destroy)> pat(cairo_pattern_create_for_surface(backBufferSfc), &cairo_pattern_destroy);
-									auto patPtr = pat.get();
-									cairo_pattern_set_matrix(patPtr, &ctm);
-									cairo_pattern_set_extend(patPtr, CAIRO_EXTEND_NONE);
-									cairo_pattern_set_filter(patPtr, cairoFilter);
-									cairo_set_source(displayContext, patPtr);
+									const basic_brush_props<_Cairo_graphics_surfaces<std::experimental::io2d::v1::_Graphics_math_float_impl>>& props = data._Letterbox_brush_props.value();
+									cairo_pattern_set_extend(pttn, _Extend_to_cairo_extend_t(props.wrap_mode()));
+									cairo_pattern_set_filter(pttn, _Filter_to_cairo_filter_t(props.filter()));
+									cairo_matrix_t cPttnMatrix;
+									const auto& m = props.brush_matrix();
+									cairo_matrix_init(&cPttnMatrix, m.m00(), m.m01(), m.m10(), m.m11(), m.m20(), m.m21());
+									cairo_pattern_set_matrix(pttn, &cPttnMatrix);
+									cairo_set_source(displayContext, pttn);
 									cairo_paint(displayContext);
 								}
 							}
-						} break;
-						case std::experimental::io2d::scaling::fill_exact:
-						{
-							// Maintain aspect ratio and center, but overflow if needed rather than letterboxing.
-							if (backBufferWidth == displayWidth && backBufferHeight == displayHeight) {
-								cairo_set_source_surface(displayContext, backBufferSfc, 0.0, 0.0);
-								cairo_paint(displayContext);
-							}
-							else {
-								auto widthRatio = displayWidth / backBufferWidth;
-								auto heightRatio = displayHeight / backBufferHeight;
-								cairo_matrix_t ctm;
-								cairo_matrix_init_scale(&ctm, 1.0 / widthRatio, 1.0 / heightRatio);
-								unique_ptr<cairo_pattern_t, decltype(&cairo_pattern_destroy)> pat(cairo_pattern_create_for_surface(backBufferSfc), &cairo_pattern_destroy);
-								auto patPtr = pat.get();
-								cairo_pattern_set_matrix(patPtr, &ctm);
-								cairo_pattern_set_extend(patPtr, CAIRO_EXTEND_NONE);
-								cairo_pattern_set_filter(patPtr, cairoFilter);
-								cairo_set_source(displayContext, patPtr);
-								cairo_paint(displayContext);
-							}
-						} break;
-						case std::experimental::io2d::scaling::none:
-						{
-							cairo_set_source_surface(displayContext, backBufferSfc, 0.0, 0.0);
-							cairo_paint(displayContext);
-						} break;
-						default:
-						{
-							assert("Unexpected _Scaling value." && false);
-						} break;
+						}
+						cairo_matrix_t ctm;
+						cairo_matrix_init_scale(&ctm, 1.0 / displayWidth / static_cast<double>(userRect.width()), 1.0 / displayHeight / static_cast<double>(userRect.height()));
+						cairo_matrix_translate(&ctm, -static_cast<double>(userRect.x()), -static_cast<double>(userRect.y()));
+						_Present_user_scaled(data, ctm, cairoFilter);
+					}
+					else {
+						_Present_cached(data, displayInvalid);
 					}
 				}
-				
-				//     cairo_restore(_Native_context.get());
-				// This call to cairo_surface_flush is needed for Win32 surfaces to update.
-				cairo_surface_flush(displaySfc);
-				cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
 
 				SDL_SetRenderDrawColor(data.renderer, 0, 0, 0, 255);
 				if (SDL_RenderClear(data.renderer) != 0) {
 					throw ::std::system_error(::std::make_error_code(::std::errc::io_error), SDL_GetError());
 				}
-
-				// Copy Cairo canvas to SDL2 texture
-				unsigned char * src = cairo_image_surface_get_data(displaySfc);
-				// TODO(dludwig@pobox.com): compute the pitch, given  
-				const int pitch = (int)backBufferWidth * 4;    // '4' == 4 bytes per pixel
-				if (SDL_UpdateTexture(data.texture, nullptr, src, pitch) != 0) {
-					throw ::std::system_error(::std::make_error_code(::std::errc::io_error), SDL_GetError());
-				}
 				if (SDL_RenderCopy(data.renderer, data.texture, nullptr, nullptr) != 0) {
 					throw ::std::system_error(::std::make_error_code(::std::errc::io_error), SDL_GetError());
 				}
@@ -215,7 +172,7 @@ namespace std::experimental::io2d {
 			template <>
 			bool _Is_active<std::experimental::io2d::v1::_Graphics_math_float_impl>(_Cairo_graphics_surfaces<std::experimental::io2d::v1::_Graphics_math_float_impl>::surfaces::_Display_surface_data_type& data) noexcept
 			{
-				if (SDL_QuitRequested()) {
+				if (data.show_ended || SDL_QuitRequested()) {
 					return false;
 				}
 				if (data.window == nullptr || data.renderer == nullptr) {
@@ -235,16 +192,6 @@ namespace std::experimental::io2d {
 				//  2. an SDL renderer, which will be used to help draw Cairo-rendered content to the desired display(s)
 				//
 
-#if 0 //__LINUX__
-				// HACK: work around a bug in SDL2 + OpenGL + Vagrant + Ubuntu 18.04 + X11 via macOS'/X11,
-				// whereby apps will crash/terminate upon trying to initialize SDL.  This crash occurs
-				// when trying to detect OpenGL-related resources.
-				SDL_SetHint(SDL_HINT_FRAMEBUFFER_ACCELERATION, "0");
-				const Uint32 renderer_flags = SDL_RENDERER_SOFTWARE;
-#else
-				const Uint32 renderer_flags = 0;
-#endif
-
 				if (SDL_Init(SDL_INIT_VIDEO) != 0) {
 					throw ::std::system_error(::std::make_error_code(::std::errc::io_error), SDL_GetError());
 				}
@@ -262,11 +209,15 @@ namespace std::experimental::io2d {
 				}
 
 				// TODO(dludwig@pobox.com): Fix errors logged by Emscripten in SDL_CreateRenderer (regarding sigaction + emscripten_set_main_loop_timing)
+				// Prefer a hardware accelerated renderer. The software renderer is the fallback, e.g. with SDL_VIDEODRIVER=dummy.
 				data.renderer = SDL_CreateRenderer(
 					data.window,
 					-1,
-					renderer_flags
+					SDL_RENDERER_ACCELERATED
 				);
+				if (!data.renderer) {
+					data.renderer = SDL_CreateRenderer(data.window, -1, SDL_RENDERER_SOFTWARE);
+				}
 				if (!data.renderer) {
 					throw ::std::system_error(::std::make_error_code(::std::errc::io_error), SDL_GetError());
 				}
@@ -278,11 +229,27 @@ namespace std::experimental::io2d {
 
 				data.back_buffer = ::std::move(create_image_surface(data.back_buffer.format, data.back_buffer.dimensions.x(), data.back_buffer.dimensions.y()));
 
+				osd->budget.begin();
 				data.elapsed_draw_time = 0.0f;
 				data.previous_time = decltype(data.previous_time)();	// reset to epoch
 
 				data.redraw_required = true;
 
+				if (data.wake_event == 0) {
+					const auto eventType = SDL_RegisterEvents(1);
+					if (eventType == static_cast<Uint32>(-1)) {
+						throw ::std::system_error(::std::make_error_code(::std::errc::io_error), "SDL_RegisterEvents failed.");
+					}
+					data.wake_event = eventType;
+				}
+				const auto wakeEvent = data.wake_event;
+
+				auto handleEvent = [&data](const SDL_Event& ev) {
+					if (ev.type == SDL_QUIT) {
+						data.show_ended = true;
+					}
+				};
+
 				while (_Is_active<std::experimental::io2d::v1::_Graphics_math_float_impl>(data)) {
 					auto currentTime = ::std::chrono::steady_clock::now();
 					auto elapsedTimeIncrement = static_cast<float>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(currentTime - data.previous_time).count());
@@ -290,7 +257,14 @@ namespace std::experimental::io2d {
 					data.previous_time = currentTime;
 
 					SDL_Event ev;
-					while (SDL_PollEvent(&ev)) {}
+					const auto eventsStart = ::std::chrono::steady_clock::now();
+					while (SDL_PollEvent(&ev)) {
+						handleEvent(ev);
+					}
+					osd->timing.add_events(eventsStart);
+					if (!_Is_active<std::experimental::io2d::v1::_Graphics_math_float_impl>(data)) {
+						break;
+					}
 
 					bool redraw = true;
 					if (data.rr == io2d::refresh_style::as_needed) {
@@ -303,10 +277,12 @@ namespace std::experimental::io2d {
 						redraw = data.elapsed_draw_time >= desiredElapsed;
 					}
 					if (redraw) {
+						const auto drawStart = ::std::chrono::steady_clock::now();
 						if (osd->draw_callback) {
 							osd->draw_callback(sfc);
 						}
-						_Render_to_native_surface(osd, sfc);
+						osd->timing.add_draw(drawStart);
+						_Present_frame(osd, sfc);
 						if (data.rr == experimental::io2d::refresh_style::fixed) {
 							while (data.elapsed_draw_time >= desiredElapsed) {
 								data.elapsed_draw_time -= desiredElapsed;
@@ -316,11 +292,51 @@ namespace std::experimental::io2d {
 							data.elapsed_draw_time = 0.0F;
 						}
 					}
+					else {
+						// Shows a frame that the render thread finished after the last one was presented.
+						_Present_async_frame_if_ready(osd, sfc);
+					}
 
-					// Try to delay by a negligible amount of time.  On some platforms, this can help with responsiveness.
-					SDL_Delay(0);
+					// Sleep until an event arrives or the next refresh_style::fixed frame is due. Only
+					// refresh_style::as_fast_as_possible (and a pending redraw_required) keep the loop from blocking.
+					_Async_notify_frame_finished(data, [wakeEvent]() { _Sdl2_push_wake_event(wakeEvent); });
+					if (data.show_ended || data.rr == io2d::refresh_style::as_fast_as_possible || (data.rr == io2d::refresh_style::as_needed && data.redraw_required)) {
+						continue;
+					}
+					if (data.rr == io2d::refresh_style::as_needed) {
+						if (SDL_WaitEvent(&ev)) {
+							handleEvent(ev);
+						}
+						continue;
+					}
+					const auto sinceLoopStart = static_cast<float>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now() - data.previous_time).count());
+					const auto deadline = data.previous_time + ::std::chrono::nanoseconds(static_cast<long long>(desiredElapsed - data.elapsed_draw_time));
+					const auto remaining = static_cast<long long>(desiredElapsed - data.elapsed_draw_time - sinceLoopStart);
+					// SDL_WaitEventTimeout only has millisecond resolution, so it sleeps for the whole milliseconds minus one and
+					// the rest is slept precisely.
+					if (remaining >= 2'000'000) {
+						if (SDL_WaitEventTimeout(&ev, static_cast<int>(remaining / 1'000'000) - 1)) {
+							handleEvent(ev);
+							continue;
+						}
+					}
+					::std::this_thread::sleep_until(deadline);
 				}
 				data.elapsed_draw_time = 0.0F;
+				data.show_ended = false;
+				if (data.texture) {
+					SDL_DestroyTexture(data.texture);
+					data.texture = nullptr;
+				}
+				if (data.renderer) {
+					SDL_DestroyRenderer(data.renderer);
+					data.renderer = nullptr;
+				}
+				if (data.window) {
+					SDL_DestroyWindow(data.window);
+					data.window = nullptr;
+				}
+				SDL_QuitSubSystem(SDL_INIT_VIDEO);
 				return 0;
 			}
 
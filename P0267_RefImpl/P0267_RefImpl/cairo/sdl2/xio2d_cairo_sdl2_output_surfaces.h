@@ -16,7 +16,13 @@ namespace std::experimental::io2d {
 				// bool hasOwnDC = true;
 				SDL_Window * window = nullptr;
 				SDL_Renderer * renderer = nullptr;
+				// Streaming texture with the display's dimensions. Cairo draws into its locked memory when a frame is presented;
+				// display_surface and display_context only exist while it is locked.
 				SDL_Texture * texture = nullptr;
+				// Type of the user event that wakes begin_show up, pushed by redraw_required(true) and by a finished async
+				// frame. 0 until begin_show registers it.
+				Uint32 wake_event = 0;
+				bool show_ended = false;
 
 				bool unmanaged = false;
 				bool letterbox_brush_is_default = true;
@@ -30,8 +36,16 @@ namespace std::experimental::io2d {
 				::std::unique_ptr<cairo_t, decltype(&cairo_destroy)> display_context{ nullptr, &cairo_destroy };
 
 				image_surface_data_type back_buffer;
+				// Set while async_render is on. Declared after back_buffer so that the render thread stops before the back buffer is destroyed.
+				::std::unique_ptr<_Async_renderer> async;
 
 				bool auto_clear = false;
+				int buffer_count = 1;
+				bool damage_tracking = false;
+				// Set when the whole display has to be presented, e.g. after an expose or a resize.
+				bool display_invalid = true;
+				_Damage_region damage;
+				_Present_cache present_cache;
 				io2d::scaling scl = io2d::scaling::letterbox;
 				io2d::refresh_style rr = io2d::refresh_style::as_fast_as_possible;
 				float refresh_fps = 30.0f;
@@ -46,6 +60,12 @@ namespace std::experimental::io2d {
 				::std::function<void(basic_output_surface<_Graphics_surfaces_type>&)> draw_callback;
 				::std::function<void(basic_output_surface<_Graphics_surfaces_type>&)> size_change_callback;
 				::std::function<basic_bounding_box<GraphicsMath>(const basic_output_surface<_Graphics_surfaces_type>&, bool&)> user_scaling_callback;
+				::std::function<void(const _Interchange_buffer&)> present_callback;
+				// What present_callback is handed. Kept between frames so that with damage_tracking only the damaged part is copied again.
+				_Interchange_buffer present_copy;
+				_Show_budget budget;
+				::std::function<void(const frame_timing&)> frame_timing_callback;
+				_Frame_timing_ring timing;
 			};
 
 			template<class GraphicsMath>
@@ -122,6 +142,7 @@ namespace std::experimental::io2d {
 			}
 			template <class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::destroy(output_surface_data_type& data) noexcept {
+				data->data.async.reset();
 				destroy(data->data.back_buffer);
 				delete data;
 			}
@@ -131,15 +152,11 @@ namespace std::experimental::io2d {
 
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::end_show(output_surface_data_type& data) {
-				printf("IMPLEMENT ME: %s\n", __PRETTY_FUNCTION__);
-				// if (data.renderer) {
-				// 	SDL_DestroyRenderer(data.renderer);
-				// 	data.renderer = nullptr;
-				// }
-				// if (data.window) {
-				// 	SDL_DestroyWindow(data.window);
-				// 	data.window = nullptr;
-				// }
+				// begin_show destroys the window when its loop sees this.
+				data->data.show_ended = true;
+				if (data->data.wake_event != 0) {
+					_Sdl2_push_wake_event(data->data.wake_event);
+				}
 			}
 
 			template<class GraphicsMath>
@@ -196,32 +213,52 @@ namespace std::experimental::io2d {
 			inline float _Cairo_graphics_surfaces<GraphicsMath>::surfaces::desired_frame_rate(const output_surface_data_type& data) noexcept {
 				return data->data.refresh_fps;
 			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::damage_tracking(output_surface_data_type& data, bool val) {
+				data->data.damage_tracking = val;
+				data->data.damage = _Damage_region{};
+				data->data.display_invalid = true;
+			}
+			template<class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::surfaces::damage_tracking(const output_surface_data_type& data) noexcept {
+				return data->data.damage_tracking;
+			}
 
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::flush(output_surface_data_type& data) {
+				_Async_finish_recorded(data->data);
 				cairo_surface_flush(data->data.back_buffer.surface.get());
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::flush(output_surface_data_type& data, error_code& ec) noexcept {
+				_Async_finish_recorded(data->data);
 				cairo_surface_flush(data->data.back_buffer.surface.get());
 				ec.clear();
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data) {
+				_Async_wait_idle(data->data);
 				cairo_surface_mark_dirty(data->data.back_buffer.surface.get());
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>());
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, error_code& ec) noexcept {
+				_Async_wait_idle(data->data);
 				cairo_surface_mark_dirty(data->data.back_buffer.surface.get());
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>());
 				ec.clear();
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, const basic_bounding_box<GraphicsMath>& extents) {
+				_Async_wait_idle(data->data);
 				cairo_surface_mark_dirty_rectangle(data->data.back_buffer.surface.get(), _Float_to_int(extents.x()), _Float_to_int(extents.y()), _Float_to_int(extents.width()), _Float_to_int(extents.height()));
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>(extents));
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, const basic_bounding_box<GraphicsMath>& extents, error_code& ec) noexcept {
+				_Async_wait_idle(data->data);
 				cairo_surface_mark_dirty_rectangle(data->data.back_buffer.surface.get(), _Float_to_int(extents.x()), _Float_to_int(extents.y()), _Float_to_int(extents.width()), _Float_to_int(extents.height()));
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>(extents));
 				ec.clear();
 			}
 
@@ -246,6 +283,16 @@ namespace std::experimental::io2d {
 				_Ds_mask<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, b, mb, bp, mp, rp, cl);
 			}
 			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill_instances(output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_fill_instances<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, ip, first, last, bp, rp, cl);
+			}
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke_instances(output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_stroke_instances<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, ip, first, last, bp, sp, d, rp, cl);
+			}
+			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::draw_callback(output_surface_data_type& data, function<void(basic_output_surface<_Graphics_surfaces_type>&)> fn) {
 				data->draw_callback = fn;
 			}
@@ -256,6 +303,7 @@ namespace std::experimental::io2d {
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::user_scaling_callback(output_surface_data_type& data, function<basic_bounding_box<GraphicsMath>(const basic_output_surface<_Graphics_surfaces_type>&, bool&)> fn) {
 				data->user_scaling_callback = fn;
+				data->data.display_invalid = true;
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::dimensions(output_surface_data_type& data, const basic_display_point<GraphicsMath>& val) {
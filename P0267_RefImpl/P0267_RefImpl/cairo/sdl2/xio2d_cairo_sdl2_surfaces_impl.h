@@ -9,51 +9,136 @@ namespace std::experimental::io2d {
             template <class GraphicsMath>
             void _Create_display_surface_and_context(typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Display_surface_data_type& data);
             
+            // Wakes up begin_show's event loop.
+            inline void _Sdl2_push_wake_event(Uint32 eventType) noexcept {
+                SDL_Event ev{};
+                ev.type = eventType;
+                SDL_PushEvent(&ev);
+            }
+            
             template <class GraphicsSurfaces>
             inline void _Ds_clear(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::clear(data.async->recording);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    // Clearing uses whatever clip the previous draw left behind, so its extents aren't known here.
+                    data.damage.full = true;
+                }
                 GraphicsSurfaces::surfaces::clear(data.back_buffer);
             }
             template <class GraphicsSurfaces>
             inline void _Ds_paint(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_brush_props<GraphicsSurfaces>& bp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::paint(data.async->recording, b, bp, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_damage(data.damage, _Clip_device_extents(_Recording_extents_context(), rp, cl));
+                }
                 GraphicsSurfaces::surfaces::paint(data.back_buffer, b, bp, rp, cl);
             }
             template <class GraphicsSurfaces>
             inline void _Ds_stroke(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const basic_brush_props<GraphicsSurfaces>& bp, const basic_stroke_props<GraphicsSurfaces>& sp, const basic_dashes<GraphicsSurfaces>& d, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::stroke(data.async->recording, b, ip, bp, sp, d, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_damage(data.damage, _Stroke_device_extents(ip, sp, d, rp, cl));
+                }
                 GraphicsSurfaces::surfaces::stroke(data.back_buffer, b, ip, bp, sp, d, rp, cl);
             }
             template <class GraphicsSurfaces>
             inline void _Ds_fill(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const basic_brush_props<GraphicsSurfaces>& bp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::fill(data.async->recording, b, ip, bp, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_damage(data.damage, _Fill_device_extents(ip, bp, rp, cl));
+                }
                 GraphicsSurfaces::surfaces::fill(data.back_buffer, b, ip, bp, rp, cl);
             }
             template <class GraphicsSurfaces>
             inline void _Ds_mask(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const basic_brush_props<GraphicsSurfaces>& bp, const basic_mask_props<GraphicsSurfaces>& mp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::mask(data.async->recording, b, mb, bp, mp, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_damage(data.damage, _Clip_device_extents(_Recording_extents_context(), rp, cl));
+                }
                 GraphicsSurfaces::surfaces::mask(data.back_buffer, b, mb, bp, mp, rp, cl);
             }
+            template <class GraphicsSurfaces, class InputIterator>
+            inline void _Ds_fill_instances(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const basic_brush_props<GraphicsSurfaces>& bp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::fill_instances(data.async->recording, ip, first, last, bp, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_instances_damage(data.damage, first, last, rp, [&](const basic_render_props<GraphicsSurfaces>& irp) { return _Fill_device_extents(ip, bp, irp, cl); });
+                }
+                GraphicsSurfaces::surfaces::fill_instances(data.back_buffer, ip, first, last, bp, rp, cl);
+            }
+            template <class GraphicsSurfaces, class InputIterator>
+            inline void _Ds_stroke_instances(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const basic_brush_props<GraphicsSurfaces>& bp, const basic_stroke_props<GraphicsSurfaces>& sp, const basic_dashes<GraphicsSurfaces>& d, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl) {
+                if (data.async != nullptr) {
+                    const auto firstDraw = data.async->recording.draws.size();
+                    GraphicsSurfaces::surfaces::stroke_instances(data.async->recording, ip, first, last, bp, sp, d, rp, cl);
+                    _Add_recorded_damage(data, firstDraw);
+                    return;
+                }
+                if (data.damage_tracking) {
+                    _Add_instances_damage(data.damage, first, last, rp, [&](const basic_render_props<GraphicsSurfaces>& irp) { return _Stroke_device_extents(ip, sp, d, irp, cl); });
+                }
+                GraphicsSurfaces::surfaces::stroke_instances(data.back_buffer, ip, first, last, bp, sp, d, rp, cl);
+            }
             template <class GraphicsSurfaces>
             inline void _Ds_dimensions(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_display_point<typename GraphicsSurfaces::graphics_math_type>& val) {
+                _Async_wait_idle(data);
                 if (val != data.back_buffer.dimensions) {
                     // Recreate the render target that is drawn to the displayed surface
                     data.back_buffer = ::std::move(GraphicsSurfaces::surfaces::create_image_surface(data.back_buffer.format, val.x(), val.y()));
+                    data.display_invalid = true;
                 }
             }
             template <class GraphicsSurfaces>
             inline void _Ds_display_dimensions(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_display_point<typename GraphicsSurfaces::graphics_math_type>& val) {
                 data.display_dimensions = val;
+                data.display_invalid = true;
             }
             template <class GraphicsSurfaces>
             inline void _Ds_scaling(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, io2d::scaling val) {
                 data.scl = val;
+                data.display_invalid = true;
             }
             template <class GraphicsSurfaces>
             inline void _Ds_letterbox_brush(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const optional<basic_brush<GraphicsSurfaces>>& val, const optional<basic_brush_props<GraphicsSurfaces>>& bp) noexcept {
                 data.letterbox_brush_is_default = !val.has_value();
                 data._Letterbox_brush = (val.has_value() ? val.value() : data._Default_letterbox_brush);
                 data._Letterbox_brush_props = (bp.has_value() ? bp.value() : basic_brush_props<GraphicsSurfaces>());
+                data.display_invalid = true;
                 
             }
             template <class GraphicsSurfaces>
             inline void _Ds_letterbox_brush_props(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush_props<GraphicsSurfaces>& val) {
                 data._Letterbox_brush_props = val;
+                data.display_invalid = true;
             }
             template <class GraphicsSurfaces>
             inline void _Ds_auto_clear(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, bool val) {
@@ -62,6 +147,9 @@ namespace std::experimental::io2d {
             template <class GraphicsSurfaces>
             inline void _Ds_redraw_required(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, bool val) {
                 data.redraw_required = val;
+                if (val && data.wake_event != 0) {
+                    _Sdl2_push_wake_event(data.wake_event);
+                }
             }
             template <class GraphicsSurfaces>
             inline io2d::format _Ds_format(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept {
@@ -109,131 +197,6 @@ namespace std::experimental::io2d {
                 return basic_display_point<GraphicsMath>(16384, 16384); // This takes up 1 GB of RAM, you probably don't want to do this. 2048x2048 is the max size for hardware that meets 9_1 specs (i.e. quite low powered or really old). Probably much more reasonable.
             }
             
-            template <class OutputDataType>
-            inline void _Render_for_scaling_uniform_or_letterbox(OutputDataType& osd) {
-                const cairo_filter_t cairoFilter = CAIRO_FILTER_GOOD;
-                
-                auto& data = osd.data;
-                double displayWidth = static_cast<double>(data.display_dimensions.x());
-                double displayHeight = static_cast<double>(data.display_dimensions.y());
-                double backBufferWidth = static_cast<double>(data.back_buffer.dimensions.x());
-                double backBufferHeight = static_cast<double>(data.back_buffer.dimensions.y());
-                auto backBufferSfc = data.back_buffer.surface.get();
-                auto displayContext = data.display_context.get();
-                
-                if (backBufferWidth == displayWidth && backBufferHeight == displayHeight) {
-                    cairo_set_source_surface(displayContext, backBufferSfc, 0.0, 0.0);
-                    cairo_paint(displayContext);
-                }
-                else {
-                    const auto whRatio = backBufferWidth / backBufferHeight;
-                    const auto displayWHRatio = displayWidth / displayHeight;
-                    cairo_matrix_t ctm;
-                    double rectX, rectY, rectWidth, rectHeight;
-                    if (whRatio < displayWHRatio) {
-                        // We don't want any existing path on the displayContext since we are doing fill operations.
-                        cairo_new_path(displayContext);
-                        rectWidth = trunc(displayHeight * whRatio);
-                        rectHeight = displayHeight;
-                        rectX = trunc(abs(rectWidth - displayWidth) / 2.0);
-                        rectY = 0.0;
-                        cairo_rectangle(displayContext, rectX, rectY, rectWidth, rectHeight);
-                        
-                        const auto heightRatio = backBufferHeight / displayHeight;
-                        cairo_matrix_init_scale(&ctm, heightRatio, heightRatio);
-                        cairo_matrix_translate(&ctm, -rectX, 0.0);
-                        unique_ptr<cairo_pattern_t, decltype(&cairo_pattern_destroy)> pat(cairo_pattern_create_for_surface(backBufferSfc), &cairo_pattern_destroy);
-                        auto patPtr = pat.get();
-                        cairo_pattern_set_matrix(patPtr, &ctm);
-                        cairo_pattern_set_extend(patPtr, CAIRO_EXTEND_NONE);
-                        cairo_pattern_set_filter(patPtr, cairoFilter);
-                        cairo_set_source(displayContext, patPtr);
-                        cairo_fill(displayContext); // Draw the back buffer. Note that this also clears the context path.
-                        
-                        if (data.scl == io2d::scaling::letterbox) { // There is only a scaling::letterbox branch since scaling::uniform doesn't touch contents that would be letterboxed if it was scaling::letterbox.
-                            const auto lboxWidth = trunc(((displayWidth)-rectWidth) / 2.0);
-                            cairo_rectangle(displayContext, 0.0, 0.0, lboxWidth, rectHeight);
-                            cairo_rectangle(displayContext, rectWidth + lboxWidth, 0.0, lboxWidth, rectHeight);
-                            if (data._Letterbox_brush == nullopt) {
-                                cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
-                            }
-                            else {
-                                auto pttn = data._Letterbox_brush.value().data().brush.get();
-                                if (data._Letterbox_brush_props == nullopt) {
-                                    cairo_pattern_set_extend(pttn, CAIRO_EXTEND_NONE);
-                                    cairo_pattern_set_filter(pttn, CAIRO_FILTER_GOOD);
-                                    cairo_matrix_t cPttnMatrix;
-                                    cairo_matrix_init_identity(&cPttnMatrix);
-                                    cairo_pattern_set_matrix(pttn, &cPttnMatrix);
-                                    cairo_set_source(displayContext, pttn);
-                                }
-                                else {
-                                    const auto& props = data._Letterbox_brush_props.value();
-                                    cairo_pattern_set_extend(pttn, _Extend_to_cairo_extend_t(props.wrap_mode()));
-                                    cairo_pattern_set_filter(pttn, _Filter_to_cairo_filter_t(props.filter()));
-                                    cairo_matrix_t cPttnMatrix;
-                                    const auto& m = props.brush_matrix();
-                                    cairo_matrix_init(&cPttnMatrix, m.m00(), m.m01(), m.m10(), m.m11(), m.m20(), m.m21());
-                                    cairo_pattern_set_matrix(pttn, &cPttnMatrix);
-                                    cairo_set_source(displayContext, pttn);
-                                }
-                            }
-                            cairo_fill(displayContext);
-                        }
-                    }
-                    else {
-                        cairo_new_path(displayContext);
-                        rectWidth = displayWidth;
-                        rectHeight = trunc(displayWidth / whRatio);
-                        rectX = 0.0;
-                        rectY = trunc(abs(rectHeight - displayHeight) / 2.0);
-                        cairo_rectangle(displayContext, rectX, rectY, rectWidth, rectHeight);
-                        
-                        const auto widthRatio = backBufferWidth / displayWidth;
-                        cairo_matrix_init_scale(&ctm, widthRatio, widthRatio);
-                        cairo_matrix_translate(&ctm, 0.0, -rectY);
-                        unique_ptr<cairo_pattern_t, decltype(&cairo_pattern_destroy)> pat(cairo_pattern_create_for_surface(backBufferSfc), &cairo_pattern_destroy);
-                        auto patPtr = pat.get();
-                        cairo_pattern_set_matrix(patPtr, &ctm);
-                        cairo_pattern_set_extend(patPtr, CAIRO_EXTEND_NONE);
-                        cairo_pattern_set_filter(patPtr, cairoFilter);
-                        cairo_set_source(displayContext, patPtr);
-                        cairo_fill(displayContext);
-                        if (data.scl == io2d::scaling::letterbox) {
-                            const auto lboxHeight = trunc((displayHeight - rectHeight) / 2.0);
-                            cairo_rectangle(displayContext, 0.0, 0.0, rectWidth, lboxHeight);
-                            cairo_rectangle(displayContext, 0.0, rectHeight + lboxHeight, rectWidth, lboxHeight);
-                            if (data._Letterbox_brush == nullopt) {
-                                cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
-                                //cairo_paint(_Native_context.get());
-                            }
-                            else {
-                                auto pttn = data._Letterbox_brush.value().data().brush.get();
-                                if (data._Letterbox_brush_props == nullopt) {
-                                    cairo_pattern_set_extend(pttn, CAIRO_EXTEND_NONE);
-                                    cairo_pattern_set_filter(pttn, CAIRO_FILTER_GOOD);
-                                    cairo_matrix_t cPttnMatrix;
-                                    cairo_matrix_init_identity(&cPttnMatrix);
-                                    cairo_pattern_set_matrix(pttn, &cPttnMatrix);
-                                    cairo_set_source(displayContext, pttn);
-                                    //cairo_paint(_Native_context.get());
-                                }
-                                else {
-                                    const auto& props = data._Letterbox_brush_props.value();
-                                    cairo_pattern_set_extend(pttn, _Extend_to_cairo_extend_t(props.wrap_mode()));
-                                    cairo_pattern_set_filter(pttn, _Filter_to_cairo_filter_t(props.filter()));
-                                    cairo_matrix_t cPttnMatrix;
-                                    const auto& m = props.brush_matrix();
-                                    cairo_matrix_init(&cPttnMatrix, m.m00(), m.m01(), m.m10(), m.m11(), m.m20(), m.m21());
-                                    cairo_pattern_set_matrix(pttn, &cPttnMatrix);
-                                    cairo_set_source(displayContext, pttn);
-                                }
-                            }
-                            cairo_fill(displayContext); // Draws the letterbox brush into the appropriate triangles using the appropriate brush_props, etc., settings.
-                        }
-                    }
-                }
-            }
         }
     }
 }
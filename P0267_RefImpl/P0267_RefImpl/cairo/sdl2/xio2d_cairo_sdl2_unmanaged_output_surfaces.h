@@ -119,6 +119,16 @@ namespace std::experimental::io2d {
 				_Ds_mask<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, b, mb, bp, mp, rp, cl);
 			}
 			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill_instances(unmanaged_output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_fill_instances<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, ip, first, last, bp, rp, cl);
+			}
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke_instances(unmanaged_output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_stroke_instances<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, ip, first, last, bp, sp, d, rp, cl);
+			}
+			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::draw_callback(unmanaged_output_surface_data_type& data, function<void(basic_unmanaged_output_surface<_Graphics_surfaces_type>&)> fn) {
 				data->draw_callback = fn;
 			}
@@ -129,6 +139,7 @@ namespace std::experimental::io2d {
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::user_scaling_callback(unmanaged_output_surface_data_type& data, function<basic_bounding_box<GraphicsMath>(const basic_unmanaged_output_surface<_Graphics_surfaces_type>&, bool&)> fn) {
 				data->user_scaling_callback = fn;
+				data->data.display_invalid = true;
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::dimensions(unmanaged_output_surface_data_type& data, const basic_display_point<GraphicsMath>& val) {
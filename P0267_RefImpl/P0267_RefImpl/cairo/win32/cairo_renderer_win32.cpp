@@ -96,6 +96,7 @@ namespace std::experimental::io2d {
 						auto& data = *outputSfc->data();
 						if (data.data.display_dimensions != dimensions) {
 							data.data.display_dimensions = dimensions;
+							data.data.display_invalid = true;
 
 							// Call user size change function.
 
@@ -122,8 +123,11 @@ namespace std::experimental::io2d {
 							break;
 						}
 
+						data.data.display_invalid = true;
+						const auto drawStart = ::std::chrono::steady_clock::now();
 						data.draw_callback(*outputSfc);
-						_Cairo_graphics_surfaces<_Graphics_math_float_impl>::surfaces::_Render_to_native_surface(outputSfc->data(), *outputSfc);
+						data.timing.add_draw(drawStart);
+						_Cairo_graphics_surfaces<_Graphics_math_float_impl>::surfaces::_Present_frame(outputSfc->data(), *outputSfc);
 
 						EndPaint(hwnd, &ps);
 					} break;
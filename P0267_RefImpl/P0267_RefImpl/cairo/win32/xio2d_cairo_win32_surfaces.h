@@ -22,6 +22,12 @@ namespace std::experimental::io2d {
             template <class GraphicsSurfaces>
             void _Ds_mask(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const basic_brush_props<GraphicsSurfaces>& bp, const basic_mask_props<GraphicsSurfaces>& mp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl);
 
+            template <class GraphicsSurfaces, class InputIterator>
+            void _Ds_fill_instances(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const basic_brush_props<GraphicsSurfaces>& bp, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl);
+
+            template <class GraphicsSurfaces, class InputIterator>
+            void _Ds_stroke_instances(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const basic_brush_props<GraphicsSurfaces>& bp, const basic_stroke_props<GraphicsSurfaces>& sp, const basic_dashes<GraphicsSurfaces>& d, const basic_render_props<GraphicsSurfaces>& rp, const basic_clip_props<GraphicsSurfaces>& cl);
+
             template <class GraphicsSurfaces>
             void _Ds_dimensions(typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data, const basic_display_point<typename GraphicsSurfaces::graphics_math_type>& val);
 
@@ -73,8 +79,6 @@ namespace std::experimental::io2d {
             template <class GraphicsSurfaces>
             bool _Ds_redraw_required(const typename GraphicsSurfaces::surfaces::_Display_surface_data_type& data) noexcept;
                         
-            template <class OutputDataType>
-            void _Render_for_scaling_uniform_or_letterbox(OutputDataType& osd);
         }
     }
 }
@@ -4,6 +4,9 @@
 #define _XCAIRO_
 
 #include <cairo.h>
+#include <fstream>
+#include <list>
+#include <unordered_map>
 #include "xio2d.h"
 
 namespace std {
@@ -12,7 +15,196 @@ namespace std {
 			inline namespace v1 {
 				namespace _Cairo {
 					_IO2D_API void _Init_graphics_magic();
-                    
+					// Native PNG and JPEG codecs, compiled in when the build finds libpng or libjpeg. They return false, leaving
+					// the image to GraphicsMagick, for anything they don't handle; otherwise ec tells whether they succeeded.
+					// Decoded images are reduced so that neither side exceeds maxDimension, unless it's 0.
+					_IO2D_API bool _Native_decode_image(const ::std::string& path, image_file_format iff, io2d::format fmt, int maxDimension, cairo_surface_t*& result, ::std::error_code& ec) noexcept;
+					_IO2D_API bool _Native_decode_image(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, cairo_surface_t*& result, ::std::error_code& ec) noexcept;
+					_IO2D_API bool _Native_encode_image(cairo_surface_t* sfc, io2d::format fmt, const ::std::string& path, image_file_format iff, ::std::error_code& ec) noexcept;
+					// A sink that throws makes the encode fail with errc::io_error.
+					_IO2D_API bool _Native_encode_image(cairo_surface_t* sfc, io2d::format fmt, const ::std::function<void(const ::std::byte*, size_t)>& sink, image_file_format iff, ::std::error_code& ec) noexcept;
+					// Replaces sfc, an image surface, with a box filtered copy whose sides don't exceed maxDimension, keeping
+					// its aspect ratio. Leaves it alone if it's small enough already or maxDimension is 0; if there isn't the
+					// memory for the copy, destroys it, sets sfc to nullptr and sets ec.
+					_IO2D_API void _Reduce_image(cairo_surface_t*& sfc, int maxDimension, ::std::error_code& ec) noexcept;
+					// Returns a box filtered copy of sfc, an argb32, xrgb32 or a8 image surface, with each side halved, rounding up;
+					// the levels of a mipmapped surface brush. Returns nullptr for other formats or if there isn't the memory.
+					_IO2D_API cairo_surface_t* _Half_size_image(cairo_surface_t* sfc) noexcept;
+					// Writes the straight alpha version of a row of width premultiplied 32-bit pixels to dst, keeping the byte order;
+					// alpha is byte alphaIndex of each pixel. Each color channel is rounded as (c * 255 + a / 2) / a, whether or not
+					// the pixel goes through the SIMD loop, so a pixel encodes the same wherever it is in the row.
+					_IO2D_API void _Unpremultiply_row(const unsigned char* src, unsigned char* dst, int width, int alphaIndex) noexcept;
+					// The native image format, which is loaded by mapping the file rather than decoding it; see
+					// cairo_renderer-nativeimage.cpp. The _Native_*_image functions above handle it along with PNG and JPEG.
+					constexpr image_file_format _Native_image_file_format = static_cast<image_file_format>(10000 + 12);
+					_IO2D_API void _Map_native_image(const ::std::string& path, io2d::format fmt, cairo_surface_t*& result, ::std::error_code& ec) noexcept;
+					_IO2D_API void _Decode_native_image(const ::std::byte* data, size_t size, io2d::format fmt, cairo_surface_t*& result, ::std::error_code& ec) noexcept;
+					_IO2D_API void _Encode_native_image(cairo_surface_t* sfc, const ::std::string& path, ::std::error_code& ec) noexcept;
+					_IO2D_API void _Encode_native_image(cairo_surface_t* sfc, const ::std::function<void(const ::std::byte*, size_t)>& sink, ::std::error_code& ec) noexcept;
+					// QOI, a fast lossless format for frame dumps and render caches; see cairo_renderer-qoi.cpp. Like the native
+					// format it's handled by the _Native_*_image functions, for argb32 and xrgb32 surfaces.
+					constexpr image_file_format _Qoi_image_file_format = static_cast<image_file_format>(10000 + 13);
+					_IO2D_API void _Decode_qoi_image(const ::std::string& path, io2d::format fmt, cairo_surface_t*& result, ::std::error_code& ec) noexcept;
+					_IO2D_API void _Decode_qoi_image(const ::std::byte* data, size_t size, io2d::format fmt, cairo_surface_t*& result, ::std::error_code& ec) noexcept;
+					_IO2D_API void _Encode_qoi_image(cairo_surface_t* sfc, const ::std::string& path, ::std::error_code& ec) noexcept;
+					_IO2D_API void _Encode_qoi_image(cairo_surface_t* sfc, const ::std::function<void(const ::std::byte*, size_t)>& sink, ::std::error_code& ec) noexcept;
+
+					// The decoded image cache; see cairo_renderer-imagecache.cpp. _Image_cache_find returns true with a new
+					// surface on a hit. On a miss it fills in ticket, which _Image_cache_add takes with the decoded surface.
+					struct _Image_cache_ticket {
+						::std::string key;
+						int64_t modified = 0;
+						uint64_t fileSize = 0;
+						bool cacheable = false;
+					};
+					_IO2D_API bool _Image_cache_find(const ::std::string& path, image_file_format iff, io2d::format fmt, int maxDimension, cairo_surface_t*& result, _Image_cache_ticket& ticket) noexcept;
+					_IO2D_API void _Image_cache_add(const _Image_cache_ticket& ticket, cairo_surface_t* sfc) noexcept;
+					_IO2D_API void _Image_cache_budget(size_t bytes) noexcept;
+					_IO2D_API size_t _Image_cache_budget() noexcept;
+					_IO2D_API image_cache_stats _Image_cache_stats() noexcept;
+					_IO2D_API void _Image_cache_clear() noexcept;
+
+					// The pixels behind basic_tiled_image_surface; see cairo_renderer-tiledimage.cpp. The image is split into
+					// tile_size() square tiles (narrower or shorter along the right and bottom edges) stored at cairo's stride,
+					// which are allocated, cleared, the first time they're drawn on. Once page_to has been called, the least
+					// recently used tiles are written to the store file whenever the tiles in memory exceed its byte budget.
+					class _IO2D_API _Tiled_image {
+						struct _Tile {
+							::std::unique_ptr<unsigned char[]> pixels;
+							// Where the tile is kept in the store, or -1 if it hasn't been paged out yet.
+							int64_t storeOffset = -1;
+							// Set when the pixels have changed since they were last written to the store.
+							bool dirty = false;
+							::std::list<size_t>::iterator lru;
+						};
+						cairo_format_t _Format;
+						int _Width;
+						int _Height;
+						int _Tile_size;
+						int _Columns;
+						int _Rows;
+						::std::vector<_Tile> _Tiles;
+						size_t _Allocated = 0;
+						// Indices of the tiles in memory, most recently used first.
+						::std::list<size_t> _Resident;
+						size_t _Resident_bytes = 0;
+						size_t _Budget = 0;
+						::std::string _Store_path;
+						::std::fstream _Store;
+						int64_t _Store_size = 0;
+
+						size_t _Tile_bytes(size_t index) const noexcept;
+						void _Evict(size_t index);
+						void _Make_room(size_t bytes);
+						void _Close_store() noexcept;
+					public:
+						// Throws errc::invalid_argument unless the sides and tile size are positive, and errc::value_too_large
+						// if the image needs too many tiles. The tile size is rounded up to a multiple of 16, which TIFF requires.
+						_Tiled_image(cairo_format_t fmt, int width, int height, int tileSize);
+						_Tiled_image(const _Tiled_image&) = delete;
+						_Tiled_image& operator=(const _Tiled_image&) = delete;
+						~_Tiled_image() noexcept;
+
+						cairo_format_t format() const noexcept;
+						int width() const noexcept;
+						int height() const noexcept;
+						int tile_size() const noexcept;
+						int columns() const noexcept;
+						int rows() const noexcept;
+						int tile_width(int column) const noexcept;
+						int tile_height(int row) const noexcept;
+						int tile_stride(int column) const noexcept;
+						size_t allocated_tiles() const noexcept;
+						size_t resident_tiles() const noexcept;
+
+						// Returns the tile's pixels, reading them back from the store if they were paged out. A tile that has
+						// never been drawn on is allocated if create is true and returned as nullptr otherwise; create also
+						// marks the tile as changed. The pointer is valid until the next call to tile, page_to or clear.
+						unsigned char* tile(int column, int row, bool create);
+						// Opens a new store file at path, truncating it, and pages out tiles until those in memory take up no
+						// more than residentBytes, or one tile if that's more. Tiles in a previous store are read back first.
+						// The store file is removed when the image is destroyed.
+						void page_to(const ::std::string& path, size_t residentBytes);
+						// Frees every tile, so the whole image is transparent black again.
+						void clear() noexcept;
+						// Writes the image as an uncompressed tiled TIFF, or a BigTIFF if a classic one would be over 4 GB, one
+						// tile at a time. argb32 images are RGBA with associated alpha, xrgb32 ones RGB, and a8 ones grayscale;
+						// other formats fail with errc::not_supported.
+						void save_tiff(const ::std::string& path, ::std::error_code& ec) noexcept;
+					};
+
+					// The pages behind basic_brush_atlas; see cairo_renderer-brushatlas.cpp. Each page is a page_size() square image
+					// surface with one pattern over it, which every entry on the page is drawn with. Entries are packed bottom left
+					// along a skyline, inside gutter() pixels of transparent gutter so that filtering at an entry's edges doesn't
+					// sample its neighbours. One pixel covers nearest and bilinear filtering at any scale and every filter when the
+					// entry isn't drawn smaller; cairo's good and best filters average about 1 / scale pixels when minifying, so
+					// those need a gutter of about that many. Erasing an entry clears its pixels and hands its rectangle back to
+					// the page's free list.
+					class _IO2D_API _Brush_atlas {
+					public:
+						struct _Rect {
+							int x;
+							int y;
+							int width;
+							int height;
+						};
+						// A stretch of the skyline: from x to x + width, the rows above y are taken by entries or the free list.
+						struct _Skyline_node {
+							int x;
+							int y;
+							int width;
+						};
+						struct _Page {
+							::std::shared_ptr<cairo_surface_t> surface;
+							::std::shared_ptr<cairo_pattern_t> pattern;
+							::std::vector<_Skyline_node> skyline;
+							// Free rectangles behind the skyline: gaps left where an entry spanned nodes of different heights, and the
+							// places of erased entries. They don't overlap.
+							::std::vector<_Rect> free;
+							size_t entries = 0;
+						};
+						struct _Entry {
+							int page;
+							// The entry's pixels, not counting its gutter.
+							_Rect area;
+						};
+					private:
+						cairo_format_t _Format;
+						int _Page_size;
+						// Transparent pixels kept around each entry.
+						int _Gutter;
+						::std::vector<_Page> _Pages;
+						::std::unordered_map<size_t, _Entry> _Entries;
+						size_t _Next_key = 1;
+
+						void _Add_page();
+						void _Clear(_Page& page, const _Rect& r) noexcept;
+					public:
+						// Throws errc::invalid_argument unless gutter isn't negative and pageSize is between 1 + 2 * gutter and
+						// 32767, and errc::not_supported for a1.
+						_Brush_atlas(cairo_format_t fmt, int pageSize, int gutter);
+						_Brush_atlas(const _Brush_atlas&) = delete;
+						_Brush_atlas& operator=(const _Brush_atlas&) = delete;
+
+						cairo_format_t format() const noexcept;
+						int page_size() const noexcept;
+						int gutter() const noexcept;
+						int page_count() const noexcept;
+						size_t size() const noexcept;
+						const _Page& page(int index) const noexcept;
+						// Returns nullptr for keys that were never returned by insert or have been erased.
+						const _Entry* find(size_t key) const noexcept;
+
+						// Copies img, an image surface, onto the first page with room for it, adding a page if none has, and
+						// returns the new entry's key. Keys aren't reused. Throws errc::invalid_argument if img and its gutter are
+						// larger than a page.
+						size_t insert(cairo_surface_t* img);
+						// Returns false if there was no such entry. A page that empties is kept for later entries.
+						bool erase(size_t key) noexcept;
+						// Erases every entry and frees the pages. Brushes made from the atlas keep their page alive.
+						void clear() noexcept;
+					};
+
 					constexpr const wchar_t* _Refimpl_window_class_name = L"_P0267RefImplCairoRenderer_FF2B4C8D-0AB8-4343-AA02-6D0857E9FA21";
 
 					template <class GraphicsMath>
@@ -34,6 +226,10 @@ namespace std {
 							const static image_file_format psd = static_cast<image_file_format>(_Base + 8);
 							const static image_file_format xbm = static_cast<image_file_format>(_Base + 10);
 							const static image_file_format xpm = static_cast<image_file_format>(_Base + 11);
+							// Premultiplied rows at cairo's stride behind a small header; loading maps the file instead of decoding it.
+							const static image_file_format native = _Native_image_file_format;
+							// Lossless and much faster to write than PNG, at the cost of larger files.
+							const static image_file_format qoi = _Qoi_image_file_format;
 
 							struct read_only {
 								const static int _Base = 20000;
@@ -248,6 +444,8 @@ namespace std {
 								::std::shared_ptr<cairo_surface_t> imageSurface;
 								::std::shared_ptr<cairo_pattern_t> brush;
 								brush_type brushType;
+								// For a mipmapped surface brush, patterns over successively halved copies of imageSurface, down to 1x1.
+								::std::vector<::std::shared_ptr<cairo_pattern_t>> mipLevels;
 							};
 							using brush_data_type = _Brush_data;
 
@@ -259,10 +457,31 @@ namespace std {
 							static brush_data_type create_brush(const basic_circle<GraphicsMath>& start, const basic_circle<GraphicsMath>& end, InputIterator first, InputIterator last);
 							static brush_data_type create_brush(const basic_circle<GraphicsMath>& start, const basic_circle<GraphicsMath>& end, ::std::initializer_list<gradient_stop> il);
 							static brush_data_type create_brush(basic_image_surface<_Graphics_surfaces_type>&& img);
+							static brush_data_type create_brush(basic_image_surface<_Graphics_surfaces_type>&& img, bool mipmap);
 							static brush_data_type copy_brush(const brush_data_type& data);
 							static brush_data_type move_brush(brush_data_type&& data) noexcept;
 							static void destroy(brush_data_type& data) noexcept;
 							static brush_type get_brush_type(const brush_data_type& data) noexcept;
+
+							// brush_atlas
+							using brush_atlas_data_type = ::std::unique_ptr<_Brush_atlas>;
+
+							static brush_atlas_data_type create_brush_atlas(io2d::format fmt, int pageSize, int gutter);
+							static brush_atlas_data_type move_brush_atlas(brush_atlas_data_type&& data) noexcept;
+							static void destroy(brush_atlas_data_type& data) noexcept;
+							static size_t insert(brush_atlas_data_type& data, const basic_image_surface<_Graphics_surfaces_type>& img);
+							static bool erase(brush_atlas_data_type& data, size_t key) noexcept;
+							static void clear(brush_atlas_data_type& data) noexcept;
+							static bool contains(const brush_atlas_data_type& data, size_t key) noexcept;
+							static size_t size(const brush_atlas_data_type& data) noexcept;
+							static io2d::format format(const brush_atlas_data_type& data) noexcept;
+							static int page_size(const brush_atlas_data_type& data) noexcept;
+							static int gutter(const brush_atlas_data_type& data) noexcept;
+							static int page_count(const brush_atlas_data_type& data) noexcept;
+							static int page(const brush_atlas_data_type& data, size_t key);
+							static basic_bounding_box<GraphicsMath> bounds(const brush_atlas_data_type& data, size_t key);
+							// A surface brush over the page that holds key's entry, sharing the page's pattern.
+							static brush_data_type create_brush(const brush_atlas_data_type& data, size_t key);
 						};
 
 						struct surface_state_props {
@@ -401,6 +620,10 @@ namespace std {
 							// image_surface
 
 							static basic_display_point<GraphicsMath> max_dimensions() noexcept;
+							static void cache_budget(size_t bytes) noexcept;
+							static size_t cache_budget() noexcept;
+							static image_cache_stats cache_stats() noexcept;
+							static void clear_cache() noexcept;
 
 							struct _Image_surface_data {
 								::std::unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> surface{ nullptr, &cairo_surface_destroy };
@@ -415,9 +638,13 @@ namespace std {
 #if defined(_Filesystem_support_test)
 							static image_surface_data_type create_image_surface(filesystem::path p, image_file_format iff, io2d::format fmt);
 							static image_surface_data_type create_image_surface(filesystem::path p, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept;
+							static image_surface_data_type create_image_surface(filesystem::path p, image_file_format iff, io2d::format fmt, int maxDimension);
+							static image_surface_data_type create_image_surface(filesystem::path p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept;
 #else
 							static image_surface_data_type create_image_surface(::std::string p, image_file_format iff, io2d::format fmt);
 							static image_surface_data_type create_image_surface(::std::string p, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept;
+							static image_surface_data_type create_image_surface(::std::string p, image_file_format iff, io2d::format fmt, int maxDimension);
+							static image_surface_data_type create_image_surface(::std::string p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept;
 #endif
 							static image_surface_data_type move_image_surface(image_surface_data_type&& data) noexcept;
 							static void destroy(image_surface_data_type& data) noexcept;
@@ -428,6 +655,12 @@ namespace std {
 							static void save(image_surface_data_type& data, ::std::string p, image_file_format iff);
 							static void save(image_surface_data_type& data, ::std::string p, image_file_format iff, error_code& ec) noexcept;
 #endif
+							static image_surface_data_type create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt);
+							static image_surface_data_type create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept;
+							static image_surface_data_type create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension);
+							static image_surface_data_type create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept;
+							static void save(image_surface_data_type& data, const ::std::function<void(const ::std::byte*, size_t)>& sink, image_file_format iff);
+							static void save(image_surface_data_type& data, const ::std::function<void(const ::std::byte*, size_t)>& sink, image_file_format iff, error_code& ec) noexcept;
 							static io2d::format format(const image_surface_data_type& data) noexcept;
 							static basic_display_point<GraphicsMath> dimensions(const image_surface_data_type& data) noexcept;
 							static void clear(image_surface_data_type& data);
@@ -441,7 +674,138 @@ namespace std {
 							static void stroke(image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 							static void fill(image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 							static void mask(image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush<_Graphics_surfaces_type>& mb, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_mask_props<_Graphics_surfaces_type>& mp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							template <class InputIterator>
+							static void fill_instances(image_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							template <class InputIterator>
+							static void stroke_instances(image_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 							static _Interchange_buffer _Copy_to_interchange_buffer(image_surface_data_type& data, _Interchange_buffer::pixel_layout layout, _Interchange_buffer::alpha_mode alpha);
+							// Converts the r part of data into the same part of target, which has data's dimensions and target's own layout.
+							static void _Copy_to_interchange_buffer(image_surface_data_type& data, const cairo_rectangle_int_t& r, _Interchange_buffer& target);
+
+							// recorded_scene
+
+							enum class _Recorded_op {
+								clear,
+								paint,
+								stroke,
+								fill,
+								mask
+							};
+
+							struct _Recorded_draw {
+								_Recorded_op op = _Recorded_op::clear;
+								optional<basic_brush<_Graphics_surfaces_type>> b;
+								optional<basic_brush<_Graphics_surfaces_type>> mb;
+								basic_interpreted_path<_Graphics_surfaces_type> ip;
+								basic_brush_props<_Graphics_surfaces_type> bp;
+								basic_stroke_props<_Graphics_surfaces_type> sp;
+								basic_dashes<_Graphics_surfaces_type> d;
+								basic_mask_props<_Graphics_surfaces_type> mp;
+								basic_render_props<_Graphics_surfaces_type> rp;
+								basic_clip_props<_Graphics_surfaces_type> cl;
+								// Device space area the draw can touch; nullopt means it can touch the whole surface.
+								optional<basic_bounding_box<GraphicsMath>> extents;
+							};
+
+							struct _Recorded_scene_data {
+								::std::vector<_Recorded_draw> draws;
+							};
+
+							using recorded_scene_data_type = _Recorded_scene_data;
+
+							static recorded_scene_data_type create_recorded_scene() noexcept;
+							static recorded_scene_data_type copy_recorded_scene(const recorded_scene_data_type& data);
+							static recorded_scene_data_type move_recorded_scene(recorded_scene_data_type&& data) noexcept;
+							static void destroy(recorded_scene_data_type& data) noexcept;
+							static bool empty(const recorded_scene_data_type& data) noexcept;
+							static void clear(recorded_scene_data_type& data);
+							static void paint(recorded_scene_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							static void stroke(recorded_scene_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							static void fill(recorded_scene_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							static void mask(recorded_scene_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush<_Graphics_surfaces_type>& mb, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_mask_props<_Graphics_surfaces_type>& mp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							template <class InputIterator>
+							static void fill_instances(recorded_scene_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							template <class InputIterator>
+							static void stroke_instances(recorded_scene_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							static void render_tiled(image_surface_data_type& data, const recorded_scene_data_type& rs, int tileWidth, int tileHeight, unsigned int threadCount);
+
+							// tiled_image_surface
+
+							using tiled_image_surface_data_type = ::std::unique_ptr<_Tiled_image>;
+
+							static tiled_image_surface_data_type create_tiled_image_surface(io2d::format fmt, int width, int height, int tileSize);
+							static tiled_image_surface_data_type move_tiled_image_surface(tiled_image_surface_data_type&& data) noexcept;
+							static void destroy(tiled_image_surface_data_type& data) noexcept;
+#ifdef _Filesystem_support_test
+							static void page_to(tiled_image_surface_data_type& data, filesystem::path p, size_t residentBytes);
+							static void save(tiled_image_surface_data_type& data, filesystem::path p, image_file_format iff);
+							static void save(tiled_image_surface_data_type& data, filesystem::path p, image_file_format iff, error_code& ec) noexcept;
+#else
+							static void page_to(tiled_image_surface_data_type& data, ::std::string p, size_t residentBytes);
+							static void save(tiled_image_surface_data_type& data, ::std::string p, image_file_format iff);
+							static void save(tiled_image_surface_data_type& data, ::std::string p, image_file_format iff, error_code& ec) noexcept;
+#endif
+							static io2d::format format(const tiled_image_surface_data_type& data) noexcept;
+							static basic_display_point<GraphicsMath> dimensions(const tiled_image_surface_data_type& data) noexcept;
+							static int tile_size(const tiled_image_surface_data_type& data) noexcept;
+							static size_t allocated_tiles(const tiled_image_surface_data_type& data) noexcept;
+							static size_t resident_tiles(const tiled_image_surface_data_type& data) noexcept;
+							static void clear(tiled_image_surface_data_type& data);
+							static void paint(tiled_image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							static void stroke(tiled_image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							static void fill(tiled_image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							static void mask(tiled_image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush<_Graphics_surfaces_type>& mb, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_mask_props<_Graphics_surfaces_type>& mp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							// Copies the area of the tiled image whose top left corner is at x, y into dst, which has the same format.
+							static void copy_region(tiled_image_surface_data_type& data, int x, int y, image_surface_data_type& dst);
+							// Draws on every tile that extents, in device space, touches; nullopt means every tile. draw is called with an image surface over each tile's pixels.
+							template <class DrawFn>
+							static void _Draw_tiled(tiled_image_surface_data_type& data, const optional<basic_bounding_box<GraphicsMath>>& extents, DrawFn draw);
+
+							// Render thread used by output surfaces in async_render mode; defined in xcairo_surfaces_async_impl.h.
+							struct _Async_renderer;
+
+							// The part of an output surface's back buffer that changed since it was last presented, in back buffer device space.
+							struct _Damage_region {
+								// Set when a change had unknown extents.
+								bool full = false;
+								optional<basic_bounding_box<GraphicsMath>> area;
+							};
+
+							// How the back buffer is presented for the display's scaling. It only changes on a resize, an expose or a
+							// scaling or letterbox change, so it is rebuilt by _Update_present_cache when display_invalid is set.
+							struct _Present_cache {
+								// Back buffer patterns with matrix, extend and filter already set, one per swap chain buffer.
+								struct _Source_pattern {
+									::std::unique_ptr<cairo_pattern_t, decltype(&cairo_pattern_destroy)> pattern{ nullptr, &cairo_pattern_destroy };
+									cairo_surface_t* surface = nullptr;
+								};
+								array<_Source_pattern, 3> patterns;
+								size_t next_pattern = 0;
+								cairo_matrix_t matrix = { 1.0, 0.0, 0.0, 1.0, 0.0, 0.0 };
+								// The display area the back buffer is drawn to, unless it covers the whole display.
+								bool paints_display = true;
+								cairo_rectangle_t content = { 0.0, 0.0, 0.0, 0.0 };
+								// Letterbox bars, which are only drawn when the whole display is presented.
+								int bar_count = 0;
+								cairo_rectangle_t bars[2] = {};
+							};
+
+							// The limits set by frame_budget and time_budget and how much of them the running show has used.
+							struct _Show_budget {
+								int frames = 0;
+								::std::chrono::nanoseconds time{};
+								int frames_drawn = 0;
+								::std::chrono::steady_clock::time_point start;
+
+								// Called by begin_show.
+								void begin() noexcept {
+									frames_drawn = 0;
+									start = ::std::chrono::steady_clock::now();
+								}
+								bool spent() const noexcept {
+									return (frames > 0 && frames_drawn >= frames) || (time.count() > 0 && ::std::chrono::steady_clock::now() - start >= time);
+								}
+							};
 
 							// display surfaces
 							struct _Display_surface_data_type;
@@ -452,6 +816,16 @@ namespace std {
 
 							template <class OutputDataType, class OutputSurfaceType>
 							static void _Render_to_native_surface(OutputDataType& osd, OutputSurfaceType& sfc);
+							// Presents the back buffer and hands a copy of it to the present callback, if there is one. The copy is updated in place
+							// and, with damage tracking, only where the presented damage says the back buffer changed.
+							template <class OutputDataType, class OutputSurfaceType>
+							static void _Present_back_buffer(OutputDataType& osd, OutputSurfaceType& sfc);
+							// Presents a finished frame. In async_render mode this hands the recorded frame to the render thread and presents the previous one instead.
+							template <class OutputDataType, class OutputSurfaceType>
+							static void _Present_frame(OutputDataType& osd, OutputSurfaceType& sfc);
+							// Presents the last frame rasterized by the render thread if it hasn't been shown yet; does nothing outside async_render mode.
+							template <class OutputDataType, class OutputSurfaceType>
+							static void _Present_async_frame_if_ready(OutputDataType& osd, OutputSurfaceType& sfc);
 
 							static basic_display_point<GraphicsMath> max_display_dimensions() noexcept;
 							// unmanaged_output_surface functions
@@ -485,6 +859,10 @@ namespace std {
 							static void stroke(unmanaged_output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 							static void fill(unmanaged_output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& pg, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 							static void mask(unmanaged_output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush<_Graphics_surfaces_type>& mb, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_mask_props<_Graphics_surfaces_type>& mp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							template <class InputIterator>
+							static void fill_instances(unmanaged_output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							template <class InputIterator>
+							static void stroke_instances(unmanaged_output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 							static void draw_callback(unmanaged_output_surface_data_type& data, function<void(basic_unmanaged_output_surface<_Graphics_surfaces_type>&)>);
 							static void size_change_callback(unmanaged_output_surface_data_type& data, function<void(basic_unmanaged_output_surface<_Graphics_surfaces_type>&)>);
 							static void user_scaling_callback(unmanaged_output_surface_data_type& data, function<basic_bounding_box<GraphicsMath>(const basic_unmanaged_output_surface<_Graphics_surfaces_type>&, bool&)>);
@@ -534,6 +912,10 @@ namespace std {
 							static void stroke(output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 							static void fill(output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& pg, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 							static void mask(output_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush<_Graphics_surfaces_type>& mb, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_mask_props<_Graphics_surfaces_type>& mp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							template <class InputIterator>
+							static void fill_instances(output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
+							template <class InputIterator>
+							static void stroke_instances(output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl);
 
 							// display_surface common functions
 							static void draw_callback(output_surface_data_type& data, function<void(basic_output_surface<_Graphics_surfaces_type>&)>);
@@ -545,6 +927,13 @@ namespace std {
 							static void letterbox_brush_props(output_surface_data_type& data, const basic_brush_props<_Graphics_surfaces_type>& val);
 							static void auto_clear(output_surface_data_type& data, bool val);
 							static void redraw_required(output_surface_data_type& data, bool val);
+							static void async_render(output_surface_data_type& data, bool val);
+							static void buffer_count(output_surface_data_type& data, int val);
+							static void damage_tracking(output_surface_data_type& data, bool val);
+							static void frame_budget(output_surface_data_type& data, int val);
+							static void time_budget(output_surface_data_type& data, ::std::chrono::nanoseconds val);
+							static void present_callback(output_surface_data_type& data, function<void(const _Interchange_buffer&)> fn);
+							static void frame_timing_callback(output_surface_data_type& data, function<void(const frame_timing&)> fn);
 
 							static io2d::format format(const output_surface_data_type& data) noexcept;
 							static basic_display_point<GraphicsMath> dimensions(const output_surface_data_type& data) noexcept;
@@ -554,6 +943,13 @@ namespace std {
 							static basic_brush_props<_Graphics_surfaces_type> letterbox_brush_props(const output_surface_data_type& data) noexcept;
 							static bool auto_clear(const output_surface_data_type& data) noexcept;
 							static bool redraw_required(const output_surface_data_type& data) noexcept;
+							static bool async_render(const output_surface_data_type& data) noexcept;
+							static int buffer_count(const output_surface_data_type& data) noexcept;
+							static bool damage_tracking(const output_surface_data_type& data) noexcept;
+							static int frame_budget(const output_surface_data_type& data) noexcept;
+							static ::std::chrono::nanoseconds time_budget(const output_surface_data_type& data) noexcept;
+							static async_render_stats async_stats(const output_surface_data_type& data) noexcept;
+							static frame_timing_stats frame_stats(const output_surface_data_type& data) noexcept;
 							
 							static basic_image_surface<_Graphics_surfaces_type> copy_surface(basic_image_surface<_Graphics_surfaces_type>& sfc) noexcept;
 							static basic_image_surface<_Graphics_surfaces_type> copy_surface(basic_output_surface<_Graphics_surfaces_type>& sfc) noexcept;
@@ -81,6 +81,28 @@ namespace std::experimental::io2d {
 				return data;
 			}
 			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::brushes::brush_data_type _Cairo_graphics_surfaces<GraphicsMath>::brushes::create_brush(basic_image_surface<_Graphics_surfaces_type>&& img, bool mipmap) {
+				auto data = create_brush(move(img));
+				if (!mipmap) {
+					return data;
+				}
+				_IO2D_TRACE_SPAN("build_mip_chain");
+				auto level = data.imageSurface.get();
+				while (cairo_image_surface_get_width(level) > 1 || cairo_image_surface_get_height(level) > 1) {
+					auto next = _Half_size_image(level);
+					if (next == nullptr) {
+						// Formats that can't be averaged a byte at a time, or a lack of memory, leave the chain short; the
+						// levels that were made still help.
+						break;
+					}
+					data.mipLevels.push_back(shared_ptr<cairo_pattern_t>(cairo_pattern_create_for_surface(next), &cairo_pattern_destroy));
+					// The pattern holds a reference to the surface.
+					cairo_surface_destroy(next);
+					level = next;
+				}
+				return data;
+			}
+			template<class GraphicsMath>
 			inline typename _Cairo_graphics_surfaces<GraphicsMath>::brushes::brush_data_type _Cairo_graphics_surfaces<GraphicsMath>::brushes::copy_brush(const brush_data_type& data) {
 				return data;
 			}
@@ -98,6 +120,85 @@ namespace std::experimental::io2d {
 			inline brush_type _Cairo_graphics_surfaces<GraphicsMath>::brushes::get_brush_type(const brush_data_type& data) noexcept {
 				return data.brushType;
 			}
+
+			// brush_atlas
+
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::brushes::brush_atlas_data_type _Cairo_graphics_surfaces<GraphicsMath>::brushes::create_brush_atlas(io2d::format fmt, int pageSize, int gutter) {
+				return ::std::make_unique<_Brush_atlas>(_Format_to_cairo_format_t(fmt), pageSize, gutter);
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::brushes::brush_atlas_data_type _Cairo_graphics_surfaces<GraphicsMath>::brushes::move_brush_atlas(brush_atlas_data_type&& data) noexcept {
+				return move(data);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::brushes::destroy(brush_atlas_data_type& data) noexcept {
+				data.reset();
+			}
+			template<class GraphicsMath>
+			inline size_t _Cairo_graphics_surfaces<GraphicsMath>::brushes::insert(brush_atlas_data_type& data, const basic_image_surface<_Graphics_surfaces_type>& img) {
+				// The pixels are only read, but basic_image_surface has no const data(), ergo const_cast.
+				auto& imgData = const_cast<basic_image_surface<_Graphics_surfaces_type>&>(img).data();
+				return data->insert(imgData.surface.get());
+			}
+			template<class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::brushes::erase(brush_atlas_data_type& data, size_t key) noexcept {
+				return data->erase(key);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::brushes::clear(brush_atlas_data_type& data) noexcept {
+				data->clear();
+			}
+			template<class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::brushes::contains(const brush_atlas_data_type& data, size_t key) noexcept {
+				return data->find(key) != nullptr;
+			}
+			template<class GraphicsMath>
+			inline size_t _Cairo_graphics_surfaces<GraphicsMath>::brushes::size(const brush_atlas_data_type& data) noexcept {
+				return data->size();
+			}
+			template<class GraphicsMath>
+			inline io2d::format _Cairo_graphics_surfaces<GraphicsMath>::brushes::format(const brush_atlas_data_type& data) noexcept {
+				return _Cairo_format_t_to_format(data->format());
+			}
+			template<class GraphicsMath>
+			inline int _Cairo_graphics_surfaces<GraphicsMath>::brushes::page_size(const brush_atlas_data_type& data) noexcept {
+				return data->page_size();
+			}
+			template<class GraphicsMath>
+			inline int _Cairo_graphics_surfaces<GraphicsMath>::brushes::gutter(const brush_atlas_data_type& data) noexcept {
+				return data->gutter();
+			}
+			template<class GraphicsMath>
+			inline int _Cairo_graphics_surfaces<GraphicsMath>::brushes::page_count(const brush_atlas_data_type& data) noexcept {
+				return data->page_count();
+			}
+			template<class GraphicsMath>
+			inline int _Cairo_graphics_surfaces<GraphicsMath>::brushes::page(const brush_atlas_data_type& data, size_t key) {
+				const auto entry = data->find(key);
+				if (entry == nullptr) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				return entry->page;
+			}
+			template<class GraphicsMath>
+			inline basic_bounding_box<GraphicsMath> _Cairo_graphics_surfaces<GraphicsMath>::brushes::bounds(const brush_atlas_data_type& data, size_t key) {
+				const auto entry = data->find(key);
+				if (entry == nullptr) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				const auto& area = entry->area;
+				return basic_bounding_box<GraphicsMath>(static_cast<float>(area.x), static_cast<float>(area.y), static_cast<float>(area.width), static_cast<float>(area.height));
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::brushes::brush_data_type _Cairo_graphics_surfaces<GraphicsMath>::brushes::create_brush(const brush_atlas_data_type& data, size_t key) {
+				const auto& page = data->page(brushes::page(data, key));
+				brush_data_type result;
+				result.imageSurface = page.surface;
+				result.brush = page.pattern;
+				result.brushType = brush_type::surface;
+				return result;
+			}
 		}
 	}
 }
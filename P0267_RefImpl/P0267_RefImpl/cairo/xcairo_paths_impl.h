@@ -307,6 +307,7 @@ namespace std::experimental::io2d {
             
             template <class GraphicsSurfaces, class ForwardIterator>
             inline ::std::vector<typename basic_figure_items<GraphicsSurfaces>::figure_item> _Interpret_path_items(ForwardIterator first, ForwardIterator last) {
+                _IO2D_TRACE_SPAN("_Interpret_path_items");
                 using graphics_math_type = typename GraphicsSurfaces::graphics_math_type;
                 basic_matrix_2d<graphics_math_type> m;
                 basic_point_2d<graphics_math_type> currentPoint; // Tracks the untransformed current point.
@@ -439,6 +440,7 @@ namespace std::experimental::io2d {
 			template<class GraphicsMath>
 			template<class ForwardIterator>
 			inline typename _Cairo_graphics_surfaces<GraphicsMath>::paths::interpreted_path_data_type _Cairo_graphics_surfaces<GraphicsMath>::paths::create_interpreted_path(ForwardIterator first, ForwardIterator last) {
+				_IO2D_TRACE_SPAN("create_interpreted_path");
 				interpreted_path_data_type result;
 				auto cairoPathT = new cairo_path_t;
 				if (cairoPathT == nullptr) {
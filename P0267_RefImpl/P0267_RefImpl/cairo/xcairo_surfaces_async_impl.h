@@ -0,0 +1,504 @@
+#pragma once
+#include "xcairo_surfaces_impl.h"
+
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			// async_render
+
+			// Owns the render thread of an output surface in async_render mode. The thread replays one recorded frame at a
+			// time. With a single buffer it draws straight into the back buffer, which the thread that calls begin_show only
+			// touches while the render thread is idle. With more, it draws into one of the swap chain buffers and the finished
+			// frame is swapped into the back buffer when it is presented, so presentation never waits for rasterization.
+			template <class GraphicsMath>
+			struct _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Async_renderer {
+				::std::mutex mutex;
+				::std::condition_variable cv;
+				// Draws of the frame currently being built by the draw callback.
+				recorded_scene_data_type recording;
+				// The frame handed to the render thread, until it takes it. Its storage is reused for the next recording.
+				recorded_scene_data_type pending;
+				// The output surface's back buffer. It holds the frame that is being (or was last) presented.
+				image_surface_data_type* front = nullptr;
+				// buffer_count - 1 buffers that frames are rasterized into when more than one buffer is used.
+				::std::vector<image_surface_data_type> chain;
+				// Index in chain of the newest finished frame that hasn't been swapped into the back buffer yet, or -1.
+				int ready = -1;
+				bool has_pending = false;
+				bool busy = false;
+				// The back buffer holds a frame that hasn't been presented.
+				bool frame_ready = false;
+				bool stop = false;
+				// Damage of the frame handed to the render thread, of finished frames that haven't been swapped into the back
+				// buffer yet, and of the back buffer relative to what was last presented.
+				_Damage_region pending_damage;
+				_Damage_region ready_damage;
+				_Damage_region front_damage;
+				::std::exception_ptr error;
+				::std::chrono::steady_clock::time_point submit_time;
+				::std::chrono::steady_clock::time_point first_submit_time;
+				::std::chrono::nanoseconds total_latency{};
+				async_render_stats stats;
+				// Called on the render thread, with the mutex held, after it finished a frame. Event loops that block set it
+				// so that they wake up to present the frame.
+				::std::function<void()> frame_finished;
+				::std::thread worker;
+
+				_Async_renderer(image_surface_data_type& backBuffer, int bufferCount)
+					: front(&backBuffer)
+					, chain(static_cast<size_t>(bufferCount - 1)) {
+					worker = ::std::thread([this]() { run(); });
+				}
+				_Async_renderer(const _Async_renderer&) = delete;
+				_Async_renderer& operator=(const _Async_renderer&) = delete;
+				~_Async_renderer() {
+					{
+						::std::lock_guard<::std::mutex> lock(mutex);
+						stop = true;
+					}
+					cv.notify_all();
+					worker.join();
+				}
+
+				// Picks the buffer the next frame is rasterized into and the frame it has to start from. Called with the mutex held.
+				image_surface_data_type& acquire_target(cairo_surface_t*& previous) {
+					previous = nullptr;
+					if (chain.empty()) {
+						return *front;
+					}
+					// With three buffers a finished frame that is still waiting to be presented is kept, so this never blocks;
+					// with two, begin_show only submits once the previous frame was swapped out.
+					auto index = (ready == 0 && chain.size() > 1) ? 1 : 0;
+					auto& target = chain[static_cast<size_t>(index)];
+					if (target.surface == nullptr || target.format != front->format || target.dimensions != front->dimensions) {
+						target = create_image_surface(front->format, front->dimensions.x(), front->dimensions.y());
+					}
+					auto& latest = (ready >= 0) ? chain[static_cast<size_t>(ready)] : *front;
+					if (&latest != &target && latest.surface != nullptr && latest.dimensions == target.dimensions) {
+						previous = latest.surface.get();
+					}
+					return target;
+				}
+
+				void run() {
+					// The frame being rasterized. It is only touched by this thread, so the drawing thread can submit the next
+					// frame into pending meanwhile. Its storage goes back to pending for reuse.
+					recorded_scene_data_type scene;
+					::std::unique_lock<::std::mutex> lock(mutex);
+					while (true) {
+						cv.wait(lock, [this]() { return stop || has_pending; });
+						if (stop) {
+							return;
+						}
+						scene.draws.swap(pending.draws);
+						has_pending = false;
+						busy = true;
+						const auto submitted = submit_time;
+						const auto frameDamage = pending_damage;
+						cairo_surface_t* previous = nullptr;
+						auto& target = acquire_target(previous);
+						lock.unlock();
+
+						const auto start = ::std::chrono::steady_clock::now();
+						::std::exception_ptr err;
+						try {
+							// A frame that doesn't start by clearing (i.e. auto_clear is off) draws over the previous frame,
+							// which a swap chain buffer doesn't hold. Finished frames are never written to, so this is safe to
+							// read without the mutex even if the frame is swapped into the back buffer meanwhile.
+							const bool clears = !scene.draws.empty() && scene.draws.front().op == _Recorded_op::clear && !scene.draws.front().cl.data().clip.has_value();
+							if (previous != nullptr && !clears) {
+								auto dest = target.surface.get();
+								cairo_surface_flush(dest);
+								memcpy(cairo_image_surface_get_data(dest), cairo_image_surface_get_data(previous), static_cast<size_t>(cairo_image_surface_get_stride(previous)) * static_cast<size_t>(cairo_image_surface_get_height(previous)));
+								cairo_surface_mark_dirty(dest);
+							}
+							const auto w = ::std::max(1, target.dimensions.x());
+							const auto h = ::std::max(1, target.dimensions.y());
+							render_tiled(target, scene, w, h, 1);
+						}
+						catch (...) {
+							err = ::std::current_exception();
+						}
+						// Release the frame's brushes and paths here rather than on the drawing thread.
+						scene.draws.clear();
+						const auto done = ::std::chrono::steady_clock::now();
+
+						lock.lock();
+						busy = false;
+						if (err) {
+							error = err;
+							front_damage.full = true;
+						}
+						else {
+							if (&target == front) {
+								frame_ready = true;
+								_Add_damage(front_damage, frameDamage);
+							}
+							else {
+								// An older finished frame that was never presented is dropped.
+								ready = static_cast<int>(&target - chain.data());
+								_Add_damage(ready_damage, frameDamage);
+							}
+							const auto latency = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(done - submitted);
+							stats.frames_rendered++;
+							stats.last_latency = latency;
+							stats.max_latency = ::std::max(stats.max_latency, latency);
+							total_latency += latency;
+							stats.average_latency = total_latency / static_cast<int64_t>(stats.frames_rendered);
+							stats.last_render_time = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(done - start);
+							const auto elapsed = ::std::chrono::duration<float>(done - first_submit_time).count();
+							if (elapsed > 0.0f) {
+								stats.frames_per_second = static_cast<float>(stats.frames_rendered) / elapsed;
+							}
+						}
+						cv.notify_all();
+						if (frame_finished) {
+							frame_finished();
+						}
+					}
+				}
+
+				// Makes the newest finished frame the back buffer. Called with the mutex held, on the thread that presents.
+				void swap_in_ready() {
+					if (ready < 0) {
+						return;
+					}
+					auto& buffer = chain[static_cast<size_t>(ready)];
+					ready = -1;
+					const auto damage = ::std::exchange(ready_damage, _Damage_region{});
+					// The back buffer was resized after the frame was rasterized.
+					if (buffer.dimensions != front->dimensions || buffer.format != front->format) {
+						return;
+					}
+					::std::swap(*front, buffer);
+					frame_ready = true;
+					_Add_damage(front_damage, damage);
+				}
+
+				void rethrow_error() {
+					if (error) {
+						auto e = error;
+						error = nullptr;
+						::std::rethrow_exception(e);
+					}
+				}
+
+				// Blocks until the render thread has finished the frame it was given, then rethrows anything it threw.
+				// Afterwards the back buffer holds the newest frame.
+				void wait_idle(::std::unique_lock<::std::mutex>& lock) {
+					cv.wait(lock, [this]() { return !has_pending && !busy; });
+					rethrow_error();
+					swap_in_ready();
+				}
+				void wait_idle() {
+					::std::unique_lock<::std::mutex> lock(mutex);
+					wait_idle(lock);
+				}
+
+				// Waits for the render thread, then rasterizes the draws recorded so far for the next frame into the back
+				// buffer, so that the back buffer holds everything drawn until now. The rest of the frame is drawn over it: it
+				// doesn't start with a clear, so a swap chain buffer starts from a copy of the back buffer. A finished frame
+				// that was swapped in but not presented yet is drawn over, i.e. dropped.
+				void finish_recorded() {
+					::std::unique_lock<::std::mutex> lock(mutex);
+					wait_idle(lock);
+					if (recording.draws.empty() || front->surface == nullptr) {
+						return;
+					}
+					render_tiled(*front, recording, ::std::max(1, front->dimensions.x()), ::std::max(1, front->dimensions.y()), 1);
+					recording.draws.clear();
+				}
+
+				void submit(::std::unique_lock<::std::mutex>& /*lock*/, const _Damage_region& damage) {
+					recording.draws.swap(pending.draws);
+					pending_damage = damage;
+					has_pending = true;
+					submit_time = ::std::chrono::steady_clock::now();
+					if (stats.frames_submitted++ == 0) {
+						first_submit_time = submit_time;
+					}
+					cv.notify_all();
+				}
+			};
+
+			// Waits for the render thread, if any, so that the back buffer can be used directly.
+			template <class DisplaySurfaceData>
+			inline void _Async_wait_idle(DisplaySurfaceData& data) {
+				if (data.async != nullptr) {
+					data.async->wait_idle();
+				}
+			}
+
+			// Like _Async_wait_idle, but also draws what was recorded for the next frame into the back buffer, so that the
+			// back buffer's pixels can be changed directly (see output_surface::flush).
+			template <class DisplaySurfaceData>
+			inline void _Async_finish_recorded(DisplaySurfaceData& data) {
+				if (data.async != nullptr) {
+					data.async->finish_recorded();
+				}
+			}
+
+			// Installs fn as the render thread's frame_finished notification unless one is already set.
+			template <class DisplaySurfaceData, class Fn>
+			inline void _Async_notify_frame_finished(DisplaySurfaceData& data, Fn&& fn) {
+				if (data.async != nullptr) {
+					::std::lock_guard<::std::mutex> lock(data.async->mutex);
+					if (!data.async->frame_finished) {
+						data.async->frame_finished = ::std::forward<Fn>(fn);
+					}
+				}
+			}
+
+			// Adds the extents of the draws recorded since firstDraw to the damage of the frame being recorded.
+			template <class DisplaySurfaceData>
+			inline void _Add_recorded_damage(DisplaySurfaceData& data, size_t firstDraw) {
+				if (!data.damage_tracking) {
+					return;
+				}
+				const auto& draws = data.async->recording.draws;
+				for (auto i = firstDraw; i < draws.size(); i++) {
+					_Add_damage(data.damage, draws[i].extents);
+				}
+			}
+
+			// Adds damage for a change made directly to the back buffer's pixels (see output_surface::mark_dirty).
+			template <class DisplaySurfaceData, class GraphicsMath>
+			inline void _Add_back_buffer_damage(DisplaySurfaceData& data, const optional<basic_bounding_box<GraphicsMath>>& extents) {
+				if (!data.damage_tracking) {
+					return;
+				}
+				if (data.async != nullptr) {
+					::std::lock_guard<::std::mutex> lock(data.async->mutex);
+					_Add_damage(data.async->front_damage, extents);
+				}
+				else {
+					_Add_damage(data.damage, extents);
+				}
+			}
+
+			// Ends the show once the frames drawn since begin_show used up its frame or time budget. Called after presenting, since
+			// ending the show can destroy the window.
+			template <class OutputDataType, class OutputSurfaceType>
+			inline void _End_show_if_budget_spent(OutputDataType& osd, OutputSurfaceType& sfc) {
+				if (osd->budget.spent()) {
+					sfc.end_show();
+				}
+			}
+
+			// Records the timing of the frame that _Present_frame finished. Whatever time it spent neither presenting nor in the
+			// present callback went into finishing the back buffer: flushing it or waiting for the render thread.
+			template <class OutputDataType>
+			inline void _Commit_frame_timing(OutputDataType& osd, ::std::chrono::steady_clock::time_point start, ::std::chrono::nanoseconds presentingBefore) {
+				auto& timing = osd->timing;
+				const auto flush = ::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now() - start) - (timing.presenting - presentingBefore);
+				const auto frame = timing.commit(::std::max(::std::chrono::nanoseconds{}, flush));
+				if (osd->frame_timing_callback != nullptr) {
+					osd->frame_timing_callback(frame);
+				}
+			}
+
+			template <class GraphicsMath>
+			template <class OutputDataType, class OutputSurfaceType>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Present_back_buffer(OutputDataType& osd, OutputSurfaceType& sfc) {
+				const auto start = ::std::chrono::steady_clock::now();
+				// Presenting clears the damage.
+				const auto damage = osd->data.damage;
+				{
+					_IO2D_TRACE_SPAN("_Render_to_native_surface");
+					_Render_to_native_surface(osd, sfc);
+				}
+				osd->timing.pending_present += ::std::chrono::steady_clock::now() - start;
+				auto& copy = osd->present_copy;
+				if (osd->present_callback == nullptr) {
+					// Frames presented without a callback aren't copied, so the copy would be stale.
+					copy = _Interchange_buffer{};
+				}
+				else {
+					auto& backBuffer = osd->data.back_buffer;
+					const int width = backBuffer.dimensions.x();
+					const int height = backBuffer.dimensions.y();
+					if (!osd->data.damage_tracking || damage.full || copy.width() != width || copy.height() != height || copy.data() == nullptr) {
+						copy = _Copy_to_interchange_buffer(backBuffer, _Interchange_buffer::pixel_layout::b8g8r8a8, _Interchange_buffer::alpha_mode::premultiplied);
+					}
+					else if (damage.area.has_value()) {
+						const auto& a = damage.area.value();
+						const auto left = ::std::max(0, static_cast<int>(::std::floor(a.x())));
+						const auto top = ::std::max(0, static_cast<int>(::std::floor(a.y())));
+						const auto right = ::std::min(width, static_cast<int>(::std::ceil(a.x() + a.width())));
+						const auto bottom = ::std::min(height, static_cast<int>(::std::ceil(a.y() + a.height())));
+						if (right > left && bottom > top) {
+							_Copy_to_interchange_buffer(backBuffer, cairo_rectangle_int_t{ left, top, right - left, bottom - top }, copy);
+						}
+					}
+					osd->present_callback(copy);
+				}
+				osd->timing.presenting += ::std::chrono::steady_clock::now() - start;
+			}
+
+			template <class GraphicsMath>
+			template <class OutputDataType, class OutputSurfaceType>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Present_frame(OutputDataType& osd, OutputSurfaceType& sfc) {
+				auto async = osd->data.async.get();
+				const auto start = ::std::chrono::steady_clock::now();
+				const auto presentingBefore = osd->timing.presenting;
+				osd->budget.frames_drawn++;
+				if (async == nullptr) {
+					// Flushed here so that finishing the back buffer's rendering is timed apart from presenting it.
+					cairo_surface_flush(osd->data.back_buffer.surface.get());
+					_Present_back_buffer(osd, sfc);
+					_Commit_frame_timing(osd, start, presentingBefore);
+					_End_show_if_budget_spent(osd, sfc);
+					return;
+				}
+				// The damage recorded so far belongs to the frame being submitted, not to the one being presented.
+				const auto recordedDamage = ::std::exchange(osd->data.damage, _Damage_region{});
+				::std::unique_lock<::std::mutex> lock(async->mutex);
+				if (async->chain.empty()) {
+					async->wait_idle(lock);
+					// The back buffer can't be presented while the next frame is being rasterized into it, so show the previous
+					// frame now; rasterizing this one then overlaps with the caller producing the frame after it.
+					if (async->frame_ready) {
+						async->frame_ready = false;
+						osd->data.damage = ::std::exchange(async->front_damage, _Damage_region{});
+						_Present_back_buffer(osd, sfc);
+					}
+					async->submit(lock, recordedDamage);
+					osd->data.damage = _Damage_region{};
+					lock.unlock();
+					_Commit_frame_timing(osd, start, presentingBefore);
+					_End_show_if_budget_spent(osd, sfc);
+					return;
+				}
+				// With two buffers the frame being rasterized has to finish before its buffer can be swapped out; with three
+				// the render thread always has a free buffer, so only the hand-off slot has to be empty.
+				const bool needsIdle = async->chain.size() < 2;
+				async->cv.wait(lock, [async, needsIdle]() { return !async->has_pending && !(needsIdle && async->busy); });
+				async->rethrow_error();
+				async->swap_in_ready();
+				const bool present = async->frame_ready;
+				async->frame_ready = false;
+				auto presentedDamage = present ? ::std::exchange(async->front_damage, _Damage_region{}) : _Damage_region{};
+				async->submit(lock, recordedDamage);
+				lock.unlock();
+				// The render thread only writes to swap chain buffers, so the back buffer is presented while it rasterizes.
+				if (present) {
+					osd->data.damage = presentedDamage;
+					_Present_back_buffer(osd, sfc);
+				}
+				osd->data.damage = _Damage_region{};
+				_Commit_frame_timing(osd, start, presentingBefore);
+				_End_show_if_budget_spent(osd, sfc);
+			}
+
+			template <class GraphicsMath>
+			template <class OutputDataType, class OutputSurfaceType>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Present_async_frame_if_ready(OutputDataType& osd, OutputSurfaceType& sfc) {
+				auto async = osd->data.async.get();
+				if (async == nullptr) {
+					return;
+				}
+				::std::unique_lock<::std::mutex> lock(async->mutex, ::std::try_to_lock);
+				if (!lock.owns_lock()) {
+					return;
+				}
+				const bool singleBuffer = async->chain.empty();
+				if (singleBuffer && (async->busy || async->has_pending)) {
+					return;
+				}
+				async->rethrow_error();
+				async->swap_in_ready();
+				if (!async->frame_ready) {
+					return;
+				}
+				async->frame_ready = false;
+				// Draws may already have been recorded for the next frame; their damage has to survive this present.
+				const auto recordedDamage = ::std::exchange(osd->data.damage, ::std::exchange(async->front_damage, _Damage_region{}));
+				if (!singleBuffer) {
+					lock.unlock();
+				}
+				_Present_back_buffer(osd, sfc);
+				osd->data.damage = recordedDamage;
+			}
+
+			template <class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::async_render(output_surface_data_type& data, bool val) {
+				auto& ds = data->data;
+				if (val == (ds.async != nullptr)) {
+					return;
+				}
+				if (val) {
+					ds.async = ::std::make_unique<_Async_renderer>(ds.back_buffer, ds.buffer_count);
+				}
+				else {
+					// Draws made since the last frame was handed off still belong in the back buffer.
+					ds.async->finish_recorded();
+					_Add_damage(ds.damage, ds.async->front_damage);
+					ds.async.reset();
+				}
+			}
+			template <class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::buffer_count(output_surface_data_type& data, int val) {
+				if (val < 1 || val > 3) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				auto& ds = data->data;
+				ds.buffer_count = val;
+				if (ds.async != nullptr) {
+					auto& async = *ds.async;
+					::std::unique_lock<::std::mutex> lock(async.mutex);
+					async.wait_idle(lock);
+					async.chain.clear();
+					async.chain.resize(static_cast<size_t>(val - 1));
+				}
+			}
+			template <class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::surfaces::async_render(const output_surface_data_type& data) noexcept {
+				return data->data.async != nullptr;
+			}
+			template <class GraphicsMath>
+			inline int _Cairo_graphics_surfaces<GraphicsMath>::surfaces::buffer_count(const output_surface_data_type& data) noexcept {
+				return data->data.buffer_count;
+			}
+			template <class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::frame_budget(output_surface_data_type& data, int val) {
+				if (val < 0) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				data->budget.frames = val;
+			}
+			template <class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::time_budget(output_surface_data_type& data, ::std::chrono::nanoseconds val) {
+				if (val.count() < 0) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				data->budget.time = val;
+			}
+			template <class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::present_callback(output_surface_data_type& data, function<void(const _Interchange_buffer&)> fn) {
+				data->present_callback = fn;
+			}
+			template <class GraphicsMath>
+			inline int _Cairo_graphics_surfaces<GraphicsMath>::surfaces::frame_budget(const output_surface_data_type& data) noexcept {
+				return data->budget.frames;
+			}
+			template <class GraphicsMath>
+			inline ::std::chrono::nanoseconds _Cairo_graphics_surfaces<GraphicsMath>::surfaces::time_budget(const output_surface_data_type& data) noexcept {
+				return data->budget.time;
+			}
+			template <class GraphicsMath>
+			inline async_render_stats _Cairo_graphics_surfaces<GraphicsMath>::surfaces::async_stats(const output_surface_data_type& data) noexcept {
+				auto async = data->data.async.get();
+				if (async == nullptr) {
+					return async_render_stats{};
+				}
+				::std::lock_guard<::std::mutex> lock(async->mutex);
+				return async->stats;
+			}
+		}
+	}
+}
@@ -421,6 +421,165 @@ namespace std::experimental::io2d {
 				return pixels;
 			}
 
+			// Wraps a surface decoded by the native codecs.
+			template <class ImageSurfaceData>
+			inline ImageSurfaceData _Image_surface_data_from_decoded(cairo_surface_t* sfc, io2d::format fmt) {
+				ImageSurfaceData data;
+				data.surface.reset(sfc);
+				data.context.reset(cairo_create(sfc));
+				data.dimensions.x(cairo_image_surface_get_width(sfc));
+				data.dimensions.y(cairo_image_surface_get_height(sfc));
+				data.format = fmt;
+				return data;
+			}
+
+			// Reduces an image that was decoded at full size so that neither side exceeds maxDimension (see
+			// _Reduce_image). Images that failed to load are returned as they are.
+			template <class ImageSurfaceData>
+			inline ImageSurfaceData _Reduce_image_surface_data(ImageSurfaceData&& data, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept {
+				if (ec || maxDimension <= 0) {
+					return ::std::move(data);
+				}
+				data.context.reset();
+				auto sfc = data.surface.release();
+				_Reduce_image(sfc, maxDimension, ec);
+				if (sfc == nullptr) {
+					return ImageSurfaceData{};
+				}
+				return _Image_surface_data_from_decoded<ImageSurfaceData>(sfc, fmt);
+			}
+
+#ifdef _IO2D_Has_Magick
+			// Copies an image read by GraphicsMagick into a new image surface.
+			template <class ImageSurfaceData>
+			inline ImageSurfaceData _Image_surface_data_from_magick_image(Image* image, io2d::format fmt, ExceptionInfo* exInfo, ::std::error_code& ec) noexcept {
+				ImageSurfaceData data;
+				auto width = image->columns;
+				auto height = image->rows;
+
+				data.surface = ::std::move(unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)>(cairo_image_surface_create(_Format_to_cairo_format_t(fmt), static_cast<int>(width), static_cast<int>(height)), &cairo_surface_destroy));
+				data.context = ::std::move(unique_ptr<cairo_t, decltype(&cairo_destroy)>(cairo_create(data.surface.get()), &cairo_destroy));
+				data.dimensions.x(static_cast<int>(width));
+				data.dimensions.y(static_cast<int>(height));
+				data.format = fmt;
+
+				// Note: We don't own the pixels pointer.
+				PixelPacket* pixels = GetImagePixelsEx(image, 0, 0, width, height, exInfo);
+				if (pixels == nullptr) {
+					ec = _Graphics_magic_exception_type_to_error_code(exInfo);
+					return ImageSurfaceData{};
+				}
+
+				auto map = cairo_surface_map_to_image(data.surface.get(), nullptr);
+				auto mapStride = cairo_image_surface_get_stride(map);
+				auto mapData = cairo_image_surface_get_data(map);
+				const auto channelMaxValue = static_cast<float>(numeric_limits<decltype(pixels->red)>::max());
+				if (image->matte != 0) {
+					for (unsigned long y = 0; y < height; y++) {
+						for (unsigned long x = 0; x < width; x++) {
+							const PixelPacket& currPixel = pixels[y * width + x];
+							auto red = static_cast<unsigned char>(currPixel.red * currPixel.opacity / channelMaxValue * 255);
+							auto green = static_cast<unsigned char>(currPixel.green * currPixel.opacity / channelMaxValue * 255);
+							auto blue = static_cast<unsigned char>(currPixel.blue * currPixel.opacity / channelMaxValue * 255);
+							auto alpha = static_cast<unsigned char>(currPixel.opacity / channelMaxValue * 255);
+							_Convert_and_set_pixel_to_io2d_format(fmt, mapData, static_cast<int>(y), static_cast<int>(x), mapStride, red, green, blue, alpha);
+						}
+					}
+				}
+				else {
+					for (unsigned long y = 0; y < height; y++) {
+						for (unsigned long x = 0; x < width; x++) {
+							const PixelPacket& currPixel = pixels[y * width + x];
+							auto red = static_cast<unsigned char>(currPixel.red / channelMaxValue * 255);
+							auto green = static_cast<unsigned char>(currPixel.green / channelMaxValue * 255);
+							auto blue = static_cast<unsigned char>(currPixel.blue / channelMaxValue * 255);
+							auto alpha = static_cast<unsigned char>(255);
+							_Convert_and_set_pixel_to_io2d_format(fmt, mapData, static_cast<int>(y), static_cast<int>(x), mapStride, red, green, blue, alpha);
+						}
+					}
+				}
+				cairo_surface_unmap_image(data.surface.get(), map);
+				cairo_surface_mark_dirty(data.surface.get());
+				if (cairo_surface_status(data.surface.get()) != CAIRO_STATUS_SUCCESS) {
+					ec = ::std::make_error_code(errc::operation_canceled);
+					return ImageSurfaceData{};
+				}
+				ec.clear();
+				return data;
+			}
+
+			// GraphicsMagick's coder name for iff, or nullptr if there isn't one. GraphicsSurfaces supplies the additional formats.
+			template <class GraphicsSurfaces>
+			inline const char* _Magick_format_name(image_file_format iff) noexcept {
+				using _Additional = typename GraphicsSurfaces::additional_image_file_formats;
+				switch (iff)
+				{
+				case std::experimental::io2d::v1::image_file_format::png:
+					return "PNG";
+				case std::experimental::io2d::v1::image_file_format::jpeg:
+					return "JPEG";
+				case std::experimental::io2d::v1::image_file_format::tiff:
+					return "TIFF";
+				default:
+					break;
+				}
+				const ::std::pair<image_file_format, const char*> additional[] = {
+					{ _Additional::bmp, "BMP" }, { _Additional::tga, "TGA" }, { _Additional::dib, "DIB" }, { _Additional::gif, "GIF" },
+					{ _Additional::pcx, "PCX" }, { _Additional::pbm, "PBM" }, { _Additional::pgm, "PGM" }, { _Additional::ppm, "PPM" },
+					{ _Additional::psd, "PSD" }, { _Additional::xbm, "XBM" }, { _Additional::xpm, "XPM" }
+				};
+				for (const auto& entry : additional) {
+					if (entry.first == iff) {
+						return entry.second;
+					}
+				}
+				return nullptr;
+			}
+
+			// Creates a GraphicsMagick image of the surface's pixels, set up along with imageInfo to be written as iff.
+			template <class GraphicsSurfaces, class ImageSurfaceData>
+			inline ::std::unique_ptr<Image, decltype(&DestroyImage)> _Magick_image_from_image_surface_data(ImageSurfaceData& data, image_file_format iff, ImageInfo* imageInfo, ExceptionInfo* exInfo, ::std::error_code& ec) noexcept {
+				const char* format = _Magick_format_name<GraphicsSurfaces>(iff);
+				if (format == nullptr) {
+					ec = make_error_code(iff == image_file_format::unknown ? errc::not_supported : errc::invalid_argument);
+					return { nullptr, &DestroyImage };
+				}
+				auto map = cairo_surface_map_to_image(data.surface.get(), nullptr);
+				auto mapStride = cairo_image_surface_get_stride(map);
+				auto mapData = cairo_image_surface_get_data(map);
+				auto width = data.dimensions.x();
+				auto height = data.dimensions.y();
+				auto pixelDataUP = _Convert_and_create_pixel_array_from_map_pixels<unsigned char>(data.format, mapData, width, height, mapStride);
+				cairo_surface_unmap_image(data.surface.get(), map);
+				::std::unique_ptr<Image, decltype(&DestroyImage)> image(ConstituteImage(static_cast<unsigned long>(width), static_cast<unsigned long>(height), "BGRA", CharPixel, pixelDataUP.get(), exInfo), &DestroyImage);
+				if (image == nullptr) {
+					ec = _Graphics_magic_exception_type_to_error_code(exInfo);
+					return image;
+				}
+				strncpy(imageInfo->magick, format, MaxTextExtent);
+				strncpy(image->magick, format, MaxTextExtent);
+				image->background_color = PixelPacket{};
+				imageInfo->background_color = PixelPacket{};
+				image->colorspace = TransparentColorspace;
+				imageInfo->colorspace = TransparentColorspace;
+				image->depth = 8;
+				imageInfo->depth = 8;
+				image->matte = 1;
+
+				image->matte_color = PixelPacket{};
+				imageInfo->matte_color = PixelPacket{};
+				image->orientation = TopLeftOrientation;
+
+				imageInfo->quality = 90;
+				image->units = PixelsPerInchResolution;
+				imageInfo->units = PixelsPerInchResolution;
+				image->x_resolution = 96.0;
+				image->y_resolution = 96.0;
+				ec.clear();
+				return image;
+			}
+#endif	// _IO2D_Has_Magick
+
 #if defined(_Filesystem_support_test)
 			template<class GraphicsMath>
 			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(filesystem::path p, image_file_format iff, io2d::format fmt) {
@@ -433,11 +592,37 @@ namespace std::experimental::io2d {
 			}
 			template<class GraphicsMath>
 			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(filesystem::path p, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept {
-				_Init_graphics_magic();
+				return create_image_surface(p, iff, fmt, 0, ec);
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(filesystem::path p, image_file_format iff, io2d::format fmt, int maxDimension) {
+				::std::error_code ec;
+				auto data = create_image_surface(p, iff, fmt, maxDimension, ec);
+				if (ec) {
+					throw ::std::system_error(ec);
+				}
+				return data;
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(filesystem::path p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept {
 				if (iff == image_file_format::unknown) {
 					ec = ::std::make_error_code(errc::not_supported);
 					return image_surface_data_type{};
 				}
+				cairo_surface_t* decoded = nullptr;
+				_Image_cache_ticket cacheTicket;
+				if (_Image_cache_find(p.string(), iff, fmt, maxDimension, decoded, cacheTicket)) {
+					ec.clear();
+					return _Image_surface_data_from_decoded<image_surface_data_type>(decoded, fmt);
+				}
+				if (_Native_decode_image(p.string(), iff, fmt, maxDimension, decoded, ec)) {
+					if (ec) {
+						return image_surface_data_type{};
+					}
+					_Image_cache_add(cacheTicket, decoded);
+					return _Image_surface_data_from_decoded<image_surface_data_type>(decoded, fmt);
+				}
+				_Init_graphics_magic();
 				ExceptionInfo exInfo;
 				GetExceptionInfo(&exInfo);
 
@@ -455,7 +640,12 @@ namespace std::experimental::io2d {
 				strncpy(imageInfo->filename, pathStr.c_str(), pathStr.length());
 				PixelPacket mattePixel{};
 				imageInfo->matte_color = mattePixel;
-				unique_ptr<Image, decltype(&DestroyImage)> image(ReadImage(imageInfo.get(), &exInfo), &DestroyImage);
+				Image* readImage;
+				{
+					_IO2D_TRACE_SPAN("ReadImage");
+					readImage = ReadImage(imageInfo.get(), &exInfo);
+				}
+				unique_ptr<Image, decltype(&DestroyImage)> image(readImage, &DestroyImage);
 				if (image == nullptr) {
 					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
 					DestroyExceptionInfo(&exInfo);
@@ -516,6 +706,10 @@ namespace std::experimental::io2d {
 					return image_surface_data_type{};
 				}
 				ec.clear();
+				data = _Reduce_image_surface_data(::std::move(data), fmt, maxDimension, ec);
+				if (!ec) {
+					_Image_cache_add(cacheTicket, data.surface.get());
+				}
 				return data;
 			}
 #else
@@ -529,20 +723,44 @@ namespace std::experimental::io2d {
 				}
 				return data;
 			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(::std::string p, image_file_format iff, io2d::format fmt, int maxDimension) {
+				::std::error_code ec;
+				auto data = create_image_surface(p, iff, fmt, maxDimension, ec);
+				if (ec) {
+					throw ::std::system_error(ec);
+				}
+				return data;
+			}
 
 #ifdef _IO2D_Has_Magick
 			template <class GraphicsMath>
 			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(::std::string p, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept {
-				_Init_graphics_magic();
+				return create_image_surface(p, iff, fmt, 0, ec);
+			}
+			template <class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(::std::string p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept {
 				if (iff == image_file_format::unknown) {
 					ec = ::std::make_error_code(errc::not_supported);
 					return image_surface_data_type{};
 				}
+				cairo_surface_t* decoded = nullptr;
+				_Image_cache_ticket cacheTicket;
+				if (_Image_cache_find(p, iff, fmt, maxDimension, decoded, cacheTicket)) {
+					ec.clear();
+					return _Image_surface_data_from_decoded<image_surface_data_type>(decoded, fmt);
+				}
+				if (_Native_decode_image(p, iff, fmt, maxDimension, decoded, ec)) {
+					if (ec) {
+						return image_surface_data_type{};
+					}
+					_Image_cache_add(cacheTicket, decoded);
+					return _Image_surface_data_from_decoded<image_surface_data_type>(decoded, fmt);
+				}
+				_Init_graphics_magic();
 				ExceptionInfo exInfo;
 				GetExceptionInfo(&exInfo);
 
-				image_surface_data_type data;
-
 				unique_ptr<ImageInfo, decltype(&DestroyImageInfo)> imageInfo(CloneImageInfo(nullptr), &DestroyImageInfo);
 				imageInfo->depth = 8;
 				imageInfo->colorspace = TransparentColorspace;
@@ -555,66 +773,23 @@ namespace std::experimental::io2d {
 				strncpy(imageInfo->filename, pathStr.c_str(), pathStr.length());
 				PixelPacket mattePixel{};
 				imageInfo->matte_color = mattePixel;
-				unique_ptr<Image, decltype(&DestroyImage)> image(ReadImage(imageInfo.get(), &exInfo), &DestroyImage);
-				if (image == nullptr) {
-					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
-					DestroyExceptionInfo(&exInfo);
-					return image_surface_data_type{};
+				Image* readImage;
+				{
+					_IO2D_TRACE_SPAN("ReadImage");
+					readImage = ReadImage(imageInfo.get(), &exInfo);
 				}
-				auto width = image->columns;
-				auto height = image->rows;
-
-				data.surface = ::std::move(unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)>(cairo_image_surface_create(_Format_to_cairo_format_t(fmt), width, height), &cairo_surface_destroy));
-				data.context = ::std::move(unique_ptr<cairo_t, decltype(&cairo_destroy)>(cairo_create(data.surface.get()), &cairo_destroy));
-				data.dimensions.x(width);
-				data.dimensions.y(height);
-				data.format = fmt;
-
-				// Note: We don't own the pixels pointer.
-				PixelPacket* pixels = GetImagePixelsEx(image.get(), 0, 0, width, height, &exInfo);
-				if (pixels == nullptr) {
+				unique_ptr<Image, decltype(&DestroyImage)> image(readImage, &DestroyImage);
+				if (image == nullptr) {
 					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
 					DestroyExceptionInfo(&exInfo);
 					return image_surface_data_type{};
 				}
-
+				auto data = _Image_surface_data_from_magick_image<image_surface_data_type>(image.get(), fmt, &exInfo, ec);
 				DestroyExceptionInfo(&exInfo);
-
-				auto map = cairo_surface_map_to_image(data.surface.get(), nullptr);
-				auto mapStride = cairo_image_surface_get_stride(map);
-				auto mapData = cairo_image_surface_get_data(map);
-				const auto channelMaxValue = static_cast<float>(numeric_limits<decltype(mattePixel.red)>::max());
-				if (image->matte != 0) {
-					for (unsigned long y = 0; y < height; y++) {
-						for (unsigned long x = 0; x < width; x++) {
-							const PixelPacket& currPixel = pixels[y * width + x];
-							auto red = static_cast<unsigned char>(currPixel.red * currPixel.opacity / channelMaxValue * 255);
-							auto green = static_cast<unsigned char>(currPixel.green * currPixel.opacity / channelMaxValue * 255);
-							auto blue = static_cast<unsigned char>(currPixel.blue * currPixel.opacity / channelMaxValue * 255);
-							auto alpha = static_cast<unsigned char>(currPixel.opacity / channelMaxValue * 255);
-							_Convert_and_set_pixel_to_io2d_format(fmt, mapData, y, x, mapStride, red, green, blue, alpha);
-						}
-					}
+				data = _Reduce_image_surface_data(::std::move(data), fmt, maxDimension, ec);
+				if (!ec) {
+					_Image_cache_add(cacheTicket, data.surface.get());
 				}
-				else {
-					for (unsigned long y = 0; y < height; y++) {
-						for (unsigned long x = 0; x < width; x++) {
-							const PixelPacket& currPixel = pixels[y * width + x];
-							auto red = static_cast<unsigned char>(currPixel.red / channelMaxValue * 255);
-							auto green = static_cast<unsigned char>(currPixel.green / channelMaxValue * 255);
-							auto blue = static_cast<unsigned char>(currPixel.blue / channelMaxValue * 255);
-							auto alpha = static_cast<unsigned char>(255);
-							_Convert_and_set_pixel_to_io2d_format(fmt, mapData, y, x, mapStride, red, green, blue, alpha);
-						}
-					}
-				}
-				cairo_surface_unmap_image(data.surface.get(), map);
-				cairo_surface_mark_dirty(data.surface.get());
-				if (cairo_surface_status(data.surface.get()) != CAIRO_STATUS_SUCCESS) {
-					ec = ::std::make_error_code(errc::operation_canceled);
-					return image_surface_data_type{};
-				}
-				ec.clear();
 				return data;
 			}
 #endif	// _IO2D_Has_Magick
@@ -639,26 +814,17 @@ namespace std::experimental::io2d {
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::save(image_surface_data_type& data, filesystem::path p, image_file_format iff, error_code& ec) noexcept {
-				_Init_graphics_magic();
 				if (iff == image_file_format::unknown) {
 					ec = make_error_code(errc::not_supported);
 					return;
 				}
+				if (_Native_encode_image(data.surface.get(), data.format, p.string(), iff, ec)) {
+					return;
+				}
+				_Init_graphics_magic();
 				ExceptionInfo exInfo;
 				GetExceptionInfo(&exInfo);
 
-				auto map = cairo_surface_map_to_image(data.surface.get(), nullptr);
-				auto mapStride = cairo_image_surface_get_stride(map);
-				auto mapData = cairo_image_surface_get_data(map);
-				auto width = data.dimensions.x();
-				auto height = data.dimensions.y();
-				auto pixelDataUP = _Convert_and_create_pixel_array_from_map_pixels<unsigned char>(data.format, mapData, width, height, mapStride);
-				::std::unique_ptr<Image, decltype(&DestroyImage)> image(ConstituteImage(static_cast<unsigned long>(width), static_cast<unsigned long>(height), "BGRA", CharPixel, pixelDataUP.get(), &exInfo), &DestroyImage);
-				if (image == nullptr) {
-					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
-					DestroyExceptionInfo(&exInfo);
-					return;
-				}
 				unique_ptr<ImageInfo, decltype(&DestroyImageInfo)> imageInfo(CloneImageInfo(nullptr), &DestroyImageInfo);
 				auto pathStr = p.string();
 				if (pathStr.length() > MaxTextExtent - 1) {
@@ -666,154 +832,20 @@ namespace std::experimental::io2d {
 					DestroyExceptionInfo(&exInfo);
 					return;
 				}
+				auto image = _Magick_image_from_image_surface_data<_Cairo_graphics_surfaces>(data, iff, imageInfo.get(), &exInfo, ec);
+				if (image == nullptr) {
+					DestroyExceptionInfo(&exInfo);
+					return;
+				}
 				strncpy(imageInfo->filename, pathStr.c_str(), pathStr.length());
 				strncpy(image->filename, pathStr.c_str(), pathStr.length());
-				switch (iff)
-				{
-#ifdef __clang__
-#pragma clang diagnostic push
-#pragma clang diagnostic ignored "-Wunreachable-code-break"
-#endif
-				case std::experimental::io2d::v1::image_file_format::unknown:
-				{
-					//if (p.has_extension()) {
 
-					//}
-					//else {
-					ec = make_error_code(errc::not_supported);
-					DestroyExceptionInfo(&exInfo);
-					//}
-					return;
-				} break;
-#ifdef __clang__
-#pragma clang diagnostic pop
-#endif
-				case std::experimental::io2d::v1::image_file_format::png:
-				{
-					const char format[] = "PNG";
-					const auto formatElemCount = ::std::extent_v<decltype(format)>;
-					strncpy(imageInfo->magick, format, formatElemCount);
-					strncpy(image->magick, format, formatElemCount);
-				} break;
-				case std::experimental::io2d::v1::image_file_format::jpeg:
-				{
-					const char format[] = "JPEG";
-					const auto formatElemCount = ::std::extent_v<decltype(format)>;
-					strncpy(imageInfo->magick, format, formatElemCount);
-					strncpy(image->magick, format, formatElemCount);
-				} break;
-				case std::experimental::io2d::v1::image_file_format::tiff:
-				{
-					const char format[] = "TIFF";
-					const auto formatElemCount = ::std::extent_v<decltype(format)>;
-					strncpy(imageInfo->magick, format, formatElemCount);
-					strncpy(image->magick, format, formatElemCount);
-				} break;
-				default:
+				unsigned int written;
 				{
-					if (iff == additional_image_file_formats::bmp) {
-						const char format[] = "BMP";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::tga) {
-						const char format[] = "TGA";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::dib) {
-						const char format[] = "DIB";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::gif) {
-						const char format[] = "GIF";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::pcx) {
-						const char format[] = "PCX";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::pbm) {
-						const char format[] = "PBM";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::pgm) {
-						const char format[] = "PGM";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::ppm) {
-						const char format[] = "PPM";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::psd) {
-						const char format[] = "PSD";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::xbm) {
-						const char format[] = "XBM";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					if (iff == additional_image_file_formats::xpm) {
-						const char format[] = "XPM";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					ec = make_error_code(errc::invalid_argument);
-					DestroyExceptionInfo(&exInfo);
-					return;
-				} break;
+					_IO2D_TRACE_SPAN("WriteImage");
+					written = WriteImage(imageInfo.get(), image.get());
 				}
-				image->background_color = PixelPacket{};
-				imageInfo->background_color = PixelPacket{};
-				image->colorspace = TransparentColorspace;
-				imageInfo->colorspace = TransparentColorspace;
-				image->depth = 8;
-				imageInfo->depth = 8;
-				image->matte = 1;
-
-				image->matte_color = PixelPacket{};
-				imageInfo->matte_color = PixelPacket{};
-				image->orientation = TopLeftOrientation;
-
-
-				imageInfo->quality = 90;
-				image->units = PixelsPerInchResolution;
-				imageInfo->units = PixelsPerInchResolution;
-				image->x_resolution = 96.0;
-
-				image->y_resolution = 96.0;
-
-				if (WriteImage(imageInfo.get(), image.get()) == MagickFail) {
+				if (written == MagickFail) {
 					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
 					DestroyExceptionInfo(&exInfo);
 					return;
@@ -836,26 +868,17 @@ namespace std::experimental::io2d {
 #ifdef _IO2D_Has_Magick
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::save(image_surface_data_type& data, ::std::string p, image_file_format iff, error_code& ec) noexcept {
-				_Init_graphics_magic();
 				if (iff == image_file_format::unknown) {
 					ec = make_error_code(errc::not_supported);
 					return;
 				}
+				if (_Native_encode_image(data.surface.get(), data.format, p, iff, ec)) {
+					return;
+				}
+				_Init_graphics_magic();
 				ExceptionInfo exInfo;
 				GetExceptionInfo(&exInfo);
 
-				auto map = cairo_surface_map_to_image(data.surface.get(), nullptr);
-				auto mapStride = cairo_image_surface_get_stride(map);
-				auto mapData = cairo_image_surface_get_data(map);
-				auto width = data.dimensions.x();
-				auto height = data.dimensions.y();
-				auto pixelDataUP = _Convert_and_create_pixel_array_from_map_pixels<unsigned char>(data.format, mapData, width, height, mapStride);
-				::std::unique_ptr<Image, decltype(&DestroyImage)> image(ConstituteImage(static_cast<unsigned long>(width), static_cast<unsigned long>(height), "BGRA", CharPixel, pixelDataUP.get(), &exInfo), &DestroyImage);
-				if (image == nullptr) {
-					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
-					DestroyExceptionInfo(&exInfo);
-					return;
-				}
 				unique_ptr<ImageInfo, decltype(&DestroyImageInfo)> imageInfo(CloneImageInfo(nullptr), &DestroyImageInfo);
 				auto& pathStr = p;
 				if (pathStr.length() > MaxTextExtent - 1) {
@@ -863,82 +886,154 @@ namespace std::experimental::io2d {
 					DestroyExceptionInfo(&exInfo);
 					return;
 				}
+				auto image = _Magick_image_from_image_surface_data<_Cairo_graphics_surfaces>(data, iff, imageInfo.get(), &exInfo, ec);
+				if (image == nullptr) {
+					DestroyExceptionInfo(&exInfo);
+					return;
+				}
 				strncpy(imageInfo->filename, pathStr.c_str(), pathStr.length());
 				strncpy(image->filename, pathStr.c_str(), pathStr.length());
-				switch (iff)
-				{
-				case std::experimental::io2d::v1::image_file_format::unknown:
-				{
-					//if (p.has_extension()) {
 
-					//}
-					//else {
-					ec = make_error_code(errc::not_supported);
+				unsigned int written;
+				{
+					_IO2D_TRACE_SPAN("WriteImage");
+					written = WriteImage(imageInfo.get(), image.get());
+				}
+				if (written == MagickFail) {
+					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
 					DestroyExceptionInfo(&exInfo);
-					//}
 					return;
-				} break;
-				case std::experimental::io2d::v1::image_file_format::png:
-				{
-					const char format[] = "PNG";
-					strncpy(imageInfo->magick, format, MaxTextExtent);
-					strncpy(image->magick, format, MaxTextExtent);
-				} break;
-				case std::experimental::io2d::v1::image_file_format::jpeg:
-				{
-					const char format[] = "JPEG";
+				}
+				DestroyExceptionInfo(&exInfo);
+				ec.clear();
+				return;
+			}
+#endif	// _IO2D_Has_Magick
+#endif
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt) {
+				::std::error_code ec;
+				auto data = create_image_surface(bytes, size, iff, fmt, ec);
+				if (ec) {
+					throw ::std::system_error(ec);
+				}
+				return data;
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension) {
+				::std::error_code ec;
+				auto data = create_image_surface(bytes, size, iff, fmt, maxDimension, ec);
+				if (ec) {
+					throw ::std::system_error(ec);
+				}
+				return data;
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::save(image_surface_data_type& data, const ::std::function<void(const ::std::byte*, size_t)>& sink, image_file_format iff) {
+				// The error_code overload turns anything the sink throws into errc::io_error, so its exceptions are caught
+				// on the way through and rethrown here.
+				::std::exception_ptr sinkException;
+				::std::error_code ec;
+				save(data, [&sink, &sinkException](const ::std::byte* bytes, size_t size) {
+					try {
+						sink(bytes, size);
+					}
+					catch (...) {
+						sinkException = ::std::current_exception();
+						throw;
+					}
+				}, iff, ec);
+				if (sinkException != nullptr) {
+					::std::rethrow_exception(sinkException);
+				}
+				if (ec) {
+					throw ::std::system_error(ec);
+				}
+			}
+
+#ifdef _IO2D_Has_Magick
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept {
+				return create_image_surface(bytes, size, iff, fmt, 0, ec);
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept {
+				if (iff == image_file_format::unknown) {
+					ec = ::std::make_error_code(errc::not_supported);
+					return image_surface_data_type{};
+				}
+				cairo_surface_t* decoded = nullptr;
+				if (_Native_decode_image(bytes, size, iff, fmt, maxDimension, decoded, ec)) {
+					return ec ? image_surface_data_type{} : _Image_surface_data_from_decoded<image_surface_data_type>(decoded, fmt);
+				}
+				_Init_graphics_magic();
+				ExceptionInfo exInfo;
+				GetExceptionInfo(&exInfo);
+
+				unique_ptr<ImageInfo, decltype(&DestroyImageInfo)> imageInfo(CloneImageInfo(nullptr), &DestroyImageInfo);
+				imageInfo->depth = 8;
+				imageInfo->colorspace = TransparentColorspace;
+				imageInfo->matte_color = PixelPacket{};
+				if (auto format = _Magick_format_name<_Cairo_graphics_surfaces>(iff); format != nullptr) {
 					strncpy(imageInfo->magick, format, MaxTextExtent);
-					strncpy(image->magick, format, MaxTextExtent);
-				} break;
-				case std::experimental::io2d::v1::image_file_format::tiff:
+				}
+				Image* readImage;
 				{
-					const char format[] = "TIFF";
-					strncpy(imageInfo->magick, format, MaxTextExtent);
-					strncpy(image->magick, format, MaxTextExtent);
-				}break;
-				default:
-					if (iff == additional_image_file_formats::bmp) {
-						const char format[] = "BMP";
-						const auto formatElemCount = ::std::extent_v<decltype(format)>;
-						strncpy(imageInfo->magick, format, formatElemCount);
-						strncpy(image->magick, format, formatElemCount);
-						break;
-					}
-					ec = make_error_code(errc::invalid_argument);
+					_IO2D_TRACE_SPAN("BlobToImage");
+					readImage = BlobToImage(imageInfo.get(), bytes, size, &exInfo);
+				}
+				unique_ptr<Image, decltype(&DestroyImage)> image(readImage, &DestroyImage);
+				if (image == nullptr) {
+					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
 					DestroyExceptionInfo(&exInfo);
+					return image_surface_data_type{};
+				}
+				auto data = _Image_surface_data_from_magick_image<image_surface_data_type>(image.get(), fmt, &exInfo, ec);
+				DestroyExceptionInfo(&exInfo);
+				return _Reduce_image_surface_data(::std::move(data), fmt, maxDimension, ec);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::save(image_surface_data_type& data, const ::std::function<void(const ::std::byte*, size_t)>& sink, image_file_format iff, error_code& ec) noexcept {
+				if (iff == image_file_format::unknown) {
+					ec = make_error_code(errc::not_supported);
 					return;
 				}
-				image->background_color = PixelPacket{};
-				imageInfo->background_color = PixelPacket{};
-				image->colorspace = TransparentColorspace;
-				imageInfo->colorspace = TransparentColorspace;
-				image->depth = 8;
-				imageInfo->depth = 8;
-				image->matte = 1;
-
-				image->matte_color = PixelPacket{};
-				imageInfo->matte_color = PixelPacket{};
-				image->orientation = TopLeftOrientation;
-
-
-				imageInfo->quality = 90;
-				image->units = PixelsPerInchResolution;
-				imageInfo->units = PixelsPerInchResolution;
-				image->x_resolution = 96.0;
-
-				image->y_resolution = 96.0;
+				if (_Native_encode_image(data.surface.get(), data.format, sink, iff, ec)) {
+					return;
+				}
+				_Init_graphics_magic();
+				ExceptionInfo exInfo;
+				GetExceptionInfo(&exInfo);
 
-				if (WriteImage(imageInfo.get(), image.get()) == MagickFail) {
+				unique_ptr<ImageInfo, decltype(&DestroyImageInfo)> imageInfo(CloneImageInfo(nullptr), &DestroyImageInfo);
+				auto image = _Magick_image_from_image_surface_data<_Cairo_graphics_surfaces>(data, iff, imageInfo.get(), &exInfo, ec);
+				if (image == nullptr) {
+					DestroyExceptionInfo(&exInfo);
+					return;
+				}
+				size_t length = 0;
+				void* blob;
+				{
+					_IO2D_TRACE_SPAN("ImageToBlob");
+					blob = ImageToBlob(imageInfo.get(), image.get(), &length, &exInfo);
+				}
+				unique_ptr<void, decltype(&MagickFree)> blobUP(blob, &MagickFree);
+				if (blobUP == nullptr) {
 					ec = _Graphics_magic_exception_type_to_error_code(&exInfo);
 					DestroyExceptionInfo(&exInfo);
 					return;
 				}
 				DestroyExceptionInfo(&exInfo);
+				try {
+					sink(static_cast<const ::std::byte*>(blobUP.get()), length);
+				}
+				catch (...) {
+					ec = make_error_code(errc::io_error);
+					return;
+				}
 				ec.clear();
-				return;
 			}
 #endif	// _IO2D_Has_Magick
-#endif
 			template<class GraphicsMath>
 			inline io2d::format _Cairo_graphics_surfaces<GraphicsMath>::surfaces::format(const image_surface_data_type& data) noexcept {
 				return data.format;
@@ -988,8 +1083,7 @@ namespace std::experimental::io2d {
 				auto context = data.context.get();
 				_Set_render_props(context, rp);
 				_Set_clip_props(context, cl);
-				_Set_brush_props(context, bp, b);
-				cairo_set_source(context, b.data().brush.get());
+				cairo_set_source(context, _Set_brush_props(context, bp, b));
 				cairo_paint(context);
 			}
 			template<class GraphicsMath>
@@ -997,11 +1091,11 @@ namespace std::experimental::io2d {
 				auto context = data.context.get();
 				_Set_render_props(context, rp);
 				_Set_clip_props(context, cl);
-				_Set_brush_props(context, bp, b);
 				_Set_stroke_props(context, sp, sp.max_miter_limit(), d);
-				cairo_set_source(context, b.data().brush.get());
+				cairo_set_source(context, _Set_brush_props(context, bp, b));
 				cairo_new_path(context);
 				cairo_append_path(context, ip.data().path.get());
+				_IO2D_TRACE_SPAN("cairo_stroke");
 				cairo_stroke(context);
 			}
 			template<class GraphicsMath>
@@ -1009,10 +1103,10 @@ namespace std::experimental::io2d {
 				auto context = data.context.get();
 				_Set_render_props(context, rp);
 				_Set_clip_props(context, cl);
-				_Set_brush_props(context, bp, b);
-				cairo_set_source(context, b.data().brush.get());
+				cairo_set_source(context, _Set_brush_props(context, bp, b));
 				cairo_new_path(context);
 				cairo_append_path(context, ip.data().path.get());
+				_IO2D_TRACE_SPAN("cairo_fill");
 				cairo_fill(context);
 			}
 			template<class GraphicsMath>
@@ -1020,39 +1114,84 @@ namespace std::experimental::io2d {
 				auto context = data.context.get();
 				_Set_render_props(context, rp);
 				_Set_clip_props(context, cl);
-				_Set_brush_props(context, bp, b);
+				auto source = _Set_brush_props(context, bp, b);
 				_Set_mask_props(mp, mb);
-				cairo_set_source(context, b.data().brush.get());
+				cairo_set_source(context, source);
 				cairo_new_path(context);
 				cairo_mask(context, mb.data().brush.get());
 			}
-            template<class GraphicsMath>
-            inline _Interchange_buffer _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Copy_to_interchange_buffer(image_surface_data_type& data, _Interchange_buffer::pixel_layout layout, _Interchange_buffer::alpha_mode alpha) {
-                auto fmt = data.format;
-                auto map = cairo_surface_map_to_image(data.surface.get(), nullptr);
-                auto stride = cairo_image_surface_get_stride(map);
-                auto pixels = cairo_image_surface_get_data(map);
-                auto width = data.dimensions.x();
-                auto height = data.dimensions.y();
-                auto src_layout = _Interchange_buffer::pixel_layout::r8g8b8a8;
-                auto src_alpha = _Interchange_buffer::alpha_mode::ignore;
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill_instances(image_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Draw_instances(data.context.get(), false, ip, first, last, bp, rp, cl);
+			}
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke_instances(image_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				auto context = data.context.get();
+				_Set_stroke_props(context, sp, sp.max_miter_limit(), d);
+				_Draw_instances(context, true, ip, first, last, bp, rp, cl);
+			}
+            // The interchange buffer layout of an image surface's pixels.
+            inline void _Interchange_source_layout(format fmt, _Interchange_buffer::pixel_layout& layout, _Interchange_buffer::alpha_mode& alpha) {
                 switch( fmt ) {
                     case format::argb32:
-                        src_layout = _Interchange_buffer::pixel_layout::b8g8r8a8;
-                        src_alpha = _Interchange_buffer::alpha_mode::premultiplied;
+                        layout = _Interchange_buffer::pixel_layout::b8g8r8a8;
+                        alpha = _Interchange_buffer::alpha_mode::premultiplied;
                         break;
                     case format::xrgb32:
-                        src_layout = _Interchange_buffer::pixel_layout::b8g8r8a8;
-                        src_alpha = _Interchange_buffer::alpha_mode::ignore;
+                        layout = _Interchange_buffer::pixel_layout::b8g8r8a8;
+                        alpha = _Interchange_buffer::alpha_mode::ignore;
                         break;
                     case format::a8:
-                        src_layout = _Interchange_buffer::pixel_layout::a8;
-                        src_alpha = _Interchange_buffer::alpha_mode::straight;
+                        layout = _Interchange_buffer::pixel_layout::a8;
+                        alpha = _Interchange_buffer::alpha_mode::straight;
                         break;
                     default:
                         throw make_error_code(errc::not_supported);
-                };                
+                };
+            }
+            template<class GraphicsMath>
+            inline _Interchange_buffer _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Copy_to_interchange_buffer(image_surface_data_type& data, _Interchange_buffer::pixel_layout layout, _Interchange_buffer::alpha_mode alpha) {
+                auto fmt = data.format;
+                auto src_layout = _Interchange_buffer::pixel_layout::r8g8b8a8;
+                auto src_alpha = _Interchange_buffer::alpha_mode::ignore;
+                _Interchange_source_layout(fmt, src_layout, src_alpha);
+                auto map = cairo_surface_map_to_image(data.surface.get(), nullptr);
+                auto stride = cairo_image_surface_get_stride(map);
+                auto pixels = cairo_image_surface_get_data(map);
+                auto width = data.dimensions.x();
+                auto height = data.dimensions.y();
                 return _Interchange_buffer{layout, alpha, (const byte*)pixels, src_layout, src_alpha, int(width), int(height), int(stride) };    
+            }
+            template<class GraphicsMath>
+            inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Copy_to_interchange_buffer(image_surface_data_type& data, const cairo_rectangle_int_t& r, _Interchange_buffer& target) {
+                assert(target.width() == data.dimensions.x() && target.height() == data.dimensions.y());
+                assert(r.x >= 0 && r.y >= 0 && r.x + r.width <= target.width() && r.y + r.height <= target.height());
+                if (r.width <= 0 || r.height <= 0) {
+                    return;
+                }
+                auto src_layout = _Interchange_buffer::pixel_layout::r8g8b8a8;
+                auto src_alpha = _Interchange_buffer::alpha_mode::ignore;
+                _Interchange_source_layout(data.format, src_layout, src_alpha);
+                // Only r is mapped and converted; its rows then go to the same place in target.
+                auto map = cairo_surface_map_to_image(data.surface.get(), &r);
+                _Interchange_buffer part;
+                try {
+                    part = _Interchange_buffer{ target.layout(), target.alpha(), (const byte*)cairo_image_surface_get_data(map), src_layout, src_alpha, r.width, r.height, cairo_image_surface_get_stride(map) };
+                }
+                catch (...) {
+                    cairo_surface_unmap_image(data.surface.get(), map);
+                    throw;
+                }
+                cairo_surface_unmap_image(data.surface.get(), map);
+                const auto rowBytes = static_cast<size_t>(part.stride());
+                const auto pixelBytes = part.stride() / r.width;
+                auto dest = target.data() + static_cast<ptrdiff_t>(r.y) * target.stride() + static_cast<ptrdiff_t>(r.x) * pixelBytes;
+                auto src = part.data();
+                for (int y = 0; y < r.height; ++y, dest += target.stride(), src += part.stride()) {
+                    ::std::memcpy(dest, src, rowBytes);
+                }
             }
 		}
 	}
@@ -26,6 +26,7 @@ namespace std::experimental::io2d {
 
 			template <class GraphicsMath>
 			inline void _Set_render_props(cairo_t* context, const basic_render_props<_Cairo_graphics_surfaces<GraphicsMath>>& r) {
+				_IO2D_TRACE_SPAN("_Set_render_props");
 				const auto& props = r;
 				const auto m = props.surface_matrix();
 				cairo_matrix_t cm{ m.m00(), m.m01(), m.m10(), m.m11(), m.m20(), m.m21() };
@@ -36,6 +37,7 @@ namespace std::experimental::io2d {
 
 			template <class GraphicsMath>
 			inline void _Set_clip_props(cairo_t* context, const basic_clip_props<_Cairo_graphics_surfaces<GraphicsMath>>& c) {
+				_IO2D_TRACE_SPAN("_Set_clip_props");
 				cairo_reset_clip(context);
 				const auto& props = c.data();
 				if (props.clip.has_value()) {
@@ -52,6 +54,7 @@ namespace std::experimental::io2d {
 
 			template <class GraphicsMath>
 			inline void _Set_stroke_props(cairo_t* context, const basic_stroke_props<_Cairo_graphics_surfaces<GraphicsMath>>& s, float miterMax, const basic_dashes<_Cairo_graphics_surfaces<GraphicsMath>>& ds) {
+				_IO2D_TRACE_SPAN("_Set_stroke_props");
 				const auto& props = s.data();
 				cairo_set_line_width(context, props._Line_width);
 				cairo_set_line_cap(context, _Line_cap_to_cairo_line_cap_t(props._Line_cap));
@@ -60,31 +63,71 @@ namespace std::experimental::io2d {
 
 				const auto& d = ds.data();
 				const auto& dFloatVal = d.pattern;
-				vector<double> dashAsDouble(dFloatVal.size());
-				for (const auto& val : dFloatVal) {
-					dashAsDouble.push_back(static_cast<double>(val));
+				// cairo wants the pattern as doubles. Typical patterns are converted on the stack so that stroking doesn't allocate.
+				array<double, 16> dashBuffer;
+				vector<double> dashVector;
+				double* dashAsDouble = dashBuffer.data();
+				if (dFloatVal.size() > dashBuffer.size()) {
+					dashVector.resize(dFloatVal.size());
+					dashAsDouble = dashVector.data();
 				}
-				cairo_set_dash(context, dashAsDouble.data(), _Container_size_to_int(dashAsDouble), static_cast<double>(d.offset));
+				::std::transform(dFloatVal.begin(), dFloatVal.end(), dashAsDouble, [](float val) { return static_cast<double>(val); });
+				cairo_set_dash(context, dashAsDouble, _Container_size_to_int(dFloatVal), static_cast<double>(d.offset));
 				if (cairo_status(context) == CAIRO_STATUS_INVALID_DASH) {
 					_Throw_if_failed_cairo_status_t(CAIRO_STATUS_INVALID_DASH);
 				}
 			}
 
+			// The mip level of a brush with levelCount levels after the full size image that best matches how much the pattern
+			// matrix cm and the context's CTM shrink it: the nearest power of two to the number of image pixels that one device
+			// pixel covers along the brush's more shrunk axis.
+			inline size_t _Choose_mip_level(cairo_t* context, const cairo_matrix_t& cm, size_t levelCount) noexcept {
+				cairo_matrix_t deviceToPattern;
+				cairo_get_matrix(context, &deviceToPattern);
+				if (cairo_matrix_invert(&deviceToPattern) != CAIRO_STATUS_SUCCESS) {
+					return 0;
+				}
+				cairo_matrix_multiply(&deviceToPattern, &deviceToPattern, &cm);
+				const auto scale = ::std::max(::std::hypot(deviceToPattern.xx, deviceToPattern.yx), ::std::hypot(deviceToPattern.xy, deviceToPattern.yy));
+				if (!(scale >= ::std::sqrt(2.0))) {
+					return 0;
+				}
+				return ::std::min(levelCount, static_cast<size_t>(::std::floor(::std::log2(scale) + 0.5)));
+			}
+
+			// Sets b's pattern up with bp and returns the pattern to draw with, which for a mipmapped surface brush is the
+			// level chosen for the CTM, so the render props must be set first.
 			template <class GraphicsMath>
-			inline void _Set_brush_props(cairo_t* context, const basic_brush_props<_Cairo_graphics_surfaces<GraphicsMath>>& bp, const basic_brush<_Cairo_graphics_surfaces<GraphicsMath>>& b) {
+			inline cairo_pattern_t* _Set_brush_props(cairo_t* context, const basic_brush_props<_Cairo_graphics_surfaces<GraphicsMath>>& bp, const basic_brush<_Cairo_graphics_surfaces<GraphicsMath>>& b) {
+				_IO2D_TRACE_SPAN("_Set_brush_props");
 				const auto& props = bp;
 				auto p = b.data().brush.get();
-				cairo_pattern_set_extend(p, _Extend_to_cairo_extend_t(props.wrap_mode()));
-				cairo_pattern_set_filter(p, _Filter_to_cairo_filter_t(props.filter()));
 				const auto& m = props.brush_matrix();
 				cairo_matrix_t cm{ m.m00(), m.m01(), m.m10(), m.m11(), m.m20(), m.m21() };
+				const auto& levels = b.data().mipLevels;
+				if (!levels.empty()) {
+					const auto level = _Choose_mip_level(context, cm, levels.size());
+					if (level > 0) {
+						// Level patterns are in the level's pixels, so scale the matrix down by the level's size over the full size.
+						p = levels[level - 1].get();
+						cairo_surface_t* levelSurface = nullptr;
+						cairo_pattern_get_surface(p, &levelSurface);
+						const auto fullSurface = b.data().imageSurface.get();
+						cairo_matrix_t toLevel;
+						cairo_matrix_init_scale(&toLevel, static_cast<double>(cairo_image_surface_get_width(levelSurface)) / cairo_image_surface_get_width(fullSurface), static_cast<double>(cairo_image_surface_get_height(levelSurface)) / cairo_image_surface_get_height(fullSurface));
+						cairo_matrix_multiply(&cm, &cm, &toLevel);
+					}
+				}
+				cairo_pattern_set_extend(p, _Extend_to_cairo_extend_t(props.wrap_mode()));
+				cairo_pattern_set_filter(p, _Filter_to_cairo_filter_t(props.filter()));
 				cairo_pattern_set_matrix(p, &cm);
 				cairo_set_fill_rule(context, _Fill_rule_to_cairo_fill_rule_t(props.fill_rule()));
-				//}
+				return p;
 			}
 
 			template <class GraphicsSurfaces>
 			inline void _Set_mask_props(const basic_mask_props<GraphicsSurfaces>& mp, const basic_brush<GraphicsSurfaces>& b) {
+				_IO2D_TRACE_SPAN("_Set_mask_props");
 				const auto& props = mp;
 				auto p = b.data().brush.get();
 				cairo_pattern_set_extend(p, _Extend_to_cairo_extend_t(props.wrap_mode()));
@@ -94,10 +137,331 @@ namespace std::experimental::io2d {
 				cairo_pattern_set_matrix(p, &cm);
 			}
 
+			// Draws ip once per instance, with the same result as an individual fill or stroke whose surface matrix
+			// is the instance matrix followed by rp's. Render and stroke state are set up once; each instance then
+			// only changes the CTM and the source (and the clip, when there is a clip path to transform). The source
+			// is set after the CTM so that it is locked to the instance's user space.
+			template <class GraphicsMath, class InputIterator>
+			inline void _Draw_instances(cairo_t* context, bool stroke, const basic_interpreted_path<_Cairo_graphics_surfaces<GraphicsMath>>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Cairo_graphics_surfaces<GraphicsMath>>& bp, const basic_render_props<_Cairo_graphics_surfaces<GraphicsMath>>& rp, const basic_clip_props<_Cairo_graphics_surfaces<GraphicsMath>>& cl) {
+				_Set_render_props(context, rp);
+				const bool clipPerInstance = cl.data().clip.has_value();
+				if (!clipPerInstance) {
+					_Set_clip_props(context, cl);
+				}
+				cairo_set_fill_rule(context, _Fill_rule_to_cairo_fill_rule_t(bp.fill_rule()));
+				const auto rm = rp.surface_matrix();
+				const auto path = ip.data().path.get();
+				cairo_pattern_t* lastPattern = nullptr;
+				cairo_pattern_t* source = nullptr;
+				for (; first != last; ++first) {
+					const auto& inst = *first;
+					const auto m = inst.matrix() * rm;
+					cairo_matrix_t cm{ m.m00(), m.m01(), m.m10(), m.m11(), m.m20(), m.m21() };
+					cairo_set_matrix(context, &cm);
+					if (clipPerInstance) {
+						_Set_clip_props(context, cl);
+					}
+					if (inst.has_brush()) {
+						const auto& b = inst.brush();
+						auto p = b.data().brush.get();
+						// A mipmapped brush's level depends on the instance's matrix.
+						if (p != lastPattern || !b.data().mipLevels.empty()) {
+							source = _Set_brush_props(context, bp, b);
+							lastPattern = p;
+						}
+						cairo_set_source(context, source);
+					}
+					else {
+						const auto c = inst.color();
+						cairo_set_source_rgba(context, c.r(), c.g(), c.b(), c.a());
+					}
+					cairo_new_path(context);
+					cairo_append_path(context, path);
+					if (stroke) {
+						_IO2D_TRACE_SPAN("cairo_stroke");
+						cairo_stroke(context);
+					}
+					else {
+						_IO2D_TRACE_SPAN("cairo_fill");
+						cairo_fill(context);
+					}
+				}
+			}
+
+			// Damage tracking for output surfaces
+
+			// Adds extents to a damage region; nullopt means the change can touch the whole surface.
+			template <class DamageRegion, class GraphicsMath>
+			inline void _Add_damage(DamageRegion& damage, const optional<basic_bounding_box<GraphicsMath>>& extents) {
+				if (damage.full) {
+					return;
+				}
+				if (!extents.has_value()) {
+					damage.full = true;
+					damage.area.reset();
+					return;
+				}
+				if (extents->width() <= 0.0f || extents->height() <= 0.0f) {
+					return;
+				}
+				if (!damage.area.has_value()) {
+					damage.area = extents;
+					return;
+				}
+				const auto& a = damage.area.value();
+				const auto left = ::std::min(a.x(), extents->x());
+				const auto top = ::std::min(a.y(), extents->y());
+				const auto right = ::std::max(a.x() + a.width(), extents->x() + extents->width());
+				const auto bottom = ::std::max(a.y() + a.height(), extents->y() + extents->height());
+				damage.area = basic_bounding_box<GraphicsMath>(left, top, right - left, bottom - top);
+			}
+
+			template <class DamageRegion>
+			inline void _Add_damage(DamageRegion& damage, const DamageRegion& other) {
+				if (other.full) {
+					damage.full = true;
+					damage.area.reset();
+				}
+				else if (other.area.has_value()) {
+					_Add_damage(damage, other.area);
+				}
+			}
+
+			// Rebuilds the cached presentation geometry when the display was invalidated and makes sure a pattern for the
+			// current back buffer surface exists. Only the user scaling callback path doesn't use it.
+			template <class DisplaySurfaceData>
+			inline void _Update_present_cache(DisplaySurfaceData& data) {
+				auto& cache = data.present_cache;
+				if (data.display_invalid) {
+					const double displayWidth = static_cast<double>(data.display_dimensions.x());
+					const double displayHeight = static_cast<double>(data.display_dimensions.y());
+					const double backBufferWidth = static_cast<double>(data.back_buffer.dimensions.x());
+					const double backBufferHeight = static_cast<double>(data.back_buffer.dimensions.y());
+					cairo_matrix_init_identity(&cache.matrix);
+					cache.paints_display = true;
+					cache.bar_count = 0;
+					if (data.scl != io2d::scaling::none && (backBufferWidth != displayWidth || backBufferHeight != displayHeight)) {
+						switch (data.scl) {
+						case io2d::scaling::letterbox:
+						case io2d::scaling::uniform:
+						{
+							// Only the back buffer's rectangle is drawn; scaling::uniform leaves the rest of the display untouched.
+							const auto whRatio = backBufferWidth / backBufferHeight;
+							const auto displayWHRatio = displayWidth / displayHeight;
+							cache.paints_display = false;
+							if (whRatio < displayWHRatio) {
+								const auto rectWidth = trunc(displayHeight * whRatio);
+								const auto rectX = trunc(abs(rectWidth - displayWidth) / 2.0);
+								const auto heightRatio = backBufferHeight / displayHeight;
+								cairo_matrix_init_scale(&cache.matrix, heightRatio, heightRatio);
+								cairo_matrix_translate(&cache.matrix, -rectX, 0.0);
+								cache.content = { rectX, 0.0, rectWidth, displayHeight };
+								cache.bars[0] = { 0.0, 0.0, rectX, displayHeight };
+								cache.bars[1] = { rectX + rectWidth, 0.0, displayWidth - rectX - rectWidth, displayHeight };
+							}
+							else {
+								const auto rectHeight = trunc(displayWidth / whRatio);
+								const auto rectY = trunc(abs(rectHeight - displayHeight) / 2.0);
+								const auto widthRatio = backBufferWidth / displayWidth;
+								cairo_matrix_init_scale(&cache.matrix, widthRatio, widthRatio);
+								cairo_matrix_translate(&cache.matrix, 0.0, -rectY);
+								cache.content = { 0.0, rectY, displayWidth, rectHeight };
+								cache.bars[0] = { 0.0, 0.0, displayWidth, rectY };
+								cache.bars[1] = { 0.0, rectY + rectHeight, displayWidth, displayHeight - rectY - rectHeight };
+							}
+							if (data.scl == io2d::scaling::letterbox) {
+								cache.bar_count = 2;
+							}
+						} break;
+						case io2d::scaling::fill_uniform:
+						{
+							// Maintain aspect ratio and center, but overflow if needed rather than letterboxing.
+							const auto widthRatio = displayWidth / backBufferWidth;
+							const auto heightRatio = displayHeight / backBufferHeight;
+							if (widthRatio < heightRatio) {
+								cairo_matrix_init_scale(&cache.matrix, 1.0 / heightRatio, 1.0 / heightRatio);
+								cairo_matrix_translate(&cache.matrix, trunc(abs((displayWidth - (backBufferWidth * heightRatio)) / 2.0)), 0.0);
+							}
+							else {
+								cairo_matrix_init_scale(&cache.matrix, 1.0 / widthRatio, 1.0 / widthRatio);
+								cairo_matrix_translate(&cache.matrix, 0.0, trunc(abs((displayHeight - (backBufferHeight * widthRatio)) / 2.0)));
+							}
+						} break;
+						case io2d::scaling::fill_exact:
+						{
+							cairo_matrix_init_scale(&cache.matrix, backBufferWidth / displayWidth, backBufferHeight / displayHeight);
+						} break;
+						default:
+						{
+							assert("Unexpected _Scaling value." && false);
+						} break;
+						}
+					}
+					for (auto& p : cache.patterns) {
+						if (p.pattern != nullptr) {
+							cairo_pattern_set_matrix(p.pattern.get(), &cache.matrix);
+						}
+					}
+				}
+				auto backBufferSfc = data.back_buffer.surface.get();
+				// Swapping a finished frame in makes another swap chain buffer the back buffer, which is looked up by surface
+				// below. A buffer that's been let go of since, e.g. because buffer_count or the back buffer's size changed,
+				// is only kept alive by its pattern, so that pattern is dropped.
+				for (auto& p : cache.patterns) {
+					if (p.surface != nullptr && p.surface != backBufferSfc && cairo_surface_get_reference_count(p.surface) == 1) {
+						p.pattern.reset();
+						p.surface = nullptr;
+					}
+				}
+				for (const auto& p : cache.patterns) {
+					if (p.surface == backBufferSfc) {
+						return;
+					}
+				}
+				// A cached pattern holds a reference to its surface, so a surface address is never reused while it is cached.
+				auto free = ::std::find_if(cache.patterns.begin(), cache.patterns.end(), [](const auto& cached) { return cached.surface == nullptr; });
+				if (free == cache.patterns.end()) {
+					free = cache.patterns.begin() + static_cast<ptrdiff_t>(cache.next_pattern);
+					cache.next_pattern = (cache.next_pattern + 1) % cache.patterns.size();
+				}
+				auto& p = *free;
+				p.pattern.reset(cairo_pattern_create_for_surface(backBufferSfc));
+				p.surface = backBufferSfc;
+				cairo_pattern_set_matrix(p.pattern.get(), &cache.matrix);
+				cairo_pattern_set_extend(p.pattern.get(), CAIRO_EXTEND_NONE);
+				cairo_pattern_set_filter(p.pattern.get(), CAIRO_FILTER_GOOD);
+			}
+
+			// Presents the back buffer with the rectangle chosen by a user scaling callback. Borrows the cached pattern instead of
+			// creating one per frame and puts its cached matrix and filter back afterwards.
+			template <class DisplaySurfaceData>
+			inline void _Present_user_scaled(DisplaySurfaceData& data, const cairo_matrix_t& m, cairo_filter_t filter) {
+				auto& cache = data.present_cache;
+				auto backBufferSfc = data.back_buffer.surface.get();
+				auto p = ::std::find_if(cache.patterns.begin(), cache.patterns.end(), [backBufferSfc](const auto& cached) { return cached.surface == backBufferSfc; });
+				assert(p != cache.patterns.end() && "_Update_present_cache wasn't called.");
+				auto pattern = p->pattern.get();
+				auto displayContext = data.display_context.get();
+				cairo_pattern_set_matrix(pattern, &m);
+				cairo_pattern_set_filter(pattern, filter);
+				cairo_set_source(displayContext, pattern);
+				cairo_paint(displayContext);
+				cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
+				cairo_pattern_set_matrix(pattern, &cache.matrix);
+				cairo_pattern_set_filter(pattern, CAIRO_FILTER_GOOD);
+			}
+
+			// Presents the back buffer with the cached pattern. The letterbox bars are only drawn when drawBars is set, i.e. after
+			// the display was invalidated, since nothing else draws over them.
+			template <class DisplaySurfaceData>
+			inline void _Present_cached(DisplaySurfaceData& data, bool drawBars) {
+				auto& cache = data.present_cache;
+				auto displayContext = data.display_context.get();
+				cairo_new_path(displayContext);
+				if (drawBars && cache.bar_count > 0) {
+					for (int i = 0; i < cache.bar_count; i++) {
+						cairo_rectangle(displayContext, cache.bars[i].x, cache.bars[i].y, cache.bars[i].width, cache.bars[i].height);
+					}
+					if (data._Letterbox_brush == nullopt) {
+						cairo_set_source_rgb(displayContext, 0.0, 0.0, 0.0);
+					}
+					else {
+						auto pttn = data._Letterbox_brush.value().data().brush.get();
+						cairo_matrix_t cPttnMatrix;
+						if (data._Letterbox_brush_props == nullopt) {
+							cairo_pattern_set_extend(pttn, CAIRO_EXTEND_NONE);
+							cairo_pattern_set_filter(pttn, CAIRO_FILTER_GOOD);
+							cairo_matrix_init_identity(&cPttnMatrix);
+						}
+						else {
+							const auto& props = data._Letterbox_brush_props.value();
+							cairo_pattern_set_extend(pttn, _Extend_to_cairo_extend_t(props.wrap_mode()));
+							cairo_pattern_set_filter(pttn, _Filter_to_cairo_filter_t(props.filter()));
+							const auto& m = props.brush_matrix();
+							cairo_matrix_init(&cPttnMatrix, m.m00(), m.m01(), m.m10(), m.m11(), m.m20(), m.m21());
+						}
+						cairo_pattern_set_matrix(pttn, &cPttnMatrix);
+						cairo_set_source(displayContext, pttn);
+					}
+					cairo_fill(displayContext); // Draws the letterbox brush into the bars. Note that this also clears the context path.
+				}
+				auto backBufferSfc = data.back_buffer.surface.get();
+				for (const auto& p : cache.patterns) {
+					if (p.surface == backBufferSfc) {
+						cairo_set_source(displayContext, p.pattern.get());
+						break;
+					}
+				}
+				if (cache.paints_display) {
+					cairo_paint(displayContext);
+				}
+				else {
+					cairo_rectangle(displayContext, cache.content.x, cache.content.y, cache.content.width, cache.content.height);
+					cairo_fill(displayContext);
+				}
+			}
+
+			// Returns false when the whole display has to be presented. Otherwise r is the part of the display that shows the
+			// damaged part of the back buffer, which may be empty. Uses the matrix cached by _Update_present_cache.
+			template <class DisplaySurfaceData>
+			inline bool _Display_damage_rect(const DisplaySurfaceData& data, cairo_rectangle_int_t& r) {
+				if (!data.damage_tracking || data.display_invalid || data.damage.full) {
+					return false;
+				}
+				r = { 0, 0, 0, 0 };
+				if (!data.damage.area.has_value()) {
+					return true;
+				}
+				auto m = data.present_cache.matrix;
+				if (cairo_matrix_invert(&m) != CAIRO_STATUS_SUCCESS) {
+					return false;
+				}
+				const auto& a = data.damage.area.value();
+				double xs[4] = { a.x(), a.x() + a.width(), a.x(), a.x() + a.width() };
+				double ys[4] = { a.y(), a.y(), a.y() + a.height(), a.y() + a.height() };
+				for (int i = 0; i < 4; i++) {
+					cairo_matrix_transform_point(&m, &xs[i], &ys[i]);
+				}
+				// Scaling filters sample neighbouring pixels, so pad by one.
+				auto left = ::std::max(0, static_cast<int>(::std::floor(*::std::min_element(xs, xs + 4))) - 1);
+				auto top = ::std::max(0, static_cast<int>(::std::floor(*::std::min_element(ys, ys + 4))) - 1);
+				auto right = ::std::min(data.display_dimensions.x(), static_cast<int>(::std::ceil(*::std::max_element(xs, xs + 4))) + 1);
+				auto bottom = ::std::min(data.display_dimensions.y(), static_cast<int>(::std::ceil(*::std::max_element(ys, ys + 4))) + 1);
+				// Only the content rectangle shows the back buffer. The SDL2 backend relies on this since it redraws every pixel of the
+				// rectangle it locks, and the letterbox bars are only drawn when the whole display is presented.
+				const auto& cache = data.present_cache;
+				if (!cache.paints_display) {
+					left = ::std::max(left, static_cast<int>(cache.content.x));
+					top = ::std::max(top, static_cast<int>(cache.content.y));
+					right = ::std::min(right, static_cast<int>(cache.content.x + cache.content.width));
+					bottom = ::std::min(bottom, static_cast<int>(cache.content.y + cache.content.height));
+				}
+				if (right > left && bottom > top) {
+					r = { left, top, right - left, bottom - top };
+				}
+				return true;
+			}
+
 			template<class GraphicsMath>
 			inline basic_display_point<GraphicsMath> _Cairo_graphics_surfaces<GraphicsMath>::surfaces::max_dimensions() noexcept {
 				return basic_display_point<GraphicsMath>(16384, 16384); // This takes up 1 GB of RAM, you probably don't want to do this. 2048x2048 is the max size for hardware that meets 9_1 specs (i.e. quite low powered or really old). Probably much more reasonable.
 			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::cache_budget(size_t bytes) noexcept {
+				_Image_cache_budget(bytes);
+			}
+			template<class GraphicsMath>
+			inline size_t _Cairo_graphics_surfaces<GraphicsMath>::surfaces::cache_budget() noexcept {
+				return _Image_cache_budget();
+			}
+			template<class GraphicsMath>
+			inline image_cache_stats _Cairo_graphics_surfaces<GraphicsMath>::surfaces::cache_stats() noexcept {
+				return _Image_cache_stats();
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::clear_cache() noexcept {
+				_Image_cache_clear();
+			}
 
 			template <class GraphicsMath>
 			inline basic_image_surface<_Cairo_graphics_surfaces<GraphicsMath>> _Cairo_graphics_surfaces<GraphicsMath>::surfaces::copy_surface(basic_image_surface<_Cairo_graphics_surfaces<GraphicsMath>>& sfc) noexcept {
@@ -131,3 +495,7 @@ namespace std::experimental::io2d {
 }
 
 #include "xcairo_surfaces_image_impl.h"
+#include "xcairo_surfaces_recorded_impl.h"
+#include "xcairo_surfaces_async_impl.h"
+#include "xcairo_surfaces_timing_impl.h"
+#include "xcairo_surfaces_tiled_impl.h"
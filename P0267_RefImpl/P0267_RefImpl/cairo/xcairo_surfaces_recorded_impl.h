@@ -0,0 +1,442 @@
+#pragma once
+#include "xcairo_surfaces_impl.h"
+#include "xcairo_helpers.h"
+
+#include <condition_variable>
+#include <thread>
+#include <mutex>
+#include <unordered_map>
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			// recorded_scene
+
+			// A tiny context that is only used to measure fill, stroke, and clip extents while recording.
+			inline cairo_t* _Recording_extents_context() {
+				thread_local ::std::unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> sfc{ cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1), &cairo_surface_destroy };
+				thread_local ::std::unique_ptr<cairo_t, decltype(&cairo_destroy)> ctx{ cairo_create(sfc.get()), &cairo_destroy };
+				return ctx.get();
+			}
+
+			// Converts user space extents on the current path's matrix to integer device space extents, padded by one pixel for antialiasing.
+			template <class GraphicsMath>
+			inline basic_bounding_box<GraphicsMath> _User_extents_to_device_extents(cairo_t* context, double x1, double y1, double x2, double y2) {
+				double xs[4] = { x1, x2, x1, x2 };
+				double ys[4] = { y1, y1, y2, y2 };
+				for (int i = 0; i < 4; i++) {
+					cairo_user_to_device(context, &xs[i], &ys[i]);
+				}
+				const auto left = ::std::floor(*::std::min_element(xs, xs + 4)) - 1.0;
+				const auto top = ::std::floor(*::std::min_element(ys, ys + 4)) - 1.0;
+				const auto right = ::std::ceil(*::std::max_element(xs, xs + 4)) + 1.0;
+				const auto bottom = ::std::ceil(*::std::max_element(ys, ys + 4)) + 1.0;
+				return basic_bounding_box<GraphicsMath>(static_cast<float>(left), static_cast<float>(top), static_cast<float>(right - left), static_cast<float>(bottom - top));
+			}
+
+			template <class GraphicsMath>
+			inline optional<basic_bounding_box<GraphicsMath>> _Intersect_extents(const optional<basic_bounding_box<GraphicsMath>>& a, const optional<basic_bounding_box<GraphicsMath>>& b) {
+				if (!a.has_value()) {
+					return b;
+				}
+				if (!b.has_value()) {
+					return a;
+				}
+				const auto left = ::std::max(a->x(), b->x());
+				const auto top = ::std::max(a->y(), b->y());
+				const auto right = ::std::max(left, ::std::min(a->x() + a->width(), b->x() + b->width()));
+				const auto bottom = ::std::max(top, ::std::min(a->y() + a->height(), b->y() + b->height()));
+				return basic_bounding_box<GraphicsMath>(left, top, right - left, bottom - top);
+			}
+
+			// Operators that modify destination pixels outside of the shape being drawn (see cairo's _cairo_operator_bounded_by_mask).
+			inline bool _Compositing_op_is_unbounded(compositing_op co) noexcept {
+				return co == compositing_op::in || co == compositing_op::out || co == compositing_op::dest_in || co == compositing_op::dest_atop;
+			}
+
+			template <class GraphicsMath>
+			inline optional<basic_bounding_box<GraphicsMath>> _Clip_device_extents(cairo_t* context, const basic_render_props<_Cairo_graphics_surfaces<GraphicsMath>>& rp, const basic_clip_props<_Cairo_graphics_surfaces<GraphicsMath>>& cl) {
+				const auto& props = cl.data();
+				if (!props.clip.has_value()) {
+					return nullopt;
+				}
+				_Set_render_props(context, rp);
+				cairo_new_path(context);
+				cairo_append_path(context, props.clip.value().data().path.get());
+				double x1, y1, x2, y2;
+				cairo_path_extents(context, &x1, &y1, &x2, &y2);
+				cairo_new_path(context);
+				return _User_extents_to_device_extents<GraphicsMath>(context, x1, y1, x2, y2);
+			}
+
+			template <class GraphicsMath>
+			inline optional<basic_bounding_box<GraphicsMath>> _Shape_device_extents(cairo_t* context, bool stroke, const basic_interpreted_path<_Cairo_graphics_surfaces<GraphicsMath>>& ip, const basic_render_props<_Cairo_graphics_surfaces<GraphicsMath>>& rp, const basic_clip_props<_Cairo_graphics_surfaces<GraphicsMath>>& cl) {
+				auto clipExtents = _Clip_device_extents(context, rp, cl);
+				if (_Compositing_op_is_unbounded(rp.compositing())) {
+					return clipExtents;
+				}
+				_Set_render_props(context, rp);
+				cairo_new_path(context);
+				cairo_append_path(context, ip.data().path.get());
+				double x1, y1, x2, y2;
+				if (stroke) {
+					cairo_stroke_extents(context, &x1, &y1, &x2, &y2);
+				}
+				else {
+					cairo_fill_extents(context, &x1, &y1, &x2, &y2);
+				}
+				cairo_new_path(context);
+				return _Intersect_extents<GraphicsMath>(_User_extents_to_device_extents<GraphicsMath>(context, x1, y1, x2, y2), clipExtents);
+			}
+
+			template <class GraphicsMath>
+			inline optional<basic_bounding_box<GraphicsMath>> _Fill_device_extents(const basic_interpreted_path<_Cairo_graphics_surfaces<GraphicsMath>>& ip, const basic_brush_props<_Cairo_graphics_surfaces<GraphicsMath>>& bp, const basic_render_props<_Cairo_graphics_surfaces<GraphicsMath>>& rp, const basic_clip_props<_Cairo_graphics_surfaces<GraphicsMath>>& cl) {
+				auto context = _Recording_extents_context();
+				cairo_set_fill_rule(context, _Fill_rule_to_cairo_fill_rule_t(bp.fill_rule()));
+				return _Shape_device_extents(context, false, ip, rp, cl);
+			}
+
+			template <class GraphicsMath>
+			inline optional<basic_bounding_box<GraphicsMath>> _Stroke_device_extents(const basic_interpreted_path<_Cairo_graphics_surfaces<GraphicsMath>>& ip, const basic_stroke_props<_Cairo_graphics_surfaces<GraphicsMath>>& sp, const basic_dashes<_Cairo_graphics_surfaces<GraphicsMath>>& d, const basic_render_props<_Cairo_graphics_surfaces<GraphicsMath>>& rp, const basic_clip_props<_Cairo_graphics_surfaces<GraphicsMath>>& cl) {
+				auto context = _Recording_extents_context();
+				_Set_stroke_props(context, sp, sp.max_miter_limit(), d);
+				return _Shape_device_extents(context, true, ip, rp, cl);
+			}
+
+			// Adds the extents of every instance of a path to a damage region. An input iterator can only be traversed once,
+			// so drawing through one damages the whole surface.
+			template <class DamageRegion, class InputIterator, class GraphicsSurfaces, class ExtentsFn>
+			inline void _Add_instances_damage(DamageRegion& damage, InputIterator first, InputIterator last, const basic_render_props<GraphicsSurfaces>& rp, ExtentsFn extents) {
+				if constexpr (is_base_of_v<forward_iterator_tag, typename iterator_traits<InputIterator>::iterator_category>) {
+					auto irp = rp;
+					for (; first != last; ++first) {
+						irp.surface_matrix((*first).matrix() * rp.surface_matrix());
+						_Add_damage(damage, extents(irp));
+					}
+				}
+				else {
+					damage.full = true;
+					damage.area.reset();
+				}
+			}
+
+			// Makes a pattern that draws the same as p but shares no mutable state with it, so that each worker can set brush props on its own copy.
+			inline cairo_pattern_t* _Clone_cairo_pattern(cairo_pattern_t* p) {
+				cairo_pattern_t* result = nullptr;
+				switch (cairo_pattern_get_type(p)) {
+				case CAIRO_PATTERN_TYPE_SOLID:
+				{
+					double r, g, b, a;
+					cairo_pattern_get_rgba(p, &r, &g, &b, &a);
+					result = cairo_pattern_create_rgba(r, g, b, a);
+				} break;
+				case CAIRO_PATTERN_TYPE_SURFACE:
+				{
+					cairo_surface_t* src = nullptr;
+					cairo_pattern_get_surface(p, &src);
+					if (cairo_surface_get_type(src) == CAIRO_SURFACE_TYPE_IMAGE) {
+						// Alias the pixels rather than sharing the cairo_surface_t; cairo's per-surface bookkeeping is not thread safe.
+						cairo_surface_flush(src);
+						auto alias = cairo_image_surface_create_for_data(cairo_image_surface_get_data(src), cairo_image_surface_get_format(src), cairo_image_surface_get_width(src), cairo_image_surface_get_height(src), cairo_image_surface_get_stride(src));
+						result = cairo_pattern_create_for_surface(alias);
+						cairo_surface_destroy(alias);
+					}
+					else {
+						result = cairo_pattern_create_for_surface(src);
+					}
+				} break;
+				case CAIRO_PATTERN_TYPE_LINEAR:
+				{
+					double x0, y0, x1, y1;
+					cairo_pattern_get_linear_points(p, &x0, &y0, &x1, &y1);
+					result = cairo_pattern_create_linear(x0, y0, x1, y1);
+				} break;
+				case CAIRO_PATTERN_TYPE_RADIAL:
+				{
+					double x0, y0, r0, x1, y1, r1;
+					cairo_pattern_get_radial_circles(p, &x0, &y0, &r0, &x1, &y1, &r1);
+					result = cairo_pattern_create_radial(x0, y0, r0, x1, y1, r1);
+				} break;
+				default:
+					return cairo_pattern_reference(p);
+				}
+				int stopCount = 0;
+				if (cairo_pattern_get_color_stop_count(p, &stopCount) == CAIRO_STATUS_SUCCESS) {
+					for (int i = 0; i < stopCount; i++) {
+						double offset, r, g, b, a;
+						cairo_pattern_get_color_stop_rgba(p, i, &offset, &r, &g, &b, &a);
+						cairo_pattern_add_color_stop_rgba(result, offset, r, g, b, a);
+					}
+				}
+				cairo_pattern_set_extend(result, cairo_pattern_get_extend(p));
+				cairo_pattern_set_filter(result, cairo_pattern_get_filter(p));
+				cairo_matrix_t cm;
+				cairo_pattern_get_matrix(p, &cm);
+				cairo_pattern_set_matrix(result, &cm);
+				_Throw_if_failed_cairo_status_t(cairo_pattern_status(result));
+				return result;
+			}
+
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::recorded_scene_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_recorded_scene() noexcept {
+				return recorded_scene_data_type{};
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::recorded_scene_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::copy_recorded_scene(const recorded_scene_data_type& data) {
+				return data;
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::recorded_scene_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::move_recorded_scene(recorded_scene_data_type&& data) noexcept {
+				return ::std::move(data);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::destroy(recorded_scene_data_type& /*data*/) noexcept {
+				// Do nothing; the recorded draws hold their resources via shared_ptr's.
+			}
+			template<class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::surfaces::empty(const recorded_scene_data_type& data) noexcept {
+				return data.draws.empty();
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::clear(recorded_scene_data_type& data) {
+				_Recorded_draw draw;
+				draw.op = _Recorded_op::clear;
+				// clear() paints through whatever clip the previous draw left on the context, so replay needs that draw's render and clip props.
+				if (!data.draws.empty()) {
+					draw.rp = data.draws.back().rp;
+					draw.cl = data.draws.back().cl;
+				}
+				draw.extents = _Clip_device_extents(_Recording_extents_context(), draw.rp, draw.cl);
+				data.draws.push_back(::std::move(draw));
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::paint(recorded_scene_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Recorded_draw draw;
+				draw.op = _Recorded_op::paint;
+				draw.b = b;
+				draw.bp = bp;
+				draw.rp = rp;
+				draw.cl = cl;
+				draw.extents = _Clip_device_extents(_Recording_extents_context(), rp, cl);
+				data.draws.push_back(::std::move(draw));
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke(recorded_scene_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Recorded_draw draw;
+				draw.op = _Recorded_op::stroke;
+				draw.b = b;
+				draw.ip = ip;
+				draw.bp = bp;
+				draw.sp = sp;
+				draw.d = d;
+				draw.rp = rp;
+				draw.cl = cl;
+				draw.extents = _Stroke_device_extents(ip, sp, d, rp, cl);
+				data.draws.push_back(::std::move(draw));
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill(recorded_scene_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Recorded_draw draw;
+				draw.op = _Recorded_op::fill;
+				draw.b = b;
+				draw.ip = ip;
+				draw.bp = bp;
+				draw.rp = rp;
+				draw.cl = cl;
+				draw.extents = _Fill_device_extents(ip, bp, rp, cl);
+				data.draws.push_back(::std::move(draw));
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mask(recorded_scene_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush<_Graphics_surfaces_type>& mb, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_mask_props<_Graphics_surfaces_type>& mp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Recorded_draw draw;
+				draw.op = _Recorded_op::mask;
+				draw.b = b;
+				draw.mb = mb;
+				draw.bp = bp;
+				draw.mp = mp;
+				draw.rp = rp;
+				draw.cl = cl;
+				draw.extents = _Clip_device_extents(_Recording_extents_context(), rp, cl);
+				data.draws.push_back(::std::move(draw));
+			}
+			// Instances are recorded as individual draws so that each one is culled against the tiles on its own.
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill_instances(recorded_scene_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				auto irp = rp;
+				for (; first != last; ++first) {
+					const auto& inst = *first;
+					irp.surface_matrix(inst.matrix() * rp.surface_matrix());
+					fill(data, inst.has_brush() ? inst.brush() : basic_brush<_Graphics_surfaces_type>(inst.color()), ip, bp, irp, cl);
+				}
+			}
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke_instances(recorded_scene_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				auto irp = rp;
+				for (; first != last; ++first) {
+					const auto& inst = *first;
+					irp.surface_matrix(inst.matrix() * rp.surface_matrix());
+					stroke(data, inst.has_brush() ? inst.brush() : basic_brush<_Graphics_surfaces_type>(inst.color()), ip, bp, sp, d, irp, cl);
+				}
+			}
+
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::render_tiled(image_surface_data_type& data, const recorded_scene_data_type& rs, int tileWidth, int tileHeight, unsigned int threadCount) {
+				if (tileWidth < 1 || tileHeight < 1) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				auto target = data.surface.get();
+				if (cairo_surface_get_type(target) != CAIRO_SURFACE_TYPE_IMAGE) {
+					throw ::std::system_error(::std::make_error_code(errc::not_supported));
+				}
+				const auto width = data.dimensions.x();
+				const auto height = data.dimensions.y();
+				const auto cfmt = cairo_image_surface_get_format(target);
+				const int bytesPerPixel = (cfmt == CAIRO_FORMAT_A8) ? 1 : 4;
+				// Keep every tile's first pixel 4 byte aligned, which pixman requires.
+				tileWidth = (tileWidth + 3) / 4 * 4;
+
+				struct _Tile {
+					int x;
+					int y;
+					int w;
+					int h;
+				};
+				::std::vector<_Tile> tiles;
+				for (int y = 0; y < height; y += tileHeight) {
+					for (int x = 0; x < width; x += tileWidth) {
+						tiles.push_back({ x, y, ::std::min(tileWidth, width - x), ::std::min(tileHeight, height - y) });
+					}
+				}
+				if (threadCount == 0) {
+					threadCount = ::std::max(1U, ::std::thread::hardware_concurrency());
+				}
+				threadCount = ::std::min(threadCount, static_cast<unsigned int>(tiles.size()));
+
+				cairo_surface_flush(target);
+				auto pixels = cairo_image_surface_get_data(target);
+				const auto stride = cairo_image_surface_get_stride(target);
+
+				::std::atomic<size_t> nextTile{ 0 };
+				::std::mutex errorMutex;
+				::std::exception_ptr error;
+
+				auto worker = [&]() {
+					try {
+						// Each worker replays with its own copies of the brushes because setting brush props mutates the cairo_pattern_t.
+						::std::unordered_map<cairo_pattern_t*, basic_brush<_Graphics_surfaces_type>> brushes;
+						auto localBrush = [&brushes](const basic_brush<_Graphics_surfaces_type>& b) -> const basic_brush<_Graphics_surfaces_type>& {
+							auto key = b.data().brush.get();
+							auto it = brushes.find(key);
+							if (it == brushes.end()) {
+								basic_brush<_Graphics_surfaces_type> copy(b);
+								copy.data().brush = shared_ptr<cairo_pattern_t>(_Clone_cairo_pattern(key), &cairo_pattern_destroy);
+								for (auto& level : copy.data().mipLevels) {
+									level = shared_ptr<cairo_pattern_t>(_Clone_cairo_pattern(level.get()), &cairo_pattern_destroy);
+								}
+								it = brushes.emplace(key, ::std::move(copy)).first;
+							}
+							return it->second;
+						};
+
+						for (auto i = nextTile++; i < tiles.size(); i = nextTile++) {
+							const auto& tile = tiles[i];
+							// An image surface aliasing the target's pixels. Unlike a cairo_surface_create_for_rectangle sub-surface it shares no bookkeeping with the target, so tiles can be drawn concurrently.
+							image_surface_data_type tileData;
+							tileData.surface.reset(cairo_image_surface_create_for_data(pixels + static_cast<ptrdiff_t>(tile.y) * stride + tile.x * bytesPerPixel, cfmt, tile.w, tile.h, stride));
+							_Throw_if_failed_cairo_status_t(cairo_surface_status(tileData.surface.get()));
+							cairo_surface_set_device_offset(tileData.surface.get(), -tile.x, -tile.y);
+							tileData.context.reset(cairo_create(tileData.surface.get()));
+							tileData.dimensions.x(tile.w);
+							tileData.dimensions.y(tile.h);
+							tileData.format = data.format;
+
+							for (const auto& draw : rs.draws) {
+								if (draw.extents.has_value()) {
+									const auto& e = draw.extents.value();
+									if (e.x() >= tile.x + tile.w || e.y() >= tile.y + tile.h || e.x() + e.width() <= tile.x || e.y() + e.height() <= tile.y) {
+										continue;
+									}
+								}
+								switch (draw.op) {
+								case _Recorded_op::clear:
+								{
+									_Set_render_props(tileData.context.get(), draw.rp);
+									_Set_clip_props(tileData.context.get(), draw.cl);
+									clear(tileData);
+								} break;
+								case _Recorded_op::paint:
+								{
+									paint(tileData, localBrush(draw.b.value()), draw.bp, draw.rp, draw.cl);
+								} break;
+								case _Recorded_op::stroke:
+								{
+									stroke(tileData, localBrush(draw.b.value()), draw.ip, draw.bp, draw.sp, draw.d, draw.rp, draw.cl);
+								} break;
+								case _Recorded_op::fill:
+								{
+									fill(tileData, localBrush(draw.b.value()), draw.ip, draw.bp, draw.rp, draw.cl);
+								} break;
+								case _Recorded_op::mask:
+								{
+									mask(tileData, localBrush(draw.b.value()), localBrush(draw.mb.value()), draw.bp, draw.mp, draw.rp, draw.cl);
+								} break;
+								}
+							}
+							cairo_surface_flush(tileData.surface.get());
+						}
+					}
+					catch (...) {
+						::std::lock_guard<::std::mutex> lock(errorMutex);
+						if (!error) {
+							error = ::std::current_exception();
+						}
+						nextTile = tiles.size();
+					}
+				};
+
+				// The other workers run on the shared thread pool. Any that haven't started by the time this thread runs out
+				// of tiles are told to skip, so a pool that's busy (or a call made from a pool thread) doesn't hold this up.
+				struct _Tile_workers {
+					::std::mutex mutex;
+					::std::condition_variable idle;
+					unsigned int active = 0;
+					bool closed = false;
+				};
+				auto workers = ::std::make_shared<_Tile_workers>();
+				try {
+					for (unsigned int i = 1; i < threadCount; i++) {
+						_Thread_pool::instance().submit([workers, &worker]() {
+							{
+								::std::lock_guard<::std::mutex> lock(workers->mutex);
+								if (workers->closed) {
+									return;
+								}
+								++workers->active;
+							}
+							worker();
+							::std::lock_guard<::std::mutex> lock(workers->mutex);
+							if (--workers->active == 0) {
+								workers->idle.notify_all();
+							}
+						}, threadCount - 1);
+					}
+				}
+				catch (...) {
+					// Couldn't queue every worker; the ones that were queued and this thread draw all of the tiles anyway.
+				}
+				worker();
+				{
+					::std::unique_lock<::std::mutex> lock(workers->mutex);
+					workers->closed = true;
+					workers->idle.wait(lock, [&workers]() { return workers->active == 0; });
+				}
+				cairo_surface_mark_dirty(target);
+				if (error) {
+					::std::rethrow_exception(error);
+				}
+			}
+		}
+	}
+}
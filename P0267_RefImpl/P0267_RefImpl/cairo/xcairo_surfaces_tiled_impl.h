@@ -0,0 +1,201 @@
+#pragma once
+#include "xcairo_surfaces_impl.h"
+#include "xcairo_helpers.h"
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			// tiled_image_surface
+
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::tiled_image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::create_tiled_image_surface(io2d::format fmt, int width, int height, int tileSize) {
+				return ::std::make_unique<_Tiled_image>(_Format_to_cairo_format_t(fmt), width, height, tileSize);
+			}
+			template<class GraphicsMath>
+			inline typename _Cairo_graphics_surfaces<GraphicsMath>::surfaces::tiled_image_surface_data_type _Cairo_graphics_surfaces<GraphicsMath>::surfaces::move_tiled_image_surface(tiled_image_surface_data_type&& data) noexcept {
+				return move(data);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::destroy(tiled_image_surface_data_type& data) noexcept {
+				data.reset();
+			}
+#ifdef _Filesystem_support_test
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::page_to(tiled_image_surface_data_type& data, filesystem::path p, size_t residentBytes) {
+				data->page_to(p.string(), residentBytes);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::save(tiled_image_surface_data_type& data, filesystem::path p, image_file_format iff) {
+				::std::error_code ec;
+				save(data, p, iff, ec);
+				if (ec) {
+					throw ::std::system_error(ec);
+				}
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::save(tiled_image_surface_data_type& data, filesystem::path p, image_file_format iff, error_code& ec) noexcept {
+				if (iff != image_file_format::tiff) {
+					ec = make_error_code(errc::not_supported);
+					return;
+				}
+				data->save_tiff(p.string(), ec);
+			}
+#else
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::page_to(tiled_image_surface_data_type& data, ::std::string p, size_t residentBytes) {
+				data->page_to(p, residentBytes);
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::save(tiled_image_surface_data_type& data, ::std::string p, image_file_format iff) {
+				::std::error_code ec;
+				save(data, p, iff, ec);
+				if (ec) {
+					throw ::std::system_error(ec);
+				}
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::save(tiled_image_surface_data_type& data, ::std::string p, image_file_format iff, error_code& ec) noexcept {
+				if (iff != image_file_format::tiff) {
+					ec = make_error_code(errc::not_supported);
+					return;
+				}
+				data->save_tiff(p, ec);
+			}
+#endif
+			template<class GraphicsMath>
+			inline io2d::format _Cairo_graphics_surfaces<GraphicsMath>::surfaces::format(const tiled_image_surface_data_type& data) noexcept {
+				return _Cairo_format_t_to_format(data->format());
+			}
+			template<class GraphicsMath>
+			inline basic_display_point<GraphicsMath> _Cairo_graphics_surfaces<GraphicsMath>::surfaces::dimensions(const tiled_image_surface_data_type& data) noexcept {
+				return basic_display_point<GraphicsMath>(data->width(), data->height());
+			}
+			template<class GraphicsMath>
+			inline int _Cairo_graphics_surfaces<GraphicsMath>::surfaces::tile_size(const tiled_image_surface_data_type& data) noexcept {
+				return data->tile_size();
+			}
+			template<class GraphicsMath>
+			inline size_t _Cairo_graphics_surfaces<GraphicsMath>::surfaces::allocated_tiles(const tiled_image_surface_data_type& data) noexcept {
+				return data->allocated_tiles();
+			}
+			template<class GraphicsMath>
+			inline size_t _Cairo_graphics_surfaces<GraphicsMath>::surfaces::resident_tiles(const tiled_image_surface_data_type& data) noexcept {
+				return data->resident_tiles();
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::clear(tiled_image_surface_data_type& data) {
+				data->clear();
+			}
+
+			template<class GraphicsMath>
+			template <class DrawFn>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Draw_tiled(tiled_image_surface_data_type& data, const optional<basic_bounding_box<GraphicsMath>>& extents, DrawFn draw) {
+				auto& img = *data;
+				const auto size = img.tile_size();
+				int firstColumn = 0;
+				int lastColumn = img.columns() - 1;
+				int firstRow = 0;
+				int lastRow = img.rows() - 1;
+				if (extents.has_value()) {
+					const auto& e = extents.value();
+					const auto left = ::std::max(0.0, ::std::floor(static_cast<double>(e.x())));
+					const auto top = ::std::max(0.0, ::std::floor(static_cast<double>(e.y())));
+					const auto right = ::std::min(static_cast<double>(img.width()), ::std::ceil(static_cast<double>(e.x()) + e.width()));
+					const auto bottom = ::std::min(static_cast<double>(img.height()), ::std::ceil(static_cast<double>(e.y()) + e.height()));
+					if (left >= right || top >= bottom) {
+						return;
+					}
+					firstColumn = static_cast<int>(left) / size;
+					lastColumn = (static_cast<int>(right) - 1) / size;
+					firstRow = static_cast<int>(top) / size;
+					lastRow = (static_cast<int>(bottom) - 1) / size;
+				}
+				const auto cfmt = img.format();
+				for (int row = firstRow; row <= lastRow; row++) {
+					for (int column = firstColumn; column <= lastColumn; column++) {
+						// As in render_tiled, an image surface over the tile's pixels whose device offset puts it at the tile's place in the image.
+						auto pixels = img.tile(column, row, true);
+						image_surface_data_type tileData;
+						tileData.surface.reset(cairo_image_surface_create_for_data(pixels, cfmt, img.tile_width(column), img.tile_height(row), img.tile_stride(column)));
+						_Throw_if_failed_cairo_status_t(cairo_surface_status(tileData.surface.get()));
+						cairo_surface_set_device_offset(tileData.surface.get(), -column * static_cast<double>(size), -row * static_cast<double>(size));
+						tileData.context.reset(cairo_create(tileData.surface.get()));
+						tileData.dimensions.x(img.tile_width(column));
+						tileData.dimensions.y(img.tile_height(row));
+						tileData.format = _Cairo_format_t_to_format(cfmt);
+						draw(tileData);
+						cairo_surface_flush(tileData.surface.get());
+					}
+				}
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::paint(tiled_image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Draw_tiled(data, _Clip_device_extents(_Recording_extents_context(), rp, cl), [&](image_surface_data_type& tile) {
+					paint(tile, b, bp, rp, cl);
+				});
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke(tiled_image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Draw_tiled(data, _Stroke_device_extents(ip, sp, d, rp, cl), [&](image_surface_data_type& tile) {
+					stroke(tile, b, ip, bp, sp, d, rp, cl);
+				});
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill(tiled_image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_interpreted_path<_Graphics_surfaces_type>& ip, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Draw_tiled(data, _Fill_device_extents(ip, bp, rp, cl), [&](image_surface_data_type& tile) {
+					fill(tile, b, ip, bp, rp, cl);
+				});
+			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mask(tiled_image_surface_data_type& data, const basic_brush<_Graphics_surfaces_type>& b, const basic_brush<_Graphics_surfaces_type>& mb, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_mask_props<_Graphics_surfaces_type>& mp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Draw_tiled(data, _Clip_device_extents(_Recording_extents_context(), rp, cl), [&](image_surface_data_type& tile) {
+					mask(tile, b, mb, bp, mp, rp, cl);
+				});
+			}
+
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::copy_region(tiled_image_surface_data_type& data, int x, int y, image_surface_data_type& dst) {
+				auto& img = *data;
+				auto target = dst.surface.get();
+				const auto cfmt = img.format();
+				if (cairo_image_surface_get_format(target) != cfmt) {
+					throw ::std::system_error(::std::make_error_code(errc::invalid_argument));
+				}
+				const int bytesPerPixel = (cfmt == CAIRO_FORMAT_A8) ? 1 : (cfmt == CAIRO_FORMAT_RGB16_565) ? 2 : 4;
+				cairo_surface_flush(target);
+				auto out = cairo_image_surface_get_data(target);
+				const auto stride = cairo_image_surface_get_stride(target);
+				const auto width = cairo_image_surface_get_width(target);
+				const auto height = cairo_image_surface_get_height(target);
+				::std::memset(out, 0, static_cast<size_t>(stride) * static_cast<size_t>(height));
+
+				const auto size = img.tile_size();
+				const auto left = ::std::max<int64_t>(x, 0);
+				const auto top = ::std::max<int64_t>(y, 0);
+				const auto right = ::std::min<int64_t>(static_cast<int64_t>(x) + width, img.width());
+				const auto bottom = ::std::min<int64_t>(static_cast<int64_t>(y) + height, img.height());
+				if (left < right && top < bottom) {
+					for (auto row = static_cast<int>(top / size); row <= static_cast<int>((bottom - 1) / size); row++) {
+						for (auto column = static_cast<int>(left / size); column <= static_cast<int>((right - 1) / size); column++) {
+							auto pixels = img.tile(column, row, false);
+							if (pixels == nullptr) {
+								continue;
+							}
+							const int64_t tileX = static_cast<int64_t>(column) * size;
+							const int64_t tileY = static_cast<int64_t>(row) * size;
+							const auto x0 = ::std::max(left, tileX);
+							const auto x1 = ::std::min(right, tileX + img.tile_width(column));
+							const auto y0 = ::std::max(top, tileY);
+							const auto y1 = ::std::min(bottom, tileY + img.tile_height(row));
+							const auto tileStride = img.tile_stride(column);
+							for (auto py = y0; py < y1; py++) {
+								::std::memcpy(out + (py - y) * stride + (x0 - x) * bytesPerPixel, pixels + (py - tileY) * tileStride + (x0 - tileX) * bytesPerPixel, static_cast<size_t>(x1 - x0) * bytesPerPixel);
+							}
+						}
+					}
+				}
+				cairo_surface_mark_dirty(target);
+			}
+		}
+	}
+}
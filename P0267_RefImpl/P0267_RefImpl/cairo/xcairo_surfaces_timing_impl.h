@@ -0,0 +1,109 @@
+#pragma once
+#include "xcairo_surfaces_impl.h"
+
+#include <array>
+#include <atomic>
+
+namespace std::experimental::io2d {
+	inline namespace v1 {
+		namespace _Cairo {
+			// frame timing
+
+			// The timings of an output surface's most recent frames. Only the thread that runs begin_show writes to it, while
+			// frame_stats can read it from any thread without taking a lock. A slot that is overwritten while it is read can
+			// mix the values of two frames, which doesn't matter for percentiles.
+			struct _Frame_timing_ring {
+				static constexpr size_t capacity = 256;
+				struct _Slot {
+					::std::atomic<int64_t> events{ 0 };
+					::std::atomic<int64_t> draw{ 0 };
+					::std::atomic<int64_t> flush{ 0 };
+					::std::atomic<int64_t> present{ 0 };
+				};
+				::std::array<_Slot, capacity> slots;
+				// Number of frames committed so far. Slot count % capacity is written next.
+				::std::atomic<uint64_t> count{ 0 };
+
+				// Phases of the frame in progress; only touched by the thread that runs begin_show.
+				::std::chrono::nanoseconds pending_events{};
+				::std::chrono::nanoseconds pending_draw{};
+				::std::chrono::nanoseconds pending_present{};
+				// Total time spent presenting frames and in the present callback, which _Present_frame doesn't count as flushing.
+				::std::chrono::nanoseconds presenting{};
+				::std::chrono::steady_clock::time_point last_commit{};
+
+				// Adds the time from start (but not from before the previous frame was committed) to the current frame.
+				void add_events(::std::chrono::steady_clock::time_point start) noexcept {
+					pending_events += ::std::chrono::steady_clock::now() - ::std::max(start, last_commit);
+				}
+				void add_draw(::std::chrono::steady_clock::time_point start) noexcept {
+					pending_draw += ::std::chrono::steady_clock::now() - ::std::max(start, last_commit);
+				}
+
+				frame_timing commit(::std::chrono::nanoseconds flush) noexcept {
+					frame_timing result;
+					result.events = pending_events;
+					result.draw = pending_draw;
+					result.flush = flush;
+					result.present = pending_present;
+					result.total = result.events + result.draw + result.flush + result.present;
+					const auto index = count.load(::std::memory_order_relaxed);
+					auto& slot = slots[index % capacity];
+					slot.events.store(result.events.count(), ::std::memory_order_relaxed);
+					slot.draw.store(result.draw.count(), ::std::memory_order_relaxed);
+					slot.flush.store(result.flush.count(), ::std::memory_order_relaxed);
+					slot.present.store(result.present.count(), ::std::memory_order_relaxed);
+					count.store(index + 1, ::std::memory_order_release);
+					pending_events = pending_draw = pending_present = ::std::chrono::nanoseconds{};
+					last_commit = ::std::chrono::steady_clock::now();
+					return result;
+				}
+
+				frame_timing_stats stats() const noexcept {
+					frame_timing_stats result;
+					result.frames = count.load(::std::memory_order_acquire);
+					const auto sampleCount = static_cast<size_t>(::std::min<uint64_t>(result.frames, capacity));
+					result.sample_count = static_cast<int>(sampleCount);
+					if (sampleCount == 0) {
+						return result;
+					}
+					::std::array<::std::array<int64_t, capacity>, 5> values;
+					for (size_t i = 0; i < sampleCount; i++) {
+						const auto& slot = slots[i];
+						values[0][i] = slot.events.load(::std::memory_order_relaxed);
+						values[1][i] = slot.draw.load(::std::memory_order_relaxed);
+						values[2][i] = slot.flush.load(::std::memory_order_relaxed);
+						values[3][i] = slot.present.load(::std::memory_order_relaxed);
+						values[4][i] = values[0][i] + values[1][i] + values[2][i] + values[3][i];
+					}
+					frame_timing_stats::percentiles* phases[5] = { &result.events, &result.draw, &result.flush, &result.present, &result.total };
+					for (size_t phase = 0; phase < 5; phase++) {
+						auto first = values[phase].begin();
+						auto last = first + static_cast<ptrdiff_t>(sampleCount);
+						// Nearest rank: the smallest value that at least p percent of the samples don't exceed.
+						auto percentile = [&](size_t p) {
+							const auto rank = ::std::max<size_t>(1, (p * sampleCount + 99) / 100);
+							auto nth = first + static_cast<ptrdiff_t>(rank - 1);
+							::std::nth_element(first, nth, last);
+							return ::std::chrono::nanoseconds(*nth);
+						};
+						phases[phase]->p50 = percentile(50);
+						phases[phase]->p95 = percentile(95);
+						phases[phase]->p99 = percentile(99);
+						phases[phase]->max = ::std::chrono::nanoseconds(*::std::max_element(first, last));
+					}
+					return result;
+				}
+			};
+
+			template <class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::frame_timing_callback(output_surface_data_type& data, function<void(const frame_timing&)> fn) {
+				data->frame_timing_callback = fn;
+			}
+			template <class GraphicsMath>
+			inline frame_timing_stats _Cairo_graphics_surfaces<GraphicsMath>::surfaces::frame_stats(const output_surface_data_type& data) noexcept {
+				return data->timing.stats();
+			}
+		}
+	}
+}
@@ -116,6 +116,11 @@ namespace std::experimental::io2d {
 				} break;
 				default:
 				{
+					// Sent when the server is done with the pixels of an XShmPutImage (see _Xshm_image).
+					const auto& shm = sfc->data()->data.shm;
+					if (shm != nullptr && xev->type == shm->completion_type) {
+						return _Xshm_completion_matches(*shm, sfc->data()->data.wndw, *xev) ? True : False;
+					}
 					// Per the X protocol, types 64 through 127 are reserved for extensions.
 					// We only care about non-extension xevs since we likely should be aware of those and should handle them.
 					// So we only return True if it is not an extension xev.
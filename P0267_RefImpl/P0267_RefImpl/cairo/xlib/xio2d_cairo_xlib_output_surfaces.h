@@ -4,13 +4,165 @@
 #include <X11/Xlib.h>
 #include <X11/Xutil.h>
 #include <X11/Xatom.h>
+#include <X11/extensions/XShm.h>
 #include <cairo-xlib.h>
+#include <sys/ipc.h>
+#include <sys/shm.h>
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+#include <cerrno>
 
 namespace std::experimental::io2d {
 	inline namespace v1 {
 		namespace _Cairo {
 			// output surface functions
             
+            // Owns a POSIX file descriptor.
+            struct _Unique_fd {
+                int fd = -1;
+                _Unique_fd() noexcept = default;
+                explicit _Unique_fd(int f) noexcept : fd(f) {}
+                _Unique_fd(_Unique_fd&& other) noexcept : fd(::std::exchange(other.fd, -1)) {}
+                _Unique_fd& operator=(_Unique_fd&& other) noexcept {
+                    reset(::std::exchange(other.fd, -1));
+                    return *this;
+                }
+                ~_Unique_fd() {
+                    reset();
+                }
+                void reset(int f = -1) noexcept {
+                    if (fd >= 0) {
+                        ::close(fd);
+                    }
+                    fd = f;
+                }
+            };
+            
+            inline void _Signal_event_fd(int fd) noexcept {
+                const uint64_t one = 1;
+                while (::write(fd, &one, sizeof(one)) < 0 && errno == EINTR) {
+                }
+            }
+            
+            // A MIT-SHM XImage that the display surface draws into. XShmPutImage presents it without sending the pixels through
+            // the X connection.
+            struct _Xshm_image {
+                ::Display* display = nullptr;
+                XShmSegmentInfo info{};
+                XImage* image = nullptr;
+                GC gc = nullptr;
+                bool attached = false;
+                // Type of the XShmCompletionEvent sent when the server is done reading the pixels.
+                int completion_type = 0;
+                // Set from XShmPutImage until its XShmCompletionEvent arrives. The pixels must not be drawn to meanwhile.
+                bool busy = false;
+                
+                _Xshm_image() noexcept = default;
+                _Xshm_image(const _Xshm_image&) = delete;
+                _Xshm_image& operator=(const _Xshm_image&) = delete;
+                ~_Xshm_image() {
+                    if (gc != nullptr) {
+                        XFreeGC(display, gc);
+                    }
+                    if (image != nullptr) {
+                        if (attached) {
+                            // Requests are processed in order, so a pending XShmPutImage still reads the segment.
+                            XShmDetach(display, &info);
+                        }
+                        image->data = nullptr;
+                        XDestroyImage(image);
+                    }
+                    if (info.shmaddr != nullptr) {
+                        shmdt(info.shmaddr);
+                    }
+                }
+            };
+            
+            inline bool _Xshm_attach_failed = false;
+            inline int _Xshm_attach_error_handler(::Display*, XErrorEvent*) {
+                _Xshm_attach_failed = true;
+                return 0;
+            }
+            
+            // Creates a shared memory image with the window's dimensions. Returns nullptr when MIT-SHM can't be used, e.g. when the
+            // X server is remote, doesn't have the extension or uses a visual whose pixels don't match cairo's RGB24 format.
+            inline ::std::unique_ptr<_Xshm_image> _Create_xshm_image(::Display* display, Window wndw, Visual* visual, int width, int height) {
+                if (width <= 0 || height <= 0 || XShmQueryExtension(display) == False) {
+                    return nullptr;
+                }
+                const int screenNumber = DefaultScreen(display);
+                const uint32_t one = 1;
+                const int nativeByteOrder = (*reinterpret_cast<const unsigned char*>(&one) == 1) ? LSBFirst : MSBFirst;
+                if (DefaultDepth(display, screenNumber) != 24 || visual->red_mask != 0xff0000 || visual->green_mask != 0xff00 || visual->blue_mask != 0xff) {
+                    return nullptr;
+                }
+                auto result = ::std::make_unique<_Xshm_image>();
+                result->display = display;
+                result->info.shmaddr = nullptr;
+                result->image = XShmCreateImage(display, visual, 24, ZPixmap, nullptr, &result->info, static_cast<unsigned int>(width), static_cast<unsigned int>(height));
+                if (result->image == nullptr || result->image->bits_per_pixel != 32 || result->image->byte_order != nativeByteOrder || result->image->bytes_per_line % 4 != 0) {
+                    return nullptr;
+                }
+                result->info.shmid = shmget(IPC_PRIVATE, static_cast<size_t>(result->image->bytes_per_line) * static_cast<size_t>(height), IPC_CREAT | 0600);
+                if (result->info.shmid < 0) {
+                    return nullptr;
+                }
+                auto addr = shmat(result->info.shmid, nullptr, 0);
+                if (addr == reinterpret_cast<void*>(-1)) {
+                    shmctl(result->info.shmid, IPC_RMID, nullptr);
+                    return nullptr;
+                }
+                result->info.shmaddr = result->image->data = static_cast<char*>(addr);
+                result->info.readOnly = False;
+                // XShmAttach fails asynchronously (e.g. with BadAccess on a remote server), so sync with the error handler swapped.
+                XSync(display, False);
+                _Xshm_attach_failed = false;
+                auto previousHandler = XSetErrorHandler(&_Xshm_attach_error_handler);
+                const auto attached = XShmAttach(display, &result->info);
+                XSync(display, False);
+                XSetErrorHandler(previousHandler);
+                // Marked for removal right away so that the segment goes away with the last process that has it attached.
+                shmctl(result->info.shmid, IPC_RMID, nullptr);
+                if (attached == False || _Xshm_attach_failed) {
+                    return nullptr;
+                }
+                result->attached = true;
+                XGCValues gcValues{};
+                gcValues.graphics_exposures = False;
+                result->gc = XCreateGC(display, wndw, GCGraphicsExposures, &gcValues);
+                result->completion_type = XShmGetEventBase(display) + ShmCompletion;
+                return result;
+            }
+            
+            // True if ev is the completion event of an XShmPutImage of shm's segment to wndw. Other windows on the same
+            // connection get their own completion events, which must be left for them.
+            inline bool _Xshm_completion_matches(const _Xshm_image& shm, Window wndw, const XEvent& ev) noexcept {
+                if (ev.type != shm.completion_type) {
+                    return false;
+                }
+                const auto& completion = reinterpret_cast<const XShmCompletionEvent&>(ev);
+                return completion.drawable == static_cast<Drawable>(wndw) && completion.shmseg == shm.info.shmseg;
+            }
+            
+            // Waits until the server has read the pixels of the last XShmPutImage. Only this surface's completion event is
+            // taken off the queue; everything else stays queued in order.
+            inline void _Xshm_wait_idle(_Xshm_image& shm, Window wndw) {
+                struct _Match {
+                    const _Xshm_image* shm;
+                    Window wndw;
+                } match{ &shm, wndw };
+                XEvent xev;
+                if (shm.busy) {
+                    XIfEvent(shm.display, &xev, [](::Display*, XEvent* ev, XPointer arg) -> Bool {
+                        const auto& m = *reinterpret_cast<const _Match*>(arg);
+                        return _Xshm_completion_matches(*m.shm, m.wndw, *ev) ? True : False;
+                    }, reinterpret_cast<XPointer>(&match));
+                    shm.busy = false;
+                }
+            }
+            
             template<class GraphicsMath>
             struct _Cairo_graphics_surfaces<GraphicsMath>::surfaces::_Display_surface_data_type {
                 unique_ptr<Display, decltype(&XCloseDisplay)> display{ nullptr, &XCloseDisplay };
@@ -18,6 +170,10 @@ namespace std::experimental::io2d {
                 Window wndw = None;
                 Visual* visual; // Note: This pointer is not a dynamic allocation and thus does not need to be managed.
                 bool unmanaged = false;
+                // Created by begin_show. poll() waits on the X connection, the timer that signals when the next refresh_style::fixed
+                // frame is due and the wake event, which is signalled by redraw_required(true) and by a finished async frame.
+                _Unique_fd frame_timer;
+                _Unique_fd wake_event;
                 bool letterbox_brush_is_default = true;
                 optional<basic_brush<_Graphics_surfaces_type>> _Letterbox_brush;
                 optional<basic_brush_props<_Graphics_surfaces_type>> _Letterbox_brush_props;
@@ -25,12 +181,23 @@ namespace std::experimental::io2d {
                 optional<basic_brush<_Graphics_surfaces_type>> _Default_letterbox_brush;
                 
                 basic_display_point<GraphicsMath> display_dimensions;
+                // Set when the display surface is an image over MIT-SHM memory rather than a cairo Xlib surface. Declared before
+                // display_surface so that it outlives it.
+                ::std::unique_ptr<_Xshm_image> shm;
                 ::std::unique_ptr<cairo_surface_t, decltype(&cairo_surface_destroy)> display_surface{ nullptr, &cairo_surface_destroy };
                 ::std::unique_ptr<cairo_t, decltype(&cairo_destroy)> display_context{ nullptr, &cairo_destroy };
                 
                 image_surface_data_type back_buffer;
+                // Set while async_render is on. Declared after back_buffer so that the render thread stops before the back buffer is destroyed.
+                ::std::unique_ptr<_Async_renderer> async;
                 
                 bool auto_clear = false;
+                int buffer_count = 1;
+                bool damage_tracking = false;
+                // Set when the whole display has to be presented, e.g. after an expose or a resize.
+                bool display_invalid = true;
+                _Damage_region damage;
+                _Present_cache present_cache;
                 io2d::scaling scl = io2d::scaling::letterbox;
                 io2d::refresh_style rr = io2d::refresh_style::as_fast_as_possible;
                 float refresh_fps = 30.0f;
@@ -45,6 +212,12 @@ namespace std::experimental::io2d {
                 ::std::function<void(basic_output_surface<_Graphics_surfaces_type>&)> draw_callback;
                 ::std::function<void(basic_output_surface<_Graphics_surfaces_type>&)> size_change_callback;
                 ::std::function<basic_bounding_box<GraphicsMath>(const basic_output_surface<_Graphics_surfaces_type>&, bool&)> user_scaling_callback;
+                ::std::function<void(const _Interchange_buffer&)> present_callback;
+                // What present_callback is handed. Kept between frames so that with damage_tracking only the damaged part is copied again.
+                _Interchange_buffer present_copy;
+                _Show_budget budget;
+                ::std::function<void(const frame_timing&)> frame_timing_callback;
+                _Frame_timing_ring timing;
             };
 
             template<class GraphicsMath>
@@ -148,6 +321,7 @@ namespace std::experimental::io2d {
 			}
 			template <class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::destroy(output_surface_data_type& data) noexcept {
+				data->data.async.reset();
 				destroy(data->data.back_buffer);
                 delete data;
 			}
@@ -173,9 +347,24 @@ namespace std::experimental::io2d {
 
 				data.back_buffer = ::std::move(create_image_surface(data.back_buffer.format, data.back_buffer.dimensions.x(), data.back_buffer.dimensions.y()));
 
+				if (data.frame_timer.fd < 0) {
+					data.frame_timer.reset(timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC));
+					if (data.frame_timer.fd < 0) {
+						throw system_error(errno, system_category());
+					}
+				}
+				if (data.wake_event.fd < 0) {
+					data.wake_event.reset(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC));
+					if (data.wake_event.fd < 0) {
+						throw system_error(errno, system_category());
+					}
+				}
+				const int wakeFd = data.wake_event.fd;
+
 				bool exit = false;
 				XEvent xev;
 
+				osd->budget.begin();
 				auto previousTime = ::std::chrono::steady_clock::now();
 				data.elapsed_draw_time = 0.0F;
 				while (!exit) {
@@ -183,7 +372,12 @@ namespace std::experimental::io2d {
 					auto elapsedTimeIncrement = static_cast<float>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(currentTime - previousTime).count());
 					data.elapsed_draw_time += elapsedTimeIncrement;
 					previousTime = currentTime;
+					const auto eventsStart = ::std::chrono::steady_clock::now();
 					while (XCheckIfEvent(data.display.get(), &xev, &_X11_if_xev_pred, reinterpret_cast<XPointer>(&osd))) {
+						if (data.shm != nullptr && _Xshm_completion_matches(*data.shm, data.wndw, xev)) {
+							data.shm->busy = false;
+							continue;
+						}
 						switch (xev.type) {
 							// ExposureMask events:
 						case Expose:
@@ -193,6 +387,8 @@ namespace std::experimental::io2d {
 							}
 							assert(data.display_surface != nullptr && data.display_context != nullptr);
 							data.can_draw = true;
+							data.display_invalid = true;
+							const auto drawStart = ::std::chrono::steady_clock::now();
 							if (osd->draw_callback != nullptr) {
 								if (data.auto_clear) {
 									_Ds_clear<_Cairo_graphics_surfaces<GraphicsMath>>(data);
@@ -202,7 +398,8 @@ namespace std::experimental::io2d {
 							else {
 								throw system_error(make_error_code(errc::operation_not_supported));
 							}
-							_Render_to_native_surface(osd, sfc);
+							osd->timing.add_draw(drawStart);
+							_Present_frame(osd, sfc);
 
 							data.elapsed_draw_time = 0.0F;
 							//if (_Refresh_rate == experimental::io2d::refresh_style::fixed) {
@@ -228,7 +425,14 @@ namespace std::experimental::io2d {
 								resized = true;
 							}
 							if (resized) {
-								cairo_xlib_surface_set_size(data.display_surface.get(), static_cast<double>(data.display_dimensions.x()), static_cast<double>(data.display_dimensions.y()));
+								if (data.shm != nullptr) {
+									// The shared memory image can't be resized, so it is recreated.
+									_Create_display_surface_and_context<GraphicsMath>(data);
+								}
+								else {
+									cairo_xlib_surface_set_size(data.display_surface.get(), static_cast<double>(data.display_dimensions.x()), static_cast<double>(data.display_dimensions.y()));
+								}
+								data.display_invalid = true;
 								if (osd->size_change_callback != nullptr) {
 									osd->size_change_callback(sfc);
 								}
@@ -240,6 +444,7 @@ namespace std::experimental::io2d {
 							data.can_draw = false;
 							data.display_context.reset();
 							data.display_surface.reset();
+							data.shm.reset();
 							exit = true;
 						} break;
 						case GravityNotify:
@@ -258,11 +463,14 @@ namespace std::experimental::io2d {
 							data.can_draw = false;
 							data.display_context.reset();
 							data.display_surface.reset();
+							data.shm.reset();
 						} break;
 						// Might get them even though they are unrequested events (see http://www.x.org/releases/X11R7.7/doc/libX11/libX11/libX11.html#Event_Masks ):
 						case GraphicsExpose:
 						{
 							if (data.can_draw) {
+								data.display_invalid = true;
+								const auto drawStart = ::std::chrono::steady_clock::now();
 								if (osd->draw_callback != nullptr) {
 									if (data.auto_clear) {
 										_Ds_clear<_Cairo_graphics_surfaces<GraphicsMath>>(data);
@@ -272,7 +480,8 @@ namespace std::experimental::io2d {
 								else {
 									throw system_error(make_error_code(errc::operation_not_supported));
 								}
-								_Render_to_native_surface(osd, sfc);
+								osd->timing.add_draw(drawStart);
+								_Present_frame(osd, sfc);
 
 								data.elapsed_draw_time = 0.0F;
 							}
@@ -287,6 +496,7 @@ namespace std::experimental::io2d {
 								data.can_draw = false;
 								data.display_context.reset();
 								data.display_surface.reset();
+								data.shm.reset();
 								XDestroyWindow(data.display.get(), data.wndw);
 								data.wndw = None;
 								exit = true;
@@ -351,6 +561,9 @@ namespace std::experimental::io2d {
 						} break;
 						}
 					}
+					osd->timing.add_events(eventsStart);
+					// Events that are left in Xlib's queue aren't for this window and must not keep the loop from sleeping.
+					const int unmatchedEvents = XEventsQueued(display, QueuedAlready);
 					if (data.can_draw) {
 						bool redraw = true;
 						if (data.rr == io2d::refresh_style::as_needed) {
@@ -366,6 +579,7 @@ namespace std::experimental::io2d {
 						}
 						if (redraw) {
 							// Run user draw function:
+							const auto drawStart = ::std::chrono::steady_clock::now();
 							if (osd->draw_callback != nullptr) {
 								if (data.auto_clear) {
 									_Ds_clear<_Cairo_graphics_surfaces<GraphicsMath>>(data);
@@ -375,7 +589,8 @@ namespace std::experimental::io2d {
 							else {
 								throw system_error(make_error_code(errc::operation_not_supported));
 							}
-							_Render_to_native_surface(osd, sfc);
+							osd->timing.add_draw(drawStart);
+							_Present_frame(osd, sfc);
 							if (data.rr == io2d::refresh_style::fixed) {
 								while (data.elapsed_draw_time >= desiredElapsed) {
 									data.elapsed_draw_time -= desiredElapsed;
@@ -385,6 +600,62 @@ namespace std::experimental::io2d {
 								data.elapsed_draw_time = 0.0f;
 							}
 						}
+						else {
+							// Shows a frame that the render thread finished after the last one was presented.
+							_Present_async_frame_if_ready(osd, sfc);
+						}
+					}
+					if (exit) {
+						break;
+					}
+
+					// Sleep until there is X input, the next refresh_style::fixed frame is due or the loop is woken up. Only
+					// refresh_style::as_fast_as_possible (and a pending redraw_required) keep it from blocking.
+					_Async_notify_frame_finished(data, [wakeFd]() { _Signal_event_fd(wakeFd); });
+					bool wait = true;
+					itimerspec frameDue{};
+					if (data.can_draw) {
+						if (data.rr == io2d::refresh_style::as_fast_as_possible || (data.rr == io2d::refresh_style::as_needed && data.redraw_required)) {
+							wait = false;
+						}
+						else if (data.rr == io2d::refresh_style::fixed) {
+							const auto desiredElapsed = 1'000'000'000.0f / data.refresh_fps;
+							const auto sinceLoopStart = static_cast<float>(::std::chrono::duration_cast<::std::chrono::nanoseconds>(::std::chrono::steady_clock::now() - previousTime).count());
+							const auto remaining = static_cast<long long>(desiredElapsed - data.elapsed_draw_time - sinceLoopStart);
+							if (remaining <= 0) {
+								wait = false;
+							}
+							else {
+								frameDue.it_value.tv_sec = static_cast<time_t>(remaining / 1'000'000'000);
+								frameDue.it_value.tv_nsec = static_cast<long>(remaining % 1'000'000'000);
+							}
+						}
+					}
+					XFlush(display);
+					// Drawing can make Xlib read events into its queue, where poll() doesn't see them.
+					if (XEventsQueued(display, QueuedAlready) > unmatchedEvents) {
+						wait = false;
+					}
+					if (wait) {
+						// A zero it_value disarms the timer.
+						timerfd_settime(data.frame_timer.fd, 0, &frameDue, nullptr);
+						pollfd fds[3] = {
+							{ ConnectionNumber(display), POLLIN, 0 },
+							{ data.frame_timer.fd, POLLIN, 0 },
+							{ wakeFd, POLLIN, 0 }
+						};
+						while (poll(fds, 3, -1) < 0) {
+							if (errno != EINTR) {
+								throw system_error(errno, system_category());
+							}
+						}
+						uint64_t count;
+						for (int i = 1; i < 3; i++) {
+							if ((fds[i].revents & POLLIN) != 0) {
+								while (::read(fds[i].fd, &count, sizeof(count)) < 0 && errno == EINTR) {
+								}
+							}
+						}
 					}
 				}
 				data.elapsed_draw_time = 0.0F;
@@ -436,32 +707,52 @@ namespace std::experimental::io2d {
 			inline float _Cairo_graphics_surfaces<GraphicsMath>::surfaces::desired_frame_rate(const output_surface_data_type& data) noexcept {
 				return data->data.refresh_fps;
 			}
+			template<class GraphicsMath>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::damage_tracking(output_surface_data_type& data, bool val) {
+				data->data.damage_tracking = val;
+				data->data.damage = _Damage_region{};
+				data->data.display_invalid = true;
+			}
+			template<class GraphicsMath>
+			inline bool _Cairo_graphics_surfaces<GraphicsMath>::surfaces::damage_tracking(const output_surface_data_type& data) noexcept {
+				return data->data.damage_tracking;
+			}
 
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::flush(output_surface_data_type& data) {
+				_Async_finish_recorded(data->data);
 				cairo_surface_flush(data->data.back_buffer.surface.get());
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::flush(output_surface_data_type& data, error_code& ec) noexcept {
+				_Async_finish_recorded(data->data);
 				cairo_surface_flush(data->data.back_buffer.surface.get());
 				ec.clear();
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data) {
+				_Async_wait_idle(data->data);
 				cairo_surface_mark_dirty(data->data.back_buffer.surface.get());
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>());
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, error_code& ec) noexcept {
+				_Async_wait_idle(data->data);
 				cairo_surface_mark_dirty(data->data.back_buffer.surface.get());
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>());
 				ec.clear();
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, const basic_bounding_box<GraphicsMath>& extents) {
+				_Async_wait_idle(data->data);
 				cairo_surface_mark_dirty_rectangle(data->data.back_buffer.surface.get(), _Float_to_int(extents.x()), _Float_to_int(extents.y()), _Float_to_int(extents.width()), _Float_to_int(extents.height()));
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>(extents));
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::mark_dirty(output_surface_data_type& data, const basic_bounding_box<GraphicsMath>& extents, error_code& ec) noexcept {
+				_Async_wait_idle(data->data);
 				cairo_surface_mark_dirty_rectangle(data->data.back_buffer.surface.get(), _Float_to_int(extents.x()), _Float_to_int(extents.y()), _Float_to_int(extents.width()), _Float_to_int(extents.height()));
+				_Add_back_buffer_damage(data->data, optional<basic_bounding_box<GraphicsMath>>(extents));
 				ec.clear();
 			}
 
@@ -486,6 +777,16 @@ namespace std::experimental::io2d {
 				_Ds_mask<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, b, mb, bp, mp, rp, cl);
 			}
 			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::fill_instances(output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_fill_instances<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, ip, first, last, bp, rp, cl);
+			}
+			template<class GraphicsMath>
+			template <class InputIterator>
+			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::stroke_instances(output_surface_data_type& data, const basic_interpreted_path<_Graphics_surfaces_type>& ip, InputIterator first, InputIterator last, const basic_brush_props<_Graphics_surfaces_type>& bp, const basic_stroke_props<_Graphics_surfaces_type>& sp, const basic_dashes<_Graphics_surfaces_type>& d, const basic_render_props<_Graphics_surfaces_type>& rp, const basic_clip_props<_Graphics_surfaces_type>& cl) {
+				_Ds_stroke_instances<_Cairo_graphics_surfaces<GraphicsMath>>(data->data, ip, first, last, bp, sp, d, rp, cl);
+			}
+			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::draw_callback(output_surface_data_type& data, function<void(basic_output_surface<_Graphics_surfaces_type>&)> fn) {
 				data->draw_callback = fn;
 			}
@@ -496,6 +797,7 @@ namespace std::experimental::io2d {
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::user_scaling_callback(output_surface_data_type& data, function<basic_bounding_box<GraphicsMath>(const basic_output_surface<_Graphics_surfaces_type>&, bool&)> fn) {
 				data->user_scaling_callback = fn;
+				data->data.display_invalid = true;
 			}
 			template<class GraphicsMath>
 			inline void _Cairo_graphics_surfaces<GraphicsMath>::surfaces::dimensions(output_surface_data_type& data, const basic_display_point<GraphicsMath>& val) {
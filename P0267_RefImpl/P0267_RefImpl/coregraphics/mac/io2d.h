@@ -24,6 +24,7 @@ namespace std::experimental::io2d {
         using matrix_2d = basic_matrix_2d<default_graphics_math>;
         using output_surface = basic_output_surface<default_graphics_surfaces>;
         using path_builder = basic_path_builder<default_graphics_surfaces>;
+        using path_instance = basic_path_instance<default_graphics_surfaces>;
         using point_2d = basic_point_2d<default_graphics_math>;
         using render_props = basic_render_props<default_graphics_surfaces>;
         using stroke_props = basic_stroke_props<default_graphics_surfaces>;
@@ -41,6 +41,12 @@ _GS::brushes::create_brush(basic_image_surface<_GS>&& img) {
     return data;
 }
 
+// Core Graphics filters images down itself when it draws them minified, so there's no mip chain to build.
+inline _GS::brushes::brush_data_type
+_GS::brushes::create_brush(basic_image_surface<_GS>&& img, bool /*mipmap*/) {
+    return create_brush(::std::move(img));
+}
+
 template <class InputIterator>
 inline _GS::brushes::brush_data_type
 _GS::brushes::create_brush(const basic_point_2d<GraphicsMath>& begin, const basic_point_2d<GraphicsMath>& end, InputIterator first, InputIterator last) {
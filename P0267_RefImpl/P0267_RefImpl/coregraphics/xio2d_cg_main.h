@@ -261,6 +261,7 @@ struct brushes {
     static brush_data_type create_brush(const basic_circle<GraphicsMath>& start, const basic_circle<GraphicsMath>& end, InputIterator first, InputIterator last);
     static brush_data_type create_brush(const basic_circle<GraphicsMath>& start, const basic_circle<GraphicsMath>& end, ::std::initializer_list<gradient_stop> il);
     static brush_data_type create_brush(basic_image_surface<_GS>&& img);
+    static brush_data_type create_brush(basic_image_surface<_GS>&& img, bool mipmap);
     static brush_data_type copy_brush(const brush_data_type& data);
     static brush_data_type move_brush(brush_data_type&& data) noexcept;
     static void destroy(brush_data_type& data) noexcept;
@@ -389,9 +390,13 @@ struct surfaces {
 #ifdef _IO2D_Has_Filesystem
     static image_surface_data_type create_image_surface(const filesystem::path &p, image_file_format iff, io2d::format fmt);
     static image_surface_data_type create_image_surface(const filesystem::path &p, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept;
+    static image_surface_data_type create_image_surface(const filesystem::path &p, image_file_format iff, io2d::format fmt, int maxDimension);
+    static image_surface_data_type create_image_surface(const filesystem::path &p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept;
 #else
     static image_surface_data_type create_image_surface(const string &p, image_file_format iff, io2d::format fmt);
     static image_surface_data_type create_image_surface(const string &p, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept;
+    static image_surface_data_type create_image_surface(const string &p, image_file_format iff, io2d::format fmt, int maxDimension);
+    static image_surface_data_type create_image_surface(const string &p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept;
 #endif    
     static image_surface_data_type move_image_surface(image_surface_data_type&& data) noexcept;
     static void destroy(image_surface_data_type& data) noexcept;
@@ -402,7 +407,17 @@ struct surfaces {
     static void save(image_surface_data_type& data, const string &p, image_file_format iff);
     static void save(image_surface_data_type& data, const string &p, image_file_format iff, error_code& ec) noexcept;
 #endif
+    static image_surface_data_type create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt);
+    static image_surface_data_type create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept;
+    static image_surface_data_type create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension);
+    static image_surface_data_type create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept;
+    static void save(image_surface_data_type& data, const function<void(const ::std::byte*, size_t)>& sink, image_file_format iff);
+    static void save(image_surface_data_type& data, const function<void(const ::std::byte*, size_t)>& sink, image_file_format iff, error_code& ec) noexcept;
     static basic_display_point<GraphicsMath> max_dimensions() noexcept;
+    static void cache_budget(size_t bytes) noexcept;
+    static size_t cache_budget() noexcept;
+    static image_cache_stats cache_stats() noexcept;
+    static void clear_cache() noexcept;
     static io2d::format format(const image_surface_data_type& data) noexcept;
     static basic_display_point<GraphicsMath> dimensions(const image_surface_data_type& data) noexcept;
     static void clear(image_surface_data_type& data);
@@ -416,6 +431,10 @@ struct surfaces {
     static void stroke(image_surface_data_type& data, const basic_brush<_GS>& b, const basic_interpreted_path<_GS>& ip, const basic_brush_props<_GS>& bp, const basic_stroke_props<_GS>& sp, const basic_dashes<_GS>& d, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
     static void fill(image_surface_data_type& data, const basic_brush<_GS>& b, const basic_interpreted_path<_GS>& ip, const basic_brush_props<_GS>& bp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
     static void mask(image_surface_data_type& data, const basic_brush<_GS>& b, const basic_brush<_GS>& mb, const basic_brush_props<_GS>& bp, const basic_mask_props<_GS>& mp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
+    template <class InputIterator>
+    static void fill_instances(image_surface_data_type& data, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
+    template <class InputIterator>
+    static void stroke_instances(image_surface_data_type& data, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_stroke_props<_GS>& sp, const basic_dashes<_GS>& d, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
     static _Interchange_buffer _Copy_to_interchange_buffer(image_surface_data_type& data, _Interchange_buffer::pixel_layout layout, _Interchange_buffer::alpha_mode alpha);
                     
     struct _OutputSurfaceCocoa;
@@ -445,6 +464,10 @@ struct surfaces {
     static void stroke(output_surface_data_type& data, const basic_brush<_GS>& b, const basic_interpreted_path<_GS>& ip, const basic_brush_props<_GS>& bp, const basic_stroke_props<_GS>& sp, const basic_dashes<_GS>& d, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
     static void fill(output_surface_data_type& data, const basic_brush<_GS>& b, const basic_interpreted_path<_GS>& ip, const basic_brush_props<_GS>& bp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
     static void mask(output_surface_data_type& data, const basic_brush<_GS>& b, const basic_brush<_GS>& mb, const basic_brush_props<_GS>& bp, const basic_mask_props<_GS>& mp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
+    template <class InputIterator>
+    static void fill_instances(output_surface_data_type& data, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
+    template <class InputIterator>
+    static void stroke_instances(output_surface_data_type& data, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_stroke_props<_GS>& sp, const basic_dashes<_GS>& d, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
     static void draw_callback(output_surface_data_type& data, function<void(basic_output_surface<_GS>&)>);
     static void size_change_callback(output_surface_data_type& data, function<void(basic_output_surface<_GS>&)>);
 //  static void user_scaling_callback(output_surface_data_type& data, function<basic_bounding_box<GraphicsMath>(const basic_output_surface<_Graphics_surfaces_type>&, bool&)>);
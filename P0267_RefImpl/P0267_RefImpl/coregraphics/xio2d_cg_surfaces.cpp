@@ -38,7 +38,7 @@ CGContextRef _CreateBitmap(io2d::format fmt, int width, int height) noexcept
     }
 }
     
-CGContextRef _LoadBitmap(const string &p, image_file_format iff, io2d::format fmt, ::std::error_code& ec)
+CGContextRef _LoadBitmap(const string &p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec)
 {
  //             TODO: error codes
     std::ifstream ifs(p, std::ifstream::in | std::ifstream::binary);
@@ -46,7 +46,12 @@ CGContextRef _LoadBitmap(const string &p, image_file_format iff, io2d::format fm
     if( contents.empty() )
         return nullptr;
     
-    auto data = CFDataCreateWithBytesNoCopy(nullptr, contents.data(), contents.size(), kCFAllocatorNull);
+    return _LoadBitmap(reinterpret_cast<const ::std::byte*>(contents.data()), contents.size(), iff, fmt, maxDimension, ec);
+}
+
+CGContextRef _LoadBitmap(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec)
+{
+    auto data = CFDataCreateWithBytesNoCopy(nullptr, reinterpret_cast<const UInt8*>(bytes), static_cast<CFIndex>(size), kCFAllocatorNull);
     _AutoRelease data_release{data};
     if( !data )
         return nullptr;
@@ -63,6 +68,21 @@ CGContextRef _LoadBitmap(const string &p, image_file_format iff, io2d::format fm
         return nullptr;
     
     auto image = CGImageSourceCreateImageAtIndex(source, 0, nullptr);
+    if( image && maxDimension > 0 &&
+        (CGImageGetWidth(image) > size_t(maxDimension) || CGImageGetHeight(image) > size_t(maxDimension)) ) {
+        // The image isn't decoded until it's drawn, so swapping it for ImageIO's thumbnail means the full size pixels are
+        // never produced; ImageIO scales JPEGs while it decodes them.
+        CGImageRelease(image);
+        auto max_size = CFNumberCreate(nullptr, kCFNumberIntType, &maxDimension);
+        _AutoRelease max_size_release{max_size};
+        const void *thumb_keys[] = { (const void*)kCGImageSourceCreateThumbnailFromImageAlways,
+                                     (const void*)kCGImageSourceCreateThumbnailWithTransform,
+                                     (const void*)kCGImageSourceThumbnailMaxPixelSize };
+        const void *thumb_values[] = { (const void*)kCFBooleanTrue, (const void*)kCFBooleanFalse, (const void*)max_size };
+        auto thumb_options = CFDictionaryCreate(nullptr, thumb_keys, thumb_values, 3, &kCFTypeDictionaryKeyCallBacks, &kCFTypeDictionaryValueCallBacks);
+        _AutoRelease thumb_options_release{thumb_options};
+        image = CGImageSourceCreateThumbnailAtIndex(source, 0, thumb_options);
+    }
     _AutoRelease image_release{image};
     
     if( !image )
@@ -80,13 +100,8 @@ CGContextRef _LoadBitmap(const string &p, image_file_format iff, io2d::format fm
     return bitmap;
 }
             
-void _WriteBitmap(CGContextRef ctx, const string &p, image_file_format iff, ::std::error_code &ec)
+static CFMutableDataRef EncodeBitmap(CGContextRef ctx, image_file_format iff)
 {
-    if (iff == image_file_format::unknown) {
-        ec = make_error_code(errc::not_supported);
-        return;
-    }
-    
     //             TODO: error codes
     auto type = _ToCG(iff);
     
@@ -99,7 +114,18 @@ void _WriteBitmap(CGContextRef ctx, const string &p, image_file_format iff, ::st
     
     CGImageDestinationFinalize(destination);
     CGImageRelease(image);
+    CFRelease(destination);
+    return data;
+}
+            
+void _WriteBitmap(CGContextRef ctx, const string &p, image_file_format iff, ::std::error_code &ec)
+{
+    if (iff == image_file_format::unknown) {
+        ec = make_error_code(errc::not_supported);
+        return;
+    }
     
+    auto data = EncodeBitmap(ctx, iff);
     
     std::ofstream ofs(p, std::ofstream::binary);
     auto bytes = reinterpret_cast<const char*>(CFDataGetBytePtr(data));
@@ -109,6 +135,25 @@ void _WriteBitmap(CGContextRef ctx, const string &p, image_file_format iff, ::st
     CFRelease(data);
 }
 
+void _WriteBitmap(CGContextRef ctx, const function<void(const ::std::byte*, size_t)>& sink, image_file_format iff, ::std::error_code &ec)
+{
+    if (iff == image_file_format::unknown) {
+        ec = make_error_code(errc::not_supported);
+        return;
+    }
+    
+    auto data = EncodeBitmap(ctx, iff);
+    _AutoRelease data_release{data};
+    try {
+        sink(reinterpret_cast<const ::std::byte*>(CFDataGetBytePtr(data)), static_cast<size_t>(CFDataGetLength(data)));
+    }
+    catch(...) {
+        ec = make_error_code(errc::io_error);
+        return;
+    }
+    ec.clear();
+}
+
 void _Clear(CGContextRef ctx, CGColorRef with_color, CGRect in_rect)
 {
     CGContextSaveGState(ctx);
@@ -7,10 +7,12 @@
 namespace std::experimental::io2d { inline namespace v1 { namespace _CoreGraphics {
 
 CGContextRef _CreateBitmap(io2d::format fmt, int width, int height) noexcept;
-CGContextRef _LoadBitmap(const string &p, image_file_format iff, io2d::format fmt, ::std::error_code& ec);
+CGContextRef _LoadBitmap(const string &p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec);
+CGContextRef _LoadBitmap(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec);
 CGColorRef _CreateColorFromBitmapLocation(CGContextRef ctx, int x, int y);
     
 void _WriteBitmap(CGContextRef ctx, const string &p, image_file_format iff, ::std::error_code &ec);
+void _WriteBitmap(CGContextRef ctx, const function<void(const ::std::byte*, size_t)>& sink, image_file_format iff, ::std::error_code &ec);
 void _Clear(CGContextRef ctx, CGColorRef with_color, CGRect in_rect );
 void _Stroke(CGContextRef ctx, const basic_brush<_GS>& b, const basic_interpreted_path<_GS>& ip, const basic_brush_props<_GS>& bp, const basic_stroke_props<_GS>& sp, const basic_dashes<_GS>& d, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
 void _Paint(CGContextRef ctx, const basic_brush<_GS>& b, const basic_brush_props<_GS>& bp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl);
@@ -21,6 +23,21 @@ _Interchange_buffer _CopyToInterchangeBuffer(CGContextRef ctx, _Interchange_buff
 inline basic_display_point<GraphicsMath> _GS::surfaces::max_dimensions() noexcept {
     return basic_display_point<GraphicsMath>(16384, 16384);
 }
+
+// There's no decoded image cache in this backend: the budget is ignored and the cache stays empty.
+inline void _GS::surfaces::cache_budget(size_t) noexcept {
+}
+
+inline size_t _GS::surfaces::cache_budget() noexcept {
+    return 0;
+}
+
+inline image_cache_stats _GS::surfaces::cache_stats() noexcept {
+    return image_cache_stats{};
+}
+
+inline void _GS::surfaces::clear_cache() noexcept {
+}
             
 inline _GS::surfaces::image_surface_data_type _GS::surfaces::create_image_surface(io2d::format fmt, int width, int height) {
     auto context = _CreateBitmap(fmt, width, height);
@@ -57,7 +74,29 @@ _GS::surfaces::create_image_surface(const filesystem::path &p, image_file_format
 #else
 _GS::surfaces::create_image_surface(const string &p, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept {
 #endif
-    auto context = _LoadBitmap(p, iff, fmt, ec);
+    return create_image_surface(p, iff, fmt, 0, ec);
+}
+
+inline _GS::surfaces::image_surface_data_type
+#ifdef _IO2D_Has_Filesystem
+_GS::surfaces::create_image_surface(const filesystem::path &p, image_file_format iff, io2d::format fmt, int maxDimension) {
+#else
+_GS::surfaces::create_image_surface(const string &p, image_file_format iff, io2d::format fmt, int maxDimension) {
+#endif
+    ::std::error_code ec;
+    auto data = create_image_surface(p, iff, fmt, maxDimension, ec);
+    if( ec )
+        throw ::std::system_error(ec);
+    return data;
+}
+
+inline _GS::surfaces::image_surface_data_type
+#ifdef _IO2D_Has_Filesystem
+_GS::surfaces::create_image_surface(const filesystem::path &p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept {
+#else
+_GS::surfaces::create_image_surface(const string &p, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept {
+#endif
+    auto context = _LoadBitmap(p, iff, fmt, maxDimension, ec);
     if( !context ) {
         ec = make_error_code(errc::no_such_file_or_directory);
         return {};
@@ -77,6 +116,51 @@ _GS::surfaces::create_image_surface(const string &p, image_file_format iff, io2d
     return data;
 }
 
+inline _GS::surfaces::image_surface_data_type
+_GS::surfaces::create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt) {
+    ::std::error_code ec;
+    auto data = create_image_surface(bytes, size, iff, fmt, ec);
+    if( ec )
+        throw ::std::system_error(ec);
+    return data;
+}
+
+inline _GS::surfaces::image_surface_data_type
+_GS::surfaces::create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, ::std::error_code& ec) noexcept {
+    return create_image_surface(bytes, size, iff, fmt, 0, ec);
+}
+
+inline _GS::surfaces::image_surface_data_type
+_GS::surfaces::create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension) {
+    ::std::error_code ec;
+    auto data = create_image_surface(bytes, size, iff, fmt, maxDimension, ec);
+    if( ec )
+        throw ::std::system_error(ec);
+    return data;
+}
+
+inline _GS::surfaces::image_surface_data_type
+_GS::surfaces::create_image_surface(const ::std::byte* bytes, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, ::std::error_code& ec) noexcept {
+    auto context = _LoadBitmap(bytes, size, iff, fmt, maxDimension, ec);
+    if( !context ) {
+        ec = make_error_code(errc::illegal_byte_sequence);
+        return {};
+    }
+
+    auto width = (int)CGBitmapContextGetWidth(context);
+    auto height = (int)CGBitmapContextGetHeight(context);
+    
+    CGContextConcatCTM(context, CGAffineTransform{ 1., 0., 0., -1., 0., double(height) } );
+    CGContextSetAllowsAntialiasing(context, true);
+    
+    image_surface_data_type data;
+    data.context.reset(context);
+    data.dimensions.x(width);
+    data.dimensions.y(height);
+    data.format = fmt;
+    return data;
+}
+
 inline _GS::surfaces::image_surface_data_type
 _GS::surfaces::move_image_surface(image_surface_data_type&& data) noexcept {
     return move(data);
@@ -112,6 +196,31 @@ _GS::surfaces::save(image_surface_data_type& data, const string &p, image_file_f
 #endif
     _WriteBitmap(data.context.get(), p, iff, ec);
 }
+
+inline void
+_GS::surfaces::save(image_surface_data_type& data, const function<void(const ::std::byte*, size_t)>& sink, image_file_format iff) {
+    // The error_code overload reports a throwing sink as errc::io_error, so the exception is kept to be rethrown here.
+    ::std::exception_ptr sink_exception;
+    ::std::error_code ec;
+    save(data, [&sink, &sink_exception](const ::std::byte* bytes, size_t size) {
+        try {
+            sink(bytes, size);
+        }
+        catch(...) {
+            sink_exception = ::std::current_exception();
+            throw;
+        }
+    }, iff, ec);
+    if( sink_exception )
+        ::std::rethrow_exception(sink_exception);
+    if( ec )
+        throw ::std::system_error(ec);
+}
+
+inline void
+_GS::surfaces::save(image_surface_data_type& data, const function<void(const ::std::byte*, size_t)>& sink, image_file_format iff, error_code& ec) noexcept {
+    _WriteBitmap(data.context.get(), sink, iff, ec);
+}
             
 inline io2d::format
 _GS::surfaces::format(const image_surface_data_type& data) noexcept {
@@ -156,6 +265,45 @@ _GS::surfaces::mask(image_surface_data_type& data, const basic_brush<_GS>& b, co
     _Mask(data.context.get(), b, mb, bp, mp, rp, cl);
 }
 
+// There is no batched path in CoreGraphics, so instances are drawn as individual fills and strokes.
+template <class SurfaceData, class InputIterator>
+void _DrawInstances(SurfaceData& data, bool stroke, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_stroke_props<_GS>& sp, const basic_dashes<_GS>& d, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl) {
+    auto irp = rp;
+    for (; first != last; ++first) {
+        const auto& inst = *first;
+        irp.surface_matrix(inst.matrix() * rp.surface_matrix());
+        const auto b = inst.has_brush() ? inst.brush() : basic_brush<_GS>(inst.color());
+        if (stroke)
+            _GS::surfaces::stroke(data, b, ip, bp, sp, d, irp, cl);
+        else
+            _GS::surfaces::fill(data, b, ip, bp, irp, cl);
+    }
+}
+
+template <class InputIterator>
+inline void
+_GS::surfaces::fill_instances(image_surface_data_type& data, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl) {
+    _DrawInstances(data, false, ip, first, last, bp, basic_stroke_props<_GS>(), basic_dashes<_GS>(), rp, cl);
+}
+
+template <class InputIterator>
+inline void
+_GS::surfaces::stroke_instances(image_surface_data_type& data, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_stroke_props<_GS>& sp, const basic_dashes<_GS>& d, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl) {
+    _DrawInstances(data, true, ip, first, last, bp, sp, d, rp, cl);
+}
+
+template <class InputIterator>
+inline void
+_GS::surfaces::fill_instances(output_surface_data_type& data, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl) {
+    _DrawInstances(data, false, ip, first, last, bp, basic_stroke_props<_GS>(), basic_dashes<_GS>(), rp, cl);
+}
+
+template <class InputIterator>
+inline void
+_GS::surfaces::stroke_instances(output_surface_data_type& data, const basic_interpreted_path<_GS>& ip, InputIterator first, InputIterator last, const basic_brush_props<_GS>& bp, const basic_stroke_props<_GS>& sp, const basic_dashes<_GS>& d, const basic_render_props<_GS>& rp, const basic_clip_props<_GS>& cl) {
+    _DrawInstances(data, true, ip, first, last, bp, sp, d, rp, cl);
+}
+
 inline _Interchange_buffer
 _GS::surfaces::_Copy_to_interchange_buffer(image_surface_data_type& data, _Interchange_buffer::pixel_layout layout, _Interchange_buffer::alpha_mode alpha)
 {
@@ -2,6 +2,7 @@
 
 #include "xcolor.h"
 #include "xgraphicsmath.h"
+#include "xsurfaces_enums.h"
 
 namespace std {
 	namespace experimental {
@@ -9,6 +10,8 @@ namespace std {
 			inline namespace v1 {
 				template <class GraphicsSurfaces>
 				class basic_image_surface;
+				template <class GraphicsSurfaces>
+				class basic_brush_atlas;
 
 				enum class wrap_mode {
 					none,
@@ -77,9 +80,63 @@ namespace std {
 					basic_brush(const basic_circle<graphics_math_type>& start, const basic_circle<graphics_math_type>& end, ::std::initializer_list<gradient_stop> il);
 
 					basic_brush(basic_image_surface<GraphicsSurfaces>&& img);
+					// With mipmap, also builds a chain of successively halved, box filtered copies of img. Each draw then samples
+					// the copy that matches how much the brush matrix and surface matrix shrink the image, so a heavily
+					// downscaled brush is neither aliased nor slow to filter. Mask brushes always use the full size image.
+					basic_brush(basic_image_surface<GraphicsSurfaces>&& img, bool mipmap);
+					// A surface brush over the atlas page that holds key's entry, to be drawn with atlas.brush_matrix(key, ...).
+					// Brushes for entries on the same page share the page's pattern. Throws errc::invalid_argument if the atlas
+					// has no such entry.
+					basic_brush(const basic_brush_atlas<GraphicsSurfaces>& atlas, size_t key);
 
 					brush_type type() const noexcept;
 				};
+
+				// Packs many small images onto a few page_size() square surfaces, so that drawing them reuses one brush per page,
+				// and whatever the backend caches for it, instead of a brush made and destroyed per image. Each image inserted
+				// gets a key; basic_brush(atlas, key) drawn with brush_matrix(key, origin) and wrap_mode::none puts the image's
+				// top left corner at origin. Only fill bounds(key) moved to origin, since the rest of the page holds other
+				// entries. Entries can be erased to make room, which suits a cache of icons that changes as it's used. Each
+				// entry is surrounded by gutter() transparent pixels, so filtering at its edges fades to transparent rather
+				// than picking up its neighbours. The default of one pixel is enough unless entries are drawn smaller with
+				// filter::good or filter::best, which average about 1 / scale pixels; an atlas drawn at down to half size
+				// needs a gutter of 2, at a quarter size 4. Mipmapped surface brushes don't apply to atlas brushes.
+				template <class GraphicsSurfaces>
+				class basic_brush_atlas {
+				public:
+					using graphics_math_type = typename GraphicsSurfaces::graphics_math_type;
+					using data_type = typename GraphicsSurfaces::brushes::brush_atlas_data_type;
+				private:
+					data_type _Data;
+				public:
+					const data_type& data() const noexcept;
+					data_type& data() noexcept;
+
+					explicit basic_brush_atlas(io2d::format fmt = io2d::format::argb32, int pageSize = 1024, int gutter = 1);
+					basic_brush_atlas(basic_brush_atlas&&) noexcept;
+					basic_brush_atlas& operator=(basic_brush_atlas&&) noexcept;
+					~basic_brush_atlas() noexcept;
+
+					// Copies img onto the first page with room for it, converted to format(), and returns its key. Keys aren't
+					// reused. Throws errc::invalid_argument if img is wider or taller than page_size() less twice gutter().
+					size_t insert(const basic_image_surface<GraphicsSurfaces>& img);
+					// Clears the entry's pixels and frees its space; returns false if there's no such entry.
+					bool erase(size_t key) noexcept;
+					void clear() noexcept;
+					bool contains(size_t key) const noexcept;
+					size_t size() const noexcept;
+
+					io2d::format format() const noexcept;
+					int page_size() const noexcept;
+					int gutter() const noexcept;
+					int page_count() const noexcept;
+					// Where the entry is: its page and its pixels on the page. Both throw errc::invalid_argument if there's no
+					// such entry.
+					int page(size_t key) const;
+					basic_bounding_box<graphics_math_type> bounds(size_t key) const;
+					// The brush matrix that draws the entry with its top left corner at origin.
+					basic_matrix_2d<graphics_math_type> brush_matrix(size_t key, const basic_point_2d<graphics_math_type>& origin = basic_point_2d<graphics_math_type>{}) const;
+				};
 			}
 		}
 	}
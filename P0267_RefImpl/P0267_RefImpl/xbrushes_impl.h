@@ -65,8 +65,94 @@ namespace std::experimental::io2d {
 			: _Data(GraphicsSurfaces::brushes::create_brush(move(img))) {
 		}
 		template<class GraphicsSurfaces>
+		inline basic_brush<GraphicsSurfaces>::basic_brush(basic_image_surface<GraphicsSurfaces>&& img, bool mipmap)
+			: _Data(GraphicsSurfaces::brushes::create_brush(move(img), mipmap)) {
+		}
+		template<class GraphicsSurfaces>
+		inline basic_brush<GraphicsSurfaces>::basic_brush(const basic_brush_atlas<GraphicsSurfaces>& atlas, size_t key)
+			: _Data(GraphicsSurfaces::brushes::create_brush(atlas.data(), key)) {
+		}
+		template<class GraphicsSurfaces>
 		inline brush_type basic_brush<GraphicsSurfaces>::type() const noexcept {
 			return GraphicsSurfaces::brushes::get_brush_type(_Data);
 		}
+
+		template<class GraphicsSurfaces>
+		inline const typename basic_brush_atlas<GraphicsSurfaces>::data_type& basic_brush_atlas<GraphicsSurfaces>::data() const noexcept {
+			return _Data;
+		}
+		template<class GraphicsSurfaces>
+		inline typename basic_brush_atlas<GraphicsSurfaces>::data_type& basic_brush_atlas<GraphicsSurfaces>::data() noexcept {
+			return _Data;
+		}
+		template<class GraphicsSurfaces>
+		inline basic_brush_atlas<GraphicsSurfaces>::basic_brush_atlas(io2d::format fmt, int pageSize, int gutter)
+			: _Data(GraphicsSurfaces::brushes::create_brush_atlas(fmt, pageSize, gutter)) {
+		}
+		template<class GraphicsSurfaces>
+		inline basic_brush_atlas<GraphicsSurfaces>::basic_brush_atlas(basic_brush_atlas&& other) noexcept
+			: _Data(GraphicsSurfaces::brushes::move_brush_atlas(move(other._Data))) {
+		}
+		template<class GraphicsSurfaces>
+		inline basic_brush_atlas<GraphicsSurfaces>& basic_brush_atlas<GraphicsSurfaces>::operator=(basic_brush_atlas&& other) noexcept {
+			if (this != &other) {
+				_Data = GraphicsSurfaces::brushes::move_brush_atlas(move(other._Data));
+			}
+			return *this;
+		}
+		template<class GraphicsSurfaces>
+		inline basic_brush_atlas<GraphicsSurfaces>::~basic_brush_atlas() noexcept {
+			GraphicsSurfaces::brushes::destroy(_Data);
+		}
+		template<class GraphicsSurfaces>
+		inline size_t basic_brush_atlas<GraphicsSurfaces>::insert(const basic_image_surface<GraphicsSurfaces>& img) {
+			return GraphicsSurfaces::brushes::insert(_Data, img);
+		}
+		template<class GraphicsSurfaces>
+		inline bool basic_brush_atlas<GraphicsSurfaces>::erase(size_t key) noexcept {
+			return GraphicsSurfaces::brushes::erase(_Data, key);
+		}
+		template<class GraphicsSurfaces>
+		inline void basic_brush_atlas<GraphicsSurfaces>::clear() noexcept {
+			GraphicsSurfaces::brushes::clear(_Data);
+		}
+		template<class GraphicsSurfaces>
+		inline bool basic_brush_atlas<GraphicsSurfaces>::contains(size_t key) const noexcept {
+			return GraphicsSurfaces::brushes::contains(_Data, key);
+		}
+		template<class GraphicsSurfaces>
+		inline size_t basic_brush_atlas<GraphicsSurfaces>::size() const noexcept {
+			return GraphicsSurfaces::brushes::size(_Data);
+		}
+		template<class GraphicsSurfaces>
+		inline io2d::format basic_brush_atlas<GraphicsSurfaces>::format() const noexcept {
+			return GraphicsSurfaces::brushes::format(_Data);
+		}
+		template<class GraphicsSurfaces>
+		inline int basic_brush_atlas<GraphicsSurfaces>::page_size() const noexcept {
+			return GraphicsSurfaces::brushes::page_size(_Data);
+		}
+		template<class GraphicsSurfaces>
+		inline int basic_brush_atlas<GraphicsSurfaces>::gutter() const noexcept {
+			return GraphicsSurfaces::brushes::gutter(_Data);
+		}
+		template<class GraphicsSurfaces>
+		inline int basic_brush_atlas<GraphicsSurfaces>::page_count() const noexcept {
+			return GraphicsSurfaces::brushes::page_count(_Data);
+		}
+		template<class GraphicsSurfaces>
+		inline int basic_brush_atlas<GraphicsSurfaces>::page(size_t key) const {
+			return GraphicsSurfaces::brushes::page(_Data, key);
+		}
+		template<class GraphicsSurfaces>
+		inline basic_bounding_box<typename basic_brush_atlas<GraphicsSurfaces>::graphics_math_type> basic_brush_atlas<GraphicsSurfaces>::bounds(size_t key) const {
+			return GraphicsSurfaces::brushes::bounds(_Data, key);
+		}
+		template<class GraphicsSurfaces>
+		inline basic_matrix_2d<typename basic_brush_atlas<GraphicsSurfaces>::graphics_math_type> basic_brush_atlas<GraphicsSurfaces>::brush_matrix(size_t key, const basic_point_2d<graphics_math_type>& origin) const {
+			// The brush matrix maps drawing space to the page, so origin has to land on the entry's top left corner.
+			const auto b = bounds(key);
+			return basic_matrix_2d<graphics_math_type>::create_translate(basic_point_2d<graphics_math_type>(b.x() - origin.x(), b.y() - origin.y()));
+		}
 	}
 }
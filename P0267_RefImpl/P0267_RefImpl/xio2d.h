@@ -3,6 +3,7 @@
 
 #include <limits>
 #include <cmath>
+#include <cctype>
 #include <cassert>
 #include <type_traits>
 #include <memory>
@@ -11,15 +12,18 @@
 #include <exception>
 #include <vector>
 #include <string>
+#include <string_view>
 #include <algorithm>
 #include <system_error>
 #include <cstdint>
+#include <cstddef>
 #include <atomic>
 #include <variant>
 #include <optional>
 #include <initializer_list>
 #include <cmath>
 #include <chrono>
+#include <future>
 
 #define __cpp_lib_experimental_io2d 201710
 
@@ -98,6 +102,14 @@ namespace std {
 					return static_cast<int>(container.size());
 				}
 
+				// Returns the value of an optional drawing argument, or a default-constructed one when it has none, without
+				// copying it. Copying would allocate for props that own memory, such as a dash pattern.
+				template <class T>
+				inline const T& _Value_or_default(const optional<T>& o) noexcept {
+					static const T defaultValue{};
+					return o.has_value() ? o.value() : defaultValue;
+				}
+
 				enum class _To_radians_sfinae {};
 				constexpr static _To_radians_sfinae _To_radians_sfinae_val = {};
 				enum class _To_degrees_sfinae {};
@@ -138,6 +150,8 @@ namespace std {
 #include "xsurfaces_enums.h"
 #include "xsurfaces.h"
 #include "xtext.h"
+#include "xthreadpool.h"
+#include "xtrace.h"
 #include "xbrushes_impl.h"
 #include "xgraphicsmath_impl.h"
 #include "xgraphicsmathfloat_impl.h"
@@ -3,6 +3,7 @@
 #include "xsurfaces_enums.h"
 #include "xpath.h"
 #include "xgraphicsmath.h"
+#include "xinterchangebuffer.h"
 
 //#if defined(_Filesystem_support_test)
 //#include <filesystem>
@@ -164,6 +165,74 @@ namespace std::experimental::io2d {
 			~basic_dashes() noexcept;
 		};
 
+		template <class GraphicsSurfaces>
+		class basic_path_instance {
+		public:
+			using graphics_math_type = typename GraphicsSurfaces::graphics_math_type;
+
+		private:
+			basic_matrix_2d<graphics_math_type> _Matrix;
+			variant<basic_brush<GraphicsSurfaces>, rgba_color> _Paint;
+
+		public:
+			basic_path_instance(const basic_matrix_2d<graphics_math_type>& m, const basic_brush<GraphicsSurfaces>& b);
+			basic_path_instance(const basic_matrix_2d<graphics_math_type>& m, const rgba_color& c) noexcept;
+
+			void matrix(const basic_matrix_2d<graphics_math_type>& m) noexcept;
+			void brush(const basic_brush<GraphicsSurfaces>& b);
+			void color(const rgba_color& c) noexcept;
+
+			basic_matrix_2d<graphics_math_type> matrix() const noexcept;
+			bool has_brush() const noexcept;
+			const basic_brush<GraphicsSurfaces>& brush() const;
+			rgba_color color() const;
+		};
+
+		template <class GraphicsSurfaces>
+		class basic_recorded_scene {
+		public:
+			using graphics_math_type = typename GraphicsSurfaces::graphics_math_type;
+			using data_type = typename GraphicsSurfaces::surfaces::recorded_scene_data_type;
+
+		private:
+			data_type _Data;
+
+		public:
+			const data_type& data() const noexcept;
+			data_type& data() noexcept;
+			basic_recorded_scene() noexcept;
+			basic_recorded_scene(const basic_recorded_scene& other);
+			basic_recorded_scene& operator=(const basic_recorded_scene& other);
+			basic_recorded_scene(basic_recorded_scene&& other) noexcept;
+			basic_recorded_scene& operator=(basic_recorded_scene&& other) noexcept;
+			~basic_recorded_scene() noexcept;
+
+			bool empty() const noexcept;
+			void clear();
+			void paint(const basic_brush<GraphicsSurfaces>& b, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class Allocator>
+			void stroke(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_stroke_props<GraphicsSurfaces>>& sp = nullopt, const optional<basic_dashes<GraphicsSurfaces>>& d = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			void stroke(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_stroke_props<GraphicsSurfaces>>& sp = nullopt, const optional<basic_dashes<GraphicsSurfaces>>& d = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class Allocator>
+			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			void mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_mask_props<GraphicsSurfaces>>& mp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class InputIterator>
+			void fill_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class InputIterator>
+			void stroke_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_stroke_props<GraphicsSurfaces>>& sp = nullopt, const optional<basic_dashes<GraphicsSurfaces>>& d = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+		};
+
+		// A snapshot of the decoded image cache (see basic_image_surface::cache_budget).
+		struct image_cache_stats {
+			uint64_t hits = 0;
+			uint64_t misses = 0;
+			uint64_t evictions = 0;
+			size_t entries = 0;
+			size_t bytes = 0;
+			size_t byte_budget = 0;
+		};
+
 		template <class GraphicsSurfaces>
 		class basic_image_surface {
 		public:
@@ -179,13 +248,36 @@ namespace std::experimental::io2d {
 #ifdef _Filesystem_support_test
 			basic_image_surface(filesystem::path f, image_file_format iff, io2d::format fmt);
 			basic_image_surface(filesystem::path f, image_file_format iff, io2d::format fmt, error_code& ec) noexcept;
+			// Loads the image reduced so that neither side exceeds maxDimension, keeping its aspect ratio (0 means no limit).
+			// Where the format allows it the image is reduced while it's decoded, so a thumbnail of a large photo never
+			// needs the memory for the photo at full size.
+			basic_image_surface(filesystem::path f, image_file_format iff, io2d::format fmt, int maxDimension);
+			basic_image_surface(filesystem::path f, image_file_format iff, io2d::format fmt, int maxDimension, error_code& ec) noexcept;
 #else
 			basic_image_surface(::std::string f, image_file_format iff, format fmt);
 			basic_image_surface(::std::string f, image_file_format iff, io2d::format fmt, error_code& ec) noexcept;
+			// Loads the image reduced so that neither side exceeds maxDimension, keeping its aspect ratio (0 means no limit).
+			// Where the format allows it the image is reduced while it's decoded, so a thumbnail of a large photo never
+			// needs the memory for the photo at full size.
+			basic_image_surface(::std::string f, image_file_format iff, io2d::format fmt, int maxDimension);
+			basic_image_surface(::std::string f, image_file_format iff, io2d::format fmt, int maxDimension, error_code& ec) noexcept;
 #endif
+			// Decodes the size bytes at data, e.g. an image received over the network, without going through a file.
+			basic_image_surface(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt);
+			basic_image_surface(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt, error_code& ec) noexcept;
+			basic_image_surface(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt, int maxDimension);
+			basic_image_surface(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, error_code& ec) noexcept;
 			basic_image_surface(basic_image_surface&&) noexcept;
 			basic_image_surface& operator=(basic_image_surface&&) noexcept;
 			~basic_image_surface() noexcept;
+			// Loads each of paths on io2d's worker pool, using up to threadCount threads (0 means one per hardware thread).
+			// The futures are in the same order as paths; a failed load stores its system_error in its future. If iff is
+			// image_file_format::unknown, each file's format is chosen from its extension.
+#ifdef _Filesystem_support_test
+			static vector<future<basic_image_surface>> load_images(const vector<filesystem::path>& paths, image_file_format iff, io2d::format fmt, unsigned int threadCount = 0);
+#else
+			static vector<future<basic_image_surface>> load_images(const vector<::std::string>& paths, image_file_format iff, io2d::format fmt, unsigned int threadCount = 0);
+#endif
 #ifdef _Filesystem_support_test
 			void save(filesystem::path p, image_file_format i);
 			void save(filesystem::path p, image_file_format i, error_code& ec) noexcept;
@@ -193,7 +285,22 @@ namespace std::experimental::io2d {
 			void save(::std::string f, image_file_format i);
 			void save(::std::string f, image_file_format i, error_code& ec) noexcept;
 #endif
+			// Encodes into memory. The vector overloads append the image to buffer, leaving it as it was if they fail. The
+			// sink overloads pass the encoded bytes to sink in order, in one or more pieces; an exception thrown by sink
+			// propagates out of save, or is reported as errc::io_error by the error_code overload.
+			void save(vector<::std::byte>& buffer, image_file_format i);
+			void save(vector<::std::byte>& buffer, image_file_format i, error_code& ec) noexcept;
+			void save(const function<void(const ::std::byte*, size_t)>& sink, image_file_format i);
+			void save(const function<void(const ::std::byte*, size_t)>& sink, image_file_format i, error_code& ec) noexcept;
 			static basic_display_point<graphics_math_type> max_dimensions() noexcept;
+			// The process wide cache of images decoded from files, which is off until it's given a budget. While it's on,
+			// loading a file whose path, modification time, size and formats match a cached image returns a copy of the
+			// cached pixels instead of decoding the file again; the least recently used images are evicted to keep the
+			// cache within bytes. A budget of 0 turns the cache off and empties it.
+			static void cache_budget(size_t bytes) noexcept;
+			static size_t cache_budget() noexcept;
+			static image_cache_stats cache_stats() noexcept;
+			static void clear_cache() noexcept;
 			io2d::format format() const noexcept;
 			basic_display_point<graphics_math_type> dimensions() const noexcept;
 
@@ -212,6 +319,109 @@ namespace std::experimental::io2d {
 			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
 			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
 			void mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_mask_props<GraphicsSurfaces>>& mp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class InputIterator>
+			void fill_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class InputIterator>
+			void stroke_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_stroke_props<GraphicsSurfaces>>& sp = nullopt, const optional<basic_dashes<GraphicsSurfaces>>& d = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			// Replays rs into this surface by splitting it into tiles that are rendered concurrently on io2d's worker pool and the calling thread. A threadCount of 0 uses one thread per hardware thread.
+			void render_tiled(const basic_recorded_scene<GraphicsSurfaces>& rs, int tileWidth = 512, int tileHeight = 512, unsigned int threadCount = 0);
+		};
+
+		// An image too large for an image surface, such as a map of a whole city. It's stored as square tiles of tileSize
+		// pixels (rounded up to a multiple of 16), each of which is only allocated once something is drawn on it, and every
+		// draw is made on just the tiles it can touch. Areas that have never been drawn on are transparent black.
+		template <class GraphicsSurfaces>
+		class basic_tiled_image_surface {
+		public:
+			using graphics_math_type = typename GraphicsSurfaces::graphics_math_type;
+			using data_type = typename GraphicsSurfaces::surfaces::tiled_image_surface_data_type;
+
+		private:
+			data_type _Data;
+
+		public:
+			data_type& data() noexcept;
+			basic_tiled_image_surface(io2d::format fmt, int width, int height, int tileSize = 512);
+			basic_tiled_image_surface(basic_tiled_image_surface&&) noexcept;
+			basic_tiled_image_surface& operator=(basic_tiled_image_surface&&) noexcept;
+			~basic_tiled_image_surface() noexcept;
+#ifdef _Filesystem_support_test
+			// Keeps no more than residentBytes of tiles in memory (but always at least one tile), writing the least recently
+			// used ones to a store file at p and reading them back when they're next drawn on, copied or saved. The store
+			// file is removed with the surface.
+			void page_to(filesystem::path p, size_t residentBytes);
+			// Saves the image as a tiled TIFF, written a tile at a time; image_file_format::tiff is the only format supported.
+			void save(filesystem::path p, image_file_format i);
+			void save(filesystem::path p, image_file_format i, error_code& ec) noexcept;
+#else
+			// Keeps no more than residentBytes of tiles in memory (but always at least one tile), writing the least recently
+			// used ones to a store file at p and reading them back when they're next drawn on, copied or saved. The store
+			// file is removed with the surface.
+			void page_to(::std::string p, size_t residentBytes);
+			// Saves the image as a tiled TIFF, written a tile at a time; image_file_format::tiff is the only format supported.
+			void save(::std::string p, image_file_format i);
+			void save(::std::string p, image_file_format i, error_code& ec) noexcept;
+#endif
+			io2d::format format() const noexcept;
+			basic_display_point<graphics_math_type> dimensions() const noexcept;
+			int tile_size() const noexcept;
+			// The number of tiles that have been drawn on, and how many of those are in memory.
+			size_t allocated_tiles() const noexcept;
+			size_t resident_tiles() const noexcept;
+			// Copies the pixels of area, rounded out to whole pixels, into a new image surface. Parts of area outside the
+			// image are transparent black.
+			basic_image_surface<GraphicsSurfaces> copy_region(const basic_bounding_box<graphics_math_type>& area);
+
+			void clear();
+			void paint(const basic_brush<GraphicsSurfaces>& b, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class Allocator>
+			void stroke(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_stroke_props<GraphicsSurfaces>>& sp = nullopt, const optional<basic_dashes<GraphicsSurfaces>>& d = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			void stroke(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_stroke_props<GraphicsSurfaces>>& sp = nullopt, const optional<basic_dashes<GraphicsSurfaces>>& d = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class Allocator>
+			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			void mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_mask_props<GraphicsSurfaces>>& mp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+		};
+
+		// Counters for an output surface that rasterizes its frames on a render thread (see basic_output_surface::async_render).
+		// Latency is measured from the end of the draw callback to the frame being fully rasterized.
+		struct async_render_stats {
+			uint64_t frames_submitted = 0;
+			uint64_t frames_rendered = 0;
+			chrono::nanoseconds last_latency{};
+			chrono::nanoseconds average_latency{};
+			chrono::nanoseconds max_latency{};
+			chrono::nanoseconds last_render_time{};
+			float frames_per_second = 0.0f;
+		};
+
+		// How long the phases of one frame of an output surface took. events is the time spent handling window system events
+		// since the previous frame, draw the draw callback, flush finishing the back buffer (in async_render mode, waiting for
+		// the render thread) and present getting it to the display.
+		struct frame_timing {
+			chrono::nanoseconds events{};
+			chrono::nanoseconds draw{};
+			chrono::nanoseconds flush{};
+			chrono::nanoseconds present{};
+			chrono::nanoseconds total{};
+		};
+
+		// Frame time percentiles over an output surface's most recent frames (see basic_output_surface::frame_stats).
+		struct frame_timing_stats {
+			struct percentiles {
+				chrono::nanoseconds p50{};
+				chrono::nanoseconds p95{};
+				chrono::nanoseconds p99{};
+				chrono::nanoseconds max{};
+			};
+			// Frames drawn since the surface was created, and how many of the latest ones the percentiles cover.
+			uint64_t frames = 0;
+			int sample_count = 0;
+			percentiles events;
+			percentiles draw;
+			percentiles flush;
+			percentiles present;
+			percentiles total;
 		};
 
 		template <class GraphicsSurfaces>
@@ -256,6 +466,10 @@ namespace std::experimental::io2d {
 
 			// rendering functions
 			void clear();
+			// In async_render mode, flush also waits for the render thread and draws what was recorded since the last frame
+			// into the back buffer. Call it before changing the back buffer's pixels directly, and mark_dirty afterwards.
+			// Without it, draws recorded before the change are rasterized after it, over it, or with more than one buffer
+			// into a swap chain buffer that never sees the change.
 			void flush();
 			void flush(error_code& ec) noexcept;
 			void mark_dirty();
@@ -270,6 +484,10 @@ namespace std::experimental::io2d {
 			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
 			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
 			void mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_mask_props<GraphicsSurfaces>>& mp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class InputIterator>
+			void fill_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class InputIterator>
+			void stroke_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_stroke_props<GraphicsSurfaces>>& sp = nullopt, const optional<basic_dashes<GraphicsSurfaces>>& d = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
 
 			// display functions
 			void draw_callback(const function<void(basic_output_surface& sfc)>& fn);
@@ -284,6 +502,22 @@ namespace std::experimental::io2d {
 			void letterbox_brush_props(const optional<basic_brush_props<GraphicsSurfaces>>& bp) noexcept;
 			void auto_clear(bool val) noexcept;
 			void redraw_required(bool val = true) noexcept;
+			// When enabled, draw calls are recorded and rasterized on a render thread so that the draw callback returns immediately.
+			void async_render(bool val);
+			// Number of back buffers (1 to 3) used in async_render mode. With 2 or more, presenting a frame overlaps rasterizing the next one.
+			void buffer_count(int val);
+			// When enabled, only the parts of the back buffer touched by draw calls or mark_dirty since the last frame are presented.
+			// Mostly useful with auto_clear off, since clearing damages the whole surface.
+			void damage_tracking(bool val);
+			// Ends the show once this many frames were drawn. 0, the default, means no limit.
+			void frame_budget(int val);
+			// Ends the show once this much time has passed since begin_show. It is checked between frames; zero means no limit.
+			void time_budget(chrono::nanoseconds val);
+			// Called with a copy of the back buffer each time a frame is presented. The copy is only valid during the call; it is
+			// kept for the next frame, and with damage_tracking only the damaged part of it is updated.
+			void present_callback(const function<void(const _Interchange_buffer&)>& fn);
+			// Called with the timing of each frame right after it was presented, on the thread that runs begin_show.
+			void frame_timing_callback(const function<void(const frame_timing&)>& fn);
 
 			io2d::format format() const noexcept;
 			basic_display_point<graphics_math_type> dimensions() const noexcept;
@@ -294,6 +528,14 @@ namespace std::experimental::io2d {
 			optional<basic_brush<GraphicsSurfaces>> letterbox_brush() const noexcept;
 			optional<basic_brush_props<GraphicsSurfaces>> letterbox_brush_props() const noexcept;
 			bool auto_clear() const noexcept;
+			bool async_render() const noexcept;
+			int buffer_count() const noexcept;
+			bool damage_tracking() const noexcept;
+			int frame_budget() const noexcept;
+			chrono::nanoseconds time_budget() const noexcept;
+			async_render_stats async_stats() const noexcept;
+			// Timing of the last 256 frames. Can be called from any thread.
+			frame_timing_stats frame_stats() const noexcept;
 		};
 
 		template <class GraphicsSurfaces>
@@ -338,6 +580,10 @@ namespace std::experimental::io2d {
 			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
 			void fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
 			void mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_mask_props<GraphicsSurfaces>>& mp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class InputIterator>
+			void fill_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
+			template <class InputIterator>
+			void stroke_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp = nullopt, const optional<basic_stroke_props<GraphicsSurfaces>>& sp = nullopt, const optional<basic_dashes<GraphicsSurfaces>>& d = nullopt, const optional<basic_render_props<GraphicsSurfaces>>& rp = nullopt, const optional<basic_clip_props<GraphicsSurfaces>>& cl = nullopt);
 
 			// display functions
 			void draw_callback(const function<void(basic_unmanaged_output_surface& sfc)>& fn);
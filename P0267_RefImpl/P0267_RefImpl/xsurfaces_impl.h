@@ -6,6 +6,134 @@ namespace std {
 	namespace experimental {
 		namespace io2d {
 			inline namespace v1 {
+				// path_instance
+
+				template <class GraphicsSurfaces>
+				inline basic_path_instance<GraphicsSurfaces>::basic_path_instance(const basic_matrix_2d<graphics_math_type>& m, const basic_brush<GraphicsSurfaces>& b)
+					: _Matrix(m)
+					, _Paint(b) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_path_instance<GraphicsSurfaces>::basic_path_instance(const basic_matrix_2d<graphics_math_type>& m, const rgba_color& c) noexcept
+					: _Matrix(m)
+					, _Paint(c) {
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_path_instance<GraphicsSurfaces>::matrix(const basic_matrix_2d<graphics_math_type>& m) noexcept {
+					_Matrix = m;
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_path_instance<GraphicsSurfaces>::brush(const basic_brush<GraphicsSurfaces>& b) {
+					_Paint = b;
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_path_instance<GraphicsSurfaces>::color(const rgba_color& c) noexcept {
+					_Paint = c;
+				}
+				template <class GraphicsSurfaces>
+				inline basic_matrix_2d<typename basic_path_instance<GraphicsSurfaces>::graphics_math_type> basic_path_instance<GraphicsSurfaces>::matrix() const noexcept {
+					return _Matrix;
+				}
+				template <class GraphicsSurfaces>
+				inline bool basic_path_instance<GraphicsSurfaces>::has_brush() const noexcept {
+					return _Paint.index() == 0;
+				}
+				template <class GraphicsSurfaces>
+				inline const basic_brush<GraphicsSurfaces>& basic_path_instance<GraphicsSurfaces>::brush() const {
+					return get<basic_brush<GraphicsSurfaces>>(_Paint);
+				}
+				template <class GraphicsSurfaces>
+				inline rgba_color basic_path_instance<GraphicsSurfaces>::color() const {
+					return get<rgba_color>(_Paint);
+				}
+
+				// recorded_scene
+
+				template <class GraphicsSurfaces>
+				inline const typename basic_recorded_scene<GraphicsSurfaces>::data_type& basic_recorded_scene<GraphicsSurfaces>::data() const noexcept {
+					return _Data;
+				}
+				template <class GraphicsSurfaces>
+				inline typename basic_recorded_scene<GraphicsSurfaces>::data_type& basic_recorded_scene<GraphicsSurfaces>::data() noexcept {
+					return _Data;
+				}
+				template <class GraphicsSurfaces>
+				inline basic_recorded_scene<GraphicsSurfaces>::basic_recorded_scene() noexcept
+					: _Data(GraphicsSurfaces::surfaces::create_recorded_scene()) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_recorded_scene<GraphicsSurfaces>::basic_recorded_scene(const basic_recorded_scene& other)
+					: _Data(GraphicsSurfaces::surfaces::copy_recorded_scene(other._Data)) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_recorded_scene<GraphicsSurfaces>& basic_recorded_scene<GraphicsSurfaces>::operator=(const basic_recorded_scene& other) {
+					if (this != &other) {
+						GraphicsSurfaces::surfaces::destroy(_Data);
+						_Data = GraphicsSurfaces::surfaces::copy_recorded_scene(other._Data);
+					}
+					return *this;
+				}
+				template <class GraphicsSurfaces>
+				inline basic_recorded_scene<GraphicsSurfaces>::basic_recorded_scene(basic_recorded_scene&& other) noexcept
+					: _Data(GraphicsSurfaces::surfaces::move_recorded_scene(move(other._Data))) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_recorded_scene<GraphicsSurfaces>& basic_recorded_scene<GraphicsSurfaces>::operator=(basic_recorded_scene&& other) noexcept {
+					if (this != &other) {
+						GraphicsSurfaces::surfaces::destroy(_Data);
+						_Data = GraphicsSurfaces::surfaces::move_recorded_scene(move(other._Data));
+					}
+					return *this;
+				}
+				template <class GraphicsSurfaces>
+				inline basic_recorded_scene<GraphicsSurfaces>::~basic_recorded_scene() noexcept {
+					GraphicsSurfaces::surfaces::destroy(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline bool basic_recorded_scene<GraphicsSurfaces>::empty() const noexcept {
+					return GraphicsSurfaces::surfaces::empty(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_recorded_scene<GraphicsSurfaces>::clear() {
+					GraphicsSurfaces::surfaces::clear(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_recorded_scene<GraphicsSurfaces>::paint(const basic_brush<GraphicsSurfaces>& b, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::paint(_Data, b, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class Allocator>
+				inline void basic_recorded_scene<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::stroke(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_recorded_scene<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::stroke(_Data, b, ip, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class Allocator>
+				inline void basic_recorded_scene<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::fill(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_recorded_scene<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::fill(_Data, b, ip, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_recorded_scene<GraphicsSurfaces>::mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_mask_props<GraphicsSurfaces>>& mp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::mask(_Data, b, mb, _Value_or_default(bp), _Value_or_default(mp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class InputIterator>
+				inline void basic_recorded_scene<GraphicsSurfaces>::fill_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::fill_instances(_Data, ip, first, last, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class InputIterator>
+				inline void basic_recorded_scene<GraphicsSurfaces>::stroke_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::stroke_instances(_Data, ip, first, last, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
+				}
+
 				// image_surface
 
 				template <class GraphicsSurfaces>
@@ -26,6 +154,14 @@ namespace std {
 				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(filesystem::path f, image_file_format iff, io2d::format fmt, error_code& ec) noexcept
 					: _Data(GraphicsSurfaces::surfaces::create_image_surface(f, iff, fmt, ec)) {
 				}
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(filesystem::path f, image_file_format iff, io2d::format fmt, int maxDimension)
+					: _Data(GraphicsSurfaces::surfaces::create_image_surface(f, iff, fmt, maxDimension)) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(filesystem::path f, image_file_format iff, io2d::format fmt, int maxDimension, error_code& ec) noexcept
+					: _Data(GraphicsSurfaces::surfaces::create_image_surface(f, iff, fmt, maxDimension, ec)) {
+				}
 #else
 				template <class GraphicsSurfaces>
 				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(::std::string f, image_file_format iff, io2d::format fmt)
@@ -35,7 +171,31 @@ namespace std {
 				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(::std::string f, image_file_format iff, io2d::format fmt, error_code& ec) noexcept
 					: _Data(GraphicsSurfaces::surfaces::create_image_surface(f, iff, fmt, ec)) {
 				}
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(::std::string f, image_file_format iff, io2d::format fmt, int maxDimension)
+					: _Data(GraphicsSurfaces::surfaces::create_image_surface(f, iff, fmt, maxDimension)) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(::std::string f, image_file_format iff, io2d::format fmt, int maxDimension, error_code& ec) noexcept
+					: _Data(GraphicsSurfaces::surfaces::create_image_surface(f, iff, fmt, maxDimension, ec)) {
+				}
 #endif
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt)
+					: _Data(GraphicsSurfaces::surfaces::create_image_surface(data, size, iff, fmt)) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt, error_code& ec) noexcept
+					: _Data(GraphicsSurfaces::surfaces::create_image_surface(data, size, iff, fmt, ec)) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt, int maxDimension)
+					: _Data(GraphicsSurfaces::surfaces::create_image_surface(data, size, iff, fmt, maxDimension)) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(const ::std::byte* data, size_t size, image_file_format iff, io2d::format fmt, int maxDimension, error_code& ec) noexcept
+					: _Data(GraphicsSurfaces::surfaces::create_image_surface(data, size, iff, fmt, maxDimension, ec)) {
+				}
 				template<class GraphicsSurfaces>
 				inline basic_image_surface<GraphicsSurfaces>::basic_image_surface(basic_image_surface&& val) noexcept 
 					: _Data(move(GraphicsSurfaces::surfaces::move_image_surface(move(val._Data)))) {
@@ -54,6 +214,92 @@ namespace std {
 					GraphicsSurfaces::surfaces::destroy(_Data);
 				}
 
+				// Whether extension, in any case, is lowerCase. Compares in place so that nothing allocates.
+				inline bool _Extension_is(::std::string_view extension, ::std::string_view lowerCase) noexcept {
+					return extension.size() == lowerCase.size() && ::std::equal(extension.begin(), extension.end(), lowerCase.begin(), [](char c, char lower) {
+						return tolower(static_cast<unsigned char>(c)) == lower;
+					});
+				}
+				inline image_file_format _Image_file_format_from_extension(const ::std::string& p) noexcept {
+					const auto dot = p.find_last_of('.');
+					if (dot == ::std::string::npos) {
+						return image_file_format::unknown;
+					}
+					const ::std::string_view extension(p.data() + dot + 1, p.size() - dot - 1);
+					if (_Extension_is(extension, "png")) {
+						return image_file_format::png;
+					}
+					if (_Extension_is(extension, "jpg") || _Extension_is(extension, "jpeg")) {
+						return image_file_format::jpeg;
+					}
+					if (_Extension_is(extension, "tif") || _Extension_is(extension, "tiff")) {
+						return image_file_format::tiff;
+					}
+					return image_file_format::unknown;
+				}
+#ifdef _Filesystem_support_test
+				inline image_file_format _Image_file_format_from_extension(const filesystem::path& p) {
+					return _Image_file_format_from_extension(p.extension().string());
+				}
+#endif
+
+				// The state shared by the pool tasks of one load_images call. Each task claims the next unloaded path until
+				// there are none left, so a slow file holds up only the thread that's decoding it.
+				template <class GraphicsSurfaces, class Path>
+				struct _Image_load_batch {
+					vector<Path> paths;
+					vector<promise<basic_image_surface<GraphicsSurfaces>>> results;
+					atomic<size_t> next{ 0 };
+					image_file_format iff;
+					io2d::format fmt;
+
+					void run() noexcept {
+						for (auto i = next.fetch_add(1); i < paths.size(); i = next.fetch_add(1)) {
+							try {
+								const auto fileFormat = (iff == image_file_format::unknown) ? _Image_file_format_from_extension(paths[i]) : iff;
+								results[i].set_value(basic_image_surface<GraphicsSurfaces>(paths[i], fileFormat, fmt));
+							}
+							catch (...) {
+								results[i].set_exception(current_exception());
+							}
+						}
+					}
+				};
+
+				template <class GraphicsSurfaces, class Path>
+				inline vector<future<basic_image_surface<GraphicsSurfaces>>> _Load_images(const vector<Path>& paths, image_file_format iff, io2d::format fmt, unsigned int threadCount) {
+					auto batch = make_shared<_Image_load_batch<GraphicsSurfaces, Path>>();
+					batch->paths = paths;
+					batch->results.resize(paths.size());
+					batch->iff = iff;
+					batch->fmt = fmt;
+					vector<future<basic_image_surface<GraphicsSurfaces>>> futures;
+					futures.reserve(paths.size());
+					for (auto& result : batch->results) {
+						futures.push_back(result.get_future());
+					}
+					if (threadCount == 0) {
+						threadCount = max(thread::hardware_concurrency(), 1U);
+					}
+					const auto tasks = static_cast<unsigned int>(min(static_cast<size_t>(threadCount), paths.size()));
+					for (unsigned int i = 0; i < tasks; i++) {
+						_Thread_pool::instance().submit([batch]() { batch->run(); }, threadCount);
+					}
+					return futures;
+				}
+
+#ifdef _Filesystem_support_test
+				template <class GraphicsSurfaces>
+				inline vector<future<basic_image_surface<GraphicsSurfaces>>> basic_image_surface<GraphicsSurfaces>::load_images(const vector<filesystem::path>& paths, image_file_format iff, io2d::format fmt, unsigned int threadCount) {
+					return _Load_images<GraphicsSurfaces>(paths, iff, fmt, threadCount);
+				}
+#else
+				template <class GraphicsSurfaces>
+				inline vector<future<basic_image_surface<GraphicsSurfaces>>> basic_image_surface<GraphicsSurfaces>::load_images(const vector<::std::string>& paths, image_file_format iff, io2d::format fmt, unsigned int threadCount) {
+					return _Load_images<GraphicsSurfaces>(paths, iff, fmt, threadCount);
+				}
+#endif
+
 #ifdef _Filesystem_support_test
 				template <class GraphicsSurfaces>
 				inline void basic_image_surface<GraphicsSurfaces>::save(filesystem::path p, image_file_format iff) {
@@ -73,11 +319,68 @@ namespace std {
 					GraphicsSurfaces::surfaces::save(_Data, p, iff, ec);
 				}
 #endif
+				template <class GraphicsSurfaces>
+				inline void basic_image_surface<GraphicsSurfaces>::save(vector<::std::byte>& buffer, image_file_format iff) {
+					const auto initialSize = buffer.size();
+					try {
+						GraphicsSurfaces::surfaces::save(_Data, [&buffer](const ::std::byte* bytes, size_t size) {
+							buffer.insert(buffer.end(), bytes, bytes + size);
+						}, iff);
+					}
+					catch (...) {
+						buffer.resize(initialSize);
+						throw;
+					}
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_image_surface<GraphicsSurfaces>::save(vector<::std::byte>& buffer, image_file_format iff, error_code& ec) noexcept {
+					const auto initialSize = buffer.size();
+					bool outOfMemory = false;
+					GraphicsSurfaces::surfaces::save(_Data, [&buffer, &outOfMemory](const ::std::byte* bytes, size_t size) {
+						try {
+							buffer.insert(buffer.end(), bytes, bytes + size);
+						}
+						catch (const bad_alloc&) {
+							outOfMemory = true;
+							throw;
+						}
+					}, iff, ec);
+					if (ec) {
+						buffer.resize(initialSize);
+						if (outOfMemory) {
+							ec = make_error_code(errc::not_enough_memory);
+						}
+					}
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_image_surface<GraphicsSurfaces>::save(const function<void(const ::std::byte*, size_t)>& sink, image_file_format iff) {
+					GraphicsSurfaces::surfaces::save(_Data, sink, iff);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_image_surface<GraphicsSurfaces>::save(const function<void(const ::std::byte*, size_t)>& sink, image_file_format iff, error_code& ec) noexcept {
+					GraphicsSurfaces::surfaces::save(_Data, sink, iff, ec);
+				}
 
 				template<class GraphicsSurfaces>
 				inline basic_display_point<typename basic_image_surface<GraphicsSurfaces>::graphics_math_type> basic_image_surface<GraphicsSurfaces>::max_dimensions() noexcept {
 					return GraphicsSurfaces::surfaces::max_dimensions();
 				}
+				template<class GraphicsSurfaces>
+				inline void basic_image_surface<GraphicsSurfaces>::cache_budget(size_t bytes) noexcept {
+					GraphicsSurfaces::surfaces::cache_budget(bytes);
+				}
+				template<class GraphicsSurfaces>
+				inline size_t basic_image_surface<GraphicsSurfaces>::cache_budget() noexcept {
+					return GraphicsSurfaces::surfaces::cache_budget();
+				}
+				template<class GraphicsSurfaces>
+				inline image_cache_stats basic_image_surface<GraphicsSurfaces>::cache_stats() noexcept {
+					return GraphicsSurfaces::surfaces::cache_stats();
+				}
+				template<class GraphicsSurfaces>
+				inline void basic_image_surface<GraphicsSurfaces>::clear_cache() noexcept {
+					GraphicsSurfaces::surfaces::clear_cache();
+				}
 				template <class GraphicsSurfaces>
 				inline io2d::format basic_image_surface<GraphicsSurfaces>::format() const noexcept {
 					return GraphicsSurfaces::surfaces::format(_Data);
@@ -117,29 +420,156 @@ namespace std {
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_image_surface<GraphicsSurfaces>::paint(const basic_brush<GraphicsSurfaces>& b, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::paint(_Data, b, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::paint(_Data, b, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				template <class Allocator>
 				inline void basic_image_surface<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::stroke(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (sp == nullopt ? basic_stroke_props<GraphicsSurfaces>() : sp.value()), (d == nullopt ? basic_dashes<GraphicsSurfaces>() : d.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::stroke(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_image_surface<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::stroke(_Data, b, ip, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (sp == nullopt ? basic_stroke_props<GraphicsSurfaces>() : sp.value()), (d == nullopt ? basic_dashes<GraphicsSurfaces>() : d.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::stroke(_Data, b, ip, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				template <class Allocator>
 				inline void basic_image_surface<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::fill(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::fill(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_image_surface<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::fill(_Data, b, ip, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::fill(_Data, b, ip, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_image_surface<GraphicsSurfaces>::mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_mask_props<GraphicsSurfaces>>& mp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::mask(_Data, b, mb, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (mp == nullopt ? basic_mask_props<GraphicsSurfaces>() : mp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::mask(_Data, b, mb, _Value_or_default(bp), _Value_or_default(mp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class InputIterator>
+				inline void basic_image_surface<GraphicsSurfaces>::fill_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::fill_instances(_Data, ip, first, last, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class InputIterator>
+				inline void basic_image_surface<GraphicsSurfaces>::stroke_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::stroke_instances(_Data, ip, first, last, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_image_surface<GraphicsSurfaces>::render_tiled(const basic_recorded_scene<GraphicsSurfaces>& rs, int tileWidth, int tileHeight, unsigned int threadCount) {
+					GraphicsSurfaces::surfaces::render_tiled(_Data, rs.data(), tileWidth, tileHeight, threadCount);
+				}
+
+				// basic_tiled_image_surface
+
+				template <class GraphicsSurfaces>
+				inline typename basic_tiled_image_surface<GraphicsSurfaces>::data_type& basic_tiled_image_surface<GraphicsSurfaces>::data() noexcept {
+					return _Data;
+				}
+				template <class GraphicsSurfaces>
+				inline basic_tiled_image_surface<GraphicsSurfaces>::basic_tiled_image_surface(io2d::format fmt, int width, int height, int tileSize)
+					: _Data(GraphicsSurfaces::surfaces::create_tiled_image_surface(fmt, width, height, tileSize)) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_tiled_image_surface<GraphicsSurfaces>::basic_tiled_image_surface(basic_tiled_image_surface&& val) noexcept
+					: _Data(move(GraphicsSurfaces::surfaces::move_tiled_image_surface(move(val._Data)))) {
+				}
+				template <class GraphicsSurfaces>
+				inline basic_tiled_image_surface<GraphicsSurfaces>& basic_tiled_image_surface<GraphicsSurfaces>::operator=(basic_tiled_image_surface&& val) noexcept {
+					if (this != &val) {
+						_Data = move(GraphicsSurfaces::surfaces::move_tiled_image_surface(move(val._Data)));
+					}
+					return *this;
+				}
+				template <class GraphicsSurfaces>
+				inline basic_tiled_image_surface<GraphicsSurfaces>::~basic_tiled_image_surface() noexcept {
+					GraphicsSurfaces::surfaces::destroy(_Data);
+				}
+#ifdef _Filesystem_support_test
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::page_to(filesystem::path p, size_t residentBytes) {
+					GraphicsSurfaces::surfaces::page_to(_Data, p, residentBytes);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::save(filesystem::path p, image_file_format i) {
+					GraphicsSurfaces::surfaces::save(_Data, p, i);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::save(filesystem::path p, image_file_format i, error_code& ec) noexcept {
+					GraphicsSurfaces::surfaces::save(_Data, p, i, ec);
+				}
+#else
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::page_to(::std::string p, size_t residentBytes) {
+					GraphicsSurfaces::surfaces::page_to(_Data, p, residentBytes);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::save(::std::string p, image_file_format i) {
+					GraphicsSurfaces::surfaces::save(_Data, p, i);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::save(::std::string p, image_file_format i, error_code& ec) noexcept {
+					GraphicsSurfaces::surfaces::save(_Data, p, i, ec);
+				}
+#endif
+				template <class GraphicsSurfaces>
+				inline io2d::format basic_tiled_image_surface<GraphicsSurfaces>::format() const noexcept {
+					return GraphicsSurfaces::surfaces::format(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline basic_display_point<typename basic_tiled_image_surface<GraphicsSurfaces>::graphics_math_type> basic_tiled_image_surface<GraphicsSurfaces>::dimensions() const noexcept {
+					return GraphicsSurfaces::surfaces::dimensions(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline int basic_tiled_image_surface<GraphicsSurfaces>::tile_size() const noexcept {
+					return GraphicsSurfaces::surfaces::tile_size(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline size_t basic_tiled_image_surface<GraphicsSurfaces>::allocated_tiles() const noexcept {
+					return GraphicsSurfaces::surfaces::allocated_tiles(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline size_t basic_tiled_image_surface<GraphicsSurfaces>::resident_tiles() const noexcept {
+					return GraphicsSurfaces::surfaces::resident_tiles(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline basic_image_surface<GraphicsSurfaces> basic_tiled_image_surface<GraphicsSurfaces>::copy_region(const basic_bounding_box<graphics_math_type>& area) {
+					const auto left = static_cast<int>(::std::floor(area.x()));
+					const auto top = static_cast<int>(::std::floor(area.y()));
+					const auto right = static_cast<int>(::std::ceil(area.x() + area.width()));
+					const auto bottom = static_cast<int>(::std::ceil(area.y() + area.height()));
+					basic_image_surface<GraphicsSurfaces> result(format(), ::std::max(1, right - left), ::std::max(1, bottom - top));
+					GraphicsSurfaces::surfaces::copy_region(_Data, left, top, result.data());
+					return result;
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::clear() {
+					GraphicsSurfaces::surfaces::clear(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::paint(const basic_brush<GraphicsSurfaces>& b, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::paint(_Data, b, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class Allocator>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::stroke(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::stroke(_Data, b, ip, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class Allocator>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::fill(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::fill(_Data, b, ip, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_tiled_image_surface<GraphicsSurfaces>::mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_mask_props<GraphicsSurfaces>>& mp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::mask(_Data, b, mb, _Value_or_default(bp), _Value_or_default(mp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 
 				template<class GraphicsSurfaces>
@@ -247,29 +677,39 @@ namespace std {
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_output_surface<GraphicsSurfaces>::paint(const basic_brush<GraphicsSurfaces>& b, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::paint(_Data, b, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::paint(_Data, b, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				template <class Allocator>
 				inline void basic_output_surface<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::stroke(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (sp == nullopt ? basic_stroke_props<GraphicsSurfaces>() : sp.value()), (d == nullopt ? basic_dashes<GraphicsSurfaces>() : d.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::stroke(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_output_surface<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::stroke(_Data, b, ip, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (sp == nullopt ? basic_stroke_props<GraphicsSurfaces>() : sp.value()), (d == nullopt ? basic_dashes<GraphicsSurfaces>() : d.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::stroke(_Data, b, ip, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				template <class Allocator>
 				inline void basic_output_surface<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::fill(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::fill(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_output_surface<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::fill(_Data, b, ip, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::fill(_Data, b, ip, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_output_surface<GraphicsSurfaces>::mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_mask_props<GraphicsSurfaces>>& mp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::mask(_Data, b, mb, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (mp == nullopt ? basic_mask_props<GraphicsSurfaces>() : mp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::mask(_Data, b, mb, _Value_or_default(bp), _Value_or_default(mp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class InputIterator>
+				inline void basic_output_surface<GraphicsSurfaces>::fill_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::fill_instances(_Data, ip, first, last, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class InputIterator>
+				inline void basic_output_surface<GraphicsSurfaces>::stroke_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::stroke_instances(_Data, ip, first, last, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
 				}
 
 				template <class GraphicsSurfaces>
@@ -321,6 +761,34 @@ namespace std {
 					GraphicsSurfaces::surfaces::redraw_required(_Data, val);
 				}
 				template <class GraphicsSurfaces>
+				inline void basic_output_surface<GraphicsSurfaces>::async_render(bool val) {
+					GraphicsSurfaces::surfaces::async_render(_Data, val);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_output_surface<GraphicsSurfaces>::buffer_count(int val) {
+					GraphicsSurfaces::surfaces::buffer_count(_Data, val);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_output_surface<GraphicsSurfaces>::damage_tracking(bool val) {
+					GraphicsSurfaces::surfaces::damage_tracking(_Data, val);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_output_surface<GraphicsSurfaces>::frame_budget(int val) {
+					GraphicsSurfaces::surfaces::frame_budget(_Data, val);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_output_surface<GraphicsSurfaces>::time_budget(chrono::nanoseconds val) {
+					GraphicsSurfaces::surfaces::time_budget(_Data, val);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_output_surface<GraphicsSurfaces>::present_callback(const function<void(const _Interchange_buffer&)>& fn) {
+					GraphicsSurfaces::surfaces::present_callback(_Data, fn);
+				}
+				template <class GraphicsSurfaces>
+				inline void basic_output_surface<GraphicsSurfaces>::frame_timing_callback(const function<void(const frame_timing&)>& fn) {
+					GraphicsSurfaces::surfaces::frame_timing_callback(_Data, fn);
+				}
+				template <class GraphicsSurfaces>
 				inline io2d::format basic_output_surface<GraphicsSurfaces>::format() const noexcept {
 					return GraphicsSurfaces::surfaces::format(_Data);
 				}
@@ -356,6 +824,34 @@ namespace std {
 				inline bool basic_output_surface<GraphicsSurfaces>::auto_clear() const noexcept {
 					return GraphicsSurfaces::surfaces::auto_clear(_Data);
 				}
+				template <class GraphicsSurfaces>
+				inline bool basic_output_surface<GraphicsSurfaces>::async_render() const noexcept {
+					return GraphicsSurfaces::surfaces::async_render(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline int basic_output_surface<GraphicsSurfaces>::buffer_count() const noexcept {
+					return GraphicsSurfaces::surfaces::buffer_count(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline bool basic_output_surface<GraphicsSurfaces>::damage_tracking() const noexcept {
+					return GraphicsSurfaces::surfaces::damage_tracking(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline int basic_output_surface<GraphicsSurfaces>::frame_budget() const noexcept {
+					return GraphicsSurfaces::surfaces::frame_budget(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline chrono::nanoseconds basic_output_surface<GraphicsSurfaces>::time_budget() const noexcept {
+					return GraphicsSurfaces::surfaces::time_budget(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline async_render_stats basic_output_surface<GraphicsSurfaces>::async_stats() const noexcept {
+					return GraphicsSurfaces::surfaces::async_stats(_Data);
+				}
+				template <class GraphicsSurfaces>
+				inline frame_timing_stats basic_output_surface<GraphicsSurfaces>::frame_stats() const noexcept {
+					return GraphicsSurfaces::surfaces::frame_stats(_Data);
+				}
 
 
 				// unmanaged output surface
@@ -447,29 +943,39 @@ namespace std {
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_unmanaged_output_surface<GraphicsSurfaces>::paint(const basic_brush<GraphicsSurfaces>& b, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::paint(_Data, b, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::paint(_Data, b, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				template <class Allocator>
 				inline void basic_unmanaged_output_surface<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::stroke(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (sp == nullopt ? basic_stroke_props<GraphicsSurfaces>() : sp.value()), (d == nullopt ? basic_dashes<GraphicsSurfaces>() : d.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::stroke(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_unmanaged_output_surface<GraphicsSurfaces>::stroke(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::stroke(_Data, b, ip, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (sp == nullopt ? basic_stroke_props<GraphicsSurfaces>() : sp.value()), (d == nullopt ? basic_dashes<GraphicsSurfaces>() : d.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::stroke(_Data, b, ip, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				template <class Allocator>
 				inline void basic_unmanaged_output_surface<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_path_builder<GraphicsSurfaces, Allocator>& pb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::fill(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::fill(_Data, b, basic_interpreted_path<GraphicsSurfaces>(pb), _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_unmanaged_output_surface<GraphicsSurfaces>::fill(const basic_brush<GraphicsSurfaces>& b, const basic_interpreted_path<GraphicsSurfaces>& ip, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::fill(_Data, b, ip, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::fill(_Data, b, ip, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
 				}
 				template <class GraphicsSurfaces>
 				inline void basic_unmanaged_output_surface<GraphicsSurfaces>::mask(const basic_brush<GraphicsSurfaces>& b, const basic_brush<GraphicsSurfaces>& mb, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_mask_props<GraphicsSurfaces>>& mp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
-					GraphicsSurfaces::surfaces::mask(_Data, b, mb, (bp == nullopt ? basic_brush_props<GraphicsSurfaces>() : bp.value()), (mp == nullopt ? basic_mask_props<GraphicsSurfaces>() : mp.value()), (rp == nullopt ? basic_render_props<GraphicsSurfaces>() : rp.value()), (cl == nullopt ? basic_clip_props<GraphicsSurfaces>() : cl.value()));
+					GraphicsSurfaces::surfaces::mask(_Data, b, mb, _Value_or_default(bp), _Value_or_default(mp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class InputIterator>
+				inline void basic_unmanaged_output_surface<GraphicsSurfaces>::fill_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::fill_instances(_Data, ip, first, last, _Value_or_default(bp), _Value_or_default(rp), _Value_or_default(cl));
+				}
+				template <class GraphicsSurfaces>
+				template <class InputIterator>
+				inline void basic_unmanaged_output_surface<GraphicsSurfaces>::stroke_instances(const basic_interpreted_path<GraphicsSurfaces>& ip, InputIterator first, InputIterator last, const optional<basic_brush_props<GraphicsSurfaces>>& bp, const optional<basic_stroke_props<GraphicsSurfaces>>& sp, const optional<basic_dashes<GraphicsSurfaces>>& d, const optional<basic_render_props<GraphicsSurfaces>>& rp, const optional<basic_clip_props<GraphicsSurfaces>>& cl) {
+					GraphicsSurfaces::surfaces::stroke_instances(_Data, ip, first, last, _Value_or_default(bp), _Value_or_default(sp), _Value_or_default(d), _Value_or_default(rp), _Value_or_default(cl));
 				}
 
 				template <class GraphicsSurfaces>
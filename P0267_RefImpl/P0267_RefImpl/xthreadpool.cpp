@@ -0,0 +1,54 @@
+#include "xthreadpool.h"
+
+namespace std::experimental::io2d { inline namespace v1 {
+
+	_Thread_pool& _Thread_pool::instance() {
+		static _Thread_pool pool;
+		return pool;
+	}
+
+	_Thread_pool::~_Thread_pool() noexcept {
+		{
+			lock_guard<mutex> lock(_Mutex);
+			_Stop = true;
+			_Tasks.clear();
+		}
+		_Work_available.notify_all();
+		for (auto& t : _Threads) {
+			t.join();
+		}
+	}
+
+	void _Thread_pool::submit(function<void()> task, unsigned int minThreads) {
+		{
+			lock_guard<mutex> lock(_Mutex);
+			while (_Threads.size() < minThreads) {
+				_Threads.emplace_back([this]() { _Run(); });
+			}
+			_Tasks.push_back(move(task));
+		}
+		_Work_available.notify_one();
+	}
+
+	unsigned int _Thread_pool::thread_count() {
+		lock_guard<mutex> lock(_Mutex);
+		return static_cast<unsigned int>(_Threads.size());
+	}
+
+	void _Thread_pool::_Run() noexcept {
+		for (;;) {
+			function<void()> task;
+			{
+				unique_lock<mutex> lock(_Mutex);
+				_Work_available.wait(lock, [this]() { return _Stop || !_Tasks.empty(); });
+				if (_Stop) {
+					return;
+				}
+				task = move(_Tasks.front());
+				_Tasks.pop_front();
+			}
+			task();
+		}
+	}
+
+} }
@@ -0,0 +1,37 @@
+#ifndef _XTHREADPOOL_H_
+#define _XTHREADPOOL_H_
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace std::experimental::io2d { inline namespace v1 {
+
+	// The process wide pool of worker threads that runs io2d's background work, such as basic_image_surface::load_images.
+	// Threads are started on demand, up to the most any caller has asked for, and joined at exit; tasks that haven't
+	// started by then are dropped.
+	class _Thread_pool {
+		::std::mutex _Mutex;
+		::std::condition_variable _Work_available;
+		::std::deque<::std::function<void()>> _Tasks;
+		::std::vector<::std::thread> _Threads;
+		bool _Stop = false;
+
+		_Thread_pool() = default;
+		void _Run() noexcept;
+	public:
+		static _Thread_pool& instance();
+		~_Thread_pool() noexcept;
+		_Thread_pool(const _Thread_pool&) = delete;
+		_Thread_pool& operator=(const _Thread_pool&) = delete;
+
+		// Queues task, first starting threads until there are at least minThreads. task must not throw.
+		void submit(::std::function<void()> task, unsigned int minThreads);
+		unsigned int thread_count();
+	};
+} }
+
+#endif
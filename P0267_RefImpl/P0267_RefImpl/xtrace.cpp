@@ -0,0 +1,169 @@
+#include "xtrace.h"
+#include <ostream>
+
+#if defined(_IO2D_TRACE)
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#endif
+
+namespace std::experimental::io2d { inline namespace v1 {
+
+#if defined(_IO2D_TRACE)
+
+	namespace {
+		struct _Trace_event {
+			const char* name;
+			int64_t start; // Nanoseconds since _Trace_epoch.
+			int64_t duration;
+		};
+
+		constexpr size_t _Trace_buffer_capacity = 1 << 16;
+
+		// One per thread, written only by its owner. A span is published by storing it and then release-storing the
+		// new count, so writers never take a lock and a reader sees whole events. Spans that don't fit are counted
+		// and dropped.
+		struct _Trace_buffer {
+			unique_ptr<_Trace_event[]> events;
+			atomic<size_t> count{ 0 };
+			atomic<uint64_t> dropped{ 0 };
+			int thread_id = 0;
+			_Trace_buffer* next = nullptr;
+		};
+
+		const chrono::steady_clock::time_point _Trace_epoch = chrono::steady_clock::now();
+		atomic<int> _Trace_next_thread_id{ 1 };
+
+		// Guards the lists below. Recording doesn't take it; only starting and retiring a thread's buffer and writing
+		// the trace do.
+		mutex _Trace_mutex;
+		// Every buffer that holds spans, including those of threads that have exited, so that their spans can still
+		// be written out.
+		_Trace_buffer* _Trace_buffers = nullptr;
+		// Full size event arrays given back by threads that have exited, for the next thread that records a span.
+		vector<unique_ptr<_Trace_event[]>> _Trace_free_events;
+
+		// When a thread exits, its buffer keeps only the spans it recorded, and the full size array goes back to
+		// _Trace_free_events. A thread that recorded nothing leaves nothing behind.
+		void _Retire_trace_buffer(_Trace_buffer* buffer) noexcept {
+			lock_guard<mutex> lock(_Trace_mutex);
+			const auto n = buffer->count.load(memory_order_relaxed);
+			unique_ptr<_Trace_event[]> spans;
+			if (n != 0) {
+				spans.reset(new (nothrow) _Trace_event[n]);
+				if (spans == nullptr) {
+					return;
+				}
+				::std::copy_n(buffer->events.get(), n, spans.get());
+			}
+			try {
+				_Trace_free_events.push_back(::std::move(buffer->events));
+			}
+			catch (...) {
+				// Dropped rather than kept for reuse.
+			}
+			if (n != 0) {
+				buffer->events = ::std::move(spans);
+				return;
+			}
+			for (auto link = &_Trace_buffers; *link != nullptr; link = &(*link)->next) {
+				if (*link == buffer) {
+					*link = buffer->next;
+					break;
+				}
+			}
+			delete buffer;
+		}
+
+		struct _Trace_buffer_owner {
+			_Trace_buffer* buffer = nullptr;
+			~_Trace_buffer_owner() noexcept {
+				if (buffer != nullptr) {
+					_Retire_trace_buffer(buffer);
+				}
+			}
+		};
+
+		_Trace_buffer* _Thread_trace_buffer() noexcept {
+			thread_local _Trace_buffer_owner owner;
+			if (owner.buffer == nullptr) {
+				lock_guard<mutex> lock(_Trace_mutex);
+				unique_ptr<_Trace_buffer> buffer(new (nothrow) _Trace_buffer);
+				if (buffer == nullptr) {
+					return nullptr;
+				}
+				if (!_Trace_free_events.empty()) {
+					buffer->events = ::std::move(_Trace_free_events.back());
+					_Trace_free_events.pop_back();
+				}
+				else {
+					buffer->events.reset(new (nothrow) _Trace_event[_Trace_buffer_capacity]);
+					if (buffer->events == nullptr) {
+						return nullptr;
+					}
+				}
+				buffer->thread_id = _Trace_next_thread_id.fetch_add(1, memory_order_relaxed);
+				buffer->next = _Trace_buffers;
+				_Trace_buffers = buffer.get();
+				owner.buffer = buffer.release();
+			}
+			return owner.buffer;
+		}
+
+		void _Write_microseconds(ostream& os, int64_t ns) {
+			os << ns / 1000 << '.';
+			const auto frac = ns % 1000;
+			os << static_cast<char>('0' + frac / 100) << static_cast<char>('0' + frac / 10 % 10) << static_cast<char>('0' + frac % 10);
+		}
+	}
+
+	void _Trace_record(const char* name, chrono::steady_clock::time_point start, chrono::steady_clock::time_point end) noexcept {
+		auto buffer = _Thread_trace_buffer();
+		if (buffer == nullptr) {
+			return;
+		}
+		const auto n = buffer->count.load(memory_order_relaxed);
+		if (n == _Trace_buffer_capacity) {
+			buffer->dropped.fetch_add(1, memory_order_relaxed);
+			return;
+		}
+		auto& e = buffer->events[n];
+		e.name = name;
+		e.start = chrono::duration_cast<chrono::nanoseconds>(start - _Trace_epoch).count();
+		e.duration = chrono::duration_cast<chrono::nanoseconds>(end - start).count();
+		buffer->count.store(n + 1, memory_order_release);
+	}
+
+	void write_chrome_trace(ostream& os) {
+		lock_guard<mutex> lock(_Trace_mutex);
+		os << "{\"traceEvents\":[";
+		bool first = true;
+		uint64_t dropped = 0;
+		for (auto buffer = _Trace_buffers; buffer != nullptr; buffer = buffer->next) {
+			const auto n = buffer->count.load(memory_order_acquire);
+			dropped += buffer->dropped.load(memory_order_relaxed);
+			for (size_t i = 0; i < n; ++i) {
+				const auto& e = buffer->events[i];
+				os << (first ? "\n" : ",\n") << "{\"name\":\"" << e.name << "\",\"cat\":\"io2d\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer->thread_id << ",\"ts\":";
+				_Write_microseconds(os, e.start);
+				os << ",\"dur\":";
+				_Write_microseconds(os, e.duration);
+				os << '}';
+				first = false;
+			}
+		}
+		os << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped\":" << dropped << "}}\n";
+	}
+
+#else
+
+	void write_chrome_trace(ostream& os) {
+		os << "{\"traceEvents\":[]}\n";
+	}
+
+#endif
+
+} }
@@ -0,0 +1,47 @@
+#ifndef _XTRACE_H_
+#define _XTRACE_H_
+
+#include <chrono>
+#include <iosfwd>
+
+// Tracing spans around io2d internals, written out in Chrome's trace_event JSON format (load the output in
+// chrome://tracing or Perfetto). Spans are compiled in only when _IO2D_TRACE is defined, which the build does
+// when IO2D_WITH_TRACING is set; otherwise _IO2D_TRACE_SPAN expands to nothing.
+
+#define _IO2D_TRACE_CONCAT_IMPL(a, b) a##b
+#define _IO2D_TRACE_CONCAT(a, b) _IO2D_TRACE_CONCAT_IMPL(a, b)
+
+#if defined(_IO2D_TRACE)
+#define _IO2D_TRACE_SPAN(name) ::std::experimental::io2d::_Trace_span _IO2D_TRACE_CONCAT(_Trace_span_, __LINE__){ name }
+#else
+#define _IO2D_TRACE_SPAN(name) ((void)0)
+#endif
+
+namespace std::experimental::io2d { inline namespace v1 {
+
+#if defined(_IO2D_TRACE)
+	// Appends a complete span to the calling thread's trace buffer. name must be a string literal.
+	void _Trace_record(const char* name, ::std::chrono::steady_clock::time_point start, ::std::chrono::steady_clock::time_point end) noexcept;
+
+	class _Trace_span {
+		const char* _Name;
+		::std::chrono::steady_clock::time_point _Start;
+	public:
+		explicit _Trace_span(const char* name) noexcept
+			: _Name(name)
+			, _Start(::std::chrono::steady_clock::now()) {
+		}
+		~_Trace_span() noexcept {
+			_Trace_record(_Name, _Start, ::std::chrono::steady_clock::now());
+		}
+		_Trace_span(const _Trace_span&) = delete;
+		_Trace_span& operator=(const _Trace_span&) = delete;
+	};
+#endif
+
+	// Writes every span recorded so far, from all threads, as a Chrome trace_event JSON object. Writes an empty
+	// trace when tracing is compiled out. Safe to call while other threads keep recording.
+	void write_chrome_trace(::std::ostream& os);
+} }
+
+#endif
@@ -41,6 +41,7 @@ private:
     vector<CellState> m_Cells;
     vector<uint8_t> m_Counts;
     interpreted_path m_CellFigure;    
+    vector<path_instance> m_CellInstances;
 };
 
 GameOfLife::GameOfLife(int board_width, int board_height):
@@ -127,34 +128,34 @@ void GameOfLife::DrawCells(output_surface &surface)
 {
     auto beta = m_TransitionPoint;
     auto gamma = 1.f - m_TransitionPoint;    
-    const auto on_brush = brush{rgba_color::black};
-    const auto fading_brush = brush{rgba_color{0.5f*beta, 0.5f*beta, 0.5f*beta}};
-    const auto emerging_brush = brush{rgba_color{0.5f*gamma, 0.5f*gamma, 0.5f*gamma}};
+    const auto on_color = rgba_color::black;
+    const auto fading_color = rgba_color{0.5f*beta, 0.5f*beta, 0.5f*beta};
+    const auto emerging_color = rgba_color{0.5f*gamma, 0.5f*gamma, 0.5f*gamma};
     const auto cell_size = m_CellPxSize - 1.f;
 	const auto min_scale = 0.01f;
         
+    m_CellInstances.clear();
     for( auto y = 0; y < m_BoardHeight; ++y )
         for( auto x = 0; x < m_BoardWidth; ++x ) {
             auto state = At(x, y);
-            auto rp = render_props{};
-            rp.compositing(compositing_op::source);
             if( state == CellState::On ) {
-                rp.surface_matrix(matrix_2d::create_translate({m_CellPxSize * x, m_CellPxSize * y}));
-                surface.fill(on_brush, m_CellFigure, nullopt, rp);
+                m_CellInstances.emplace_back(matrix_2d::create_translate({m_CellPxSize * x, m_CellPxSize * y}), on_color);
             }
             if( state == CellState::Fading  && gamma >= min_scale) {
-                rp.surface_matrix(matrix_2d::create_scale({gamma, gamma}) *
-                                  matrix_2d::create_translate({cell_size * beta / 2 , cell_size * beta / 2}) * 
-                                  matrix_2d::create_translate({m_CellPxSize * x, m_CellPxSize * y}));
-                surface.fill(fading_brush, m_CellFigure, nullopt, rp);
+                m_CellInstances.emplace_back(matrix_2d::create_scale({gamma, gamma}) *
+                                             matrix_2d::create_translate({cell_size * beta / 2 , cell_size * beta / 2}) * 
+                                             matrix_2d::create_translate({m_CellPxSize * x, m_CellPxSize * y}), fading_color);
             }
             if( state == CellState::Emerging && beta >= min_scale ) {
-                rp.surface_matrix(matrix_2d::create_scale({beta, beta}) *
-                                  matrix_2d::create_translate({cell_size * gamma / 2 , cell_size * gamma / 2}) * 
-                                  matrix_2d::create_translate({m_CellPxSize * x, m_CellPxSize * y}));
-                surface.fill(emerging_brush, m_CellFigure, nullopt, rp);                
+                m_CellInstances.emplace_back(matrix_2d::create_scale({beta, beta}) *
+                                             matrix_2d::create_translate({cell_size * gamma / 2 , cell_size * gamma / 2}) * 
+                                             matrix_2d::create_translate({m_CellPxSize * x, m_CellPxSize * y}), emerging_color);
             }
         }
+    
+    auto rp = render_props{};
+    rp.compositing(compositing_op::source);
+    surface.fill_instances(m_CellFigure, begin(m_CellInstances), end(m_CellInstances), nullopt, rp);
 }
 
 void GameOfLife::DrawGrid(output_surface &surface)
@@ -56,7 +56,24 @@ path_builder ImagePath( display_point image_dimenstions, matrix_2d /*mat*/ )
     return pb;
 }
 
-void Draw(const Cat &cat, const brush &image, display_point image_dimenstions, output_surface& surface)
+void DrawOpaque(vector<path_instance> &opaque, const interpreted_path &image_path, output_surface& surface)
+{
+    if( opaque.empty() )
+        return;
+    
+    auto rp = render_props{};
+    rp.compositing(compositing_op::source);
+    
+    auto bp = brush_props{};
+    bp.filter(filter::fast);
+    
+    surface.fill_instances(image_path, begin(opaque), end(opaque), bp, rp);
+    opaque.clear();
+}
+
+// Opaque cats are batched into 'opaque' and drawn with a single fill_instances call; a translucent cat flushes the
+// batch first so that the drawing order is preserved.
+void Draw(const Cat &cat, const brush &image, display_point image_dimenstions, const interpreted_path &image_path, vector<path_instance> &opaque, output_surface& surface)
 {
 	const auto min_scale = 0.01f;
 	if ( abs(cat.scale.x()) < min_scale || abs(cat.scale.y()) < min_scale )
@@ -64,21 +81,21 @@ void Draw(const Cat &cat, const brush &image, display_point image_dimenstions, o
 
     auto mat = Transformation(cat, image_dimenstions);
     
+    if( cat.alpha == 1.f ) {
+        opaque.emplace_back(mat, image);
+        return;
+    }
+    DrawOpaque(opaque, image_path, surface);
+    
     auto rp = render_props{};
     rp.surface_matrix(mat);
     
     auto bp = brush_props{};
     bp.filter(filter::fast);
 
-    auto cp = clip_props{ImagePath(image_dimenstions, mat)};
+    auto cp = clip_props{image_path};
     
-    if( cat.alpha == 1.f ) {
-        rp.compositing(compositing_op::source);
-        surface.paint(image, bp, rp, cp);
-    }        
-    else {
-        surface.mask(image, brush{rgba_color{1.f, 1.f, 1.f, cat.alpha}}, bp, nullopt, rp, cp);
-    }
+    surface.mask(image, brush{rgba_color{1.f, 1.f, 1.f, cat.alpha}}, bp, nullopt, rp, cp);
 }
 
 void Resize(Cat &cat, milliseconds now)
@@ -164,6 +181,8 @@ int main(int /*argc*/, char *argv[]) {
     }();
     const auto image_size = image.dimensions();
     const auto cat_brush = brush{move(image)};
+    const auto cat_path = interpreted_path{ImagePath(image_size, matrix_2d{})};
+    vector<path_instance> opaque_cats;
     auto display = output_surface{500, 500, format::argb32, scaling::none};    
     
     vector<Cat> cats;
@@ -179,8 +198,9 @@ int main(int /*argc*/, char *argv[]) {
         const auto now = high_resolution_clock::now();
         for( auto &c: cats ) {
             Animate(c, duration_cast<milliseconds>(now - c.spawn_time));
-            Draw(c, cat_brush, image_size, surface);
+            Draw(c, cat_brush, image_size, cat_path, opaque_cats, surface);
         }
+        DrawOpaque(opaque_cats, cat_path, surface);
     };
     display.draw_callback(draw_frame);    
     display.size_change_callback([&](output_surface& surface){
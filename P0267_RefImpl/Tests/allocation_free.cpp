@@ -0,0 +1,105 @@
+#include "catch.hpp"
+#include <io2d.h>
+#include <cstdlib>
+#include <new>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+
+// Counts the calls to the global operator new made on this thread while counting is switched on. cairo allocates with
+// malloc, so only io2d's own allocations are seen.
+static thread_local bool CountAllocations = false;
+static thread_local int Allocations = 0;
+
+void* operator new(size_t size) {
+    if (CountAllocations) {
+        Allocations++;
+    }
+    if (auto p = malloc(size == 0 ? 1 : size)) {
+        return p;
+    }
+    throw bad_alloc();
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+template <class F>
+static int AllocationsIn(F&& f) {
+    Allocations = 0;
+    CountAllocations = true;
+    f();
+    CountAllocations = false;
+    return Allocations;
+}
+
+struct Prebuilt {
+    brush solid{ rgba_color::cornflower_blue };
+    brush gradient{ { 0.f, 0.f }, { 64.f, 0.f }, { gradient_stop{ 0.f, rgba_color::transparent_black }, gradient_stop{ 1.f, rgba_color::black } } };
+    interpreted_path path{ bounding_box{ 8.f, 8.f, 48.f, 48.f } };
+    brush_props bp{ wrap_mode::none, filter::good, fill_rule::even_odd };
+    stroke_props sp{ 3.f };
+    dashes d{ 0.f, { 4.f, 2.f, 1.f, 2.f } };
+    render_props rp{ antialias::good, matrix_2d::create_translate({ 2.f, 2.f }) };
+    clip_props cl{ bounding_box{ 4.f, 4.f, 56.f, 56.f } };
+};
+
+// Draws everything once so that one-time setup, like the defaults for omitted props, happens before counting.
+template <class Surface>
+static void DrawAll(Surface& s, const Prebuilt& p) {
+    s.paint(p.solid);
+    s.paint(p.solid, p.bp, p.rp, p.cl);
+    s.fill(p.solid, p.path);
+    s.fill(p.gradient, p.path, p.bp, p.rp, p.cl);
+    s.stroke(p.solid, p.path);
+    s.stroke(p.solid, p.path, p.bp, p.sp, p.d, p.rp, p.cl);
+    s.mask(p.solid, p.gradient);
+    s.mask(p.solid, p.gradient, p.bp, nullopt, p.rp, p.cl);
+}
+
+TEST_CASE("Drawing with pre-built paths, brushes and props doesn't allocate")
+{
+    image_surface img{ format::argb32, 64, 64 };
+    const Prebuilt p;
+    DrawAll(img, p);
+
+    CHECK( AllocationsIn([&] { img.paint(p.solid); }) == 0 );
+    CHECK( AllocationsIn([&] { img.paint(p.solid, p.bp, p.rp, p.cl); }) == 0 );
+    CHECK( AllocationsIn([&] { img.fill(p.solid, p.path); }) == 0 );
+    CHECK( AllocationsIn([&] { img.fill(p.gradient, p.path, p.bp, p.rp, p.cl); }) == 0 );
+    CHECK( AllocationsIn([&] { img.stroke(p.solid, p.path); }) == 0 );
+    CHECK( AllocationsIn([&] { img.stroke(p.solid, p.path, p.bp, p.sp); }) == 0 );
+    CHECK( AllocationsIn([&] { img.stroke(p.solid, p.path, p.bp, p.sp, p.d, p.rp, p.cl); }) == 0 );
+    CHECK( AllocationsIn([&] { img.mask(p.solid, p.gradient); }) == 0 );
+    CHECK( AllocationsIn([&] { img.mask(p.solid, p.gradient, p.bp, nullopt, p.rp, p.cl); }) == 0 );
+}
+
+#if defined(_IO2D_CAIRO_HEADLESS_)
+
+TEST_CASE("Drawing on an output surface in steady state doesn't allocate")
+{
+    output_surface sfc{ 64, 64, format::argb32, scaling::letterbox, refresh_style::as_fast_as_possible };
+    sfc.frame_budget(3);
+    const Prebuilt p;
+    int frame = 0;
+    int allocations = -1;
+    sfc.draw_callback([&](output_surface& s) {
+        if (frame++ == 0) {
+            DrawAll(s, p);
+        }
+        else {
+            allocations = AllocationsIn([&] { DrawAll(s, p); });
+        }
+    });
+    sfc.begin_show();
+
+    CHECK( allocations == 0 );
+}
+
+#endif
@@ -0,0 +1,52 @@
+#include "catch.hpp"
+#include <io2d.h>
+#include <chrono>
+#include <cstdlib>
+#include <thread>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+
+#if defined(_IO2D_CAIRO_HEADLESS_) || defined(_IO2D_CAIRO_XLIB_) || defined(_IO2D_CAIRO_SDL2_H_) || defined(_IO2D_CAIRO_WIN32_H_)
+
+TEST_CASE("Output surfaces time each frame's phases")
+{
+#if defined(_IO2D_CAIRO_XLIB_)
+    if( getenv("DISPLAY") == nullptr )
+        return; // Needs an X server.
+#elif defined(_IO2D_CAIRO_SDL2_H_)
+    // Nothing has to be seen, so unless a video driver was chosen SDL's dummy one is used, which needs no display and
+    // falls back to the software renderer.
+    SDL_setenv("SDL_VIDEODRIVER", "dummy", 0);
+#endif
+    // On Win32 frames are drawn both from the message loop and from WM_PAINT; both paths are timed.
+
+    const int frames = 20;
+    output_surface sfc{ 64, 64, format::argb32, scaling::letterbox, refresh_style::as_fast_as_possible };
+    sfc.frame_budget(frames);
+    int timed = 0;
+    bool phasesAddUp = true;
+    sfc.draw_callback([&](output_surface& s) {
+        s.paint(brush{ rgba_color::cornflower_blue });
+        this_thread::sleep_for(chrono::milliseconds(2));
+    });
+    sfc.frame_timing_callback([&](const frame_timing& t) {
+        timed++;
+        phasesAddUp = phasesAddUp && t.draw >= chrono::milliseconds(2) && t.total == t.events + t.draw + t.flush + t.present;
+    });
+    sfc.begin_show();
+
+    CHECK( timed == frames );
+    CHECK( phasesAddUp );
+    const auto stats = sfc.frame_stats();
+    CHECK( stats.frames == frames );
+    CHECK( stats.sample_count == frames );
+    CHECK( stats.draw.p50 >= chrono::milliseconds(2) );
+    CHECK( stats.total.p50 >= stats.draw.p50 );
+    CHECK( stats.total.p50 <= stats.total.p95 );
+    CHECK( stats.total.p95 <= stats.total.p99 );
+    CHECK( stats.total.p99 <= stats.total.max );
+}
+
+#endif
@@ -0,0 +1,237 @@
+#include "catch.hpp"
+#include <io2d.h>
+#include <chrono>
+#include <vector>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+
+#if defined(_IO2D_CAIRO_HEADLESS_)
+
+TEST_CASE("A headless output surface stops after its frame budget and presents each frame")
+{
+    output_surface sfc{ 32, 16, format::argb32, scaling::none, refresh_style::as_fast_as_possible };
+    sfc.frame_budget(5);
+    int drawn = 0, presented = 0;
+    bool pixelsMatch = true;
+    sfc.draw_callback([&](output_surface& s) {
+        drawn++;
+        s.paint(brush{ rgba_color::blue });
+    });
+    sfc.present_callback([&](const _Interchange_buffer& frame) {
+        presented++;
+        auto pixel = frame.data() + frame.stride() * 8 + 4 * 16;
+        // b8g8r8a8, premultiplied
+        pixelsMatch = pixelsMatch && frame.width() == 32 && frame.height() == 16 &&
+            pixel[0] == byte{ 255 } && pixel[1] == byte{ 0 } && pixel[2] == byte{ 0 } && pixel[3] == byte{ 255 };
+    });
+    sfc.begin_show();
+
+    CHECK( drawn == 5 );
+    CHECK( presented == 5 );
+    CHECK( pixelsMatch );
+}
+
+TEST_CASE("A headless output surface that waits for redraws ends when its time budget runs out")
+{
+    output_surface sfc{ 16, 16, format::argb32, scaling::none, refresh_style::as_needed };
+    sfc.time_budget(chrono::milliseconds(100));
+    int drawn = 0;
+    sfc.draw_callback([&](output_surface& s) {
+        drawn++;
+        s.paint(brush{ rgba_color::red });
+    });
+    const auto start = chrono::steady_clock::now();
+    sfc.begin_show();
+    const auto elapsed = chrono::steady_clock::now() - start;
+
+    // Only the first frame is drawn; nothing asks for another one.
+    CHECK( drawn == 1 );
+    CHECK( elapsed >= chrono::milliseconds(100) );
+    CHECK( elapsed < chrono::seconds(5) );
+}
+
+// The b8g8r8a8 pixel at x, y of a presented frame, as 0xAARRGGBB.
+static uint32_t PresentedPixel(const _Interchange_buffer& frame, int x, int y)
+{
+    auto pixel = frame.data() + frame.stride() * y + 4 * x;
+    return (to_integer<uint32_t>(pixel[3]) << 24) | (to_integer<uint32_t>(pixel[2]) << 16) | (to_integer<uint32_t>(pixel[1]) << 8) | to_integer<uint32_t>(pixel[0]);
+}
+
+TEST_CASE("A headless output surface with damage tracking hands the present callback the whole back buffer")
+{
+    output_surface sfc{ 32, 16, format::argb32, scaling::none, refresh_style::as_fast_as_possible };
+    sfc.auto_clear(false);
+    sfc.damage_tracking(true);
+    sfc.frame_budget(6);
+    int drawn = 0;
+    bool matches = true;
+    sfc.draw_callback([&](output_surface& s) {
+        // A red frame, then a blue square further right on each frame after it. Only the square is damaged.
+        if( drawn == 0 )
+            s.paint(brush{ rgba_color::red });
+        else
+            s.fill(brush{ rgba_color::blue }, interpreted_path{ bounding_box{ 4.f * drawn, 4.f, 4.f, 4.f } });
+        drawn++;
+    });
+    sfc.present_callback([&](const _Interchange_buffer& frame) {
+        for( int y = 0; y < 16; ++y )
+            for( int x = 0; x < 32; ++x ) {
+                const bool square = y >= 4 && y < 8 && x >= 4 && x < 4 * drawn;
+                matches = matches && PresentedPixel(frame, x, y) == (square ? 0xFF0000FF : 0xFFFF0000);
+            }
+    });
+    sfc.begin_show();
+
+    CHECK( drawn == 6 );
+    CHECK( matches );
+}
+
+TEST_CASE("An async headless output surface presents the frames it rasterized in order")
+{
+    const rgba_color colors[] = { rgba_color::red, rgba_color::lime, rgba_color::blue, rgba_color::white };
+    const uint32_t pixels[] = { 0xFFFF0000, 0xFF00FF00, 0xFF0000FF, 0xFFFFFFFF };
+    output_surface sfc{ 32, 16, format::argb32, scaling::none, refresh_style::as_fast_as_possible };
+    sfc.async_render(true);
+    CHECK( sfc.async_render() == true );
+    sfc.frame_budget(4);
+    int drawn = 0;
+    vector<uint32_t> presented;
+    sfc.draw_callback([&](output_surface& s) {
+        s.paint(brush{ colors[drawn++] });
+    });
+    sfc.present_callback([&](const _Interchange_buffer& frame) {
+        presented.push_back(PresentedPixel(frame, 16, 8));
+    });
+    sfc.begin_show();
+
+    // The render thread may still be on the last frame, which then isn't presented.
+    auto stats = sfc.async_stats();
+    CHECK( stats.frames_submitted == 4 );
+    CHECK( stats.frames_rendered >= 3 );
+    CHECK( stats.frames_rendered <= 4 );
+    CHECK( stats.max_latency >= stats.last_latency );
+    REQUIRE( presented.size() >= 3 );
+    for( size_t i = 0; i < presented.size(); ++i )
+        CHECK( presented[i] == pixels[i] );
+
+    sfc.async_render(false);
+    CHECK( sfc.async_stats().frames_submitted == 0 );
+}
+
+TEST_CASE("An async headless output surface keeps direct changes to the back buffer made between flush and mark_dirty")
+{
+    for( auto buffers : { 1, 3 } ) {
+        output_surface sfc{ 32, 16, format::argb32, scaling::none, refresh_style::as_fast_as_possible };
+        sfc.async_render(true);
+        sfc.buffer_count(buffers);
+        sfc.frame_budget(3);
+        int drawn = 0;
+        uint32_t inside = 0, outside = 0;
+        sfc.draw_callback([&](output_surface& s) {
+            if( ++drawn == 1 ) {
+                s.paint(brush{ rgba_color::red });
+            }
+            else if( drawn == 2 ) {
+                s.paint(brush{ rgba_color::lime });
+                // Native drawing on the back buffer, which mark_dirty is there for. The paint recorded above has to land
+                // under it.
+                s.flush();
+                auto cr = cairo_create(s.data()->data.back_buffer.surface.get());
+                cairo_set_source_rgb(cr, 0.0, 0.0, 1.0);
+                cairo_rectangle(cr, 4.0, 4.0, 8.0, 8.0);
+                cairo_fill(cr);
+                cairo_destroy(cr);
+                s.mark_dirty(bounding_box{ 4.f, 4.f, 8.f, 8.f });
+            }
+        });
+        sfc.present_callback([&](const _Interchange_buffer& frame) {
+            inside = PresentedPixel(frame, 6, 6);
+            outside = PresentedPixel(frame, 20, 10);
+        });
+        sfc.begin_show();
+
+        INFO( "buffer_count " << buffers );
+        CHECK( inside == 0xFF0000FF );
+        CHECK( outside == 0xFF00FF00 );
+    }
+}
+
+TEST_CASE("An async headless output surface presents whole frames in order from its swap chain")
+{
+    {
+        output_surface sfc{ 16, 16, format::argb32, scaling::none, refresh_style::as_fast_as_possible };
+        CHECK( sfc.buffer_count() == 1 );
+        CHECK_THROWS_AS( sfc.buffer_count(0), system_error );
+        CHECK_THROWS_AS( sfc.buffer_count(4), system_error );
+    }
+    for( auto buffers : { 2, 3 } ) {
+        output_surface sfc{ 32, 16, format::argb32, scaling::none, refresh_style::as_fast_as_possible };
+        sfc.async_render(true);
+        sfc.buffer_count(buffers);
+        CHECK( sfc.buffer_count() == buffers );
+        sfc.frame_budget(8);
+        int drawn = 0;
+        vector<int> presented;
+        bool whole = true;
+        sfc.draw_callback([&](output_surface& s) {
+            // Frame n is painted with red n * 30 and green 255 - n * 30, so that the presented frame can be told apart.
+            s.paint(brush{ rgba_color(drawn * 30, 255 - drawn * 30, 0) });
+            // Rotating through a different number of buffers halfway through the show.
+            if( ++drawn == 4 )
+                s.buffer_count(buffers == 2 ? 3 : 2);
+        });
+        sfc.present_callback([&](const _Interchange_buffer& frame) {
+            auto pixel = PresentedPixel(frame, 1, 1);
+            whole = whole && pixel == PresentedPixel(frame, 30, 14);
+            presented.push_back(static_cast<int>((pixel >> 16) & 0xFF) / 30);
+        });
+        sfc.begin_show();
+
+        INFO( "buffer_count " << buffers );
+        CHECK( whole );
+        // A frame can be dropped when a newer one finished first, but none is presented twice or after a newer one.
+        REQUIRE( presented.size() >= 1 );
+        for( size_t i = 1; i < presented.size(); ++i )
+            CHECK( presented[i] > presented[i - 1] );
+        CHECK( presented.back() < 8 );
+    }
+}
+
+TEST_CASE("An async headless output surface with three buffers rasterizes every frame it was handed")
+{
+    const int frames = 10;
+    output_surface sfc{ 256, 256, format::argb32, scaling::none, refresh_style::as_fast_as_possible };
+    sfc.async_render(true);
+    sfc.buffer_count(3);
+    sfc.frame_budget(frames);
+    int drawn = 0;
+    vector<int> presented;
+    bool whole = true;
+    sfc.draw_callback([&](output_surface& s) {
+        // Rasterizing the translucent paints takes far longer than recording them, so each frame is submitted while the
+        // one before it is still being rasterized. The last paint tells the frames apart, as in the test above.
+        for( int i = 0; i < 400; ++i )
+            s.paint(brush{ rgba_color(0, 0, 255, 16) });
+        s.paint(brush{ rgba_color(drawn * 20, 255 - drawn * 20, 0) });
+        drawn++;
+    });
+    sfc.present_callback([&](const _Interchange_buffer& frame) {
+        auto pixel = PresentedPixel(frame, 1, 1);
+        whole = whole && pixel == PresentedPixel(frame, 254, 254);
+        presented.push_back(static_cast<int>((pixel >> 16) & 0xFF) / 20);
+    });
+    sfc.begin_show();
+
+    // The render thread only takes a frame once it finished the one before, which the drawing thread swaps in right
+    // away, so none is dropped. Only the last two frames may not have been presented when the show ended.
+    const auto stats = sfc.async_stats();
+    CHECK( stats.frames_submitted == frames );
+    CHECK( whole );
+    REQUIRE( presented.size() + 2 >= static_cast<size_t>(stats.frames_submitted) );
+    for( size_t i = 0; i < presented.size(); ++i )
+        CHECK( presented[i] == static_cast<int>(i) );
+}
+
+#endif
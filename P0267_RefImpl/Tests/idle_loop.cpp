@@ -0,0 +1,61 @@
+#include "catch.hpp"
+#include <io2d.h>
+#include <chrono>
+#include <cstdlib>
+
+#if defined(_IO2D_CAIRO_XLIB_) || defined(_IO2D_CAIRO_SDL2_H_)
+#include <sys/resource.h>
+#endif
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+
+#if defined(_IO2D_CAIRO_XLIB_) || defined(_IO2D_CAIRO_SDL2_H_)
+
+static chrono::microseconds ProcessCpuTime()
+{
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) + chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+
+TEST_CASE("A fixed refresh rate output surface sleeps between frames")
+{
+#if defined(_IO2D_CAIRO_SDL2_H_)
+    // Runs headless without a display.
+    setenv("SDL_VIDEODRIVER", "dummy", 0);
+#else
+    if( getenv("DISPLAY") == nullptr )
+        return; // Needs an X server.
+#endif
+
+    const int frames = 30;
+    output_surface sfc{ 64, 64, format::argb32, scaling::letterbox, refresh_style::fixed, 30.f };
+    int drawn = 0;
+    chrono::steady_clock::time_point wallStart, wallEnd;
+    chrono::microseconds cpuStart{}, cpuEnd{};
+    sfc.draw_callback([&](output_surface& s) {
+        // Starts measuring at the first frame so that window creation isn't counted.
+        if( drawn == 0 ) {
+            wallStart = chrono::steady_clock::now();
+            cpuStart = ProcessCpuTime();
+        }
+        s.paint(brush{ rgba_color::cornflower_blue });
+        if( ++drawn == frames + 1 ) {
+            wallEnd = chrono::steady_clock::now();
+            cpuEnd = ProcessCpuTime();
+            s.end_show();
+        }
+    });
+    sfc.begin_show();
+
+    const auto wall = chrono::duration_cast<chrono::microseconds>(wallEnd - wallStart);
+    const auto cpu = cpuEnd - cpuStart;
+    // The first frame is drawn right away; the others are paced by the frame timer.
+    CHECK( wall >= chrono::milliseconds(frames * 1000 / 30 - 50) );
+    // A loop that spins uses about as much CPU time as wall time.
+    CHECK( cpu < wall / 5 );
+}
+
+#endif
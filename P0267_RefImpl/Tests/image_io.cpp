@@ -72,3 +72,207 @@ TEST_CASE("IO2D properly encodes TIFF images", "[!mayfail]") // cairo backend fa
     auto dup_img = image_surface{duplicate, image_file_format::tiff, format::argb32};    
     CHECK( CompareImages(dup_img, ref_img, tolerance) == true );
 }
+
+TEST_CASE("IO2D preserves translucent pixels when round tripping PNG images")
+{
+    auto tolerance = 0.01f;
+    auto duplicate = "translucent.png";
+    auto img = image_surface{format::argb32, 64, 48};
+    img.paint(brush{ rgba_color{ 0.2f, 0.4f, 0.8f, 0.5f } });
+    img.fill(brush{ rgba_color{ 1.f, 0.f, 0.f, 0.25f } }, interpreted_path{ bounding_box{ 8.f, 8.f, 24.f, 16.f } });
+    img.save(duplicate, image_file_format::png);
+    auto dup_img = image_surface{duplicate, image_file_format::png, format::argb32};
+    CHECK( dup_img.dimensions().x() == 64 );
+    CHECK( dup_img.dimensions().y() == 48 );
+    CHECK( CompareImages(dup_img, img, tolerance) == true );
+}
+
+#if defined(_XCAIRO_)
+TEST_CASE("IO2D un-premultiplies every pixel of a row the same way when encoding")
+{
+    // 37 pixels: several four pixel blocks for the SIMD loop and a tail for the scalar one. Each pixel is compared with
+    // the scalar formula, so a pixel encodes the same whichever loop it lands in.
+    const int width = 37;
+    vector<unsigned char> src(width * 4);
+    for( int x = 0; x < width; ++x ) {
+        const unsigned char a = static_cast<unsigned char>(x * 7 + 1);
+        src[x * 4 + 0] = static_cast<unsigned char>(a * 3 / 7);
+        src[x * 4 + 1] = static_cast<unsigned char>(a / 2);
+        src[x * 4 + 2] = static_cast<unsigned char>(a - a / 5);
+        src[x * 4 + 3] = a;
+    }
+    vector<unsigned char> dst(width * 4);
+    _Cairo::_Unpremultiply_row(src.data(), dst.data(), width, 3);
+    for( int x = 0; x < width; ++x ) {
+        const unsigned int a = src[x * 4 + 3];
+        for( int c = 0; c < 3; ++c )
+            CHECK( dst[x * 4 + c] == min(255u, (src[x * 4 + c] * 255u + a / 2) / a) );
+        CHECK( dst[x * 4 + 3] == a );
+    }
+}
+#endif
+
+TEST_CASE("IO2D encodes to and decodes from memory")
+{
+    auto tolerance = 0.01f;
+    auto reference = "image_500x375.png";
+    auto ref_img = image_surface{reference, image_file_format::png, format::argb32};
+    vector<std::byte> encoded;
+    ref_img.save(encoded, image_file_format::png);
+    REQUIRE( encoded.size() > 8 );
+    auto dup_img = image_surface{encoded.data(), encoded.size(), image_file_format::png, format::argb32};
+    CHECK( CompareImages(dup_img, ref_img, tolerance) == true );
+
+    vector<std::byte> streamed;
+    ref_img.save([&streamed](const std::byte* data, size_t size) { streamed.insert(streamed.end(), data, data + size); }, image_file_format::png);
+    CHECK( streamed == encoded );
+
+    error_code ec;
+    auto truncated = image_surface{encoded.data(), encoded.size() / 2, image_file_format::png, format::argb32, ec};
+    CHECK( ec );
+}
+
+TEST_CASE("IO2D round trips images large enough to be encoded in bands")
+{
+    auto tolerance = 0.01f;
+    auto duplicate = "large.png";
+    auto img = image_surface{format::argb32, 1500, 1000};
+    img.paint(brush{ { 0.f, 0.f }, { 1500.f, 1000.f }, { gradient_stop{ 0.f, rgba_color::aquamarine }, gradient_stop{ 1.f, rgba_color{ 0.5f, 0.f, 0.5f, 0.5f } } } });
+    img.save(duplicate, image_file_format::png);
+    auto dup_img = image_surface{duplicate, image_file_format::png, format::argb32};
+    CHECK( CompareImages(dup_img, img, tolerance) == true );
+}
+
+TEST_CASE("IO2D loads batches of images concurrently")
+{
+    auto tolerance = 0.01f;
+    vector<string> paths;
+    for (int i = 0; i < 8; i++) {
+        paths.push_back(i % 2 == 0 ? "image_500x375.png" : "image_500x375.jpg");
+    }
+    paths.push_back("missing.png");
+    auto images = image_surface::load_images(paths, image_file_format::unknown, format::argb32, 4);
+    REQUIRE( images.size() == paths.size() );
+    auto png = image_surface{"image_500x375.png", image_file_format::png, format::argb32};
+    auto jpg = image_surface{"image_500x375.jpg", image_file_format::jpeg, format::argb32};
+    for (size_t i = 0; i < 8; i++) {
+        auto img = images[i].get();
+        CHECK( CompareImages(img, i % 2 == 0 ? png : jpg, tolerance) == true );
+    }
+    CHECK_THROWS_AS( images[8].get(), system_error );
+}
+
+TEST_CASE("IO2D maps native images without decoding them")
+{
+    const auto native = default_graphics_surfaces::additional_image_file_formats::native;
+    auto duplicate = "duplicate.io2d";
+    auto ref_img = image_surface{"image_500x375.png", image_file_format::png, format::argb32};
+    ref_img.save(duplicate, native);
+    auto mapped = image_surface{duplicate, native, format::argb32};
+    CHECK( CompareImages(mapped, ref_img, 0.f) == true );
+
+    // Drawing on a mapped image copies the pages it touches; the file keeps the original pixels.
+    mapped.paint(brush{ rgba_color::red });
+    auto reloaded = image_surface{duplicate, native, format::argb32};
+    CHECK( CompareImages(reloaded, ref_img, 0.f) == true );
+
+    // Saving a mapped image over the file it maps leaves both the surface and the new file intact.
+    auto remapped = image_surface{duplicate, native, format::argb32};
+    remapped.save(duplicate, native);
+    CHECK( CompareImages(remapped, ref_img, 0.f) == true );
+    remapped.paint(brush{ rgba_color::red });
+    remapped.save(duplicate, native);
+    auto painted = image_surface{duplicate, native, format::argb32};
+    CHECK( CompareImages(painted, mapped, 0.f) == true );
+
+    vector<std::byte> encoded;
+    ref_img.save(encoded, native);
+    auto decoded = image_surface{encoded.data(), encoded.size(), native, format::xrgb32};
+    CHECK( decoded.format() == format::xrgb32 );
+
+    error_code ec;
+    auto truncated = image_surface{encoded.data(), encoded.size() - 1, native, format::argb32, ec};
+    CHECK( ec );
+}
+
+TEST_CASE("IO2D saves BMP images through every save overload")
+{
+    const auto bmp = default_graphics_surfaces::additional_image_file_formats::bmp;
+    auto img = image_surface{format::argb32, 32, 24};
+    img.paint(brush{ rgba_color::red });
+    img.fill(brush{ rgba_color::blue }, interpreted_path{ bounding_box{ 8.f, 8.f, 8.f, 8.f } });
+    const string duplicate = "duplicate.bmp";
+    img.save(duplicate, bmp);
+    auto dup_img = image_surface{duplicate, bmp, format::argb32};
+    CHECK( CompareImages(dup_img, img, 0.01f) == true );
+
+    vector<std::byte> encoded;
+    img.save(encoded, bmp);
+    REQUIRE( encoded.size() > 2 );
+    CHECK( encoded[0] == std::byte{ 'B' } );
+    CHECK( encoded[1] == std::byte{ 'M' } );
+}
+
+TEST_CASE("IO2D round trips QOI images losslessly")
+{
+    const auto qoi = default_graphics_surfaces::additional_image_file_formats::qoi;
+    auto duplicate = "duplicate.qoi";
+    auto img = image_surface{format::argb32, 64, 48};
+    img.paint(brush{ { 0.f, 0.f }, { 64.f, 48.f }, { gradient_stop{ 0.f, rgba_color::aquamarine }, gradient_stop{ 1.f, rgba_color{ 0.5f, 0.f, 0.5f, 0.25f } } } });
+    img.save(duplicate, qoi);
+    auto dup_img = image_surface{duplicate, qoi, format::argb32};
+    CHECK( CompareImages(dup_img, img, 0.f) == true );
+
+    vector<std::byte> encoded;
+    img.save(encoded, qoi);
+    auto decoded = image_surface{encoded.data(), encoded.size(), qoi, format::argb32};
+    CHECK( CompareImages(decoded, img, 0.f) == true );
+
+    error_code ec;
+    auto truncated = image_surface{encoded.data(), encoded.size() / 2, qoi, format::argb32, ec};
+    CHECK( ec );
+}
+
+TEST_CASE("IO2D caches decoded images when given a budget")
+{
+    auto reference = "image_500x375.png";
+    image_surface::clear_cache();
+    image_surface::cache_budget(16 * 1024 * 1024);
+    const auto before = image_surface::cache_stats();
+    auto first = image_surface{reference, image_file_format::png, format::argb32};
+    auto second = image_surface{reference, image_file_format::png, format::argb32};
+    const auto after = image_surface::cache_stats();
+    CHECK( after.misses == before.misses + 1 );
+    CHECK( after.hits == before.hits + 1 );
+    CHECK( after.entries == 1 );
+    CHECK( CompareImages(first, second, 0.f) == true );
+
+    // A cached image is a copy: drawing on it leaves the cache, and later loads, alone.
+    second.paint(brush{ rgba_color::red });
+    auto third = image_surface{reference, image_file_format::png, format::argb32};
+    CHECK( CompareImages(first, third, 0.f) == true );
+
+    image_surface::cache_budget(0);
+    CHECK( image_surface::cache_stats().entries == 0 );
+}
+
+TEST_CASE("IO2D reduces images to a maximum dimension while loading them")
+{
+    // Each pixel of the 100x75 image is the average of a 5x5 block, so the corners are a little lighter than the full
+    // size image's.
+    auto tolerance = 0.02f;
+    for (auto [reference, iff] : { pair{ "image_500x375.png", image_file_format::png }, pair{ "image_500x375.jpg", image_file_format::jpeg } }) {
+        auto thumb = image_surface{reference, iff, format::argb32, 100};
+        CHECK( thumb.dimensions().x() == 100 );
+        CHECK( thumb.dimensions().y() == 75 );
+        CHECK( CompareImageColor(thumb, 0, 0, {77, 81, 91}, tolerance) == true );
+        CHECK( CompareImageColor(thumb, 99, 0, {186, 200, 219}, tolerance) == true );
+        CHECK( CompareImageColor(thumb, 99, 74, {202, 216, 236}, tolerance) == true );
+        CHECK( CompareImageColor(thumb, 0, 74, {198, 211, 233}, tolerance) == true );
+
+        // Images that already fit are loaded as they are.
+        auto full = image_surface{reference, iff, format::argb32};
+        auto unreduced = image_surface{reference, iff, format::argb32, 1000};
+        CHECK( CompareImages(unreduced, full, 0.f) == true );
+    }
+}
@@ -0,0 +1,87 @@
+#include "catch.hpp"
+#include <io2d.h>
+#include "comparison.h"
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+
+static interpreted_path Star()
+{
+    path_builder pb;
+    pb.new_figure({ 0.f, -20.f });
+    for( int i = 1; i < 5; ++i ) {
+        const auto angle = two_pi<float> * 2.f * i / 5.f;
+        pb.line({ 20.f * sinf(angle), -20.f * cosf(angle) });
+    }
+    pb.close_figure();
+    return interpreted_path{ pb };
+}
+
+static vector<path_instance> Instances(const brush& gradient)
+{
+    vector<path_instance> instances;
+    for( int i = 0; i < 8; ++i ) {
+        auto m = matrix_2d::create_rotate(0.3f * i) * matrix_2d::create_translate({ 30.f + 35.f * i, 40.f + 15.f * i });
+        if( i % 2 )
+            instances.emplace_back(m, rgba_color{ 0.1f * i, 0.5f, 1.f - 0.1f * i, 0.8f });
+        else
+            instances.emplace_back(m, gradient);
+    }
+    return instances;
+}
+
+TEST_CASE("Instanced fills and strokes match individual draw calls")
+{
+    const auto star = Star();
+    const auto gradient = brush{ {-20.f, 0.f}, {20.f, 0.f}, { {0.f, rgba_color::red}, {1.f, rgba_color::blue} } };
+    const auto instances = Instances(gradient);
+    const auto bp = brush_props{ wrap_mode::reflect, filter::good, fill_rule::even_odd };
+    const auto rp = render_props{ antialias::good, matrix_2d::create_scale({ 0.9f, 0.9f }) };
+    const auto sp = stroke_props{ 3.f, line_cap::round, line_join::bevel };
+    const auto d = dashes{ 0.f, { 6.f, 3.f } };
+
+    auto individually = [&](image_surface& img, bool stroke, const optional<clip_props>& cl) {
+        for( const auto& inst: instances ) {
+            auto irp = rp;
+            irp.surface_matrix(inst.matrix() * rp.surface_matrix());
+            const auto b = inst.has_brush() ? inst.brush() : brush{ inst.color() };
+            if( stroke )
+                img.stroke(b, star, bp, sp, d, irp, cl);
+            else
+                img.fill(b, star, bp, irp, cl);
+        }
+    };
+
+    SECTION("Fill") {
+        image_surface expected{ format::argb32, 300, 200 };
+        individually(expected, false, nullopt);
+        image_surface img{ format::argb32, 300, 200 };
+        img.fill_instances(star, begin(instances), end(instances), bp, rp);
+        CHECK( CompareImages(img, expected) == true );
+    }
+    SECTION("Stroke") {
+        image_surface expected{ format::argb32, 300, 200 };
+        individually(expected, true, nullopt);
+        image_surface img{ format::argb32, 300, 200 };
+        img.stroke_instances(star, begin(instances), end(instances), bp, sp, d, rp);
+        CHECK( CompareImages(img, expected) == true );
+    }
+    SECTION("The clip is transformed with each instance") {
+        const auto cl = clip_props{ bounding_box{ -20.f, -20.f, 40.f, 20.f } };
+        image_surface expected{ format::argb32, 300, 200 };
+        individually(expected, false, cl);
+        image_surface img{ format::argb32, 300, 200 };
+        img.fill_instances(star, begin(instances), end(instances), bp, rp, cl);
+        CHECK( CompareImages(img, expected) == true );
+    }
+    SECTION("Recorded instances replay like individual draw calls") {
+        image_surface expected{ format::argb32, 300, 200 };
+        individually(expected, true, nullopt);
+        recorded_scene scene;
+        scene.stroke_instances(star, begin(instances), end(instances), bp, sp, d, rp);
+        image_surface img{ format::argb32, 300, 200 };
+        img.render_tiled(scene, 64, 64, 2);
+        CHECK( CompareImages(img, expected) == true );
+    }
+}
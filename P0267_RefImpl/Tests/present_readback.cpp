@@ -0,0 +1,75 @@
+#include "catch.hpp"
+#include <io2d.h>
+#include <chrono>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+
+#if defined(_IO2D_CAIRO_XLIB_)
+
+// Looks for a viewable width x height window under parent that shows background at (5, 5) and square at (20, 20), reading
+// it back through the given connection rather than the one the output surface owns.
+static bool ShowsFrame(Display* display, Window parent, unsigned int width, unsigned int height, unsigned long background, unsigned long square)
+{
+    Window root, parentOfParent;
+    Window* children = nullptr;
+    unsigned int count = 0;
+    if( XQueryTree(display, parent, &root, &parentOfParent, &children, &count) == 0 )
+        return false;
+    unique_ptr<Window, decltype(&XFree)> childrenOwner{ children, &XFree };
+    for( unsigned int i = 0; i < count; ++i ) {
+        XWindowAttributes attr{};
+        if( XGetWindowAttributes(display, children[i], &attr) == 0 || attr.map_state != IsViewable )
+            continue;
+        if( static_cast<unsigned int>(attr.width) == width && static_cast<unsigned int>(attr.height) == height && attr.depth == 24 ) {
+            XImage* img = XGetImage(display, children[i], 0, 0, width, height, AllPlanes, ZPixmap);
+            if( img != nullptr ) {
+                const bool shows = (XGetPixel(img, 5, 5) & 0xffffff) == background && (XGetPixel(img, 20, 20) & 0xffffff) == square;
+                XDestroyImage(img);
+                if( shows )
+                    return true;
+            }
+        }
+        // Window managers reparent top level windows into frames.
+        if( ShowsFrame(display, children[i], width, height, background, square) )
+            return true;
+    }
+    return false;
+}
+
+TEST_CASE("Presented frames reach the X window")
+{
+    if( getenv("DISPLAY") == nullptr )
+        return; // Needs an X server, e.g. Xvfb.
+    unique_ptr<Display, decltype(&XCloseDisplay)> display{ XOpenDisplay(nullptr), &XCloseDisplay };
+    REQUIRE( display != nullptr );
+    if( DefaultDepth(display.get(), DefaultScreen(display.get())) != 24 )
+        return; // The pixel values below assume a TrueColor visual.
+
+    output_surface sfc{ 64, 64, format::argb32, scaling::none, refresh_style::fixed, 30.f };
+    int drawn = 0;
+    sfc.draw_callback([&](output_surface& s) {
+        // Several identical frames, so that presenting a frame has waited for the server to take the one before it
+        // whether it is shown from MIT-SHM memory or through the cairo Xlib surface.
+        s.paint(brush{ rgba_color::red });
+        s.fill(brush{ rgba_color::blue }, interpreted_path{ bounding_box{ 10.f, 10.f, 20.f, 20.f } });
+        if( ++drawn == 3 )
+            s.end_show();
+    });
+    sfc.begin_show();
+
+    // The window stays up until sfc is destroyed. The server may not have drawn the last requests yet, so give it a moment.
+    bool shown = false;
+    for( int attempt = 0; attempt < 50 && !shown; ++attempt ) {
+        shown = ShowsFrame(display.get(), DefaultRootWindow(display.get()), 64, 64, 0xff0000, 0x0000ff);
+        if( !shown )
+            this_thread::sleep_for(chrono::milliseconds(20));
+    }
+    CHECK( shown );
+}
+
+#endif
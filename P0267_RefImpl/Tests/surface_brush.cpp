@@ -7,6 +7,7 @@ using namespace std::experimental;
 using namespace std::experimental::io2d;
 
 static image_surface DrawCheckerboard4x4();
+static image_surface FineCheckerboard(int size);
 
 TEST_CASE("Properly draws with a non-wrapped surface brush")
 {
@@ -295,6 +296,121 @@ TEST_CASE("IO2D extends a non-papped surface brush with transparent_black")
     CHECK( CompareWithPNGImage(img, reference) == true );
 }
 
+TEST_CASE("IO2D samples minified mipmapped surface brushes without aliasing")
+{
+    // A one pixel checkerboard shrunk eight times. Nearest filtering of the full size image picks out single black or
+    // white pixels; the mip level it's drawn from instead has averaged them to grey.
+    auto tolerance = 0.01f;
+    auto bp = brush_props{ wrap_mode::repeat, filter::nearest };
+    bp.brush_matrix(matrix_2d::create_scale({ 8.f, 8.f }));
+
+    image_surface plain{ format::argb32, 32, 32 };
+    plain.paint(brush{ FineCheckerboard(256) }, bp);
+    CHECK( (CompareImageColor(plain, 5, 5, rgba_color::black) || CompareImageColor(plain, 5, 5, rgba_color::white)) );
+
+    image_surface mipmapped{ format::argb32, 32, 32 };
+    mipmapped.paint(brush{ FineCheckerboard(256), true }, bp);
+    for( int i = 0; i < 32; i += 5 )
+        CHECK( CompareImageColor(mipmapped, i, 31 - i, {128, 128, 128}, tolerance) == true );
+
+    // Shrinking with the surface matrix instead of the brush matrix picks the same level.
+    image_surface scaled{ format::argb32, 32, 32 };
+    auto rp = render_props{ antialias::none, matrix_2d::create_scale({ 0.125f, 0.125f }) };
+    scaled.paint(brush{ FineCheckerboard(256), true }, brush_props{ wrap_mode::repeat, filter::nearest }, rp);
+    CHECK( CompareImages(scaled, mipmapped, tolerance) == true );
+
+    // Drawn at full size, a mipmapped brush is the same as a plain one.
+    image_surface full{ format::argb32, 20, 20 };
+    image_surface fullMipmapped{ format::argb32, 20, 20 };
+    bp.brush_matrix(matrix_2d{});
+    full.paint(brush{ DrawCheckerboard4x4() }, bp);
+    fullMipmapped.paint(brush{ DrawCheckerboard4x4(), true }, bp);
+    CHECK( CompareImages(full, fullMipmapped) == true );
+}
+
+TEST_CASE("IO2D draws brush atlas entries like the images they were inserted from")
+{
+    // Pages small enough that the entries need more than one.
+    brush_atlas atlas{ format::argb32, 64 };
+    vector<image_surface> icons;
+    vector<size_t> keys;
+    for( int i = 0; i < 12; ++i ) {
+        auto size = 10 + (i % 4) * 5;
+        image_surface icon{ format::argb32, size, size };
+        icon.paint(brush{ DrawCheckerboard4x4() }, brush_props{ wrap_mode::repeat, filter::nearest });
+        icon.fill(brush{ rgba_color(i * 20, 255 - i * 20, 128) }, interpreted_path{ bounding_box{ 2.f, 2.f, size - 4.f, 3.f } });
+        keys.push_back(atlas.insert(icon));
+        icons.push_back(move(icon));
+    }
+    CHECK( atlas.size() == 12 );
+    CHECK( atlas.page_count() > 1 );
+
+    // Half pixel offsets with bilinear filtering sample the edges, which must blend with the gutter's transparency just
+    // as a lone image blends with what's outside it.
+    auto rp = render_props{ antialias::none };
+    image_surface expected{ format::argb32, 200, 150 };
+    image_surface actual{ format::argb32, 200, 150 };
+    for( size_t i = 0; i < keys.size(); ++i ) {
+        auto origin = point_2d{ (i % 4) * 50.f + 3.5f, (i / 4) * 50.f + 3.5f };
+        auto bounds = atlas.bounds(keys[i]);
+        auto area = interpreted_path{ bounding_box{ origin.x() - 1.f, origin.y() - 1.f, bounds.width() + 2.f, bounds.height() + 2.f } };
+        expected.fill(brush{ move(icons[i]) }, area, brush_props{ wrap_mode::none, filter::bilinear, fill_rule::winding, matrix_2d::create_translate({ -origin.x(), -origin.y() }) }, rp);
+        actual.fill(brush{ atlas, keys[i] }, area, brush_props{ wrap_mode::none, filter::bilinear, fill_rule::winding, atlas.brush_matrix(keys[i], origin) }, rp);
+    }
+    CHECK( CompareImages(expected, actual, 0.01f) == true );
+
+    SECTION("Erasing an entry frees its space for another") {
+        auto pages = atlas.page_count();
+        CHECK( atlas.erase(keys[0]) == true );
+        CHECK( atlas.erase(keys[0]) == false );
+        CHECK( atlas.contains(keys[0]) == false );
+        CHECK_THROWS_AS( atlas.bounds(keys[0]), system_error );
+        auto key = atlas.insert(image_surface{ format::argb32, 10, 10 });
+        CHECK( key != keys[0] );
+        CHECK( atlas.page(key) == 0 );
+        CHECK( atlas.page_count() == pages );
+    }
+    SECTION("Images too large for a page are refused") {
+        CHECK_THROWS_AS( atlas.insert(image_surface{ format::argb32, 63, 10 }), system_error );
+    }
+    SECTION("Clearing empties the atlas") {
+        atlas.clear();
+        CHECK( atlas.size() == 0 );
+        CHECK( atlas.page_count() == 0 );
+    }
+}
+
+TEST_CASE("IO2D keeps brush atlas neighbours out of minified draws given a wide enough gutter")
+{
+    CHECK( brush_atlas{}.gutter() == 1 );
+    CHECK_THROWS_AS( brush_atlas(format::argb32, 64, -1), system_error );
+    CHECK_THROWS_AS( brush_atlas(format::argb32, 8, 4), system_error );
+
+    // A red entry packed among green ones, drawn at a quarter size with filter::good, which averages about four
+    // pixels per output pixel. A gutter of four keeps the green out, so the entry looks like a lone red image drawn
+    // the same way.
+    brush_atlas atlas{ format::argb32, 64, 4 };
+    CHECK( atlas.gutter() == 4 );
+    image_surface red{ format::argb32, 16, 16 };
+    red.paint(brush{ rgba_color::red });
+    image_surface green{ format::argb32, 16, 16 };
+    green.paint(brush{ rgba_color::lime });
+    atlas.insert(green);
+    auto key = atlas.insert(red);
+    atlas.insert(green);
+    atlas.insert(green);
+    CHECK( atlas.page_count() == 1 );
+
+    auto rp = render_props{ antialias::none, matrix_2d::create_scale({ 0.25f, 0.25f }) };
+    auto origin = point_2d{ 6.f, 6.f };
+    auto area = interpreted_path{ bounding_box{ origin.x(), origin.y(), 16.f, 16.f } };
+    image_surface expected{ format::argb32, 8, 8 };
+    image_surface actual{ format::argb32, 8, 8 };
+    expected.fill(brush{ move(red) }, area, brush_props{ wrap_mode::none, filter::good, fill_rule::winding, matrix_2d::create_translate({ -origin.x(), -origin.y() }) }, rp);
+    actual.fill(brush{ atlas, key }, area, brush_props{ wrap_mode::none, filter::good, fill_rule::winding, atlas.brush_matrix(key, origin) }, rp);
+    CHECK( CompareImages(expected, actual, 0.01f) == true );
+}
+
 /**
  * Draws the following pattern:
  * BWBW
@@ -315,3 +431,11 @@ static image_surface DrawCheckerboard4x4()
     
     return img;
 }
+
+// A size x size checkerboard of single black and white pixels.
+static image_surface FineCheckerboard(int size)
+{
+    image_surface img{format::argb32, size, size};
+    img.paint(brush{ DrawCheckerboard4x4() }, brush_props{ wrap_mode::repeat, filter::nearest });
+    return img;
+}
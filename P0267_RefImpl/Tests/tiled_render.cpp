@@ -0,0 +1,132 @@
+#include "catch.hpp"
+#include <io2d.h>
+#include "comparison.h"
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+
+// Issues the same draws on either an image_surface or a recorded_scene.
+template <class Target>
+static void DrawScene(Target& target, const brush& checker)
+{
+    auto bg = brush{ {0.f, 0.f}, {300.f, 200.f}, { {0.f, rgba_color::navy}, {1.f, rgba_color::orange} } };
+    target.paint(bg);
+
+    auto circles = brush{ rgba_color::lime_green };
+    for( int i = 0; i < 12; ++i ) {
+        path_builder pb;
+        pb.new_figure({ 25.f * i + 7.f, 13.f * i + 9.f });
+        pb.arc({ 19.f, 19.f }, two_pi<float>, 0.f);
+        pb.close_figure();
+        target.fill(circles, pb);
+    }
+
+    path_builder zigzag;
+    zigzag.new_figure({ 3.f, 190.f });
+    for( int i = 1; i < 20; ++i )
+        zigzag.line({ 15.f * i + 3.f, (i % 2) ? 10.f : 190.f });
+    auto sp = stroke_props{ 4.5f, line_cap::round, line_join::round };
+    auto d = dashes{ 0.f, {20.f, 7.f} };
+    auto rp = render_props{ antialias::good, matrix_2d::create_rotate(0.05f, {150.f, 100.f}) };
+    target.stroke(brush{ rgba_color::white }, zigzag, nullopt, sp, d, rp);
+
+    auto bp = brush_props{ wrap_mode::repeat, filter::nearest };
+    bp.brush_matrix(matrix_2d::create_scale({ 0.25f, 0.25f }));
+    auto cl = clip_props{ bounding_box{ 70.f, 40.f, 150.f, 110.f } };
+    auto cp = render_props{ antialias::good, matrix_2d{}, compositing_op::multiply };
+    target.paint(checker, bp, cp, cl);
+
+    target.mask(brush{ rgba_color::crimson }, bg, nullopt, nullopt, nullopt, clip_props{ bounding_box{ 250.f, 0.f, 50.f, 200.f } });
+}
+
+static brush Checkerboard()
+{
+    image_surface img{ format::argb32, 4, 4 };
+    img.paint(brush{ rgba_color::black });
+    img.fill(brush{ rgba_color::yellow }, interpreted_path{ bounding_box{ 0.f, 0.f, 2.f, 2.f } });
+    img.fill(brush{ rgba_color::yellow }, interpreted_path{ bounding_box{ 2.f, 2.f, 2.f, 2.f } });
+    return brush{ move(img) };
+}
+
+TEST_CASE("Tiled rendering of a recorded scene is identical to direct rendering")
+{
+    auto checker = Checkerboard();
+
+    image_surface expected{ format::argb32, 300, 200 };
+    DrawScene(expected, checker);
+
+    recorded_scene rs;
+    DrawScene(rs, checker);
+    CHECK( rs.empty() == false );
+
+    SECTION("Single thread, tiles which don't divide the surface evenly") {
+        image_surface img{ format::argb32, 300, 200 };
+        img.render_tiled(rs, 37, 23, 1);
+        CHECK( CompareImages(img, expected) == true );
+    }
+    SECTION("Several threads") {
+        image_surface img{ format::argb32, 300, 200 };
+        img.render_tiled(rs, 64, 64, 4);
+        CHECK( CompareImages(img, expected) == true );
+    }
+    SECTION("One tile covering the whole surface") {
+        image_surface img{ format::argb32, 300, 200 };
+        img.render_tiled(rs, 512, 512);
+        CHECK( CompareImages(img, expected) == true );
+    }
+}
+
+TEST_CASE("Drawing on a tiled image surface is identical to drawing on an image surface")
+{
+    auto checker = Checkerboard();
+
+    image_surface expected{ format::argb32, 300, 200 };
+    DrawScene(expected, checker);
+
+    SECTION("Tiles which don't divide the surface evenly") {
+        tiled_image_surface tiled{ format::argb32, 300, 200, 48 };
+        CHECK( tiled.tile_size() == 48 );
+        DrawScene(tiled, checker);
+        CHECK( tiled.allocated_tiles() == 7 * 5 );
+        auto img = tiled.copy_region(bounding_box{ 0.f, 0.f, 300.f, 200.f });
+        CHECK( CompareImages(img, expected) == true );
+    }
+    SECTION("Tiles paged out to a store") {
+        tiled_image_surface tiled{ format::argb32, 300, 200, 48 };
+        tiled.page_to("tiled_render.store", 1);
+        DrawScene(tiled, checker);
+        CHECK( tiled.resident_tiles() < tiled.allocated_tiles() );
+        auto img = tiled.copy_region(bounding_box{ 0.f, 0.f, 300.f, 200.f });
+        CHECK( CompareImages(img, expected) == true );
+    }
+    SECTION("Saved as a tiled TIFF") {
+        tiled_image_surface tiled{ format::argb32, 300, 200, 64 };
+        DrawScene(tiled, checker);
+        tiled.save("tiled_render.tiff", image_file_format::tiff);
+        image_surface loaded{ "tiled_render.tiff", image_file_format::tiff, format::argb32 };
+        CHECK( CompareImages(loaded, expected) == true );
+
+        error_code ec;
+        tiled.save("tiled_render.png", image_file_format::png, ec);
+        CHECK( ec == errc::not_supported );
+    }
+}
+
+TEST_CASE("Tiled image surfaces only allocate the tiles that are drawn on")
+{
+    // Far wider than an image surface can be. The square straddles the corner where four tiles meet.
+    tiled_image_surface tiled{ format::argb32, 40000, 300, 256 };
+    CHECK( tiled.dimensions().x() == 40000 );
+    CHECK( tiled.allocated_tiles() == 0 );
+    tiled.fill(brush{ rgba_color::red }, interpreted_path{ bounding_box{ 35820.f, 236.f, 40.f, 40.f } });
+    CHECK( tiled.allocated_tiles() == 4 );
+
+    image_surface expected{ format::argb32, 100, 80 };
+    expected.fill(brush{ rgba_color::red }, interpreted_path{ bounding_box{ 20.f, 36.f, 40.f, 40.f } });
+    auto img = tiled.copy_region(bounding_box{ 35800.f, 200.f, 100.f, 80.f });
+    CHECK( CompareImages(img, expected) == true );
+
+    tiled.clear();
+    CHECK( tiled.allocated_tiles() == 0 );
+}
@@ -0,0 +1,58 @@
+#include "catch.hpp"
+#include <io2d.h>
+#include <sstream>
+#include <thread>
+
+using namespace std;
+using namespace std::experimental;
+using namespace std::experimental::io2d;
+
+TEST_CASE("Internal spans are exported as a Chrome trace")
+{
+    image_surface img{ format::argb32, 32, 32 };
+    img.paint(brush{ rgba_color::red });
+    img.fill(brush{ rgba_color::blue }, interpreted_path{ bounding_box{ 4.f, 4.f, 8.f, 8.f } });
+
+    stringstream trace;
+    write_chrome_trace(trace);
+    const auto json = trace.str();
+    CHECK( json.find("\"traceEvents\":[") != string::npos );
+#if defined(_IO2D_TRACE)
+    CHECK( json.find("\"name\":\"create_interpreted_path\"") != string::npos );
+    CHECK( json.find("\"name\":\"_Set_brush_props\"") != string::npos );
+    CHECK( json.find("\"name\":\"cairo_fill\"") != string::npos );
+    CHECK( json.find("\"ph\":\"X\"") != string::npos );
+#else
+    CHECK( json.find("\"name\"") == string::npos );
+#endif
+}
+
+#if defined(_IO2D_TRACE)
+static size_t CountSpans(const string& json, const string& name)
+{
+    const auto needle = "\"name\":\"" + name + "\"";
+    size_t count = 0;
+    for (auto pos = json.find(needle); pos != string::npos; pos = json.find(needle, pos + 1)) {
+        ++count;
+    }
+    return count;
+}
+
+TEST_CASE("Spans from threads that have exited are still exported")
+{
+    stringstream before;
+    write_chrome_trace(before);
+
+    for (int i = 0; i < 4; ++i) {
+        thread worker([]() {
+            image_surface img{ format::argb32, 16, 16 };
+            img.paint(brush{ rgba_color::green });
+        });
+        worker.join();
+    }
+
+    stringstream after;
+    write_chrome_trace(after);
+    CHECK( CountSpans(after.str(), "_Set_brush_props") >= CountSpans(before.str(), "_Set_brush_props") + 4 );
+}
+#endif